@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef CORRELATED_SHADOWING_PROPAGATION_LOSS_MODEL_H
+#define CORRELATED_SHADOWING_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/propagation-loss-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/vector.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/node-container.h"
+#include <unordered_map>
+
+namespace ns3 {
+class MobilityModel;
+namespace lorawan {
+
+class CorrelatedShadowingPropagationLossModel : public PropagationLossModel
+{
+
+public:
+  class Position
+  {
+public:
+    Position ();
+    Position (double x, double y);
+    double x;
+    double y;
+
+    bool operator== (const Position &other) const;
+    bool operator< (const Position &other) const;
+  };
+
+  class ShadowingMap : public
+                       SimpleRefCount<CorrelatedShadowingPropagationLossModel::ShadowingMap>
+  {
+public:
+    /**
+     * Constructor.
+     * This initializes the shadowing map with a grid of independent
+     * shadowing values, one correlationDistance meters apart from the next
+     * one. The result is something like:
+     *  o---o---o---o---o
+     *  |   |   |   |   |
+     *  o---o---o---o---o
+     *  |   |   |   |   |
+     *  o---o---o---o---o
+     *  |   |   |   |   |
+     *  o---o---o---o---o
+     *  where at each o we have an independently generated shadowing value.
+     *  Values on the grid are drawn the first time they are needed, and
+     *  then never change. We can then interpolate the 4 values surrounding
+     *  any point in space in order to get a correlated shadowing value.
+     *  After generating this value, we will add it to the map so that we
+     *  don't have to compute it twice. Also, since interpolation is a
+     *  deterministic operation, we are guaranteed that two values generated
+     *  in the same square will be correlated.
+     *
+     * \param correlationDistance The distance between points of the grid.
+     */
+    ShadowingMap (double correlationDistance = 110);
+
+    ~ShadowingMap ();
+
+    /**
+     * Get the loss for a certain position.
+     * If this position is not already in the map, add it by computing the
+     * interpolation of neighboring shadowing values belonging to the grid.
+     */
+    double GetLoss (CorrelatedShadowingPropagationLossModel::Position position);
+
+private:
+    /**
+     * Get the independent shadowing value at a point of the grid, drawing it
+     * if this is the first time it is needed.
+     *
+     * \param i The index of the point along the x axis.
+     * \param j The index of the point along the y axis.
+     */
+    double GetGridValue (int32_t i, int32_t j);
+
+    /**
+     * The independent shadowing values at the points of the grid, by the
+     * key of their indexes.
+     */
+    std::unordered_map<uint64_t, double> m_gridValues;
+
+    /**
+     * The shadowing values that were already interpolated, by the key of
+     * the 10 cm cell containing the position they were computed for.
+     */
+    std::unordered_map<uint64_t, double> m_shadowingMap;
+
+    /**
+     * The distance after which two samples are to be considered almost
+     * uncorrelated
+     */
+    double m_correlationDistance;
+
+    /**
+     * The normal random variable that is used to obtain shadowing values.
+     */
+    Ptr<NormalRandomVariable> m_shadowingValue;
+
+    /**
+     * The inverted K matrix.
+     * This matrix is used to compute the coefficients to be used when
+     * interpolating the vertices of a grid square.
+     */
+    static const double m_kInv[4][4];
+  };
+
+  static TypeId GetTypeId (void);
+
+  /**
+   * Constructor.
+   */
+  CorrelatedShadowingPropagationLossModel ();
+
+  /**
+   * Set the correlation distance for newly created ShadowingMap instances
+   */
+  void SetCorrelationDistance (double distance);
+
+  /**
+   * Get the correlation distance that is currently being used.
+   */
+  double GetCorrelationDistance (void);
+
+  /**
+   * Compute in advance the shadowing of all links from a set of senders to a
+   * set of receivers, at their current positions.
+   *
+   * This creates the ShadowingMap of every grid square containing a sender,
+   * and fills it with the shadowing at the positions of all receivers, so
+   * that no random values need to be drawn during the simulation for these
+   * links. Different ShadowingMap instances are filled by parallel threads,
+   * when threading is available.
+   *
+   * The values obtained for a link do not depend on the number of threads,
+   * but they differ from the ones that would be obtained by letting the
+   * simulation compute them lazily, since the order in which random values
+   * are drawn is different.
+   *
+   * \param senders The nodes transmitting on the links.
+   * \param receivers The nodes receiving on the links.
+   * \param nThreads The number of threads to use, or 0 to use all
+   * available cores.
+   */
+  void Generate (NodeContainer senders, NodeContainer receivers,
+                 uint32_t nThreads = 0);
+
+private:
+  /**
+   * Get the ShadowingMap associated to the grid square containing a position,
+   * creating it if necessary.
+   */
+  Ptr<ShadowingMap> GetShadowingMap (Vector position) const;
+
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  double m_correlationDistance;     //!< The correlation distance for the ShadowingMap
+
+  /**
+   * Map linking a square to a ShadowingMap.
+   * Each square of the shadowing grid has a corresponding ShadowingMap, and a
+   * square is identified by a pair of coordinates, packed in a single key.
+   * Coordinates are computed as such:
+   *
+   *  o---------o---------o---------o---------o---------o
+   *  |         |         |    '    |         |         |
+   *  |  (-2,2) |  (-1,2) |  (0,2)  |  (1,2)  |  (2,2)  |
+   *  |         |         |    '    |         |         |
+   *  o---------o---------o----+----o---------o---------o
+   *  |         |         |    '    |         |         |
+   *  |  (-2,1) |  (-1,1) |  (0,1)  |  (1,1)  |  (2,1)  |
+   *  |         |         |    '    |         |         |
+   *  o---------o---------o----+----o---------o---------o
+   *  |         |         |    '    |         |         |
+   *  |--(-2,0)-+--(-1,0)-+--(0,0)--+--(1,0)--+--(2,0)--|
+   *  |         |         |    '    |         |         |
+   *  o---------o---------o----+----o---------o---------o
+   *  |         |         |    '    |         |         |
+   *  | (-2,-1) | (-1,-1) | (0,-1)  | (1,-1)  | (2,-1)  |
+   *  |         |         |    '    |         |         |
+   *  o---------o---------o----+----o---------o---------o
+   *  |         |         |    '    |         |         |
+   *  | (-2,-2) | (-1,-2) | (0,-2)  | (1,-2)  | (2,-2)  |
+   *  |         |         |    '    |         |         |
+   *  o---------o---------o---------o---------o---------o
+   *
+   *  For each one of these coordinates, a ShadowingMap is computed. That is,
+   *  each one of the points belonging to the same square sees the same
+   *  shadowing for the points around it. This is one level of correlation for
+   *  the shadowing, i.e. close nodes transmitting to the same point will see
+   *  the same shadowing since they are using the same shadowing map.
+   *  Further, the ShadowingMap will be "smooth": when transmitting from point
+   *  a to points b and c, the shadowing experienced by b and c will be similar
+   *  if they are close (ideally, within a correlation distance).
+   */
+  mutable std::unordered_map<uint64_t, Ptr<ShadowingMap> > m_shadowingGrid;
+};
+
+}
+
+}
+#endif
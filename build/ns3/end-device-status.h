@@ -0,0 +1,488 @@
+/*
+ * Copyright (c) 2018 University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Martina Capuzzo <capuzzom@dei.unipd.it>
+ *          Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef END_DEVICE_STATUS_H
+#define END_DEVICE_STATUS_H
+
+#include "ns3/object.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-device-address.h"
+#include "ns3/lora-mac-header.h"
+#include "ns3/end-device-lora-mac.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lora-tag.h"
+#include "ns3/pointer.h"
+#include "ns3/lora-mac-header.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/simple-ref-count.h"
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * Assigns a small index to each gateway address, so that EndDeviceStatus
+ * objects can refer to gateways without storing their whole Address.
+ *
+ * A table is shared by all the EndDeviceStatus objects of a NetworkStatus.
+ */
+class GatewayAddressTable : public SimpleRefCount<GatewayAddressTable>
+{
+public:
+  /**
+   * Get the index of a gateway address, assigning a new one if the address
+   * was never seen before.
+   */
+  uint16_t GetIndex (const Address& address);
+
+  /**
+   * Get the index of a gateway address, without assigning one.
+   *
+   * \return False if the address was never seen before.
+   */
+  bool FindIndex (const Address& address, uint16_t &index) const;
+
+  /**
+   * Get the address of the gateway with a certain index.
+   */
+  Address GetAddress (uint16_t index) const;
+
+private:
+  /**
+   * Hash an address, including its type.
+   */
+  struct AddressHash
+  {
+    std::size_t operator() (const Address& address) const;
+  };
+
+  std::vector<Address> m_addresses; //!< The addresses, by index
+  std::unordered_map<Address, uint16_t, AddressHash> m_indexes; //!< The indexes, by address
+};
+
+/**
+ * This class represents the Network Server's knowledge about an End Device in
+ * the LoRaWAN network it is administering.
+ *
+ * The Network Server's NetworkStatus component contains a list of instances of
+ * this class, one for each device in the network. Each instance contains all
+ * the parameters and information of the end device and the packets received
+ * from it. Furthermore, this class holds the reply packet that the network
+ * server will send to this device at the first available receive window. Upon
+ * new packet arrivals at the Network Server, the OnReceivedPacket method is
+ * called to update the information regarding the last received packet and its
+ * parameters.
+ *
+ */
+
+/*
+ * Diagram of the end-device-status data structure. One instance of this class
+ * for each ED, that will be identified by its address.
+ *
+ * Public Access:
+ *
+ *  (ED address) --- Current device parameters:
+ *                   - First Receive Window SF and DRRe
+ *                   - First Receive Window frequency
+ *                   - Second Window SF and DR
+ *                   - Second Receive Window frequency
+ *               --- Reply
+ *                   - Need for reply (true/false)
+ *                   - Updated reply
+ *               --- Received Packets
+ *                   - Received packets list (see below).
+ *
+ *
+ * Private Access:
+ *
+ *  (Received packets list) - List of gateways that received the packet (see below)
+ *                          - SF of the received packet
+ *                          - Frequency of the received packet
+ *                          - Bandwidth of the received packet
+ *
+ *  (Gateway list) - Time at which the packet was received
+ *                 - Reception power
+ *
+ * Only the last ReceivedPacketHistory packets are kept, in a ring buffer of
+ * flat records. For each packet, the record holds the best
+ * MAX_GATEWAYS_PER_PACKET gateways that received it (by reception power), as
+ * indexes in a GatewayAddressTable, and the total number of gateways that
+ * received it. The ReceivedPacketList and GatewayList structures returned by
+ * this class are built from these records on request.
+ */
+
+class EndDeviceStatus : public Object
+{
+
+public:
+  /********************/
+  /* Reply management */
+  /********************/
+
+  /**
+   * Structure representing the reply that the network server will send this
+   * device at the first opportunity.
+   */
+  struct Reply
+  {
+    // The Mac Header to attach to the reply packet.
+    LoraMacHeader macHeader;
+
+    // The Frame Header to attach to the reply packet.
+    LoraFrameHeader frameHeader;
+
+    // The data packet that will be sent as a reply.
+    Ptr<Packet> payload;
+
+    // Whether or not this device needs a reply
+    bool needsReply = false;
+  };
+
+  /**
+   * Whether the end device needs a reply.
+   *
+   * This is determined by looking at headers and payload of the Reply
+   * structure: if they are empty, no reply should be needed.
+   *
+   * \return A boolean value signaling if the end device needs a reply.
+   */
+  bool NeedsReply (void);
+
+  /**
+   * Get the reply packet.
+   *
+   * \return A pointer to the packet reply (data + headers).
+   */
+  Ptr<Packet> GetCompleteReplyPacket (void);
+
+  /**
+   * Get the reply packet mac header.
+   *
+   * \return The packet reply mac header.
+   */
+  LoraMacHeader GetReplyMacHeader (void);
+
+  /**
+   * Get the reply packet frame header.
+   *
+   * \return The packet reply frame header.
+   */
+  LoraFrameHeader GetReplyFrameHeader (void);
+
+  /**
+   * Get the data of the reply packet.
+   *
+   * \return A pointer to the packet reply.
+   */
+  Ptr<Packet> GetReplyPayload (void);
+
+  /***********************************/
+  /* Received packet list management */
+  /***********************************/
+
+  /**
+   * Structure saving information regarding the packet reception in
+   * each gateway.
+   */
+  struct PacketInfoPerGw
+  {
+    Address gwAddress;     //!< Address of the gateway that received the packet.
+    Time receivedTime;     //!< Time at which the packet was received by this gateway.
+    double rxPower;        //!< Reception power of the packet at this gateway.
+  };
+
+  // List of gateways, with relative information
+  typedef std::map<Address, PacketInfoPerGw> GatewayList;
+
+  /**
+   * Structure saving information regarding all packet receptions.
+   */
+  struct ReceivedPacketInfo
+  {
+    // Members
+    Ptr<Packet const> packet = 0;   //!< The received packet
+    GatewayList gwList;      //!< List of gateways that received this packet.
+    uint8_t sf;
+    double frequency;
+  };
+
+  typedef std::list<std::pair<Ptr<Packet const>, ReceivedPacketInfo> >
+    ReceivedPacketList;
+
+
+  /*******************************************/
+  /* Proper EndDeviceStatus class definition */
+  /*******************************************/
+
+  /**
+   * The maximum number of gateways that are remembered for each received
+   * packet.
+   */
+  static const uint8_t MAX_GATEWAYS_PER_PACKET = 4;
+
+  static TypeId GetTypeId (void);
+
+  EndDeviceStatus ();
+  EndDeviceStatus (LoraDeviceAddress endDeviceAddress,
+                   Ptr<EndDeviceLoraMac> endDeviceMac);
+  virtual ~EndDeviceStatus ();
+
+  /**
+   * Get the spreading factor this device is using in the first receive window.
+   *
+   * \return An unsigned 8-bit integer containing the spreading factor.
+   */
+  uint8_t GetFirstReceiveWindowSpreadingFactor (void);
+
+  /**
+   * Get the first window frequency of this device.
+   */
+  double GetFirstReceiveWindowFrequency (void);
+
+  /**
+   * Get the offset of spreading factor this device is using in the second
+   * receive window with respect to the first receive window.
+   *
+   * \return An unsigned 8-bit integer containing the spreading factor.
+   */
+  uint8_t GetSecondReceiveWindowOffset (void);
+
+  /**
+   * Return the second window frequency of this device.
+   *
+   */
+  double GetSecondReceiveWindowFrequency (void);
+
+  /**
+   * Get the received packet list.
+   *
+   * \return The received packet list.
+   */
+  ReceivedPacketList GetReceivedPacketList (void);
+
+  /**
+   * Set the spreading factor this device is using in the first receive window.
+   */
+  void SetFirstReceiveWindowSpreadingFactor (uint8_t sf);
+
+  /**
+   * Set the first window frequency of this device.
+   */
+  void SetFirstReceiveWindowFrequency (double frequency);
+
+  /**
+   * Set the spreading factor this device is using in the first receive window.
+   */
+  void SetSecondReceiveWindowOffset (uint8_t offset);
+
+  /**
+   * Set the second window frequency of this device.
+   */
+  void SetSecondReceiveWindowFrequency  (double frequency);
+
+  /**
+   * Set the reply packet mac header.
+   */
+  void SetReplyMacHeader (LoraMacHeader macHeader);
+
+  /**
+   * Set the reply packet frame header.
+   */
+  void SetReplyFrameHeader (LoraFrameHeader frameHeader);
+
+  /**
+   * Set the packet reply payload.
+   */
+  void SetReplyPayload (Ptr<Packet> replyPayload);
+
+  Ptr<EndDeviceLoraMac> GetMac (void);
+
+  //////////////////////
+  //  Other methods  //
+  //////////////////////
+
+  /**
+   * Insert a received packet in the packet list.
+   */
+  void InsertReceivedPacket (Ptr<Packet const> receivedPacket,
+                             const Address& gwAddress);
+
+  /**
+   * Insert a received packet in the packet list, given the frame counter and
+   * the LoraTag the caller already extracted from it, so that its headers
+   * are not parsed again.
+   *
+   * \param receivedPacket The packet forwarded by the gateway.
+   * \param gwAddress The address of the gateway.
+   * \param fCnt The frame counter of the packet.
+   * \param tag The LoraTag of the packet.
+   */
+  void InsertReceivedPacket (Ptr<Packet const> receivedPacket,
+                             const Address& gwAddress, uint16_t fCnt,
+                             const LoraTag &tag);
+
+  /**
+   * Add the information about a gateway that received a copy of a packet in
+   * the packet list. Copies of packets that already left the list are
+   * ignored.
+   *
+   * \param receivedPacket The copy forwarded by the gateway.
+   * \param gwAddress The address of the gateway.
+   * \param fCnt The frame counter of the packet.
+   */
+  void InsertGatewayReception (Ptr<Packet const> receivedPacket,
+                               const Address& gwAddress, uint16_t fCnt);
+
+  /**
+   * Return the last packet that was received from this device.
+   */
+  Ptr<Packet const> GetLastPacketReceivedFromDevice (void);
+
+  /**
+   * Return the information about the last packet that was received from the
+   * device.
+   */
+  EndDeviceStatus::ReceivedPacketInfo GetLastReceivedPacketInfo (void);
+
+  /**
+   * Return the number of gateways that received the last packet from the
+   * device, including the ones that are not in its gateway list.
+   */
+  uint16_t GetLastReceivedPacketGatewayCount (void);
+
+  /**
+   * Return the power the last packet from the device was received with by
+   * the best gateway, or -infinity if no packet was received.
+   */
+  double GetLastReceivedPacketBestRxPower (void);
+
+  /**
+   * Set the table used to translate gateway addresses to indexes.
+   */
+  void SetGatewayAddressTable (Ptr<GatewayAddressTable> table);
+
+  /**
+   * Initialize reply.
+   */
+  void InitializeReply (void);
+
+  /**
+   * Add MAC command to the list.
+   */
+  void AddMACCommand (Ptr<MacCommand> macCommand);
+
+  /**
+   * Update Gateway data when more then one gateway receive the same packet.
+   */
+  void UpdateGatewayData (GatewayList gwList, Address gwAddress, double rcvPower);
+
+  /**
+   * Return the best gateway that:
+   * - Can reach this device
+   * - Is available to send a packet
+   */
+  Address GetBestGatewayForReply (void);
+
+  struct Reply m_reply;   //<! Next reply intended for this device
+
+  LoraDeviceAddress m_endDeviceAddress;   //<! The address of this device
+
+  friend std::ostream& operator<< (std::ostream& os, const EndDeviceStatus& status);
+
+private:
+  // Receive window data
+  uint8_t m_firstReceiveWindowSpreadingFactor = 0;
+  double m_firstReceiveWindowFrequency = 0;
+  uint8_t m_secondReceiveWindowOffset = 0;
+  double m_secondReceiveWindowFrequency = 868.625;
+
+  /**
+   * The information about a gateway that received a packet.
+   */
+  struct GatewayReception
+  {
+    Time receivedTime; //!< Time at which the packet was received by the gateway
+    double rxPower; //!< Reception power of the packet at the gateway
+    uint16_t gateway; //!< Index of the gateway in the GatewayAddressTable
+  };
+
+  /**
+   * A packet received from this device.
+   */
+  struct Reception
+  {
+    Ptr<Packet const> packet; //!< The received packet
+    double frequency; //!< The frequency of the packet
+    uint16_t fCnt; //!< The frame counter of the packet
+    uint8_t sf; //!< The spreading factor of the packet
+    uint8_t nStoredGateways; //!< The number of valid entries in gateways
+    uint16_t nGateways; //!< The number of gateways that received the packet
+    GatewayReception gateways[MAX_GATEWAYS_PER_PACKET]; //!< The best gateways
+  };
+
+  /**
+   * Get the last packet that was received, or 0 if there is none.
+   */
+  Reception * GetLastReception (void);
+
+  /**
+   * Set the capacity of the ring buffer, keeping the newest packets if it
+   * shrinks.
+   */
+  void SetHistoryDepth (uint32_t depth);
+
+  /**
+   * Get the capacity of the ring buffer.
+   */
+  uint32_t GetHistoryDepth (void) const;
+
+  /**
+   * Get the newest packet with a frame counter, or 0 if there is none.
+   */
+  Reception * FindReception (uint16_t fCnt);
+
+  /**
+   * Add a gateway to a reception, replacing the worst one if the reception
+   * already holds MAX_GATEWAYS_PER_PACKET gateways.
+   */
+  void AddGateway (Reception &reception, const Address& gwAddress,
+                   double rxPower);
+
+  /**
+   * Build the public representation of a reception.
+   */
+  ReceivedPacketInfo GetReceivedPacketInfo (const Reception &reception) const;
+
+  std::vector<Reception> m_receptions; //!< Ring buffer of received packets
+  uint32_t m_nextReception; //!< Index of m_receptions where the next packet goes
+  uint32_t m_historyDepth; //!< The capacity of the ring buffer
+  Ptr<GatewayAddressTable> m_gatewayTable; //!< The table of gateway indexes
+
+  // NOTE Using this attribute is 'cheating', since we are assuming perfect
+  // synchronization between the info at the device and at the network server
+  Ptr<EndDeviceLoraMac> m_mac;   //!< Pointer to the MAC layer of this device
+};
+}
+
+}
+#endif /* DEVICE_STATUS_H */
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LORA_BACKGROUND_TRAFFIC_HELPER_H
+#define LORA_BACKGROUND_TRAFFIC_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/lora-background-traffic.h"
+#include "ns3/gateway-lora-phy.h"
+
+#include <map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * Calibrates the load seen by gateways in a full simulation, and replays it
+ * with LoraBackgroundTraffic objects in simulations where most devices are
+ * not simulated explicitly.
+ *
+ * During calibration, the signals arriving at the gateways are counted by
+ * (gateway, frequency, spreading factor), and the power and duration of a
+ * uniform random sample of them (drawn with reservoir sampling) are kept.
+ * Calibration should thus be run with the population of devices that will be
+ * replaced: if other devices are simulated at the same time, the signals can
+ * be restricted to the ones sent by the devices to replace, so that devices
+ * that are still simulated explicitly are not counted twice. The rates are
+ * then the number of signals divided by the calibration time, and can be
+ * scaled when the calibrated population is a fraction of the one to replace.
+ *
+ * Gateways are identified by their position in the NodeContainer, so that the
+ * calibration can be installed on the gateways of a different simulation.
+ */
+class LoraBackgroundTrafficHelper
+{
+public:
+  LoraBackgroundTrafficHelper ();
+  ~LoraBackgroundTrafficHelper ();
+
+  /**
+   * Set the maximum number of samples that are kept for each (gateway,
+   * frequency, spreading factor) process. By default, 1000 samples are kept.
+   */
+  void SetMaxSamples (uint32_t maxSamples);
+
+  /**
+   * Start counting the signals arriving at some gateways, forgetting the
+   * previous calibration.
+   */
+  void StartCalibration (NodeContainer gateways);
+
+  /**
+   * Start counting the signals sent by some end devices and arriving at some
+   * gateways, forgetting the previous calibration.
+   *
+   * Signals are matched through the uid of their packet, which is recorded
+   * when an end device starts sending it.
+   *
+   * \param gateways The gateways whose incoming signals are counted.
+   * \param endDevices The end devices whose signals are counted.
+   */
+  void StartCalibration (NodeContainer gateways, NodeContainer endDevices);
+
+  /**
+   * Stop counting signals, disconnecting from the trace sources of the
+   * gateways and end devices, and compute the arrival rates.
+   */
+  void StopCalibration (void);
+
+  /**
+   * Get the calibrated arrival rate of signals at a gateway.
+   *
+   * \param gateway The position of the gateway in the calibrated container.
+   * \param frequencyMHz The frequency of the signals.
+   * \param sf The spreading factor of the signals.
+   * \return The mean number of signals per second.
+   */
+  double GetRate (uint32_t gateway, double frequencyMHz, uint8_t sf) const;
+
+  /**
+   * Get the power and duration samples of the signals arriving at a gateway.
+   *
+   * \param gateway The position of the gateway in the calibrated container.
+   * \param frequencyMHz The frequency of the signals.
+   * \param sf The spreading factor of the signals.
+   * \return The samples, which are empty if no signal was seen.
+   */
+  std::vector<LoraBackgroundTraffic::Sample> GetSamples (uint32_t gateway,
+                                                         double frequencyMHz,
+                                                         uint8_t sf) const;
+
+  /**
+   * Aggregate a LoraBackgroundTraffic object replaying the calibrated load to
+   * each gateway, starting at the current time.
+   *
+   * \param gateways The gateways, in the same order as during calibration.
+   * \param rateScale The factor the calibrated rates are multiplied by.
+   */
+  void Install (NodeContainer gateways, double rateScale = 1) const;
+
+  /**
+   * Assign fixed random variable streams to the LoraBackgroundTraffic objects
+   * of some gateways.
+   *
+   * \return The number of stream indexes assigned.
+   */
+  int64_t AssignStreams (NodeContainer gateways, int64_t stream) const;
+
+  /**
+   * Assign a fixed random variable stream to the selection of calibration
+   * samples.
+   *
+   * \return The number of stream indexes assigned.
+   */
+  int64_t AssignCalibrationStreams (int64_t stream);
+
+private:
+  /**
+   * The signals that arrived at a gateway with a certain frequency and
+   * spreading factor during calibration.
+   */
+  struct ProcessProfile
+  {
+    ProcessProfile ();
+
+    uint64_t arrivals; //!< The number of signals
+    std::vector<LoraBackgroundTraffic::Sample> samples; //!< A uniform sample of them
+  };
+
+  /**
+   * The packets sent by the end devices whose signals are calibrated.
+   */
+  class SenderFilter : public SimpleRefCount<SenderFilter>
+  {
+public:
+    /**
+     * Trace sink for the StartSending trace source of the end device PHYs.
+     */
+    void StartSending (Ptr<const Packet> packet, uint32_t node);
+
+    std::unordered_set<uint64_t> packets; //!< The uids of the sent packets
+  };
+
+  /**
+   * The signals that arrived at a gateway during calibration.
+   */
+  class GatewayProfile : public SimpleRefCount<GatewayProfile>
+  {
+public:
+    GatewayProfile (uint32_t maxSamples, Ptr<UniformRandomVariable> random,
+                    Ptr<const SenderFilter> filter);
+
+    /**
+     * Trace sink for the SignalArrival trace source of the gateway PHY.
+     */
+    void SignalArrival (Ptr<const Packet> packet, double rxPowerDbm, uint8_t sf,
+                        Time duration, double frequencyMHz);
+
+    uint32_t maxSamples; //!< The maximum number of samples per process
+    Ptr<UniformRandomVariable> random; //!< Selects the replaced samples
+    Ptr<const SenderFilter> filter; //!< The accepted senders, if any
+    std::map<std::pair<double, uint8_t>, ProcessProfile> processes; //!< By (frequency, SF)
+  };
+
+  /**
+   * Disconnect from the trace sources connected by StartCalibration.
+   */
+  void Disconnect (void);
+
+  uint32_t m_maxSamples; //!< The maximum number of samples per process
+  Ptr<UniformRandomVariable> m_random; //!< Selects calibration samples
+  std::vector<Ptr<GatewayProfile> > m_profiles; //!< By gateway
+  std::vector<Ptr<GatewayLoraPhy> > m_gatewayPhys; //!< The traced gateways
+  Ptr<SenderFilter> m_filter; //!< The accepted senders, if any
+  std::vector<Ptr<LoraPhy> > m_endDevicePhys; //!< The traced end devices
+  Time m_calibrationStart; //!< When calibration started
+  Time m_calibrationTime; //!< The duration of calibration
+};
+
+}
+}
+#endif /* LORA_BACKGROUND_TRAFFIC_HELPER_H */
@@ -0,0 +1,529 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ *
+ * The structure of this class is inspired by the YansWifiChannel
+ * contained in the WiFi module.
+ */
+
+#ifndef LORA_CHANNEL_H
+#define LORA_CHANNEL_H
+
+#include <vector>
+#include <map>
+#include <set>
+#include "ns3/lora-phy.h"
+#include "ns3/mobility-model.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/logical-lora-channel.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+class NetDevice;
+class PropagationLossModel;
+class PropagationDelayModel;
+namespace lorawan {
+
+class LoraPhy;
+struct LoraTxParameters;
+
+/**
+ * A struct that holds meaningful parameters for transmission on a
+ * LoraChannel.
+ */
+struct LoraChannelParameters
+{
+  double rxPowerDbm;     //!< The reception power.
+  uint8_t sf;     //!< The Spreading Factor of this transmission.
+  Time duration;     //!< The duration of the transmission.
+  double frequencyMHz;     //!< The frequency [MHz] of this transmission.
+};
+
+/**
+ * Allow logging of LoraChannelParameters like with any other data type.
+ */
+std::ostream &operator << (std::ostream &os, const LoraChannelParameters &params);
+
+/**
+ * The class that delivers packets among PHY layers.
+ *
+ * This class is tasked with taking packets that PHY layers want to send and,
+ * based on some factors like the transmission power and the node positions,
+ * computing the power at every receiver using a PropagationLossModel and
+ * notifying them of the reception event after a delay based on some
+ * PropagationDelayModel.
+ */
+class LoraChannel : public Channel
+{
+public:
+  // TypeId
+  static TypeId GetTypeId (void);
+
+  // Constructor and destructor
+  LoraChannel ();
+  virtual ~LoraChannel ();
+
+  // Inherited from Channel.
+  virtual std::size_t GetNDevices (void) const;
+  virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
+
+  /**
+    * Construct a LoraChannel with a loss and delay model.
+    *
+    * \param loss The loss model to associate to this channel.
+    * \param delay The delay model to associate to this channel.
+    */
+  LoraChannel (Ptr<PropagationLossModel> loss,
+               Ptr<PropagationDelayModel> delay);
+
+  /**
+    * Connect a LoraPhy object to the LoraChannel.
+    *
+    * This method is needed so that the channel knows it has to notify this PHY
+    * of incoming transmissions.
+    *
+    * \param phy The physical layer to add.
+    */
+  void Add (Ptr<LoraPhy> phy);
+
+  /**
+    * Remove a physical layer from the LoraChannel.
+    *
+    * This method removes a phy from the list of devices we have to notify.
+    * Removing unused PHY layers from the channel can improve performance, since
+    * it is not necessary to notify them about each transmission.
+    *
+    * \param phy The physical layer to remove.
+    */
+  void Remove (Ptr<LoraPhy> phy);
+
+  /**
+    * Register or unregister a PHY as currently listening.
+    *
+    * Gateway PHYs are always considered to be listening, while end device
+    * PHYs notify the channel when they switch to and from the STANDBY and RX
+    * states. If the OnlyListeningPhys attribute is set, transmissions are
+    * only delivered to PHYs that are listening.
+    *
+    * \param phy The PHY whose listening state changed.
+    * \param listening Whether the PHY is now listening.
+    */
+  void SetListening (Ptr<LoraPhy> phy, bool listening);
+
+  /**
+    * Send a packet in the channel.
+    *
+    * This method is typically invoked by a PHY that needs to send a packet.
+    * Every connected Phy will be notified of this packet send through a call to
+    * their StartReceive methods after a delay based on the channel's
+    * PropagationDelayModel.
+    *
+    * \param sender The phy that is sending this packet.
+    * \param packet The PHY layer packet that is being sent over the channel.
+    * \param txPowerDbm The power of the transmission.
+    * \param txParams The set of parameters that are used by the transmitter.
+    * \param duration The on-air duration of this packet.
+    * \param frequencyMHz The frequency this transmission will happen at.
+    *
+    * \internal
+    *
+    * When this method is called, the channel schedules an internal Receive call
+    * that performs the actual call to the PHY's StartReceive function.
+    */
+  void Send (Ptr<LoraPhy> sender, Ptr<Packet> packet, double txPowerDbm,
+             LoraTxParameters txParams, Time duration, double frequencyMHz)
+  const;
+
+  /**
+    * Compute the received power when transmitting from a point to another one.
+    *
+    * This method can be used by external object to see the receive power of a
+    * transmission from one point to another using this Channel's
+    * PropagationLossModel.
+    *
+    * \param txPowerDbm The power the transmitter is using, in dBm.
+    * \param senderMobility The mobility model of the sender.
+    * \param receiverMobility The mobility model of the receiver.
+    * \return The received power in dBm.
+    */
+  double GetRxPower (double txPowerDbm, Ptr<MobilityModel> senderMobility,
+                     Ptr<MobilityModel> receiverMobility) const;
+
+  /**
+   * Check whether GetRxPower can be called by multiple threads at the same
+   * time.
+   *
+   * This is only true if all loss models in the chain are known to compute
+   * their values without drawing random numbers or storing state.
+   *
+   * \return True if GetRxPower is thread-safe.
+   */
+  bool IsRxPowerThreadSafe (void) const;
+
+  /**
+   * Forward the transmissions of local PHYs to a partition of a distributed
+   * simulation that is run by another process.
+   *
+   * Each partition needs a device whose MpiReceiver passes the received
+   * messages to ReceiveRemote (see LoraPartitionHelper).
+   *
+   * Remote senders are only known by their position, so the simulation aborts
+   * unless the propagation loss models are deterministic functions of
+   * positions (see IsRxPowerThreadSafe), and the delay model is a
+   * ConstantSpeedPropagationDelayModel. This rules out, e.g., random and
+   * building-aware loss models. ns-3 must be configured with --enable-mpi.
+   *
+   * \param node The id of a node of the remote partition.
+   * \param device The index of the device of that node that receives
+   * transmissions.
+   * \param lookAhead The time after which the remote partition receives the
+   * message, which can't be larger than the propagation delay between any
+   * local PHY and any remote one.
+   */
+  void AddRemotePartition (uint32_t node, uint32_t device, Time lookAhead);
+
+  /**
+   * Deliver a transmission forwarded by another partition to the local PHYs.
+   *
+   * \param message The PHY packet, preceded by a LoraRemoteTransmissionHeader.
+   */
+  void ReceiveRemote (Ptr<Packet> message);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * Rebuild the structures that refer to PHYs through their index in
+   * m_phyList.
+   */
+  void RebuildPhyIndexes (void);
+
+  /**
+   * Abort if the propagation models can't be used in a distributed
+   * simulation (see AddRemotePartition).
+   */
+  void CheckDistributedModels (void) const;
+
+  /**
+   * Find the PHYs that belong to nodes simulated by other processes.
+   */
+  void UpdateRemotePhys (void) const;
+
+  /**
+   * Schedule the reception of a transmission at the local PHYs that are
+   * interested in it.
+   *
+   * \param sender The PHY that sent the transmission, or 0 if it belongs to
+   * another partition.
+   * \param senderMobility The mobility model of the sender.
+   * \param isDownlink Whether the sender is a gateway.
+   * \param packet The PHY layer packet.
+   * \param txPowerDbm The power of the transmission.
+   * \param sf The spreading factor of the transmission.
+   * \param duration The on-air duration of the transmission.
+   * \param frequencyMHz The frequency of the transmission.
+   * \param elapsed The time since the transmission started, which is
+   * subtracted from propagation delays.
+   */
+  void Deliver (Ptr<LoraPhy> sender, Ptr<MobilityModel> senderMobility,
+                bool isDownlink, Ptr<Packet> packet, double txPowerDbm,
+                uint8_t sf, Time duration, double frequencyMHz, Time elapsed)
+  const;
+
+  /**
+   * Index of a cell of the uniform grid used to cull receivers in Send.
+   */
+  typedef std::pair<int32_t, int32_t> GridCell;
+
+  /**
+   * Compute the grid cell a position falls into.
+   *
+   * \param position The position to map to a cell.
+   * \return The cell containing the position.
+   */
+  GridCell GetGridCell (Vector position) const;
+
+  /**
+   * Rebuild the spatial index from scratch, based on the current positions of
+   * all connected PHYs, and start tracking their position changes.
+   *
+   * This is done lazily at the first Send after a PHY is added or removed,
+   * since at Add time the PHY may not be connected to a node yet. Since PHY
+   * indexes may have changed, this also empties the link budget cache.
+   */
+  void BuildSpatialIndex (void) const;
+
+  /**
+   * Move the PHYs using a mobility model to the grid cell corresponding to
+   * their new position, and invalidate their cached link budgets.
+   *
+   * This method is connected to the CourseChange trace source of the mobility
+   * models of all the PHYs in the spatial index.
+   *
+   * \param mobility The mobility model whose position changed.
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility) const;
+
+  /**
+   * Check whether the loss and delay models always return the same values for
+   * the same pair of positions, so that link budgets can be cached.
+   *
+   * This is only true if the delay model is a
+   * ConstantSpeedPropagationDelayModel, and all loss models in the chain are
+   * known to be deterministic functions of positions, or are configured to
+   * keep their random components frozen for each link (see
+   * BuildingPenetrationLoss's FrozenPerLink attribute). Unknown models
+   * disable the cache.
+   *
+   * \return True if link budgets can be cached.
+   */
+  bool IsLinkBudgetCacheable (void) const;
+
+  /**
+   * Empty the link budget cache if the loss or delay models were replaced
+   * since the cached values were computed, and check whether the current
+   * models allow link budgets to be cached.
+   *
+   * This is done at every Send, so that changes to the chain of loss models
+   * are taken into account. Changes to the attributes of the models are not
+   * detected.
+   *
+   * \return True if link budgets can be cached.
+   */
+  bool UpdateLinkBudgetCache (void) const;
+
+  /**
+   * Get the received power and delay of a transmission between two PHYs,
+   * using the cached values if the PHYs did not move since they were
+   * computed.
+   *
+   * \param senderIndex The index of the sender in m_phyList.
+   * \param receiverIndex The index of the receiver in m_phyList.
+   * \param txPowerDbm The transmission power.
+   * \param senderMobility The mobility model of the sender.
+   * \param receiverMobility The mobility model of the receiver.
+   * \param rxPowerDbm The received power [dBm] is stored here.
+   * \param delay The propagation delay is stored here.
+   */
+  void GetLinkBudget (uint32_t senderIndex, uint32_t receiverIndex,
+                      double txPowerDbm, Ptr<MobilityModel> senderMobility,
+                      Ptr<MobilityModel> receiverMobility, double &rxPowerDbm,
+                      Time &delay) const;
+
+  /**
+   * Fill a vector with the indexes of the PHYs that are within m_maxRange of
+   * a position.
+   *
+   * The indexes are returned in increasing order, so that reception events
+   * are scheduled in the same order as with a full scan of m_phyList.
+   *
+   * \param position The position of the transmitter.
+   * \param candidates The vector to fill with PHY indexes.
+   */
+  void GetPhysInRange (Vector position, std::vector<uint32_t> &candidates)
+  const;
+
+  /**
+    * Private method that is scheduled by LoraChannel's Send method to happen
+    * after the channel delay, for each of the connected PHY layers.
+    *
+    * It's here that the Receive method of the PHY is called to initiate packet
+    * reception at the PHY.
+    *
+    * \param i The index of the phy to start reception on.
+    * \param packet The packet the phy will receive.
+    * \param parameters The parameters that characterize this transmission
+    */
+  void Receive (uint32_t i, Ptr<Packet> packet,
+                LoraChannelParameters parameters) const;
+
+  /**
+    * The vector containing the PHYs that are currently connected to the
+    * channel.
+    */
+  std::vector<Ptr<LoraPhy> > m_phyList;
+
+  /**
+    * Pointer to the loss model.
+    *
+    * This loss model can be a concatenation of multiple loss models, obtained
+    * via PropagationLossModel's SetNext method.
+    */
+  Ptr<PropagationLossModel> m_loss;
+
+  /**
+    * Pointer to the delay model.
+    */
+  Ptr<PropagationDelayModel> m_delay;
+
+  /**
+   * Callback for when a packet is being sent on the channel.
+   */
+  TracedCallback<Ptr<const Packet> > m_packetSent;
+
+  /**
+   * The maximum distance [m] at which a transmission is delivered to a PHY.
+   *
+   * A value of 0 disables the spatial index, and makes Send visit every PHY.
+   */
+  double m_maxRange;
+
+  /**
+   * The minimum power [dBm] a transmission needs to have at a PHY to be
+   * delivered to it.
+   */
+  double m_minRxPowerDbm;
+
+  /**
+   * Whether to only deliver transmissions to PHYs that are listening.
+   */
+  bool m_onlyListening;
+
+  /**
+   * Whether to model the IQ polarity inversion of downlink transmissions, by
+   * never delivering uplinks to end devices and downlinks to gateways.
+   */
+  bool m_separateIqPolarity;
+
+  /**
+   * The index of each PHY in m_phyList.
+   */
+  std::map<Ptr<LoraPhy>, uint32_t> m_phyIndexes;
+
+  /**
+   * Whether each PHY (indexed like m_phyList) belongs to a gateway.
+   */
+  std::vector<bool> m_phyIsGateway;
+
+  /**
+   * Whether each PHY (indexed like m_phyList) is currently listening.
+   */
+  std::vector<bool> m_phyIsListening;
+
+  /**
+   * The indexes of the PHYs that are currently listening.
+   */
+  std::set<uint32_t> m_listeningPhys;
+
+  /**
+   * The indexes of the gateway PHYs, in increasing order.
+   */
+  std::vector<uint32_t> m_gatewayPhys;
+
+  /**
+   * Whether to cache the received power and delay of each link.
+   */
+  bool m_cacheLinkBudgets;
+
+  /**
+   * The propagation results of a link, together with the position versions of
+   * its ends at the time they were computed.
+   */
+  struct LinkBudget
+  {
+    uint32_t senderVersion; //!< The position version of the sender
+    uint32_t receiverVersion; //!< The position version of the receiver
+    double txPowerDbm; //!< The transmission power used in the computation
+    double rxPowerDbm; //!< The resulting received power
+    Time delay; //!< The propagation delay
+  };
+
+  /**
+   * The cached link budgets, indexed by (sender, receiver) indexes in
+   * m_phyList.
+   */
+  mutable std::map<std::pair<uint32_t, uint32_t>, LinkBudget> m_linkBudgets;
+
+  /**
+   * For each PHY (indexed like m_phyList), a counter that is incremented
+   * every time its position changes, invalidating its cached link budgets.
+   */
+  mutable std::vector<uint32_t> m_phyPositionVersions;
+
+  /**
+   * The chain of loss models the cached link budgets were computed with.
+   */
+  mutable std::vector<Ptr<PropagationLossModel> > m_linkBudgetLossChain;
+
+  /**
+   * The delay model the cached link budgets were computed with.
+   */
+  mutable Ptr<PropagationDelayModel> m_linkBudgetDelay;
+
+  /**
+   * Whether m_grid reflects the current content of m_phyList.
+   */
+  mutable bool m_spatialIndexValid;
+
+  /**
+   * The uniform grid of cells of side m_maxRange, each holding the indexes
+   * (in m_phyList) of the PHYs that are currently inside it.
+   */
+  mutable std::map<GridCell, std::vector<uint32_t> > m_grid;
+
+  /**
+   * The cell each PHY (indexed like m_phyList) currently belongs to.
+   */
+  mutable std::vector<GridCell> m_phyCells;
+
+  /**
+   * The indexes of the PHYs using each mobility model we are tracking.
+   */
+  mutable std::map<Ptr<MobilityModel>, std::vector<uint32_t> > m_mobilityPhys;
+
+  /**
+   * A partition of a distributed simulation that is run by another process.
+   */
+  struct RemotePartition
+  {
+    uint32_t node; //!< The node receiving transmissions in the partition
+    uint32_t device; //!< The index of its receiving device
+    Time lookAhead; //!< The delay of messages to the partition
+  };
+
+  /**
+   * The partitions local transmissions are forwarded to.
+   */
+  std::vector<RemotePartition> m_remotePartitions;
+
+  /**
+   * The position of the sender of remote transmissions.
+   */
+  Ptr<MobilityModel> m_remoteSenderMobility;
+
+  /**
+   * Whether each PHY (indexed like m_phyList) belongs to a node that is
+   * simulated by another process.
+   */
+  mutable std::vector<bool> m_phyIsRemote;
+
+  /**
+   * Whether any PHY belongs to a node simulated by another process.
+   */
+  mutable bool m_hasRemotePhys;
+};
+
+} /* namespace ns3 */
+
+}
+#endif /* LORA_CHANNEL_H */
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LORA_LAZY_ENERGY_SOURCE_H
+#define LORA_LAZY_ENERGY_SOURCE_H
+
+#include "ns3/energy-source.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3 {
+namespace lorawan {
+
+class LoraRadioEnergyModel;
+
+/**
+ * \ingroup energy
+ *
+ * An energy source with constant voltage whose remaining energy is computed
+ * in closed form from the consumption of its LoraRadioEnergyModel objects.
+ *
+ * The models only record how long their radio stays in each state, and don't
+ * notify the source of state changes, so that the source needs no periodic
+ * update. Depletion is detected by a single event per source: while the
+ * source is far from empty, the event is scheduled at the earliest time it
+ * could be depleted if all radios drew their maximum current. Once depletion
+ * could happen within the DepletionHorizon, the source is notified at every
+ * state change, and schedules the event at the exact depletion time.
+ *
+ * The source can't be recharged, and all its device models must be
+ * LoraRadioEnergyModel objects, installed before the simulation starts.
+ */
+class LoraLazyEnergySource : public EnergySource
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LoraLazyEnergySource ();
+  virtual ~LoraLazyEnergySource ();
+
+  // Implemented from EnergySource
+  virtual double GetSupplyVoltage (void) const;
+  virtual double GetInitialEnergy (void) const;
+  virtual double GetRemainingEnergy (void);
+  virtual double GetEnergyFraction (void);
+
+  /**
+   * Check whether the source is depleted, and plan the next check.
+   *
+   * Models call this at every state change once the source is close to
+   * empty (see IsTracking).
+   */
+  virtual void UpdateEnergySource (void);
+
+  /**
+   * Whether depletion is close, and models need to notify state changes.
+   */
+  bool IsTracking (void) const;
+
+  /**
+   * Get the time the source was depleted or, if it still has energy, the time
+   * it will be depleted if its radios remain in their current state.
+   *
+   * \return The depletion time, or Time::Max () if the radios draw no current.
+   */
+  Time GetDepletionTime (void);
+
+private:
+  virtual void DoInitialize (void);
+  virtual void DoDispose (void);
+
+  /**
+   * Get the device models drawing energy from this source.
+   */
+  const std::vector<Ptr<LoraRadioEnergyModel> > & GetModels (void);
+
+  /**
+   * Mark the source as depleted, and notify the device models.
+   */
+  void Deplete (void);
+
+  double m_initialEnergyJ; //!< The initial energy
+  double m_supplyVoltageV; //!< The constant supply voltage
+  Time m_depletionHorizon; //!< When to start tracking state changes
+
+  bool m_tracking; //!< Whether models notify state changes
+  bool m_depleted; //!< Whether the source is empty
+  Time m_depletionTime; //!< When the source was depleted
+  EventId m_checkEvent; //!< The next depletion check
+
+  std::vector<Ptr<LoraRadioEnergyModel> > m_loraModels; //!< The device models
+};
+
+}
+}
+#endif /* LORA_LAZY_ENERGY_SOURCE_H */
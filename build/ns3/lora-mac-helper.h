@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef LORA_MAC_HELPER_H
+#define LORA_MAC_HELPER_H
+
+#include "ns3/net-device.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-phy.h"
+#include "ns3/lora-mac.h"
+#include "ns3/lora-device-address-generator.h"
+#include "ns3/end-device-lora-mac.h"
+#include "ns3/gateway-lora-mac.h"
+#include "ns3/node-container.h"
+
+namespace ns3 {
+namespace lorawan {
+
+class LoraMacHelper
+{
+public:
+  /**
+   * Define the kind of device. Can be either GW (Gateway) or ED (End Device).
+   */
+  enum DeviceType
+  {
+    GW,
+    ED
+  };
+
+  /**
+   * Define the operational region.
+   */
+  enum Regions
+  {
+    EU,
+    US,
+    China,
+    EU433MHz,
+    Australia,
+    CN,
+    AS923MHz,
+    SouthKorea
+  };
+
+  /**
+   * Create a mac helper without any parameter set. The user must set
+   * them all to be able to call Install later.
+   */
+  LoraMacHelper ();
+
+  /**
+   * Set an attribute of the underlying MAC object.
+   *
+   * \param name the name of the attribute to set.
+   * \param v the value of the attribute.
+   */
+  void Set (std::string name, const AttributeValue &v);
+
+  /**
+   * Set the address generator to use for creation of these nodes.
+   */
+  void SetAddressGenerator (Ptr<LoraDeviceAddressGenerator> addrGen);
+
+  /**
+   * Set the kind of MAC this helper will create.
+   *
+   * \param dt the device type (either gateway or end device).
+   */
+  void SetDeviceType (enum DeviceType dt);
+
+  /**
+   * Set the region in which the device is to operate.
+   */
+  void SetRegion (enum Regions region);
+
+  /**
+   * Create the LoRaMac instance and connect it to a device
+   *
+   * \param node the node on which we wish to create a wifi MAC.
+   * \param device the device within which this MAC will be created.
+   * \returns a newly-created LoraMac object.
+   */
+  Ptr<LoraMac> Create (Ptr<Node> node, Ptr<NetDevice> device) const;
+
+  /**
+   * Set up the end device's data rates
+   * This function assumes we are using the following convention:
+   * SF7 -> DR5
+   * SF8 -> DR4
+   * SF9 -> DR3
+   * SF10 -> DR2
+   * SF11 -> DR1
+   * SF12 -> DR0
+   */
+  static std::vector<int> SetSpreadingFactorsUp (NodeContainer endDevices,
+                                                 NodeContainer gateways,
+                                                 Ptr<LoraChannel> channel);
+
+  /**
+   * Set up the end device's data rates, like the method above, but only
+   * considering the gateways that are closest to each device.
+   *
+   * Gateways are indexed in a grid, so that the nearest ones can be found
+   * without computing the received power from all of them. Received powers
+   * are computed by multiple threads if the channel's loss models allow it
+   * (see LoraChannel::IsRxPowerThreadSafe), and by the calling thread
+   * otherwise.
+   *
+   * Since the closest gateways are chosen by distance, the result may differ
+   * from the one of the method above when the channel includes shadowing or
+   * penetration losses.
+   *
+   * \param endDevices The end devices to configure.
+   * \param gateways The gateways to consider.
+   * \param channel The channel used to compute received powers.
+   * \param nearestGateways The number of closest gateways to consider for
+   * each device.
+   * \param nThreads The number of threads to use, or 0 to use all available
+   * cores.
+   * \return The number of devices using each SF, from SF7 to SF12, followed by
+   * the number of devices that cannot reach any gateway.
+   */
+  static std::vector<int> SetSpreadingFactorsUp (NodeContainer endDevices,
+                                                 NodeContainer gateways,
+                                                 Ptr<LoraChannel> channel,
+                                                 uint32_t nearestGateways,
+                                                 uint32_t nThreads = 0);
+
+private:
+  /**
+   * Perform region-specific configurations for the 868 MHz EU band.
+   */
+  void ConfigureForEuRegion (Ptr<EndDeviceLoraMac> edMac) const;
+
+  /**
+   * Perform region-specific configurations for the 868 MHz EU band.
+   */
+  void ConfigureForEuRegion (Ptr<GatewayLoraMac> gwMac) const;
+
+  /**
+   * Apply configurations that are common both for the GatewayLoraMac and the
+   * EndDeviceLoraMac classes.
+   */
+  void ApplyCommonEuConfigurations (Ptr<LoraMac> loraMac) const;
+
+  ObjectFactory m_mac;
+  Ptr<LoraDeviceAddressGenerator> m_addrGen; //!< Pointer to the address generator to use
+  enum DeviceType m_deviceType; //!< The kind of device to install
+  enum Regions m_region; //!< The region in which the device will operate
+  LogicalLoraChannelHelper m_euChannelHelper; //!< The EU channel plan, shared by all configured MACs
+};
+
+} //namespace ns3
+
+}
+#endif /* LORA_PHY_HELPER_H */
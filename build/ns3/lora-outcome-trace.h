@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LORA_OUTCOME_TRACE_H
+#define LORA_OUTCOME_TRACE_H
+
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/lora-packet-tracker.h"
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * Writes the outcome of each (packet, gateway) pair to a binary file.
+ *
+ * The file starts with an 8-byte magic string, followed by a sequence of
+ * blocks. Each block starts with an 8-byte header containing the number of
+ * rows in the block (as a 32-bit unsigned integer, followed by 4 bytes of
+ * padding), and then contains one column after the other:
+ *
+ * - time [ns] (int64_t)
+ * - sender node id (uint32_t)
+ * - gateway node id (uint32_t)
+ * - frequency [MHz] (double)
+ * - received power [dBm] (double)
+ * - spreading factor (uint8_t)
+ * - outcome, as a PacketOutcome value (uint8_t)
+ *
+ * Blocks are padded to a multiple of 8 bytes, so that every column is aligned
+ * when the file is memory-mapped. Values are stored with the byte order of the
+ * machine that ran the simulation.
+ *
+ * Rows are buffered in memory and written one block at a time. The last,
+ * partial block is written when Close is called, or when the writer is
+ * deleted.
+ */
+class LoraOutcomeTraceWriter
+{
+public:
+  /**
+   * The magic string at the beginning of each file.
+   */
+  static const char magic[8];
+
+  /**
+   * Create a writer.
+   *
+   * \param filename The file to write to, which is truncated.
+   * \param blockSize The number of rows in each block.
+   */
+  LoraOutcomeTraceWriter (std::string filename, uint32_t blockSize = 65536);
+  ~LoraOutcomeTraceWriter ();
+
+  /**
+   * Add a row to the trace.
+   */
+  void Write (Time time, uint32_t sender, uint32_t gateway, uint8_t sf,
+              double frequencyMHz, double rxPowerDbm, PacketOutcome outcome);
+
+  /**
+   * Write the buffered rows and close the file.
+   */
+  void Close (void);
+
+  // Trace sinks for end device PHY layers, used to know the sender of each
+  // packet
+  void TransmissionCallback (Ptr<Packet const> packet, uint32_t systemId);
+
+  // Trace sinks for gateway PHY layers, which are bound as first argument
+  void PacketReceptionCallback (const LoraPhy *phy, Ptr<Packet const> packet,
+                                uint32_t systemId);
+  void InterferenceCallback (const LoraPhy *phy, Ptr<Packet const> packet,
+                             uint32_t systemId);
+  void NoMoreReceiversCallback (const LoraPhy *phy, Ptr<Packet const> packet,
+                                uint32_t systemId);
+  void UnderSensitivityCallback (const LoraPhy *phy, Ptr<Packet const> packet,
+                                 uint32_t systemId);
+  void LostBecauseTxCallback (const LoraPhy *phy, Ptr<Packet const> packet,
+                              uint32_t systemId);
+
+private:
+  /**
+   * Add a row for an outcome reported by a gateway, taking the information
+   * about the reception from its PHY.
+   */
+  void WriteOutcome (const LoraPhy *phy, Ptr<Packet const> packet,
+                     uint32_t gateway, PacketOutcome outcome);
+
+  /**
+   * Write the buffered rows to the file as a block.
+   */
+  void WriteBlock (void);
+
+  std::ofstream m_file;
+  uint32_t m_blockSize;
+
+  // Column buffers
+  std::vector<int64_t> m_times;
+  std::vector<uint32_t> m_senders;
+  std::vector<uint32_t> m_gateways;
+  std::vector<double> m_frequencies;
+  std::vector<double> m_rxPowers;
+  std::vector<uint8_t> m_sfs;
+  std::vector<uint8_t> m_outcomes;
+
+  // The sender of each packet that was sent recently, by packet UID, and the
+  // order in which they were sent, to forget old packets
+  std::unordered_map<uint64_t, std::pair<Time, uint32_t> > m_senderOf;
+  std::deque<std::pair<Time, uint64_t> > m_sentPackets;
+};
+
+/**
+ * Reads the files created by LoraOutcomeTraceWriter, by mapping them in
+ * memory and giving access to their columns without copying or parsing them.
+ */
+class LoraOutcomeTraceReader
+{
+public:
+  /**
+   * The columns of a block of rows.
+   */
+  struct Block
+  {
+    uint32_t rows;
+    const int64_t *times;
+    const uint32_t *senders;
+    const uint32_t *gateways;
+    const double *frequencies;
+    const double *rxPowers;
+    const uint8_t *sfs;
+    const uint8_t *outcomes;
+  };
+
+  LoraOutcomeTraceReader ();
+  ~LoraOutcomeTraceReader ();
+
+  /**
+   * Map a file in memory and index its blocks.
+   *
+   * \param filename The file to read.
+   * \return False if the file cannot be read or is not a valid trace.
+   */
+  bool Open (std::string filename);
+
+  /**
+   * Unmap the currently open file, if any.
+   */
+  void Close (void);
+
+  /**
+   * Get the blocks of the currently open file.
+   */
+  const std::vector<Block> & GetBlocks (void) const;
+
+  /**
+   * Get the total number of rows in the currently open file.
+   */
+  uint64_t GetNRows (void) const;
+
+private:
+  const uint8_t *m_data;
+  std::size_t m_size;
+  std::vector<Block> m_blocks;
+};
+
+}
+}
+#endif /* LORA_OUTCOME_TRACE_H */
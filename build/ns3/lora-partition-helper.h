@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LORA_PARTITION_HELPER_H
+#define LORA_PARTITION_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/position-allocator.h"
+#include "ns3/lora-channel.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * Splits a LoRaWAN deployment among the processes of a distributed (MPI)
+ * simulation.
+ *
+ * The area is cut in vertical strips of equal width, one for each partition,
+ * and each node belongs to the partition of the strip it is created in. Every
+ * process builds the whole topology, but only simulates the nodes of its own
+ * partition: the LoraChannel skips PHYs of other partitions, and forwards each
+ * local transmission to the other processes, which deliver it to their PHYs.
+ *
+ * The mpi module only computes the look ahead of the distributed simulators
+ * from point-to-point links between partitions, so Install connects a proxy
+ * node of each partition with all the others, using links whose delay is the
+ * look ahead. The look ahead can't exceed the propagation delay between nodes
+ * of different partitions, which is given by the empty gaps between the
+ * strips: partitions should thus be separated by areas without nodes for the
+ * simulation to actually run in parallel.
+ *
+ * Nodes are assumed not to move between partitions.
+ */
+class LoraPartitionHelper
+{
+public:
+  LoraPartitionHelper ();
+  ~LoraPartitionHelper ();
+
+  /**
+   * Set the area that is split among partitions.
+   *
+   * \param xMin The left border of the first strip.
+   * \param xMax The right border of the last strip.
+   * \param nPartitions The number of strips, or 0 to use one for each
+   * process of the simulation.
+   */
+  void SetStrips (double xMin, double xMax, uint32_t nPartitions = 0);
+
+  /**
+   * Get the number of partitions.
+   */
+  uint32_t GetNPartitions (void) const;
+
+  /**
+   * Get the partition, and thus the system id, of a position. Positions
+   * outside the area belong to the first or last partition.
+   */
+  uint32_t GetSystemId (Vector position) const;
+
+  /**
+   * Create nodes in the partitions of their positions, and install a
+   * ConstantPositionMobilityModel on them.
+   *
+   * \param positions The allocator the positions of the nodes are taken from.
+   * \param n The number of nodes to create.
+   * \return The nodes, from all partitions.
+   */
+  NodeContainer Create (Ptr<PositionAllocator> positions, uint32_t n) const;
+
+  /**
+   * Get the nodes that are simulated by this process.
+   */
+  NodeContainer GetLocal (NodeContainer nodes) const;
+
+  /**
+   * Compute the largest look ahead that can be used with some nodes, that is
+   * the time a signal takes to travel across the narrowest gap between nodes
+   * of different partitions.
+   *
+   * \param nodes All the nodes using the LoraChannel, which need a mobility
+   * model.
+   * \param speed The propagation speed, in m/s.
+   * \return The look ahead, or zero if nodes of different partitions are at
+   * the same x coordinate.
+   */
+  Time GetLookAhead (NodeContainer nodes, double speed = 299792458.0) const;
+
+  /**
+   * Connect the partitions of a LoraChannel. Nothing is done if the
+   * simulation is not distributed among several processes, or if ns-3 was
+   * built without MPI.
+   *
+   * \param channel The channel, which already contains the PHYs of all
+   * partitions.
+   * \param lookAhead The look ahead, which must be positive.
+   * \return The proxy nodes that were created, one for each partition.
+   */
+  NodeContainer Install (Ptr<LoraChannel> channel, Time lookAhead) const;
+
+private:
+  double m_xMin; //!< The left border of the first strip
+  double m_xMax; //!< The right border of the last strip
+  uint32_t m_nPartitions; //!< The number of strips
+};
+
+}
+}
+#endif /* LORA_PARTITION_HELPER_H */
@@ -0,0 +1,444 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef LORA_PHY_H
+#define LORA_PHY_H
+
+#include "ns3/object.h"
+#include "ns3/callback.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node.h"
+#include "ns3/lora-channel.h"
+#include "ns3/net-device.h"
+#include "ns3/lora-interference-helper.h"
+#include <deque>
+#include <list>
+
+namespace ns3 {
+namespace lorawan {
+
+class LoraChannel;
+
+/**
+ * Structure to collect all parameters that are used to compute the duration of
+ * a packet (excluding payload length).
+ */
+struct LoraTxParameters
+{
+  uint8_t sf = 7;     //!< Spreading Factor
+  bool headerDisabled = 0;     //!< Whether to use implicit header mode
+  uint8_t codingRate = 1;     //!< Code rate (obtained as 4/(codingRate+4))
+  double bandwidthHz = 125000;     //!< Bandwidth in Hz
+  uint32_t nPreamble = 8;     //!< Number of preamble symbols
+  bool crcEnabled = 1;     //!< Whether Cyclic Redundancy Check is enabled
+  bool lowDataRateOptimizationEnabled = 0;     //!< Whether Low Data Rate Optimization is enabled
+};
+
+/**
+ * Allow logging of LoraTxParameters like with any other data type.
+ */
+std::ostream &operator << (std::ostream &os, const LoraTxParameters &params);
+
+/**
+ * Structure to collect the parameters of a reception, which the PHY passes to
+ * the upper layer along with the packet.
+ */
+struct LoraRxParameters
+{
+  uint8_t sf = 0;     //!< Spreading Factor the packet was sent with
+  double rxPowerDbm = 0;     //!< Power the packet was received with
+  double frequencyMHz = 0;     //!< Frequency the packet was received on
+  uint8_t destroyedBy = 0;     //!< SF of the interference that destroyed the packet, or 0
+};
+
+/**
+ * \ingroup lorawan
+ *
+ * Base class for PHY layers implementing the LoRa modulation scheme.
+ *
+ * This class features common callbacks and defines the interfaces that are used
+ * to send and receive packets at the PHY layer. Furthermore, it features an
+ * implementation of the GetOnAirTime function, used to compute the actual
+ * duration of a packet based on a series of parameters that are collected in
+ * LoraTxParameters objects.
+ */
+class LoraPhy : public Object
+{
+public:
+  // TypeId
+  static TypeId GetTypeId (void);
+
+  /**
+   * Constructor and destructor
+   */
+  LoraPhy ();
+  virtual ~LoraPhy ();
+
+  /**
+   * Type definition for a callback for when a packet is correctly received.
+   *
+   * This callback can be set by an upper layer that wishes to be informed of
+   * correct reception events, and receives the parameters of the reception.
+   */
+  typedef Callback<void, Ptr<const Packet>, const LoraRxParameters &> RxOkCallback;
+
+  /**
+   * Type definition for a callback for when a packet reception fails.
+   *
+   * This callback can be set by an upper layer that wishes to be informed of
+   * failed reception events.
+   */
+  typedef Callback<void, Ptr<const Packet> > RxFailedCallback;
+
+  /**
+   * Type definition for a callback to call when a packet has finished sending.
+   *
+   * This callback is used by the MAC layer, to determine when to open a receive
+   * window.
+   */
+  typedef Callback<void, Ptr<const Packet> > TxFinishedCallback;
+
+  /**
+   * Start receiving a packet.
+   *
+   * This method is typically called by LoraChannel.
+   *
+   * \param packet The packet that is arriving at this PHY layer.
+   * \param rxPowerDbm The power of the arriving packet (assumed to be constant
+   * for the whole reception).
+   * \param sf The Spreading Factor of the arriving packet.
+   * \param duration The on air time of this packet.
+   * \param frequencyMHz The frequency this packet is being transmitted on.
+   */
+  virtual void StartReceive (Ptr<Packet> packet, double rxPowerDbm,
+                             uint8_t sf, Time duration,
+                             double frequencyMHz) = 0;
+
+  /**
+   * Finish reception of a packet.
+   *
+   * This method is scheduled by StartReceive, based on the packet duration. By
+   * passing a LoraInterferenceHelper Event to this method, the class will be
+   * able to identify the packet that is being received among all those that
+   * were registered as interference by StartReceive.
+   *
+   * \param packet The received packet.
+   * \param event The event that is tied to this packet in the
+   * LoraInterferenceHelper.
+   */
+  virtual void EndReceive (Ptr<Packet> packet,
+                           Ptr<LoraInterferenceHelper::Event> event) = 0;
+
+  /**
+   * Instruct the PHY to send a packet according to some parameters.
+   *
+   * \param packet The packet to send.
+   * \param txParams The desired transmission parameters.
+   * \param frequencyMHz The frequency on which to transmit.
+   * \param txPowerDbm The power in dBm with which to transmit the packet.
+   */
+  virtual void Send (Ptr<Packet> packet, LoraTxParameters txParams,
+                     double frequencyMHz, double txPowerDbm) = 0;
+
+  /**
+   * Whether this device is transmitting or not.
+   *
+   * \returns true if the device is currently transmitting a packet, false
+   * otherwise.
+   */
+  virtual bool IsTransmitting (void) = 0;
+
+  /**
+   * Whether this device is listening on the specified frequency or not.
+   *
+   * \param frequency The frequency to query.
+   * \returns true if the device is listening on that frequency, false
+   * otherwise.
+   */
+  virtual bool IsOnFrequency (double frequency) = 0;
+
+  /**
+   * Set the callback to call upon successful reception of a packet.
+   *
+   * This method is typically called by an upper MAC layer that wants to be
+   * notified after the successful reception of a packet.
+   */
+  void SetReceiveOkCallback (RxOkCallback callback);
+
+  /**
+   * Set the callback to call upon failed reception of a packet we were
+   * previously locked on.
+   *
+   * This method is typically called by an upper MAC layer that wants to be
+   * notified after the failed reception of a packet.
+   */
+  void SetReceiveFailedCallback (RxFailedCallback callback);
+
+  /**
+   * Set the callback to call after transmission of a packet.
+   *
+   * This method is typically called by an upper MAC layer that wants to be
+   * notified after the transmission of a packet.
+   */
+  void SetTxFinishedCallback (TxFinishedCallback callback);
+
+  /**
+   * Get the parameters of the last reception this PHY reported.
+   *
+   * They are set right before the reception trace sources fire, so that trace
+   * sinks can read the parameters of the packet they are passed.
+   *
+   * \return The parameters of the reception.
+   */
+  const LoraRxParameters & GetRxParameters (void) const;
+
+  /**
+   * Get the mobility model associated to this PHY.
+   *
+   * \return The MobilityModel associated to this PHY.
+   */
+  Ptr<MobilityModel> GetMobility ();
+
+  /**
+   * Set the mobility model associated to this PHY.
+   *
+   * \param mobility The mobility model to associate to this PHY.
+   */
+  void SetMobility (Ptr<MobilityModel> mobility);
+
+  /**
+   * Set the LoraChannel instance PHY transmits on.
+   *
+   * Typically, there is only one instance per simulation.
+   *
+   * \param channel The LoraChannel instance this PHY will transmit on.
+   */
+  void SetChannel (Ptr<LoraChannel> channel);
+
+  /**
+   * Get the channel instance associated to this PHY.
+   *
+   * \return The LoraChannel instance this PHY transmits on.
+   */
+  Ptr<LoraChannel> GetChannel (void) const;
+
+  /**
+   * Get the NetDevice associated to this PHY.
+   *
+   * \return The NetDevice associated to this PHY.
+   */
+  Ptr<NetDevice> GetDevice (void) const;
+
+  /**
+   * Set the NetDevice that owns this PHY.
+   *
+   * \param device The NetDevice this PHY will reference as its owner.
+   */
+  void SetDevice (Ptr<NetDevice> device);
+
+  /**
+   * Add a signal that doesn't come from LoraChannel to the interference
+   * computations of this PHY.
+   *
+   * The signal can only prevent the reception of the packets it overlaps
+   * with, and is never received itself. This is used to model the load of
+   * devices that are not simulated explicitly (see LoraBackgroundTraffic).
+   *
+   * \param rxPowerDbm The power of the signal at this PHY.
+   * \param sf The Spreading Factor of the signal.
+   * \param duration The duration of the signal, starting now.
+   * \param frequencyMHz The frequency of the signal.
+   */
+  void AddInterference (double rxPowerDbm, uint8_t sf, Time duration,
+                        double frequencyMHz);
+
+  /**
+   * Compute the time that a packet with certain characteristics will take to be
+   * transmitted.
+   *
+   * Besides from the ones saved in LoraTxParameters, the packet's payload
+   * (obtained through a GetSize () call to accout for the presence of Headers
+   * and Trailers, too) also influences the packet transmit time.
+   *
+   * \param packet The packet that needs to be transmitted.
+   * \param txParams The set of parameters that will be used for transmission.
+   * \return The time necessary to transmit the packet.
+   */
+  static Time GetOnAirTime (Ptr<Packet> packet, LoraTxParameters txParams);
+
+  /**
+   * Compute the time that a payload of a certain size will take to be
+   * transmitted with a certain set of parameters.
+   *
+   * This version does not need a Packet, and can be used to compute
+   * durations in advance. Durations of payloads of up to 255 bytes are kept
+   * in a table for each combination of the parameters other than the SF, so
+   * that each one is only computed once.
+   *
+   * \param payloadSize The size of the PHY payload [bytes].
+   * \param txParams The set of parameters that will be used for transmission.
+   * \return The time necessary to transmit the payload.
+   */
+  static Time GetOnAirTime (uint32_t payloadSize, LoraTxParameters txParams);
+
+private:
+  /**
+   * Compute the on-air time of a payload with the formula of the SX1272 LoRa
+   * modem designer's guide.
+   *
+   * \param payloadSize The size of the PHY payload [bytes].
+   * \param txParams The set of parameters that will be used for transmission.
+   * \return The time necessary to transmit the payload.
+   */
+  static Time ComputeOnAirTime (uint32_t payloadSize,
+                                LoraTxParameters txParams);
+
+  /**
+   * The on-air times of all SFs and payload sizes, for a combination of the
+   * other transmission parameters.
+   */
+  struct OnAirTimeTable
+  {
+    double bandwidthHz;     //!< Bandwidth in Hz
+    uint32_t nPreamble;     //!< Number of preamble symbols
+    uint8_t codingRate;     //!< Code rate
+    bool headerDisabled;     //!< Whether to use implicit header mode
+    bool crcEnabled;     //!< Whether Cyclic Redundancy Check is enabled
+    bool lowDataRateOptimizationEnabled;     //!< Whether LDRO is enabled
+    Time durations[6][256];     //!< By SF - 7 and payload size, zero until computed
+  };
+
+  /**
+   * The maximum number of tables, beyond which on-air times are computed at
+   * every call.
+   */
+  static const std::size_t MAX_ON_AIR_TIME_TABLES = 8;
+
+  /**
+   * Get the tables of on-air times that were created so far.
+   *
+   * \return The tables.
+   */
+  static std::deque<OnAirTimeTable> & GetOnAirTimeTables (void);
+
+  Ptr<MobilityModel> m_mobility;   //!< The mobility model associated to this PHY.
+
+protected:
+  // Member objects
+
+  Ptr<NetDevice> m_device; //!< The net device this PHY is attached to.
+
+  Ptr<LoraChannel> m_channel; //!< The channel this PHY transmits on.
+
+  LoraInterferenceHelper m_interference; //!< The LoraInterferenceHelper
+  //!associated to this PHY.
+
+  /**
+   * Store the parameters of a reception, and also in the packet's LoraTag if
+   * TagPackets is set.
+   *
+   * Since all receivers share the same packet, this needs to be done right
+   * before the packet is passed on.
+   *
+   * \param packet The received packet.
+   * \param sf The Spreading Factor of the packet.
+   * \param rxPowerDbm The power of the reception.
+   * \param frequencyMHz The frequency of the reception.
+   * \param destroyedBy The SF of the interference that destroyed the packet,
+   * or 0 if it was not destroyed by interference.
+   */
+  void SetRxParameters (Ptr<Packet> packet, uint8_t sf, double rxPowerDbm,
+                        double frequencyMHz, uint8_t destroyedBy);
+
+  LoraRxParameters m_rxParameters; //!< The parameters of the last reception
+
+  bool m_tagPackets; //!< Whether to store parameters in the LoraTag
+
+  // Trace sources
+
+  /**
+   * The trace source fired when a packet is sent.
+   *
+   * \see class CallBackTraceSource
+   */
+  TracedCallback<Ptr<const Packet>, uint32_t> m_startSending;
+
+  /**
+   * The trace source fired when a packet begins the reception process from the
+   * medium.
+   *
+   * \see class CallBackTraceSource
+   */
+  TracedCallback<Ptr<const Packet> > m_phyRxBeginTrace;
+
+  /**
+   * The trace source fired when a packet reception ends.
+   *
+   * \see class CallBackTraceSource
+   */
+  TracedCallback<Ptr<const Packet> > m_phyRxEndTrace;
+
+  /**
+   * The trace source fired when a packet was correctly received.
+   *
+   * \see class CallBackTraceSource
+   */
+  TracedCallback<Ptr<const Packet>, uint32_t> m_successfullyReceivedPacket;
+
+  /**
+   * The trace source fired when a packet cannot be received because its power
+   * is below the sensitivity threshold.
+   *
+   * \see class CallBackTraceSource
+   */
+  TracedCallback<Ptr<const Packet>, uint32_t> m_underSensitivity;
+
+  /**
+   * The trace source fired when a packet cannot be correctly received because
+   * of interference.
+   *
+   * \see class CallBackTraceSource
+   */
+  TracedCallback<Ptr<const Packet>, uint32_t> m_interferedPacket;
+
+  // Callbacks
+
+  /**
+   * The callback to perform upon correct reception of a packet.
+   */
+  RxOkCallback m_rxOkCallback;
+
+  /**
+   * The callback to perform upon failed reception of a packet we were locked on.
+   */
+  RxFailedCallback m_rxFailedCallback;
+
+  /**
+   * The callback to perform upon the end of a transmission.
+   */
+  TxFinishedCallback m_txFinishedCallback;
+};
+
+} /* namespace ns3 */
+
+}
+#endif /* LORA_PHY_H */
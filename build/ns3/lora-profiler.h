@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LORA_PROFILER_H
+#define LORA_PROFILER_H
+
+#include <chrono>
+#include <stdint.h>
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * Accumulates the wall clock time spent in the main processing steps of a
+ * LoRaWAN simulation, to find out where the time goes in large simulations.
+ *
+ * Profiling is disabled by default, in which case measuring a section only
+ * costs the check of a flag.
+ */
+class LoraProfiler
+{
+public:
+  /**
+   * The processing steps that are measured.
+   */
+  enum Section
+  {
+    CHANNEL_SEND,      //!< LoraChannel::Send
+    GATEWAY_RECEPTION, //!< StartReceive and EndReceive of gateway PHYs
+    NETWORK_SERVER,    //!< NetworkServer::Receive
+    ADR_UPDATE,        //!< AdrComponent::OnReceivedPacket
+    ADR_DECISION,      //!< AdrComponent::BeforeSendingReply
+    N_SECTIONS
+  };
+
+  /**
+   * Measures the time between its construction and its destruction, if
+   * profiling is enabled.
+   */
+  class Scope
+  {
+public:
+    Scope (Section section) :
+      m_section (section),
+      m_enabled (LoraProfiler::m_enabled)
+    {
+      if (m_enabled)
+        {
+          m_start = std::chrono::steady_clock::now ();
+        }
+    }
+
+    ~Scope ()
+    {
+      if (m_enabled)
+        {
+          std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now () - m_start;
+          LoraProfiler::m_seconds[m_section] += elapsed.count ();
+          LoraProfiler::m_calls[m_section]++;
+        }
+    }
+
+private:
+    Section m_section;
+    bool m_enabled;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  /**
+   * Start measuring sections.
+   */
+  static void Enable (void);
+
+  /**
+   * Stop measuring sections.
+   */
+  static void Disable (void);
+
+  /**
+   * Set the time spent in all sections to zero.
+   */
+  static void Reset (void);
+
+  /**
+   * Get the time spent in a section since the last reset.
+   *
+   * \param section The section.
+   * \return The wall clock time [s].
+   */
+  static double GetSeconds (Section section);
+
+  /**
+   * Get the number of times a section was measured since the last reset.
+   *
+   * \param section The section.
+   * \return The number of calls.
+   */
+  static uint64_t GetCalls (Section section);
+
+private:
+  static bool m_enabled; //!< Whether sections are measured
+  static double m_seconds[N_SECTIONS]; //!< The time spent in each section [s]
+  static uint64_t m_calls[N_SECTIONS]; //!< The measurements of each section
+};
+
+}
+}
+#endif /* LORA_PROFILER_H */
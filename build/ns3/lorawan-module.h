@@ -0,0 +1,66 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_LORAWAN
+    
+
+// Module headers:
+#include "building-penetration-loss.h"
+#include "correlated-shadowing-propagation-loss-model.h"
+#include "device-status.h"
+#include "end-device-lora-mac.h"
+#include "end-device-lora-phy.h"
+#include "end-device-status.h"
+#include "forwarder-helper.h"
+#include "forwarder.h"
+#include "gateway-lora-mac.h"
+#include "gateway-lora-phy.h"
+#include "gateway-status.h"
+#include "logical-lora-channel-helper.h"
+#include "logical-lora-channel.h"
+#include "lora-background-traffic-helper.h"
+#include "lora-background-traffic.h"
+#include "lora-channel.h"
+#include "lora-device-address-generator.h"
+#include "lora-device-address.h"
+#include "lora-frame-header.h"
+#include "lora-helper.h"
+#include "lora-interference-helper.h"
+#include "lora-lazy-energy-source-helper.h"
+#include "lora-lazy-energy-source.h"
+#include "lora-mac-header.h"
+#include "lora-mac-helper.h"
+#include "lora-mac.h"
+#include "lora-net-device.h"
+#include "lora-outcome-trace.h"
+#include "lora-packet-tracker.h"
+#include "lora-partition-helper.h"
+#include "lora-phy-helper.h"
+#include "lora-phy.h"
+#include "lora-profiler.h"
+#include "lora-radio-energy-model-helper.h"
+#include "lora-radio-energy-model.h"
+#include "lora-remote-transmission-header.h"
+#include "lora-tag.h"
+#include "lora-tx-current-model.h"
+#include "lora-utils.h"
+#include "mac-command.h"
+#include "network-controller-components.h"
+#include "network-controller.h"
+#include "network-scheduler.h"
+#include "network-server-helper.h"
+#include "network-server.h"
+#include "network-status.h"
+#include "one-shot-sender-helper.h"
+#include "one-shot-sender.h"
+#include "periodic-sender-helper.h"
+#include "periodic-sender.h"
+#include "simple-end-device-lora-phy.h"
+#include "simple-gateway-lora-phy.h"
+#include "simple-network-server-helper.h"
+#include "simple-network-server.h"
+#include "sub-band.h"
+#include "utilities.h"
+#endif
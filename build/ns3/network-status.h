@@ -0,0 +1,264 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Martina Capuzzo <capuzzom@dei.unipd.it>
+ *          Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef NETWORK_STATUS_H
+#define NETWORK_STATUS_H
+
+#include "ns3/device-status.h"
+#include "ns3/end-device-status.h"
+#include "ns3/end-device-lora-mac.h"
+#include "ns3/gateway-status.h"
+#include "ns3/lora-device-address.h"
+#include "ns3/network-scheduler.h"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * This class represents the knowledge about the state of the network that is
+ * available at the Network Server. It is essentially a collection of two
+ * tables: one containing DeviceStatus objects, in a hash table keyed on the
+ * device address, and the other containing GatewayStatus objects, indexed by
+ * the small integer assigned to each gateway by a GatewayAddressTable.
+ *
+ * This class is meant to be queried by NetworkController components, which
+ * can decide to take action based on the current status of the network.
+ */
+class NetworkStatus : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  NetworkStatus ();
+  virtual ~NetworkStatus ();
+
+  /**
+   * Add a device to the ones that are tracked by this NetworkStatus object.
+   */
+  void AddNode (Ptr<EndDeviceLoraMac> edMac);
+
+  /**
+   * Add this gateway to the list of gateways connected to the network.
+   *
+   * Each GW is identified by its Address in the NS-GW network.
+   */
+  void AddGateway (Address& address, Ptr<GatewayStatus> gwStatus);
+
+  /**
+   * Update network status on the received packet.
+   *
+   * Copies of the same uplink that are forwarded by different gateways within
+   * the deduplication window are recognized by the device address, the frame
+   * counter and the packet UID (which plays the role of the MIC). Only the
+   * first copy is inserted in the EndDeviceStatus: later copies just add the
+   * information about their gateway to it.
+   *
+   * \param packet the received packet.
+   * \param address the gateway this packet was received from.
+   * \return True if this is the first copy of the packet, which needs to be
+   * processed by the rest of the Network Server, false if it's a duplicate.
+   */
+  bool OnReceivedPacket (Ptr<const Packet> packet, const Address& gwaddress);
+
+  /**
+   * Set the time during which copies of an uplink are considered duplicates
+   * of the first one.
+   */
+  void SetDeduplicationWindow (Time window);
+
+  /**
+   * Return whether the specified device needs a reply.
+   *
+   * \param deviceAddress the address of the device we are interested in.
+   */
+  bool NeedsReply (LoraDeviceAddress deviceAddress);
+
+  /**
+   * Return whether we have a gateway that is available to send a reply to the
+   * specified device.
+   *
+   * \param deviceAddress the address of the device we are interested in.
+   */
+  Address GetBestGatewayForDevice (LoraDeviceAddress deviceAddress);
+
+  /**
+   * Send a packet through a Gateway.
+   *
+   * This function assumes that the packet is already tagged with a LoraTag
+   * that will inform the gateway of the parameters to use for the
+   * transmission.
+   */
+  void SendThroughGateway (Ptr<Packet> packet, Address gwAddress);
+
+  /**
+   * Get the reply for the specified device address.
+   */
+  Ptr<Packet> GetReplyForDevice (LoraDeviceAddress edAddress, int windowNumber);
+
+  /**
+   * Get the EndDeviceStatus for the device that sent a packet.
+   */
+  Ptr<EndDeviceStatus> GetEndDeviceStatus (Ptr<Packet const> packet);
+
+  /**
+   * Get the EndDeviceStatus corresponding to a LoraDeviceAddress.
+   */
+  Ptr<EndDeviceStatus> GetEndDeviceStatus (LoraDeviceAddress address);
+
+  /**
+   * Get the number of devices that are tracked by this NetworkStatus object.
+   */
+  uint32_t GetNEndDevices (void) const;
+
+  /**
+   * Get the status of all the devices that are tracked by this NetworkStatus
+   * object, in no particular order.
+   */
+  std::vector<Ptr<EndDeviceStatus> > GetEndDeviceStatuses (void) const;
+
+  /**
+   * Get the GatewayStatus corresponding to an Address.
+   *
+   * \return The status, or 0 if the gateway was not added.
+   */
+  Ptr<GatewayStatus> GetGatewayStatus (const Address& address) const;
+
+private:
+  /**
+   * An open-addressing hash table of EndDeviceStatus objects, keyed on the
+   * device address, with linear probing. Lookups take constant time and
+   * don't allocate memory.
+   */
+  class EndDeviceTable
+  {
+public:
+    EndDeviceTable ();
+
+    /**
+     * Get the status of a device.
+     *
+     * \return The status, or 0 if the device is not in the table.
+     */
+    Ptr<EndDeviceStatus> Find (LoraDeviceAddress address) const;
+
+    /**
+     * Add the status of a device, if the device is not in the table yet.
+     *
+     * \return False if the device was already in the table.
+     */
+    bool Insert (LoraDeviceAddress address, Ptr<EndDeviceStatus> status);
+
+    /**
+     * Append the status of all the devices in the table to a vector.
+     */
+    void GetStatuses (std::vector<Ptr<EndDeviceStatus> > &statuses) const;
+
+    /**
+     * Get the number of devices in the table.
+     */
+    uint32_t GetSize (void) const;
+
+private:
+    /**
+     * Get the slot where the search for an address starts.
+     */
+    std::size_t GetFirstSlot (uint32_t address) const;
+
+    /**
+     * Double the number of slots, and insert the devices again.
+     */
+    void Grow (void);
+
+    std::vector<uint32_t> m_addresses; //!< The address of each slot
+    std::vector<Ptr<EndDeviceStatus> > m_statuses; //!< The status of each slot, or 0 if it's empty
+    uint32_t m_size; //!< The number of devices in the table
+    uint32_t m_shift; //!< 64 minus the base 2 logarithm of the number of slots
+  };
+
+  /**
+   * Get the status of a device, aborting if the device is unknown.
+   */
+  Ptr<EndDeviceStatus> GetKnownEndDeviceStatus (LoraDeviceAddress address);
+
+  EndDeviceTable m_endDeviceStatuses; //!< The status of each device
+
+  /**
+   * The status of each gateway, indexed by its position in m_gatewayTable.
+   */
+  std::vector<Ptr<GatewayStatus> > m_gatewayStatuses;
+
+  /**
+   * The last packet whose sender was looked up, and the status of its
+   * sender, so that components looking up the sender of the packet that is
+   * being processed don't need to parse it again.
+   */
+  Ptr<Packet const> m_lastPacket;
+  Ptr<EndDeviceStatus> m_lastEndDeviceStatus;
+
+  /**
+   * The fields identifying an uplink in the deduplication window.
+   */
+  struct UplinkKey
+  {
+    uint32_t address; //!< The address of the device that sent the uplink
+    uint16_t fCnt; //!< The frame counter of the uplink
+    uint64_t uid; //!< The UID of the packet
+
+    bool operator== (const UplinkKey &other) const;
+  };
+
+  /**
+   * Hash function for UplinkKey.
+   */
+  struct UplinkKeyHash
+  {
+    std::size_t operator() (const UplinkKey &key) const;
+  };
+
+  /**
+   * Forget the uplinks that were received before the deduplication window.
+   */
+  void CleanRecentUplinks (void);
+
+  /**
+   * The table of gateway indexes shared by all EndDeviceStatus objects and by
+   * m_gatewayStatuses.
+   */
+  Ptr<GatewayAddressTable> m_gatewayTable;
+
+  Time m_deduplicationWindow; //!< The duration of the deduplication window
+
+  /**
+   * The status of the devices that sent the uplinks received in the
+   * deduplication window, and the times at which they were first received.
+   */
+  std::unordered_map<UplinkKey, Ptr<EndDeviceStatus>, UplinkKeyHash> m_recentUplinks;
+  std::deque<std::pair<Time, UplinkKey> > m_recentUplinkTimes;
+};
+
+} /* namespace ns3 */
+
+}
+#endif /* NETWORK_STATUS_H */
@@ -26,6 +26,7 @@
 #include "ns3/building-allocator.h"
 #include "ns3/buildings-helper.h"
 #include "ns3/forwarder-helper.h"
+#include "ns3/system-path.h"
 #include <algorithm>
 #include <ctime>
 
@@ -49,6 +50,10 @@ int transientPeriods = 0;
 
 // Output control
 bool print = true;
+double binWidth = 0;
+std::string outcomeTrace = "";
+std::string outputDir = ".";
+std::string resultFile = "";
 
 int main (int argc, char *argv[])
 {
@@ -69,6 +74,21 @@ int main (int argc, char *argv[])
   cmd.AddValue ("print",
                 "Whether or not to print various informations",
                 print);
+  cmd.AddValue ("binWidth",
+                "The width in seconds of the time bins used to count PHY "
+                "outcomes, or 0 to keep track of each packet",
+                binWidth);
+  cmd.AddValue ("outcomeTrace",
+                "The binary file where the outcome of each packet at each "
+                "gateway is written, if any",
+                outcomeTrace);
+  cmd.AddValue ("outputDir",
+                "The directory where output files are written",
+                outputDir);
+  cmd.AddValue ("resultFile",
+                "The file, relative to outputDir, where the MAC and PHY "
+                "results are written as \"name value\" lines, if any",
+                resultFile);
   cmd.Parse (argc, argv);
 
   // Set up logging
@@ -150,7 +170,20 @@ int main (int argc, char *argv[])
 
   // Create the LoraHelper
   LoraHelper helper = LoraHelper ();
-  helper.EnablePacketTracking ("performance"); // Output filename
+  if (binWidth > 0)
+    {
+      helper.EnableStreamingPacketTracking
+        (SystemPath::Append (outputDir, "performance"), Seconds (binWidth));
+    }
+  else
+    {
+      // Output filename
+      helper.EnablePacketTracking (SystemPath::Append (outputDir, "performance"));
+    }
+  if (!outcomeTrace.empty ())
+    {
+      helper.EnableOutcomeTracing (outcomeTrace);
+    }
   // helper.EnableSimulationTimePrinting ();
 
   //Create the NetworkServerHelper
@@ -260,7 +293,7 @@ int main (int argc, char *argv[])
   if (print)
     {
       std::ofstream myfile;
-      myfile.open ("buildings.txt");
+      myfile.open (SystemPath::Append (outputDir, "buildings.txt").c_str ());
       std::vector<Ptr<Building> >::const_iterator it;
       int j = 1;
       for (it = bContainer.Begin (); it != bContainer.End (); ++it, ++j)
@@ -316,7 +349,7 @@ int main (int argc, char *argv[])
   if (print)
     {
       helper.PrintEndDevices (endDevices, gateways,
-                              "endDevices.dat");
+                              SystemPath::Append (outputDir, "endDevices.dat"));
     }
 
   ////////////////
@@ -335,6 +368,17 @@ int main (int argc, char *argv[])
   ///////////////////////////
   NS_LOG_INFO ("Computing performance metrics...");
   helper.PrintPerformance (transientPeriods * appPeriod, appStopTime);
+  if (!resultFile.empty ())
+    {
+      // PrintPerformance excludes a transient at both ends
+      helper.WriteResults (transientPeriods * appPeriod,
+                           appStopTime - transientPeriods * appPeriod,
+                           SystemPath::Append (outputDir, resultFile));
+    }
+  if (binWidth > 0)
+    {
+      helper.PrintPhyBins ();
+    }
 
   return 0;
 }
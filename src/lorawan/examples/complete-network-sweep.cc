@@ -0,0 +1,377 @@
+/*
+ * This script runs complete-network-example over a grid of parameters, using
+ * one worker process per configuration and keeping all local cores busy. Each
+ * configuration is simulated with a number of independent runs, whose
+ * RngRun values are assigned automatically. Each worker writes its output files
+ * to its own directory, including a result file with the MAC and PHY outcomes;
+ * when all workers are done, these results are collected in a single table.
+ *
+ * Example usage:
+ * ./waf --run "complete-network-sweep --nDevices=100,200,500 --radius=5000,7500
+ *              --appPeriod=600 --runs=10"
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+#include "ns3/system-path.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("CompleteNetworkSweep");
+
+// A point of the grid, simulated with a certain run number
+struct Configuration
+{
+  std::string nDevices;
+  std::string radius;
+  std::string appPeriod;
+  uint32_t run;
+};
+
+// Split a comma-separated list of values
+std::vector<std::string>
+SplitList (std::string list)
+{
+  std::vector<std::string> values;
+  std::istringstream stream (list);
+  std::string value;
+  while (std::getline (stream, value, ','))
+    {
+      if (!value.empty ())
+        {
+          values.push_back (value);
+        }
+    }
+  return values;
+}
+
+// The name of the result file written by each worker in its directory
+const std::string resultFile = "results.txt";
+
+// The name of the file where the output of each worker is redirected
+const std::string workerOutputFile = "output.txt";
+
+// Create a new directory in the system's temporary directory
+std::string
+MakeTemporaryDirectory (void)
+{
+  const char *variables[] = {"TMPDIR", "TMP", "TEMP"};
+  std::string base = "/tmp";
+  for (auto variable : variables)
+    {
+      const char *value = getenv (variable);
+      if (value != 0 && *value != 0)
+        {
+          base = value;
+          break;
+        }
+    }
+
+  std::string name = SystemPath::Append (base, "complete-network-sweep-XXXXXX");
+  std::vector<char> buffer (name.begin (), name.end ());
+  buffer.push_back (0);
+  NS_ABORT_MSG_IF (mkdtemp (buffer.data ()) == 0,
+                   "Cannot create a temporary directory in " << base);
+  return buffer.data ();
+}
+
+// Remove the files of a directory, and the directory itself
+void
+RemoveDirectory (std::string directory)
+{
+  std::list<std::string> files = SystemPath::ReadFiles (directory);
+  for (auto it = files.begin (); it != files.end (); ++it)
+    {
+      if (*it != "." && *it != "..")
+        {
+          std::remove (SystemPath::Append (directory, *it).c_str ());
+        }
+    }
+  rmdir (directory.c_str ());
+}
+
+// Start a worker process simulating a configuration in a directory, where its
+// output is redirected and its result file is written
+pid_t
+StartWorker (std::string program, const Configuration &configuration,
+             std::string simulationTime, std::string directory)
+{
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "Cannot fork a worker process");
+
+  if (pid > 0)
+    {
+      return pid;
+    }
+
+  // We are in the worker: redirect the output and run the simulation
+  std::string outputFile = SystemPath::Append (directory, workerOutputFile);
+  int fd = open (outputFile.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      _exit (1);
+    }
+  dup2 (fd, STDOUT_FILENO);
+  dup2 (fd, STDERR_FILENO);
+  close (fd);
+
+  std::vector<std::string> arguments;
+  arguments.push_back (program);
+  arguments.push_back ("--nDevices=" + configuration.nDevices);
+  arguments.push_back ("--radius=" + configuration.radius);
+  arguments.push_back ("--appPeriod=" + configuration.appPeriod);
+  arguments.push_back ("--simulationTime=" + simulationTime);
+  arguments.push_back ("--print=false");
+  arguments.push_back ("--outputDir=" + directory);
+  arguments.push_back ("--resultFile=" + resultFile);
+  std::ostringstream run;
+  run << "--RngRun=" << configuration.run;
+  arguments.push_back (run.str ());
+
+  std::vector<char *> argv;
+  for (auto it = arguments.begin (); it != arguments.end (); ++it)
+    {
+      argv.push_back (const_cast<char *> (it->c_str ()));
+    }
+  argv.push_back (0);
+
+  execv (program.c_str (), argv.data ());
+  _exit (1);
+}
+
+// Read the "name value" lines of a result file written by
+// complete-network-example
+std::vector<std::pair<std::string, std::string> >
+ReadResults (std::string directory)
+{
+  std::ifstream input (SystemPath::Append (directory, resultFile).c_str ());
+  std::vector<std::pair<std::string, std::string> > results;
+  std::string name;
+  std::string value;
+  while (input >> name >> value)
+    {
+      results.push_back (std::make_pair (name, value));
+    }
+  return results;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string nDevices = "200";
+  std::string radius = "7500";
+  std::string appPeriod = "600";
+  std::string simulationTime = "600";
+  uint32_t runs = 1;
+  uint32_t firstRun = 1;
+  uint32_t workers = 0;
+  std::string program = "";
+  std::string outputFile = "";
+  std::string outputDir = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("nDevices",
+                "Comma-separated numbers of end devices to simulate",
+                nDevices);
+  cmd.AddValue ("radius",
+                "Comma-separated radii of the area to simulate",
+                radius);
+  cmd.AddValue ("appPeriod",
+                "Comma-separated periods in seconds of the applications",
+                appPeriod);
+  cmd.AddValue ("simulationTime",
+                "The time for which to simulate each configuration",
+                simulationTime);
+  cmd.AddValue ("runs",
+                "The number of independent runs of each configuration",
+                runs);
+  cmd.AddValue ("firstRun",
+                "The RngRun value of the first simulation",
+                firstRun);
+  cmd.AddValue ("workers",
+                "The maximum number of simultaneous worker processes, or 0 "
+                "to use all available cores",
+                workers);
+  cmd.AddValue ("program",
+                "The complete-network-example executable (by default, the "
+                "one next to this program)",
+                program);
+  cmd.AddValue ("output",
+                "The file where the results table is written (by default, "
+                "the standard output)",
+                outputFile);
+  cmd.AddValue ("outputDir",
+                "The directory where each simulation writes its files, in a "
+                "subdirectory named after its RngRun (by default, a temporary "
+                "directory that is removed at the end)",
+                outputDir);
+  cmd.Parse (argc, argv);
+
+  if (program.empty ())
+    {
+      // Executables are named after the example, with a prefix and suffix
+      // depending on the build profile
+      program = argv[0];
+      std::size_t position = program.rfind ("complete-network-sweep");
+      NS_ABORT_MSG_IF (position == std::string::npos,
+                       "Cannot find complete-network-example, use --program");
+      program.replace (position, std::string ("complete-network-sweep").size (),
+                       "complete-network-example");
+    }
+
+  if (workers == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      workers = cores > 0 ? cores : 1;
+    }
+
+  // Build the grid
+  std::vector<Configuration> configurations;
+  std::vector<std::string> nDevicesValues = SplitList (nDevices);
+  std::vector<std::string> radiusValues = SplitList (radius);
+  std::vector<std::string> appPeriodValues = SplitList (appPeriod);
+  uint32_t run = firstRun;
+  for (auto n = nDevicesValues.begin (); n != nDevicesValues.end (); ++n)
+    {
+      for (auto r = radiusValues.begin (); r != radiusValues.end (); ++r)
+        {
+          for (auto p = appPeriodValues.begin (); p != appPeriodValues.end (); ++p)
+            {
+              for (uint32_t i = 0; i < runs; i++)
+                {
+                  Configuration configuration;
+                  configuration.nDevices = *n;
+                  configuration.radius = *r;
+                  configuration.appPeriod = *p;
+                  configuration.run = run++;
+                  configurations.push_back (configuration);
+                }
+            }
+        }
+    }
+
+  bool keepFiles = !outputDir.empty ();
+  if (keepFiles)
+    {
+      SystemPath::MakeDirectories (outputDir);
+    }
+  else
+    {
+      outputDir = MakeTemporaryDirectory ();
+    }
+  std::vector<std::string> directories (configurations.size ());
+  for (std::size_t i = 0; i < configurations.size (); i++)
+    {
+      std::ostringstream directory;
+      directory << "run-" << configurations[i].run;
+      directories[i] = SystemPath::Append (outputDir, directory.str ());
+    }
+
+  NS_LOG_INFO ("Running " << configurations.size () << " simulations with "
+               << workers << " workers in " << outputDir);
+
+  // Keep up to workers processes running, starting a new one as soon as one
+  // of them finishes
+  std::vector<std::vector<std::pair<std::string, std::string> > >
+  results (configurations.size ());
+  std::map<pid_t, std::size_t> running;
+  std::size_t next = 0;
+  while (next < configurations.size () || !running.empty ())
+    {
+      while (next < configurations.size () && running.size () < workers)
+        {
+          SystemPath::MakeDirectories (directories[next]);
+          pid_t pid = StartWorker (program, configurations[next],
+                                   simulationTime, directories[next]);
+          running[pid] = next++;
+        }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      NS_ABORT_MSG_IF (pid < 0, "Cannot wait for worker processes");
+
+      auto it = running.find (pid);
+      if (it == running.end ())
+        {
+          continue;
+        }
+
+      std::string directory = directories[it->second];
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 0)
+        {
+          results[it->second] = ReadResults (directory);
+        }
+      else
+        {
+          std::cerr << "Simulation with RngRun "
+                    << configurations[it->second].run << " failed:" << std::endl;
+          std::ifstream failedOutput
+            (SystemPath::Append (directory, workerOutputFile).c_str ());
+          // Streaming an empty buffer would set the failbit of std::cerr
+          if (failedOutput.peek () != std::ifstream::traits_type::eof ())
+            {
+              std::cerr << failedOutput.rdbuf ();
+            }
+        }
+      if (!keepFiles)
+        {
+          RemoveDirectory (directory);
+        }
+      running.erase (it);
+    }
+
+  // Print the results table
+  std::ofstream file;
+  if (!outputFile.empty ())
+    {
+      file.open (outputFile.c_str ());
+    }
+  std::ostream &output = outputFile.empty () ? std::cout : file;
+
+  // All result files have the same names, in the same order
+  bool header = false;
+  for (std::size_t i = 0; i < configurations.size (); i++)
+    {
+      if (results[i].empty ())
+        {
+          continue;
+        }
+      if (!header)
+        {
+          output << "nDevices radius appPeriod run";
+          for (auto it = results[i].begin (); it != results[i].end (); ++it)
+            {
+              output << " " << it->first;
+            }
+          output << std::endl;
+          header = true;
+        }
+      output << configurations[i].nDevices << " " << configurations[i].radius
+             << " " << configurations[i].appPeriod << " "
+             << configurations[i].run;
+      for (auto it = results[i].begin (); it != results[i].end (); ++it)
+        {
+          output << " " << it->second;
+        }
+      output << std::endl;
+    }
+
+  if (!keepFiles)
+    {
+      rmdir (outputDir.c_str ());
+    }
+
+  return 0;
+}
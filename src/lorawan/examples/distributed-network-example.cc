@@ -0,0 +1,218 @@
+/*
+ * This script simulates a network split among the processes of a distributed
+ * simulation. End devices and gateways are placed in vertical strips, which
+ * are separated by corridors without nodes. Each process simulates a strip,
+ * and can advance independently for the time a signal takes to cross a
+ * corridor.
+ *
+ * Run it with, for instance:
+ *
+ * mpirun -np 2 ./waf --run distributed-network-example
+ *
+ * Each process prints the packets sent and received by its own nodes, which
+ * add up to the ones of a run with a single process.
+ */
+
+#include "ns3/end-device-lora-phy.h"
+#include "ns3/gateway-lora-phy.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-partition-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/position-allocator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/one-shot-sender-helper.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/command-line.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include <iostream>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE ("DistributedNetworkExample");
+
+// Packets of the nodes of this process
+int nSent = 0;
+int nReceived = 0;
+int nInterfered = 0;
+
+void
+OnStartSending (Ptr<const Packet> packet, uint32_t node)
+{
+  nSent++;
+}
+
+void
+OnReceivedPacket (Ptr<const Packet> packet, uint32_t node)
+{
+  nReceived++;
+}
+
+void
+OnInterference (Ptr<const Packet> packet, uint32_t node)
+{
+  nInterfered++;
+}
+
+int main (int argc, char *argv[])
+{
+  int nDevices = 1000;
+  int nGateways = 4;
+  double width = 20000;
+  double corridor = 1000;
+  uint32_t nStrips = 2;
+  double simulationTime = 600;
+  bool nullMessage = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("nDevices", "Number of end devices to include in the simulation", nDevices);
+  cmd.AddValue ("nGateways", "Number of gateways to include in the simulation", nGateways);
+  cmd.AddValue ("width", "The width of the area, in meters", width);
+  cmd.AddValue ("nStrips", "Number of strips separated by corridors, and of processes to use", nStrips);
+  cmd.AddValue ("corridor", "The width of the empty corridors between strips", corridor);
+  cmd.AddValue ("simulationTime", "The time during which devices send, in seconds", simulationTime);
+  cmd.AddValue ("nullMessage", "Use the null message synchronization protocol, which exchanges messages every look ahead", nullMessage);
+  cmd.Parse (argc, argv);
+
+  if (nullMessage)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::NullMessageSimulatorImpl"));
+    }
+  else
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::DistributedSimulatorImpl"));
+    }
+
+  MpiInterface::Enable (&argc, &argv);
+
+  LoraPartitionHelper partitionHelper;
+  partitionHelper.SetStrips (0, width);
+  uint32_t nPartitions = partitionHelper.GetNPartitions ();
+
+  /************************
+  *  Create the channel  *
+  ************************/
+
+  Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+  loss->SetPathLossExponent (3.76);
+  loss->SetReference (1, 7.7);
+
+  Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+
+  Ptr<LoraChannel> channel = CreateObject<LoraChannel> (loss, delay);
+
+  /*********************
+  *  Place the nodes  *
+  *********************/
+
+  // Every process draws the same positions, and keeps nodes out of the
+  // corridors centered on the borders between strips. The strips don't depend
+  // on the number of processes, so that runs with a single process simulate
+  // the same network
+  Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+  Ptr<UniformRandomVariable> y = CreateObject<UniformRandomVariable> ();
+  x->SetStream (1);
+  y->SetStream (2);
+  double stripWidth = width / nStrips;
+
+  Ptr<ListPositionAllocator> edPositions = CreateObject<ListPositionAllocator> ();
+  for (int i = 0; i < nDevices; i++)
+    {
+      uint32_t strip = i % nStrips;
+      double xMin = strip * stripWidth + ((strip > 0) ? corridor / 2 : 0);
+      double xMax = (strip + 1) * stripWidth - ((strip < nStrips - 1) ? corridor / 2 : 0);
+      edPositions->Add (Vector (x->GetValue (xMin, xMax), y->GetValue (0, width), 1.2));
+    }
+
+  Ptr<ListPositionAllocator> gwPositions = CreateObject<ListPositionAllocator> ();
+  for (int i = 0; i < nGateways; i++)
+    {
+      uint32_t strip = i % nStrips;
+      gwPositions->Add (Vector ((strip + 0.5) * stripWidth,
+                                (i / nStrips + 0.5) * width * nStrips / nGateways,
+                                15));
+    }
+
+  /************************
+  *  Create the devices  *
+  ************************/
+
+  LoraPhyHelper phyHelper = LoraPhyHelper ();
+  phyHelper.SetChannel (channel);
+  LoraMacHelper macHelper = LoraMacHelper ();
+  LoraHelper helper = LoraHelper ();
+
+  NodeContainer endDevices = partitionHelper.Create (edPositions, nDevices);
+  phyHelper.SetDeviceType (LoraPhyHelper::ED);
+  macHelper.SetDeviceType (LoraMacHelper::ED);
+  helper.Install (phyHelper, macHelper, endDevices);
+
+  NodeContainer gateways = partitionHelper.Create (gwPositions, nGateways);
+  phyHelper.SetDeviceType (LoraPhyHelper::GW);
+  macHelper.SetDeviceType (LoraMacHelper::GW);
+  helper.Install (phyHelper, macHelper, gateways);
+
+  macHelper.SetSpreadingFactorsUp (endDevices, gateways, channel);
+
+  /****************************
+  *  Connect the partitions  *
+  ****************************/
+
+  NodeContainer allNodes (endDevices, gateways);
+  Time lookAhead = partitionHelper.GetLookAhead (allNodes);
+  partitionHelper.Install (channel, lookAhead);
+
+  /*******************************************************
+  *  Install applications and traces on the local nodes  *
+  *******************************************************/
+
+  Ptr<UniformRandomVariable> sendTime = CreateObject<UniformRandomVariable> ();
+  sendTime->SetStream (3);
+  for (NodeContainer::Iterator it = endDevices.Begin (); it != endDevices.End (); ++it)
+    {
+      // Draw a time for every device, so that all processes agree on them
+      Time time = Seconds (sendTime->GetValue (0, simulationTime));
+      if ((*it)->GetSystemId () == MpiInterface::GetSystemId ())
+        {
+          OneShotSenderHelper oneShotSenderHelper;
+          oneShotSenderHelper.SetSendTime (time);
+          oneShotSenderHelper.Install (*it);
+
+          (*it)->GetDevice (0)->GetObject<LoraNetDevice> ()->GetPhy ()->
+            TraceConnectWithoutContext ("StartSending", MakeCallback (&OnStartSending));
+        }
+    }
+
+  NodeContainer localGateways = partitionHelper.GetLocal (gateways);
+  for (NodeContainer::Iterator it = localGateways.Begin (); it != localGateways.End (); ++it)
+    {
+      Ptr<LoraPhy> phy = (*it)->GetDevice (0)->GetObject<LoraNetDevice> ()->GetPhy ();
+      phy->TraceConnectWithoutContext ("ReceivedPacket", MakeCallback (&OnReceivedPacket));
+      phy->TraceConnectWithoutContext ("LostPacketBecauseInterference",
+                                       MakeCallback (&OnInterference));
+    }
+
+  /****************
+  *  Simulation  *
+  ****************/
+
+  Simulator::Stop (Seconds (simulationTime + 10));
+
+  Simulator::Run ();
+
+  std::cout << "Partition " << MpiInterface::GetSystemId () << " of " << nPartitions
+            << " (look ahead " << lookAhead.GetNanoSeconds () << " ns): "
+            << nSent << " sent, " << nReceived << " received, "
+            << nInterfered << " interfered" << std::endl;
+
+  Simulator::Destroy ();
+
+  MpiInterface::Disable ();
+
+  return 0;
+}
@@ -0,0 +1,278 @@
+/*
+ * This program benchmarks the lorawan module on synthetic networks of
+ * increasing size. For each number of end devices, a network is built on a
+ * disc whose area keeps the density of end devices constant, with gateways
+ * placed uniformly at random with the given density. Each end device sends a
+ * packet every appPeriod seconds to a network server, and the network is
+ * simulated for a fixed interval.
+ *
+ * Each network is simulated in a separate process, so that memory
+ * measurements are not affected by the previous ones. Results are printed as
+ * CSV, one line per network size, with the following columns:
+ *
+ * - nDevices, nGateways: the size of the network;
+ * - setupSeconds: the wall clock time needed to build the network;
+ * - runSeconds: the wall clock time needed to run the simulation;
+ * - events: the number of simulator events that were executed;
+ * - eventsPerSecond: the number of events executed per second of run time;
+ * - secondsPerSimulatedHour: the run time per hour of simulated time;
+ * - peakRssPerDevice: the increase of the peak resident set size caused by
+ *   the simulation, in bytes per end device;
+ * - channelSendSeconds, gatewayReceptionSeconds, networkServerSeconds: the
+ *   run time spent in LoraChannel::Send, in gateway PHY receptions and in
+ *   NetworkServer::Receive (see LoraProfiler);
+ * - interferenceEvents, interferenceEventChunks: the number of interference
+ *   events that were allocated, and the number of heap allocations that were
+ *   needed for them by the event pools of LoraInterferenceHelper;
+ * - adrUpdateNanoseconds, adrDecisionNanoseconds: the average run time of
+ *   AdrComponent when an uplink is received and before its reply is sent,
+ *   which is zero unless the adr option is given.
+ *
+ * Example usage:
+ * ./waf --run "lorawan-bench --nDevices=1000,10000,100000 --gatewayDensity=0.5"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lora-mac-helper.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/network-server-helper.h"
+#include "ns3/forwarder-helper.h"
+#include "ns3/lora-profiler.h"
+#include "ns3/lora-interference-helper.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE ("LorawanBench");
+
+// Get the peak resident set size of this process, in bytes
+uint64_t
+GetPeakRss (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  // On Linux, ru_maxrss is measured in kilobytes
+  return uint64_t (usage.ru_maxrss) * 1024;
+}
+
+// Get the seconds elapsed since a point in time
+double
+GetSecondsSince (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+  return elapsed.count ();
+}
+
+// Build and simulate a network, and print a line of results
+void
+RunBenchmark (uint32_t nDevices, double deviceDensity, double gatewayDensity,
+              double simulationTime, double appPeriod, bool networkServer,
+              bool adr)
+{
+  uint64_t initialRss = GetPeakRss ();
+  std::chrono::steady_clock::time_point setupStart = std::chrono::steady_clock::now ();
+
+  // Keep the density of devices constant
+  double area = nDevices / deviceDensity;  // km^2
+  double radius = std::sqrt (area / M_PI) * 1000;  // m
+  uint32_t nGateways = std::max (1.0, std::round (gatewayDensity * area));
+
+  // Channel
+  Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+  loss->SetPathLossExponent (3.76);
+  loss->SetReference (1, 7.7);
+  Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  Ptr<LoraChannel> channel = CreateObject<LoraChannel> (loss, delay);
+
+  // Helpers
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::UniformDiscPositionAllocator",
+                                 "rho", DoubleValue (radius),
+                                 "X", DoubleValue (0.0),
+                                 "Y", DoubleValue (0.0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+
+  LoraPhyHelper phyHelper = LoraPhyHelper ();
+  phyHelper.SetChannel (channel);
+  LoraMacHelper macHelper = LoraMacHelper ();
+  LoraHelper helper = LoraHelper ();
+
+  Config::SetDefault ("ns3::EndDeviceLoraMac::EnableAdr", BooleanValue (adr));
+
+  // End devices
+  NodeContainer endDevices;
+  endDevices.Create (nDevices);
+  mobility.Install (endDevices);
+
+  Ptr<LoraDeviceAddressGenerator> addrGen = CreateObject<LoraDeviceAddressGenerator> (54, 1864);
+  macHelper.SetAddressGenerator (addrGen);
+  phyHelper.SetDeviceType (LoraPhyHelper::ED);
+  macHelper.SetDeviceType (LoraMacHelper::ED);
+  helper.Install (phyHelper, macHelper, endDevices);
+
+  // Gateways
+  NodeContainer gateways;
+  gateways.Create (nGateways);
+  mobility.Install (gateways);
+  phyHelper.SetDeviceType (LoraPhyHelper::GW);
+  macHelper.SetDeviceType (LoraMacHelper::GW);
+  helper.Install (phyHelper, macHelper, gateways);
+
+  // The log distance model only depends on distance, so the closest gateway
+  // is also the best one
+  LoraMacHelper::SetSpreadingFactorsUp (endDevices, gateways, channel, 1);
+
+  // Applications
+  PeriodicSenderHelper appHelper = PeriodicSenderHelper ();
+  appHelper.SetPeriod (Seconds (appPeriod));
+  ApplicationContainer appContainer = appHelper.Install (endDevices);
+  appContainer.Start (Seconds (0));
+  appContainer.Stop (Seconds (simulationTime));
+
+  // Network server
+  if (networkServer)
+    {
+      NodeContainer networkServers;
+      networkServers.Create (1);
+      NetworkServerHelper networkServerHelper;
+      networkServerHelper.SetGateways (gateways);
+      networkServerHelper.SetEndDevices (endDevices);
+      networkServerHelper.EnableAdr (adr);
+      networkServerHelper.Install (networkServers);
+
+      ForwarderHelper forwarderHelper;
+      forwarderHelper.Install (gateways);
+    }
+
+  double setupSeconds = GetSecondsSince (setupStart);
+
+  // Run the simulation
+  LoraProfiler::Reset ();
+  LoraProfiler::Enable ();
+  std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now ();
+
+  Simulator::Stop (Seconds (simulationTime));
+  Simulator::Run ();
+
+  double runSeconds = GetSecondsSince (runStart);
+  LoraProfiler::Disable ();
+  uint64_t events = Simulator::GetEventCount ();
+  uint64_t peakRss = GetPeakRss ();
+  LoraInterferenceHelper::EventAllocationCounters eventCounters =
+    LoraInterferenceHelper::GetTotalEventAllocationCounters ();
+
+  Simulator::Destroy ();
+
+  // The average time per call of a section, in nanoseconds
+  auto perCall = [] (LoraProfiler::Section section)
+    {
+      uint64_t calls = LoraProfiler::GetCalls (section);
+      return (calls > 0) ? LoraProfiler::GetSeconds (section) / calls * 1e9 : 0;
+    };
+
+  std::cout << nDevices << ","
+            << nGateways << ","
+            << setupSeconds << ","
+            << runSeconds << ","
+            << events << ","
+            << events / runSeconds << ","
+            << runSeconds / (simulationTime / 3600) << ","
+            << double (peakRss - initialRss) / nDevices << ","
+            << LoraProfiler::GetSeconds (LoraProfiler::CHANNEL_SEND) << ","
+            << LoraProfiler::GetSeconds (LoraProfiler::GATEWAY_RECEPTION) << ","
+            << LoraProfiler::GetSeconds (LoraProfiler::NETWORK_SERVER) << ","
+            << eventCounters.events << ","
+            << eventCounters.chunks << ","
+            << perCall (LoraProfiler::ADR_UPDATE) << ","
+            << perCall (LoraProfiler::ADR_DECISION)
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string nDevices = "1000,10000,100000,1000000";
+  double deviceDensity = 100;
+  double gatewayDensity = 0.5;
+  double simulationTime = 600;
+  double appPeriod = 600;
+  bool networkServer = true;
+  bool adr = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("nDevices",
+                "Comma-separated numbers of end devices to simulate",
+                nDevices);
+  cmd.AddValue ("deviceDensity",
+                "The number of end devices per square kilometer",
+                deviceDensity);
+  cmd.AddValue ("gatewayDensity",
+                "The number of gateways per square kilometer",
+                gatewayDensity);
+  cmd.AddValue ("simulationTime",
+                "The simulated time in seconds",
+                simulationTime);
+  cmd.AddValue ("appPeriod",
+                "The period in seconds of the applications of end devices",
+                appPeriod);
+  cmd.AddValue ("networkServer",
+                "Whether to connect the gateways to a network server",
+                networkServer);
+  cmd.AddValue ("adr",
+                "Whether end devices use ADR, controlled by the network server",
+                adr);
+  cmd.Parse (argc, argv);
+
+  std::cout << "nDevices,nGateways,setupSeconds,runSeconds,events,"
+            << "eventsPerSecond,secondsPerSimulatedHour,peakRssPerDevice,"
+            << "channelSendSeconds,gatewayReceptionSeconds,"
+            << "networkServerSeconds,interferenceEvents,"
+            << "interferenceEventChunks,adrUpdateNanoseconds,"
+            << "adrDecisionNanoseconds" << std::endl;
+
+  std::istringstream sizes (nDevices);
+  std::string size;
+  while (std::getline (sizes, size, ','))
+    {
+      if (size.empty ())
+        {
+          continue;
+        }
+
+      // Run each network in a child process, so that its peak memory usage is
+      // measured independently and the simulator starts from scratch
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "Cannot fork a benchmark process");
+      if (pid == 0)
+        {
+          RunBenchmark (std::stoul (size), deviceDensity, gatewayDensity,
+                        simulationTime, appPeriod, networkServer, adr);
+          std::cout.flush ();
+          _exit (0);
+        }
+
+      int status;
+      waitpid (pid, &status, 0);
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          std::cerr << "Benchmark with " << size << " end devices failed"
+                    << std::endl;
+        }
+    }
+
+  return 0;
+}
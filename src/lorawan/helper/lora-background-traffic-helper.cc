@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/lora-background-traffic-helper.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/gateway-lora-phy.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+namespace lorawan {
+
+NS_LOG_COMPONENT_DEFINE ("LoraBackgroundTrafficHelper");
+
+/**
+ * Get the PHY layer of a gateway.
+ */
+static Ptr<GatewayLoraPhy>
+GetGatewayPhy (Ptr<Node> gateway)
+{
+  Ptr<LoraNetDevice> device = gateway->GetDevice (0)->GetObject<LoraNetDevice> ();
+  NS_ABORT_MSG_IF (device == 0, "Node " << gateway->GetId () << " is not a gateway");
+  Ptr<GatewayLoraPhy> phy = device->GetPhy ()->GetObject<GatewayLoraPhy> ();
+  NS_ABORT_MSG_IF (phy == 0, "Node " << gateway->GetId () << " is not a gateway");
+  return phy;
+}
+
+LoraBackgroundTrafficHelper::ProcessProfile::ProcessProfile () :
+  arrivals (0)
+{
+}
+
+void
+LoraBackgroundTrafficHelper::SenderFilter::StartSending (Ptr<const Packet> packet,
+                                                        uint32_t node)
+{
+  packets.insert (packet->GetUid ());
+}
+
+LoraBackgroundTrafficHelper::GatewayProfile::GatewayProfile (uint32_t maxSamples,
+                                                            Ptr<UniformRandomVariable> random,
+                                                            Ptr<const SenderFilter> filter) :
+  maxSamples (maxSamples),
+  random (random),
+  filter (filter)
+{
+}
+
+void
+LoraBackgroundTrafficHelper::GatewayProfile::SignalArrival (Ptr<const Packet> packet,
+                                                           double rxPowerDbm,
+                                                           uint8_t sf,
+                                                           Time duration,
+                                                           double frequencyMHz)
+{
+  if (filter != 0 && filter->packets.count (packet->GetUid ()) == 0)
+    {
+      return;
+    }
+
+  ProcessProfile &process = processes[std::make_pair (frequencyMHz, sf)];
+  process.arrivals++;
+
+  // Reservoir sampling: the n-th signal replaces a random sample with
+  // probability maxSamples / n, so that all signals are equally likely to be
+  // kept
+  LoraBackgroundTraffic::Sample sample (rxPowerDbm, duration);
+  if (process.samples.size () < maxSamples)
+    {
+      process.samples.push_back (sample);
+      return;
+    }
+  uint64_t index = random->GetInteger (0, process.arrivals - 1);
+  if (index < maxSamples)
+    {
+      process.samples[index] = sample;
+    }
+}
+
+LoraBackgroundTrafficHelper::LoraBackgroundTrafficHelper () :
+  m_maxSamples (1000)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+}
+
+LoraBackgroundTrafficHelper::~LoraBackgroundTrafficHelper ()
+{
+  Disconnect ();
+}
+
+void
+LoraBackgroundTrafficHelper::SetMaxSamples (uint32_t maxSamples)
+{
+  NS_ASSERT (maxSamples > 0);
+
+  m_maxSamples = maxSamples;
+}
+
+void
+LoraBackgroundTrafficHelper::StartCalibration (NodeContainer gateways)
+{
+  NS_LOG_FUNCTION (this);
+
+  Disconnect ();
+  m_filter = 0;
+
+  m_profiles.clear ();
+  for (NodeContainer::Iterator it = gateways.Begin (); it != gateways.End (); ++it)
+    {
+      Ptr<GatewayProfile> profile = Create<GatewayProfile> (m_maxSamples,
+                                                            m_random, m_filter);
+      Ptr<GatewayLoraPhy> phy = GetGatewayPhy (*it);
+      phy->TraceConnectWithoutContext
+        ("SignalArrival", MakeCallback (&GatewayProfile::SignalArrival, profile));
+      m_profiles.push_back (profile);
+      m_gatewayPhys.push_back (phy);
+    }
+
+  m_calibrationStart = Simulator::Now ();
+  m_calibrationTime = Seconds (0);
+}
+
+void
+LoraBackgroundTrafficHelper::StartCalibration (NodeContainer gateways,
+                                               NodeContainer endDevices)
+{
+  NS_LOG_FUNCTION (this);
+
+  StartCalibration (gateways);
+
+  // Only count the signals whose packets were sent by the given end devices
+  m_filter = Create<SenderFilter> ();
+  for (auto it = m_profiles.begin (); it != m_profiles.end (); ++it)
+    {
+      (*it)->filter = m_filter;
+    }
+  for (NodeContainer::Iterator it = endDevices.Begin (); it != endDevices.End (); ++it)
+    {
+      Ptr<LoraNetDevice> device = (*it)->GetDevice (0)->GetObject<LoraNetDevice> ();
+      NS_ABORT_MSG_IF (device == 0, "Node " << (*it)->GetId () << " is not an end device");
+      Ptr<LoraPhy> phy = device->GetPhy ();
+      phy->TraceConnectWithoutContext
+        ("StartSending", MakeCallback (&SenderFilter::StartSending, m_filter));
+      m_endDevicePhys.push_back (phy);
+    }
+}
+
+void
+LoraBackgroundTrafficHelper::StopCalibration (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Disconnect ();
+  m_filter = 0;
+
+  m_calibrationTime = Simulator::Now () - m_calibrationStart;
+  NS_ABORT_MSG_IF (m_calibrationTime.IsZero (),
+                   "Background traffic was calibrated for no time");
+}
+
+void
+LoraBackgroundTrafficHelper::Disconnect (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (uint32_t i = 0; i < m_gatewayPhys.size (); i++)
+    {
+      m_gatewayPhys[i]->TraceDisconnectWithoutContext
+        ("SignalArrival", MakeCallback (&GatewayProfile::SignalArrival, m_profiles[i]));
+    }
+  m_gatewayPhys.clear ();
+
+  for (auto it = m_endDevicePhys.begin (); it != m_endDevicePhys.end (); ++it)
+    {
+      (*it)->TraceDisconnectWithoutContext
+        ("StartSending", MakeCallback (&SenderFilter::StartSending, m_filter));
+    }
+  m_endDevicePhys.clear ();
+
+  for (auto it = m_profiles.begin (); it != m_profiles.end (); ++it)
+    {
+      (*it)->filter = 0;
+    }
+}
+
+double
+LoraBackgroundTrafficHelper::GetRate (uint32_t gateway, double frequencyMHz,
+                                      uint8_t sf) const
+{
+  NS_ASSERT (gateway < m_profiles.size ());
+  NS_ASSERT (m_calibrationTime.IsStrictlyPositive ());
+
+  const std::map<std::pair<double, uint8_t>, ProcessProfile> &processes =
+    m_profiles[gateway]->processes;
+  auto it = processes.find (std::make_pair (frequencyMHz, sf));
+  if (it == processes.end ())
+    {
+      return 0;
+    }
+  return it->second.arrivals / m_calibrationTime.GetSeconds ();
+}
+
+std::vector<LoraBackgroundTraffic::Sample>
+LoraBackgroundTrafficHelper::GetSamples (uint32_t gateway, double frequencyMHz,
+                                         uint8_t sf) const
+{
+  NS_ASSERT (gateway < m_profiles.size ());
+
+  const std::map<std::pair<double, uint8_t>, ProcessProfile> &processes =
+    m_profiles[gateway]->processes;
+  auto it = processes.find (std::make_pair (frequencyMHz, sf));
+  if (it == processes.end ())
+    {
+      return std::vector<LoraBackgroundTraffic::Sample> ();
+    }
+  return it->second.samples;
+}
+
+void
+LoraBackgroundTrafficHelper::Install (NodeContainer gateways,
+                                      double rateScale) const
+{
+  NS_LOG_FUNCTION (this << rateScale);
+
+  NS_ABORT_MSG_IF (gateways.GetN () != m_profiles.size (),
+                   "Background traffic was calibrated for "
+                   << m_profiles.size () << " gateways, not "
+                   << gateways.GetN ());
+  NS_ABORT_MSG_IF (!m_calibrationTime.IsStrictlyPositive (),
+                   "Background traffic was not calibrated");
+
+  for (uint32_t i = 0; i < gateways.GetN (); i++)
+    {
+      Ptr<LoraBackgroundTraffic> traffic = CreateObject<LoraBackgroundTraffic> ();
+      traffic->SetPhy (GetGatewayPhy (gateways.Get (i)));
+
+      const std::map<std::pair<double, uint8_t>, ProcessProfile> &processes =
+        m_profiles[i]->processes;
+      for (auto it = processes.begin (); it != processes.end (); ++it)
+        {
+          double rate = rateScale * GetRate (i, it->first.first, it->first.second);
+          if (rate > 0)
+            {
+              traffic->AddProcess (it->first.first, it->first.second, rate,
+                                   it->second.samples);
+            }
+        }
+
+      gateways.Get (i)->AggregateObject (traffic);
+
+      // Start when the simulation runs, so that streams can still be assigned
+      Simulator::ScheduleNow (&LoraBackgroundTraffic::Start, traffic);
+    }
+}
+
+int64_t
+LoraBackgroundTrafficHelper::AssignStreams (NodeContainer gateways,
+                                            int64_t stream) const
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator it = gateways.Begin (); it != gateways.End (); ++it)
+    {
+      Ptr<LoraBackgroundTraffic> traffic = (*it)->GetObject<LoraBackgroundTraffic> ();
+      if (traffic != 0)
+        {
+          currentStream += traffic->AssignStreams (currentStream);
+        }
+    }
+  return (currentStream - stream);
+}
+
+int64_t
+LoraBackgroundTrafficHelper::AssignCalibrationStreams (int64_t stream)
+{
+  m_random->SetStream (stream);
+  return 1;
+}
+
+}
+}
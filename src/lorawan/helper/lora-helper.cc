@@ -59,7 +59,10 @@ LoraHelper::Install ( const LoraPhyHelper &phyHelper,
       device->SetPhy (phy);
       NS_LOG_DEBUG ("Done creating the PHY");
 
-      // Connect Trace Sources if necessary
+      // Connect Trace Sources if necessary. Gateway sinks get the PHY as a
+      // raw pointer, since a Ptr bound in its own trace sources would keep
+      // the PHY alive forever.
+      const LoraPhy *rawPhy = PeekPointer (phy);
       if (m_packetTracker)
         {
           if (phyHelper.GetDeviceType () ==
@@ -73,26 +76,63 @@ LoraHelper::Install ( const LoraPhyHelper &phyHelper,
           else if (phyHelper.GetDeviceType () ==
                    TypeId::LookupByName ("ns3::SimpleGatewayLoraPhy"))
             {
+              m_packetTracker->AddGateway ();
               phy->TraceConnectWithoutContext ("ReceivedPacket",
                                                MakeCallback
                                                  (&LoraPacketTracker::PacketReceptionCallback,
-                                                 m_packetTracker));
+                                                 m_packetTracker).Bind (rawPhy));
               phy->TraceConnectWithoutContext ("LostPacketBecauseInterference",
                                                MakeCallback
                                                  (&LoraPacketTracker::InterferenceCallback,
-                                                 m_packetTracker));
+                                                 m_packetTracker).Bind (rawPhy));
               phy->TraceConnectWithoutContext ("LostPacketBecauseNoMoreReceivers",
                                                MakeCallback
                                                  (&LoraPacketTracker::NoMoreReceiversCallback,
-                                                 m_packetTracker));
+                                                 m_packetTracker).Bind (rawPhy));
               phy->TraceConnectWithoutContext ("LostPacketBecauseUnderSensitivity",
                                                MakeCallback
                                                  (&LoraPacketTracker::UnderSensitivityCallback,
-                                                 m_packetTracker));
+                                                 m_packetTracker).Bind (rawPhy));
               phy->TraceConnectWithoutContext ("NoReceptionBecauseTransmitting",
                                                MakeCallback
                                                  (&LoraPacketTracker::LostBecauseTxCallback,
-                                                 m_packetTracker));
+                                                 m_packetTracker).Bind (rawPhy));
+            }
+        }
+
+      if (m_outcomeTraceWriter)
+        {
+          if (phyHelper.GetDeviceType () ==
+              TypeId::LookupByName ("ns3::SimpleEndDeviceLoraPhy"))
+            {
+              phy->TraceConnectWithoutContext ("StartSending",
+                                               MakeCallback
+                                                 (&LoraOutcomeTraceWriter::TransmissionCallback,
+                                                 m_outcomeTraceWriter));
+            }
+          else if (phyHelper.GetDeviceType () ==
+                   TypeId::LookupByName ("ns3::SimpleGatewayLoraPhy"))
+            {
+              phy->TraceConnectWithoutContext ("ReceivedPacket",
+                                               MakeCallback
+                                                 (&LoraOutcomeTraceWriter::PacketReceptionCallback,
+                                                 m_outcomeTraceWriter).Bind (rawPhy));
+              phy->TraceConnectWithoutContext ("LostPacketBecauseInterference",
+                                               MakeCallback
+                                                 (&LoraOutcomeTraceWriter::InterferenceCallback,
+                                                 m_outcomeTraceWriter).Bind (rawPhy));
+              phy->TraceConnectWithoutContext ("LostPacketBecauseNoMoreReceivers",
+                                               MakeCallback
+                                                 (&LoraOutcomeTraceWriter::NoMoreReceiversCallback,
+                                                 m_outcomeTraceWriter).Bind (rawPhy));
+              phy->TraceConnectWithoutContext ("LostPacketBecauseUnderSensitivity",
+                                               MakeCallback
+                                                 (&LoraOutcomeTraceWriter::UnderSensitivityCallback,
+                                                 m_outcomeTraceWriter).Bind (rawPhy));
+              phy->TraceConnectWithoutContext ("NoReceptionBecauseTransmitting",
+                                               MakeCallback
+                                                 (&LoraOutcomeTraceWriter::LostBecauseTxCallback,
+                                                 m_outcomeTraceWriter).Bind (rawPhy));
             }
         }
 
@@ -152,6 +192,26 @@ LoraHelper::EnablePacketTracking (std::string filename)
   m_packetTracker = new LoraPacketTracker (filename);
 }
 
+void
+LoraHelper::EnableStreamingPacketTracking (std::string filename,
+                                           Time binWidth)
+{
+  NS_LOG_FUNCTION (this << filename << binWidth);
+
+  EnablePacketTracking (filename);
+  m_packetTracker->EnableStreaming (binWidth);
+}
+
+void
+LoraHelper::EnableOutcomeTracing (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+
+  m_outcomeTraceWriter = new LoraOutcomeTraceWriter (filename);
+  Simulator::ScheduleDestroy (&LoraOutcomeTraceWriter::Close,
+                              m_outcomeTraceWriter);
+}
+
 void
 LoraHelper::EnableSimulationTimePrinting (void)
 {
@@ -182,6 +242,18 @@ LoraHelper::CountPhyPackets (Time start, Time stop)
   m_packetTracker->CountPhyPackets (start, stop);
 }
 
+void
+LoraHelper::PrintPhyBins (void)
+{
+  m_packetTracker->PrintPhyBins ();
+}
+
+void
+LoraHelper::WriteResults (Time start, Time stop, std::string filename)
+{
+  m_packetTracker->WriteResults (start, stop, filename);
+}
+
 void
 LoraHelper::PrintEndDevices (NodeContainer endDevices, NodeContainer gateways,
                              std::string filename)
@@ -28,6 +28,7 @@
 #include "ns3/net-device.h"
 #include "ns3/lora-net-device.h"
 #include "ns3/lora-packet-tracker.h"
+#include "ns3/lora-outcome-trace.h"
 
 #include <ctime>
 
@@ -81,6 +82,25 @@ public:
    */
   void EnablePacketTracking (std::string filename);
 
+  /**
+   * Enable tracking of packets via trace sources, keeping only counters of
+   * PHY outcomes in time bins of the given width
+   *
+   * Memory usage does not grow with the number of transmitted packets, which
+   * makes this mode suitable for long simulations. Counters can be written to
+   * the output file with PrintPhyBins.
+   */
+  void EnableStreamingPacketTracking (std::string filename, Time binWidth);
+
+  /**
+   * Write the outcome of each packet at each gateway to a binary file
+   *
+   * See LoraOutcomeTraceWriter for the format of the file, and
+   * LoraOutcomeTraceReader to read it. The file is completed when the
+   * simulator is destroyed.
+   */
+  void EnableOutcomeTracing (std::string filename);
+
   void EnableSimulationTimePrinting (void);
 
   void PrintSimulationTime (void);
@@ -89,11 +109,23 @@ public:
 
   void CountPhyPackets (Time start, Time stop);
 
+  void PrintPhyBins (void);
+
+  /**
+   * Write the MAC and PHY outcomes of the packets in [start, stop) to a file
+   * that is easy to parse, with one "name value" pair per line
+   *
+   * Packet tracking must be enabled.
+   */
+  void WriteResults (Time start, Time stop, std::string filename);
+
   void PrintEndDevices (NodeContainer endDevices, NodeContainer gateways,
                         std::string filename);
 
   LoraPacketTracker *m_packetTracker = 0;
 
+  LoraOutcomeTraceWriter *m_outcomeTraceWriter = 0;
+
   time_t m_oldtime;
 };
 
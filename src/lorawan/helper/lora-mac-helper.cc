@@ -22,16 +22,254 @@
 #include "ns3/gateway-lora-phy.h"
 #include "ns3/end-device-lora-phy.h"
 #include "ns3/lora-net-device.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/core-config.h"
 #include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unistd.h>
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 
 namespace ns3 {
 namespace lorawan {
 
 NS_LOG_COMPONENT_DEFINE ("LoraMacHelper");
 
+// Set the data rate of a device based on the power at which its best gateway
+// receives it, and count it in the SF histogram
+static void
+AssignDataRate (Ptr<EndDeviceLoraMac> mac, Ptr<EndDeviceLoraPhy> edPhy,
+                double rxPower, std::vector<int> &sfQuantity)
+{
+  const double *edSensitivity = edPhy->sensitivity;
+
+  if (rxPower > *edSensitivity)
+    {
+      mac->SetDataRate (5);
+      sfQuantity[0] = sfQuantity[0] + 1;
+    }
+  else if (rxPower > *(edSensitivity + 1))
+    {
+      mac->SetDataRate (4);
+      sfQuantity[1] = sfQuantity[1] + 1;
+    }
+  else if (rxPower > *(edSensitivity + 2))
+    {
+      mac->SetDataRate (3);
+      sfQuantity[2] = sfQuantity[2] + 1;
+    }
+  else if (rxPower > *(edSensitivity + 3))
+    {
+      mac->SetDataRate (2);
+      sfQuantity[3] = sfQuantity[3] + 1;
+    }
+  else if (rxPower > *(edSensitivity + 4))
+    {
+      mac->SetDataRate (1);
+      sfQuantity[4] = sfQuantity[4] + 1;
+    }
+  else if (rxPower > *(edSensitivity + 5))
+    {
+      mac->SetDataRate (0);
+      sfQuantity[5] = sfQuantity[5] + 1;
+    }
+  else // Device is out of range. Assign SF12.
+    {
+      // NS_LOG_DEBUG ("Device out of range");
+      mac->SetDataRate (0);
+      sfQuantity[6] = sfQuantity[6] + 1;
+      // NS_LOG_DEBUG ("sfQuantity[6] = " << sfQuantity[6]);
+    }
+}
+
+// A uniform grid of gateway positions, used to find the gateways that are
+// closest to a point without considering all of them
+class GatewayGrid
+{
+public:
+  GatewayGrid (const std::vector<Vector> &positions);
+
+  // Get the indexes of the k positions that are closest to a point
+  void GetNearest (Vector position, uint32_t k,
+                   std::vector<uint32_t> &nearest) const;
+
+private:
+  std::vector<Vector> m_positions;
+  double m_xMin;
+  double m_yMin;
+  double m_cellSize;
+  int32_t m_nx;
+  int32_t m_ny;
+  std::vector<std::vector<uint32_t> > m_cells;
+};
+
+GatewayGrid::GatewayGrid (const std::vector<Vector> &positions) :
+  m_positions (positions)
+{
+  NS_ASSERT (!positions.empty ());
+
+  double xMax = positions[0].x;
+  double yMax = positions[0].y;
+  m_xMin = xMax;
+  m_yMin = yMax;
+  for (auto it = positions.begin (); it != positions.end (); ++it)
+    {
+      m_xMin = std::min (m_xMin, it->x);
+      m_yMin = std::min (m_yMin, it->y);
+      xMax = std::max (xMax, it->x);
+      yMax = std::max (yMax, it->y);
+    }
+
+  // Aim for about one gateway per cell, while keeping the number of cells
+  // along each side at most equal to the number of gateways
+  double width = xMax - m_xMin;
+  double height = yMax - m_yMin;
+  m_cellSize = std::max (std::sqrt (width * height / positions.size ()),
+                         std::max (width, height) / positions.size ());
+  m_cellSize = std::max (m_cellSize, 1.0);
+  m_nx = static_cast<int32_t> (width / m_cellSize) + 1;
+  m_ny = static_cast<int32_t> (height / m_cellSize) + 1;
+
+  m_cells.resize (m_nx * m_ny);
+  for (uint32_t i = 0; i < positions.size (); i++)
+    {
+      int32_t x = static_cast<int32_t> ((positions[i].x - m_xMin) / m_cellSize);
+      int32_t y = static_cast<int32_t> ((positions[i].y - m_yMin) / m_cellSize);
+      m_cells[x * m_ny + y].push_back (i);
+    }
+}
+
+void
+GatewayGrid::GetNearest (Vector position, uint32_t k,
+                         std::vector<uint32_t> &nearest) const
+{
+  // The closest positions found so far, sorted by squared distance
+  std::vector<std::pair<double, uint32_t> > best;
+  k = std::min<uint32_t> (k, m_positions.size ());
+
+  int32_t cx = static_cast<int32_t> (std::floor ((position.x - m_xMin) / m_cellSize));
+  int32_t cy = static_cast<int32_t> (std::floor ((position.y - m_yMin) / m_cellSize));
+
+  // Visit rings of cells around the one containing the point. A cell in ring r
+  // is at least (r - 1) cells away from the point.
+  for (int32_t r = 0;; r++)
+    {
+      if (best.size () == k && r > 0)
+        {
+          double minDistance = (r - 1) * m_cellSize;
+          if (best.back ().first <= minDistance * minDistance)
+            {
+              break;
+            }
+        }
+
+      for (int32_t x = std::max (cx - r, 0); x <= std::min (cx + r, m_nx - 1);
+           x++)
+        {
+          for (int32_t y = std::max (cy - r, 0); y <= std::min (cy + r, m_ny - 1);
+               y++)
+            {
+              // Only visit the cells on the border of the ring
+              if (std::abs (x - cx) != r && std::abs (y - cy) != r)
+                {
+                  continue;
+                }
+
+              const std::vector<uint32_t> &cell = m_cells[x * m_ny + y];
+              for (auto it = cell.begin (); it != cell.end (); ++it)
+                {
+                  double dx = m_positions[*it].x - position.x;
+                  double dy = m_positions[*it].y - position.y;
+                  std::pair<double, uint32_t> candidate (dx * dx + dy * dy, *it);
+                  if (best.size () < k || candidate < best.back ())
+                    {
+                      best.insert (std::upper_bound (best.begin (), best.end (),
+                                                     candidate), candidate);
+                      if (best.size () > k)
+                        {
+                          best.pop_back ();
+                        }
+                    }
+                }
+            }
+        }
+
+      // Stop when the rings cover the whole grid
+      if (cx - r <= 0 && cx + r >= m_nx - 1 && cy - r <= 0 && cy + r >= m_ny - 1)
+        {
+          break;
+        }
+    }
+
+  nearest.clear ();
+  for (auto it = best.begin (); it != best.end (); ++it)
+    {
+      nearest.push_back (it->second);
+    }
+}
+
+// A range of end devices for which to compute the highest received power. Each
+// range is processed by a single thread, with its own copy of the gateways.
+struct RxPowerComputation
+{
+  Ptr<LoraChannel> channel;
+  const GatewayGrid *grid;
+  const std::vector<Ptr<MobilityModel> > *gateways;
+  const std::vector<Ptr<MobilityModel> > *endDevices;
+  uint32_t nearestGateways;
+  std::size_t begin;
+  std::size_t end;
+  std::vector<double> *rxPowers;
+};
+
+static void
+ComputeRxPowers (RxPowerComputation *computation)
+{
+  std::vector<uint32_t> nearest;
+  for (std::size_t i = computation->begin; i < computation->end; i++)
+    {
+      Ptr<MobilityModel> position = (*computation->endDevices)[i];
+      computation->grid->GetNearest (position->GetPosition (),
+                                     computation->nearestGateways, nearest);
+
+      // Assume devices transmit at 14 dBm
+      double highestRxPower = -std::numeric_limits<double>::infinity ();
+      for (auto it = nearest.begin (); it != nearest.end (); ++it)
+        {
+          highestRxPower = std::max (highestRxPower,
+                                     computation->channel->GetRxPower
+                                       (14, position, (*computation->gateways)[*it]));
+        }
+      (*computation->rxPowers)[i] = highestRxPower;
+    }
+}
+
 LoraMacHelper::LoraMacHelper ()
   : m_region (LoraMacHelper::EU)
 {
+  // Build the EU channel plan once, so that all MACs can share it
+
+  //////////////
+  // SubBands //
+  //////////////
+
+  m_euChannelHelper.AddSubBand (868, 868.6, 0.01, 14);
+  m_euChannelHelper.AddSubBand (868.7, 869.2, 0.001, 14);
+  m_euChannelHelper.AddSubBand (869.4, 869.65, 0.1, 27);
+
+  //////////////////////
+  // Default channels //
+  //////////////////////
+  Ptr<LogicalLoraChannel> lc1 = CreateObject<LogicalLoraChannel> (868.1, 0, 5);
+  Ptr<LogicalLoraChannel> lc2 = CreateObject<LogicalLoraChannel> (868.3, 0, 5);
+  Ptr<LogicalLoraChannel> lc3 = CreateObject<LogicalLoraChannel> (868.5, 0, 5);
+  m_euChannelHelper.AddChannel (lc1);
+  m_euChannelHelper.AddChannel (lc2);
+  m_euChannelHelper.AddChannel (lc3);
 }
 
 void
@@ -204,26 +442,9 @@ LoraMacHelper::ApplyCommonEuConfigurations (Ptr<LoraMac> loraMac) const
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  //////////////
-  // SubBands //
-  //////////////
-
-  LogicalLoraChannelHelper channelHelper;
-  channelHelper.AddSubBand (868, 868.6, 0.01, 14);
-  channelHelper.AddSubBand (868.7, 869.2, 0.001, 14);
-  channelHelper.AddSubBand (869.4, 869.65, 0.1, 27);
-
-  //////////////////////
-  // Default channels //
-  //////////////////////
-  Ptr<LogicalLoraChannel> lc1 = CreateObject<LogicalLoraChannel> (868.1, 0, 5);
-  Ptr<LogicalLoraChannel> lc2 = CreateObject<LogicalLoraChannel> (868.3, 0, 5);
-  Ptr<LogicalLoraChannel> lc3 = CreateObject<LogicalLoraChannel> (868.5, 0, 5);
-  channelHelper.AddChannel (lc1);
-  channelHelper.AddChannel (lc2);
-  channelHelper.AddChannel (lc3);
-
-  loraMac->SetLogicalLoraChannelHelper (channelHelper);
+  // All MACs share the same channel plan, and only keep their own channel mask
+  // and duty cycle timers
+  loraMac->SetLogicalLoraChannelHelper (m_euChannelHelper);
 
   ///////////////////////////////////////////////
   // DataRate -> SF, DataRate -> Bandwidth     //
@@ -282,47 +503,8 @@ LoraMacHelper::SetSpreadingFactorsUp (NodeContainer endDevices, NodeContainer ga
 
       // Get the ED sensitivity
       Ptr<EndDeviceLoraPhy> edPhy = loraNetDevice->GetPhy ()->GetObject<EndDeviceLoraPhy> ();
-      const double *edSensitivity = edPhy->sensitivity;
-
-
-      if (rxPower > *edSensitivity)
-        {
-          mac->SetDataRate (5);
-          sfQuantity[0] = sfQuantity[0] + 1;
-        }
-      else if (rxPower > *(edSensitivity + 1))
-        {
-          mac->SetDataRate (4);
-          sfQuantity[1] = sfQuantity[1] + 1;
-        }
-      else if (rxPower > *(edSensitivity + 2))
-        {
-          mac->SetDataRate (3);
-          sfQuantity[2] = sfQuantity[2] + 1;
-        }
-      else if (rxPower > *(edSensitivity + 3))
-        {
-          mac->SetDataRate (2);
-          sfQuantity[3] = sfQuantity[3] + 1;
-        }
-      else if (rxPower > *(edSensitivity + 4))
-        {
-          mac->SetDataRate (1);
-          sfQuantity[4] = sfQuantity[4] + 1;
-        }
-      else if (rxPower > *(edSensitivity + 5))
-        {
-          mac->SetDataRate (0);
-          sfQuantity[5] = sfQuantity[5] + 1;
-        }
-      else // Device is out of range. Assign SF12.
-        {
-          // NS_LOG_DEBUG ("Device out of range");
-          mac->SetDataRate (0);
-          sfQuantity[6] = sfQuantity[6] + 1;
-          // NS_LOG_DEBUG ("sfQuantity[6] = " << sfQuantity[6]);
 
-        }
+      AssignDataRate (mac, edPhy, rxPower, sfQuantity);
 
 /*
 
@@ -380,5 +562,117 @@ LoraMacHelper::SetSpreadingFactorsUp (NodeContainer endDevices, NodeContainer ga
 
 } //  end function
 
+std::vector<int>
+LoraMacHelper::SetSpreadingFactorsUp (NodeContainer endDevices,
+                                      NodeContainer gateways,
+                                      Ptr<LoraChannel> channel,
+                                      uint32_t nearestGateways,
+                                      uint32_t nThreads)
+{
+  NS_LOG_FUNCTION (endDevices.GetN () << gateways.GetN () << nearestGateways
+                                      << nThreads);
+
+  NS_ASSERT (gateways.GetN () > 0);
+  NS_ASSERT (nearestGateways > 0);
+
+  std::vector<Ptr<MobilityModel> > gatewayMobilities;
+  std::vector<Vector> gatewayPositions;
+  for (NodeContainer::Iterator it = gateways.Begin (); it != gateways.End (); ++it)
+    {
+      Ptr<MobilityModel> mobility = (*it)->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      gatewayMobilities.push_back (mobility);
+      gatewayPositions.push_back (mobility->GetPosition ());
+    }
+  GatewayGrid grid (gatewayPositions);
+
+  std::vector<Ptr<MobilityModel> > endDeviceMobilities;
+  for (NodeContainer::Iterator it = endDevices.Begin (); it != endDevices.End (); ++it)
+    {
+      Ptr<MobilityModel> mobility = (*it)->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      endDeviceMobilities.push_back (mobility);
+    }
+
+  // Compute the highest received power of each device, splitting the devices
+  // in contiguous ranges
+  if (!channel->IsRxPowerThreadSafe ())
+    {
+      NS_LOG_DEBUG ("The channel's loss models are not thread-safe");
+      nThreads = 1;
+    }
+  else if (nThreads == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      nThreads = cores > 0 ? cores : 1;
+    }
+  nThreads = std::max<uint32_t> (std::min<std::size_t> (nThreads, endDevices.GetN ()), 1);
+
+  // Reference counts are not thread-safe, so each thread gets its own copy of
+  // the gateways' positions
+  std::vector<std::vector<Ptr<MobilityModel> > > threadGateways (nThreads);
+  threadGateways[0] = gatewayMobilities;
+  for (uint32_t i = 1; i < nThreads; i++)
+    {
+      for (auto it = gatewayPositions.begin (); it != gatewayPositions.end (); ++it)
+        {
+          Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+          mobility->SetPosition (*it);
+          threadGateways[i].push_back (mobility);
+        }
+    }
+
+  std::vector<double> rxPowers (endDevices.GetN ());
+  std::vector<RxPowerComputation> computations (nThreads);
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      computations[i].channel = channel;
+      computations[i].grid = &grid;
+      computations[i].gateways = &threadGateways[i];
+      computations[i].endDevices = &endDeviceMobilities;
+      computations[i].nearestGateways = nearestGateways;
+      computations[i].begin = endDevices.GetN () * i / nThreads;
+      computations[i].end = endDevices.GetN () * (i + 1) / nThreads;
+      computations[i].rxPowers = &rxPowers;
+    }
+
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < nThreads; i++)
+    {
+      threads.push_back (ns3::Create<SystemThread>
+                           (MakeBoundCallback (&ComputeRxPowers,
+                                               &computations[i])));
+      threads.back ()->Start ();
+    }
+  ComputeRxPowers (&computations[0]);
+  for (auto it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+#else
+  for (auto it = computations.begin (); it != computations.end (); ++it)
+    {
+      ComputeRxPowers (&(*it));
+    }
+#endif
+
+  // Configure the devices in the calling thread, since this can fire traces
+  std::vector<int> sfQuantity (7, 0);
+  for (uint32_t i = 0; i < endDevices.GetN (); i++)
+    {
+      Ptr<LoraNetDevice> loraNetDevice =
+        endDevices.Get (i)->GetDevice (0)->GetObject<LoraNetDevice> ();
+      NS_ASSERT (loraNetDevice != 0);
+      Ptr<EndDeviceLoraMac> mac = loraNetDevice->GetMac ()->GetObject<EndDeviceLoraMac> ();
+      NS_ASSERT (mac != 0);
+      Ptr<EndDeviceLoraPhy> edPhy = loraNetDevice->GetPhy ()->GetObject<EndDeviceLoraPhy> ();
+
+      AssignDataRate (mac, edPhy, rxPowers[i], sfQuantity);
+    }
+
+  return sfQuantity;
+}
+
 }
 } //end class
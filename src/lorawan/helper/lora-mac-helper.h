@@ -114,6 +114,36 @@ public:
                                                  NodeContainer gateways,
                                                  Ptr<LoraChannel> channel);
 
+  /**
+   * Set up the end device's data rates, like the method above, but only
+   * considering the gateways that are closest to each device.
+   *
+   * Gateways are indexed in a grid, so that the nearest ones can be found
+   * without computing the received power from all of them. Received powers
+   * are computed by multiple threads if the channel's loss models allow it
+   * (see LoraChannel::IsRxPowerThreadSafe), and by the calling thread
+   * otherwise.
+   *
+   * Since the closest gateways are chosen by distance, the result may differ
+   * from the one of the method above when the channel includes shadowing or
+   * penetration losses.
+   *
+   * \param endDevices The end devices to configure.
+   * \param gateways The gateways to consider.
+   * \param channel The channel used to compute received powers.
+   * \param nearestGateways The number of closest gateways to consider for
+   * each device.
+   * \param nThreads The number of threads to use, or 0 to use all available
+   * cores.
+   * \return The number of devices using each SF, from SF7 to SF12, followed by
+   * the number of devices that cannot reach any gateway.
+   */
+  static std::vector<int> SetSpreadingFactorsUp (NodeContainer endDevices,
+                                                 NodeContainer gateways,
+                                                 Ptr<LoraChannel> channel,
+                                                 uint32_t nearestGateways,
+                                                 uint32_t nThreads = 0);
+
 private:
   /**
    * Perform region-specific configurations for the 868 MHz EU band.
@@ -135,6 +165,7 @@ private:
   Ptr<LoraDeviceAddressGenerator> m_addrGen; //!< Pointer to the address generator to use
   enum DeviceType m_deviceType; //!< The kind of device to install
   enum Regions m_region; //!< The region in which the device will operate
+  LogicalLoraChannelHelper m_euChannelHelper; //!< The EU channel plan, shared by all configured MACs
 };
 
 } //namespace ns3
@@ -0,0 +1,362 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/lora-outcome-trace.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+namespace lorawan {
+
+NS_LOG_COMPONENT_DEFINE ("LoraOutcomeTrace");
+
+// Packets whose sender is not known are reported with this sender id
+static const uint32_t UNKNOWN_SENDER = std::numeric_limits<uint32_t>::max ();
+
+// After this time, we assume a packet will not be reported by gateways anymore
+static const Time SENDER_MEMORY = Minutes (5);
+
+/**
+ * Get the size of a block of rows, including its header and padding.
+ */
+static std::size_t
+GetBlockSize (uint32_t rows)
+{
+  std::size_t size = 8 + rows * (sizeof (int64_t) + 2 * sizeof (uint32_t)
+                                 + 2 * sizeof (double) + 2 * sizeof (uint8_t));
+  return (size + 7) & ~std::size_t (7);
+}
+
+/****************************
+ *  LoraOutcomeTraceWriter  *
+ ****************************/
+
+const char LoraOutcomeTraceWriter::magic[8] = {'L', 'O', 'R', 'A', 'O', 'U', 'T', '1'};
+
+LoraOutcomeTraceWriter::LoraOutcomeTraceWriter (std::string filename,
+                                                uint32_t blockSize) :
+  m_blockSize (blockSize)
+{
+  NS_LOG_FUNCTION (this << filename << blockSize);
+
+  NS_ASSERT (blockSize > 0);
+
+  m_file.open (filename, std::ofstream::out | std::ofstream::trunc |
+               std::ofstream::binary);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "Cannot open " << filename);
+  m_file.write (magic, sizeof (magic));
+
+  m_times.reserve (m_blockSize);
+  m_senders.reserve (m_blockSize);
+  m_gateways.reserve (m_blockSize);
+  m_frequencies.reserve (m_blockSize);
+  m_rxPowers.reserve (m_blockSize);
+  m_sfs.reserve (m_blockSize);
+  m_outcomes.reserve (m_blockSize);
+}
+
+LoraOutcomeTraceWriter::~LoraOutcomeTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+
+  Close ();
+}
+
+void
+LoraOutcomeTraceWriter::Write (Time time, uint32_t sender, uint32_t gateway,
+                               uint8_t sf, double frequencyMHz,
+                               double rxPowerDbm, PacketOutcome outcome)
+{
+  m_times.push_back (time.GetNanoSeconds ());
+  m_senders.push_back (sender);
+  m_gateways.push_back (gateway);
+  m_frequencies.push_back (frequencyMHz);
+  m_rxPowers.push_back (rxPowerDbm);
+  m_sfs.push_back (sf);
+  m_outcomes.push_back (outcome);
+
+  if (m_times.size () == m_blockSize)
+    {
+      WriteBlock ();
+    }
+}
+
+void
+LoraOutcomeTraceWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+
+  if (!m_times.empty ())
+    {
+      WriteBlock ();
+    }
+  m_file.close ();
+}
+
+void
+LoraOutcomeTraceWriter::WriteBlock (void)
+{
+  NS_LOG_FUNCTION (this << m_times.size ());
+
+  uint32_t header[2] = {uint32_t (m_times.size ()), 0};
+  m_file.write (reinterpret_cast<const char *> (header), sizeof (header));
+
+  m_file.write (reinterpret_cast<const char *> (m_times.data ()),
+                m_times.size () * sizeof (int64_t));
+  m_file.write (reinterpret_cast<const char *> (m_senders.data ()),
+                m_senders.size () * sizeof (uint32_t));
+  m_file.write (reinterpret_cast<const char *> (m_gateways.data ()),
+                m_gateways.size () * sizeof (uint32_t));
+  m_file.write (reinterpret_cast<const char *> (m_frequencies.data ()),
+                m_frequencies.size () * sizeof (double));
+  m_file.write (reinterpret_cast<const char *> (m_rxPowers.data ()),
+                m_rxPowers.size () * sizeof (double));
+  m_file.write (reinterpret_cast<const char *> (m_sfs.data ()),
+                m_sfs.size () * sizeof (uint8_t));
+  m_file.write (reinterpret_cast<const char *> (m_outcomes.data ()),
+                m_outcomes.size () * sizeof (uint8_t));
+
+  // Pad the block to a multiple of 8 bytes
+  std::size_t padding = GetBlockSize (m_times.size ()) - 8
+    - m_times.size () * (sizeof (int64_t) + 2 * sizeof (uint32_t)
+                         + 2 * sizeof (double) + 2 * sizeof (uint8_t));
+  const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  m_file.write (zeros, padding);
+
+  m_times.clear ();
+  m_senders.clear ();
+  m_gateways.clear ();
+  m_frequencies.clear ();
+  m_rxPowers.clear ();
+  m_sfs.clear ();
+  m_outcomes.clear ();
+}
+
+void
+LoraOutcomeTraceWriter::TransmissionCallback (Ptr<Packet const> packet,
+                                              uint32_t systemId)
+{
+  Time now = Simulator::Now ();
+
+  // Forget packets that cannot be reported anymore
+  while (!m_sentPackets.empty ()
+         && m_sentPackets.front ().first < now - SENDER_MEMORY)
+    {
+      auto it = m_senderOf.find (m_sentPackets.front ().second);
+      if (it != m_senderOf.end ()
+          && it->second.first == m_sentPackets.front ().first)
+        {
+          m_senderOf.erase (it);
+        }
+      m_sentPackets.pop_front ();
+    }
+
+  // Retransmissions have the same UID as the original packet
+  m_senderOf[packet->GetUid ()] = std::make_pair (now, systemId);
+  m_sentPackets.push_back (std::make_pair (now, packet->GetUid ()));
+}
+
+void
+LoraOutcomeTraceWriter::WriteOutcome (const LoraPhy *phy,
+                                      Ptr<Packet const> packet,
+                                      uint32_t gateway, PacketOutcome outcome)
+{
+  uint32_t sender = UNKNOWN_SENDER;
+  auto it = m_senderOf.find (packet->GetUid ());
+  if (it != m_senderOf.end ())
+    {
+      sender = it->second.second;
+    }
+
+  const LoraRxParameters &rxParams = phy->GetRxParameters ();
+  Write (Simulator::Now (), sender, gateway, rxParams.sf,
+         rxParams.frequencyMHz, rxParams.rxPowerDbm, outcome);
+}
+
+void
+LoraOutcomeTraceWriter::PacketReceptionCallback (const LoraPhy *phy,
+                                                 Ptr<Packet const> packet,
+                                                 uint32_t systemId)
+{
+  WriteOutcome (phy, packet, systemId, RECEIVED);
+}
+
+void
+LoraOutcomeTraceWriter::InterferenceCallback (const LoraPhy *phy,
+                                              Ptr<Packet const> packet,
+                                              uint32_t systemId)
+{
+  WriteOutcome (phy, packet, systemId, INTERFERED);
+}
+
+void
+LoraOutcomeTraceWriter::NoMoreReceiversCallback (const LoraPhy *phy,
+                                                 Ptr<Packet const> packet,
+                                                 uint32_t systemId)
+{
+  WriteOutcome (phy, packet, systemId, NO_MORE_RECEIVERS);
+}
+
+void
+LoraOutcomeTraceWriter::UnderSensitivityCallback (const LoraPhy *phy,
+                                                  Ptr<Packet const> packet,
+                                                  uint32_t systemId)
+{
+  WriteOutcome (phy, packet, systemId, UNDER_SENSITIVITY);
+}
+
+void
+LoraOutcomeTraceWriter::LostBecauseTxCallback (const LoraPhy *phy,
+                                               Ptr<Packet const> packet,
+                                               uint32_t systemId)
+{
+  WriteOutcome (phy, packet, systemId, LOST_BECAUSE_TX);
+}
+
+/****************************
+ *  LoraOutcomeTraceReader  *
+ ****************************/
+
+LoraOutcomeTraceReader::LoraOutcomeTraceReader () :
+  m_data (0),
+  m_size (0)
+{
+}
+
+LoraOutcomeTraceReader::~LoraOutcomeTraceReader ()
+{
+  Close ();
+}
+
+bool
+LoraOutcomeTraceReader::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+
+  Close ();
+
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("Cannot open " << filename);
+      return false;
+    }
+
+  struct stat fileStat;
+  if (fstat (fd, &fileStat) != 0
+      || fileStat.st_size < off_t (sizeof (LoraOutcomeTraceWriter::magic)))
+    {
+      NS_LOG_WARN ("Cannot read " << filename);
+      close (fd);
+      return false;
+    }
+
+  m_size = fileStat.st_size;
+  void *data = mmap (0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (data == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Cannot map " << filename);
+      m_size = 0;
+      return false;
+    }
+  m_data = static_cast<const uint8_t *> (data);
+
+  if (std::memcmp (m_data, LoraOutcomeTraceWriter::magic,
+                   sizeof (LoraOutcomeTraceWriter::magic)) != 0)
+    {
+      NS_LOG_WARN (filename << " is not a LoRa outcome trace");
+      Close ();
+      return false;
+    }
+
+  // Index the blocks
+  std::size_t offset = sizeof (LoraOutcomeTraceWriter::magic);
+  while (offset + 8 <= m_size)
+    {
+      Block block;
+      block.rows = *reinterpret_cast<const uint32_t *> (m_data + offset);
+      if (offset + GetBlockSize (block.rows) > m_size)
+        {
+          NS_LOG_WARN (filename << " is truncated");
+          break;
+        }
+
+      const uint8_t *column = m_data + offset + 8;
+      block.times = reinterpret_cast<const int64_t *> (column);
+      column += block.rows * sizeof (int64_t);
+      block.senders = reinterpret_cast<const uint32_t *> (column);
+      column += block.rows * sizeof (uint32_t);
+      block.gateways = reinterpret_cast<const uint32_t *> (column);
+      column += block.rows * sizeof (uint32_t);
+      block.frequencies = reinterpret_cast<const double *> (column);
+      column += block.rows * sizeof (double);
+      block.rxPowers = reinterpret_cast<const double *> (column);
+      column += block.rows * sizeof (double);
+      block.sfs = column;
+      column += block.rows * sizeof (uint8_t);
+      block.outcomes = column;
+
+      m_blocks.push_back (block);
+      offset += GetBlockSize (block.rows);
+    }
+
+  return true;
+}
+
+void
+LoraOutcomeTraceReader::Close (void)
+{
+  if (m_data != 0)
+    {
+      munmap (const_cast<uint8_t *> (m_data), m_size);
+    }
+  m_data = 0;
+  m_size = 0;
+  m_blocks.clear ();
+}
+
+const std::vector<LoraOutcomeTraceReader::Block> &
+LoraOutcomeTraceReader::GetBlocks (void) const
+{
+  return m_blocks;
+}
+
+uint64_t
+LoraOutcomeTraceReader::GetNRows (void) const
+{
+  uint64_t rows = 0;
+  for (auto it = m_blocks.begin (); it != m_blocks.end (); ++it)
+    {
+      rows += it->rows;
+    }
+  return rows;
+}
+
+}
+}
@@ -9,7 +9,9 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("LoraPacketTracker");
 
 LoraPacketTracker::LoraPacketTracker (std::string filename) :
-  m_outputFilename (filename)
+  m_outputFilename (filename),
+  m_streaming (false),
+  m_nGateways (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -38,7 +40,19 @@ LoraPacketTracker::MacTransmissionCallback (Ptr<Packet const> packet)
   status.receivedTime = Time::Max ();
   status.systemId = Simulator::GetContext ();
 
-  m_macPacketTracker.insert (std::pair<Ptr<Packet const>, MacPacketStatus> (packet, status));
+  if (m_streaming)
+    {
+      RetireOldMacPackets (Simulator::Now () - m_maxPacketAge);
+    }
+
+  // Retransmissions keep the time of the first transmission
+  bool inserted =
+    m_macPacketTracker.insert (std::make_pair (packet->GetUid (), status)).second;
+  if (m_streaming && inserted)
+    {
+      m_pendingMacPackets.push_back (std::make_pair (Simulator::Now (),
+                                                     packet->GetUid ()));
+    }
 }
 
 void
@@ -50,14 +64,31 @@ LoraPacketTracker::RequiredTransmissionsCallback (uint8_t reqTx, bool success,
   NS_LOG_DEBUG ("ReqTx " << unsigned(reqTx) << ", succ: " << success <<
                 ", firstAttempt: " << firstAttempt.GetSeconds ());
 
+  // Unconfirmed packets are not kept by the MAC, and cannot be identified
+  if (packet == 0)
+    {
+      return;
+    }
+
   RetransmissionStatus entry;
   entry.firstAttempt = firstAttempt;
   entry.finishTime = Simulator::Now ();
   entry.reTxAttempts = reqTx;
   entry.successful = success;
 
-  m_reTransmissionTracker.insert (std::pair<Ptr<Packet>, RetransmissionStatus>
-                                    (packet, entry));
+  if (m_streaming)
+    {
+      // Account for the packet in the bin it was first sent in, and forget it
+      auto it = m_macPacketTracker.find (packet->GetUid ());
+      if (it != m_macPacketTracker.end ())
+        {
+          AddMacOutcome (GetMacBin (it->second.sendTime), it->second, entry);
+          m_macPacketTracker.erase (it);
+        }
+      return;
+    }
+
+  m_reTransmissionTracker.insert (std::make_pair (packet->GetUid (), entry));
 }
 
 void
@@ -66,7 +97,7 @@ LoraPacketTracker::MacGwReceptionCallback (Ptr<Packet const> packet)
   NS_LOG_INFO ("A packet was successfully received at MAC layer of a gateway");
 
   // Find the received packet in the m_macPacketTracker
-  auto it = m_macPacketTracker.find (packet);
+  auto it = m_macPacketTracker.find (packet->GetUid ());
   if (it != m_macPacketTracker.end ())
     {
       (*it).second.receivedTime = Simulator::Now ();
@@ -75,7 +106,7 @@ LoraPacketTracker::MacGwReceptionCallback (Ptr<Packet const> packet)
       //                            ((*it).second.receivedTime -
       //                            (*it).second.sendTime).GetSeconds ());
     }
-  else
+  else if (!m_streaming)
     {
       NS_ABORT_MSG ("Packet not found in tracker");
     }
@@ -92,191 +123,323 @@ LoraPacketTracker::TransmissionCallback (Ptr<Packet const> packet, uint32_t syst
 
   // Create a packetStatus
   PacketStatus status;
-  status.packet = packet;
+  status.packetUid = packet->GetUid ();
   status.senderId = systemId;
+  status.sendTime = Simulator::Now ();
   status.outcomeNumber = 0;
+  status.receptions = 0;
   status.outcomes = std::vector<enum PacketOutcome> (1, UNSET);
 
-  m_packetTracker.insert (std::pair<Ptr<Packet const>, PacketStatus> (packet, status));
+  if (m_streaming)
+    {
+      RetireOldPackets (Simulator::Now () - m_maxPacketAge);
+
+      // Retransmissions have the same UID as the original packet
+      auto it = m_packetTracker.find (packet->GetUid ());
+      if (it != m_packetTracker.end ())
+        {
+          RetirePacket (it);
+        }
+
+      GetBin (Simulator::Now ()).sentPackets++;
+      m_pendingPackets.push_back (std::make_pair (Simulator::Now (),
+                                                  packet->GetUid ()));
+    }
+
+  m_packetTracker.insert (std::make_pair (packet->GetUid (), status));
 }
 
 void
-LoraPacketTracker::PacketReceptionCallback (Ptr<Packet const> packet, uint32_t systemId)
+LoraPacketTracker::PacketReceptionCallback (const lorawan::LoraPhy *phy,
+                                            Ptr<Packet const> packet,
+                                            uint32_t systemId)
 {
   // Remove the successfully received packet from the list of sent ones
   NS_LOG_INFO ("A packet was successfully received at gateway " << systemId);
 
-  std::map<Ptr<Packet const>, PacketStatus>::iterator it = m_packetTracker.find (packet);
-  (*it).second.outcomes.at (0) = RECEIVED;
-  (*it).second.outcomeNumber += 1;
-
-  m_phyPacketOutcomes.push_back (std::pair<Time, PacketOutcome> (Simulator::Now (), RECEIVED));
+  SetPhyOutcome (packet, systemId, phy->GetRxParameters ().sf, RECEIVED);
 }
 
 void
-LoraPacketTracker::InterferenceCallback (Ptr<Packet const> packet, uint32_t systemId)
+LoraPacketTracker::InterferenceCallback (const lorawan::LoraPhy *phy,
+                                         Ptr<Packet const> packet,
+                                         uint32_t systemId)
 {
   NS_LOG_INFO ("A packet was lost because of interference at gateway " << systemId);
 
-  std::map<Ptr<Packet const>, PacketStatus>::iterator it = m_packetTracker.find (packet);
-  (*it).second.outcomes.at (0) = INTERFERED;
-  (*it).second.outcomeNumber += 1;
-
-  m_phyPacketOutcomes.push_back (std::pair<Time, PacketOutcome> (Simulator::Now (), INTERFERED));
+  SetPhyOutcome (packet, systemId, phy->GetRxParameters ().sf, INTERFERED);
 }
 
 void
-LoraPacketTracker::NoMoreReceiversCallback (Ptr<Packet const> packet, uint32_t systemId)
+LoraPacketTracker::NoMoreReceiversCallback (const lorawan::LoraPhy *phy,
+                                            Ptr<Packet const> packet,
+                                            uint32_t systemId)
 {
   NS_LOG_INFO ("A packet was lost because there were no more receivers at gateway " << systemId);
-  std::map<Ptr<Packet const>, PacketStatus>::iterator it = m_packetTracker.find (packet);
-  (*it).second.outcomes.at (0) = NO_MORE_RECEIVERS;
-  (*it).second.outcomeNumber += 1;
-
-  m_phyPacketOutcomes.push_back (std::pair<Time, PacketOutcome> (Simulator::Now (), NO_MORE_RECEIVERS));
+  SetPhyOutcome (packet, systemId, phy->GetRxParameters ().sf, NO_MORE_RECEIVERS);
 }
 
 void
-LoraPacketTracker::UnderSensitivityCallback (Ptr<Packet const> packet, uint32_t systemId)
+LoraPacketTracker::UnderSensitivityCallback (const lorawan::LoraPhy *phy,
+                                             Ptr<Packet const> packet,
+                                             uint32_t systemId)
 {
   NS_LOG_INFO ("A packet arrived at the gateway under sensitivity at gateway " << systemId);
 
-  std::map<Ptr<Packet const>, PacketStatus>::iterator it = m_packetTracker.find (packet);
-  (*it).second.outcomes.at (0) = UNDER_SENSITIVITY;
-  (*it).second.outcomeNumber += 1;
-
-  m_phyPacketOutcomes.push_back (std::pair<Time, PacketOutcome> (Simulator::Now (), UNDER_SENSITIVITY));
+  SetPhyOutcome (packet, systemId, phy->GetRxParameters ().sf, UNDER_SENSITIVITY);
 }
 
 void
-LoraPacketTracker::LostBecauseTxCallback (Ptr<Packet const> packet, uint32_t systemId)
+LoraPacketTracker::LostBecauseTxCallback (const lorawan::LoraPhy *phy,
+                                          Ptr<Packet const> packet,
+                                          uint32_t systemId)
 {
   NS_LOG_INFO ("A packet arrived at the gateway under sensitivity at gateway " << systemId);
 
-  std::map<Ptr<Packet const>, PacketStatus>::iterator it = m_packetTracker.find (packet);
-  (*it).second.outcomes.at (0) = LOST_BECAUSE_TX;
-  (*it).second.outcomeNumber += 1;
+  SetPhyOutcome (packet, systemId, phy->GetRxParameters ().sf, LOST_BECAUSE_TX);
+}
+
+void
+LoraPacketTracker::SetPhyOutcome (Ptr<Packet const> packet, uint32_t systemId,
+                                  uint8_t sf, PacketOutcome outcome)
+{
+  auto it = m_packetTracker.find (packet->GetUid ());
+  if (it != m_packetTracker.end ())
+    {
+      it->second.outcomes.at (0) = outcome;
+      it->second.outcomeNumber += 1;
+      if (outcome == RECEIVED)
+        {
+          it->second.receptions += 1;
+        }
+    }
+
+  if (!m_streaming)
+    {
+      m_phyPacketOutcomes.push_back (std::pair<Time, PacketOutcome> (Simulator::Now (), outcome));
+      return;
+    }
+
+  std::vector<uint32_t> &counters =
+    GetBin (Simulator::Now ()).outcomes[std::make_pair (systemId, sf)];
+  if (counters.empty ())
+    {
+      counters.resize (UNSET, 0);
+    }
+  counters.at (outcome)++;
 
-  m_phyPacketOutcomes.push_back (std::pair<Time, PacketOutcome> (Simulator::Now (), LOST_BECAUSE_TX));
+  // Once all gateways have reported, the packet can be forgotten
+  if (it != m_packetTracker.end ()
+      && it->second.outcomeNumber >= int(m_nGateways))
+    {
+      RetirePacket (it);
+    }
 }
 
 void
-LoraPacketTracker::PrintPerformance (Time start, Time stop)
+LoraPacketTracker::EnableStreaming (Time binWidth, Time maxPacketAge)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << binWidth << maxPacketAge);
 
-  CountRetransmissions (start, stop, m_macPacketTracker,
-                        m_reTransmissionTracker, m_packetTracker);
+  NS_ASSERT (binWidth.IsStrictlyPositive ());
+
+  m_streaming = true;
+  m_binWidth = binWidth;
+  m_maxPacketAge = maxPacketAge;
 }
 
 void
-LoraPacketTracker::CountPhyPackets (Time start, Time stop)
+LoraPacketTracker::AddGateway (void)
 {
-  NS_LOG_FUNCTION (this);
+  m_nGateways++;
+}
 
-  DoCountPhyPackets (start, stop, m_packetTracker);
+MacOutcomeBin &
+LoraPacketTracker::GetMacBin (Time time)
+{
+  std::size_t bin = time.GetTimeStep () / m_binWidth.GetTimeStep ();
+  if (bin >= m_macBins.size ())
+    {
+      m_macBins.resize (bin + 1, CreateMacBin ());
+    }
+  return m_macBins[bin];
+}
+
+MacOutcomeBin
+LoraPacketTracker::CreateMacBin (void)
+{
+  MacOutcomeBin bin;
+  bin.successfulReTx = std::vector<int> (8, 0);
+  bin.failedReTx = std::vector<int> (8, 0);
+  bin.receivedPackets = 0;
+  bin.delaySum = Seconds (0);
+  bin.ackDelaySum = Seconds (0);
+  return bin;
 }
 
 void
-LoraPacketTracker::PrintVector (std::vector<int> vector)
+LoraPacketTracker::AddMacOutcome (MacOutcomeBin &bin,
+                                  const MacPacketStatus &macStatus,
+                                  const RetransmissionStatus &reTxStatus)
 {
-  // NS_LOG_INFO ("PrintRetransmissions");
+  if (reTxStatus.successful)
+    {
+      bin.successfulReTx.at (reTxStatus.reTxAttempts - 1)++;
+    }
+  else
+    {
+      bin.failedReTx.at (reTxStatus.reTxAttempts - 1)++;
+    }
 
-  for (int i = 0; i < int(vector.size ()); i++)
+  if (macStatus.receivedTime != Time::Max ())
     {
-      // NS_LOG_INFO ("i: " << i);
-      std::cout << vector.at (i) << " ";
+      bin.receivedPackets++;
+      bin.delaySum += macStatus.receivedTime - macStatus.sendTime;
+      bin.ackDelaySum += reTxStatus.finishTime - reTxStatus.firstAttempt;
     }
-  //
-  // std::cout << std::endl;
 }
 
+PhyOutcomeBin &
+LoraPacketTracker::GetBin (Time time)
+{
+  std::size_t bin = time.GetTimeStep () / m_binWidth.GetTimeStep ();
+  if (bin >= m_bins.size ())
+    {
+      PhyOutcomeBin empty;
+      empty.sentPackets = 0;
+      empty.receivedPackets = 0;
+      m_bins.resize (bin + 1, empty);
+    }
+  return m_bins[bin];
+}
+
+void
+LoraPacketTracker::RetirePacket (PhyPacketData::iterator it)
+{
+  if (it->second.receptions > 0)
+    {
+      GetBin (it->second.sendTime).receivedPackets++;
+    }
+  m_packetTracker.erase (it);
+}
 
 void
-LoraPacketTracker::PrintSumRetransmissions (std::vector<int> reTxVector)
+LoraPacketTracker::RetireOldPackets (Time limit)
 {
-  // NS_LOG_INFO ("PrintSumRetransmissions");
+  while (!m_pendingPackets.empty () && m_pendingPackets.front ().first < limit)
+    {
+      // The packet may have been retired already, or sent again
+      auto it = m_packetTracker.find (m_pendingPackets.front ().second);
+      if (it != m_packetTracker.end ()
+          && it->second.sendTime == m_pendingPackets.front ().first)
+        {
+          RetirePacket (it);
+        }
+      m_pendingPackets.pop_front ();
+    }
+}
 
-  int total = 0;
-  for (int i = 0; i < int(reTxVector.size ()); i++)
+void
+LoraPacketTracker::RetireOldMacPackets (Time limit)
+{
+  while (!m_pendingMacPackets.empty ()
+         && m_pendingMacPackets.front ().first < limit)
     {
-      // NS_LOG_INFO ("i: " << i);
-      total += reTxVector[i] * (i + 1);
+      // Packets whose retransmission procedure ended were already retired.
+      // The others, e.g., unconfirmed packets, can't be counted.
+      auto it = m_macPacketTracker.find (m_pendingMacPackets.front ().second);
+      if (it != m_macPacketTracker.end ()
+          && it->second.sendTime == m_pendingMacPackets.front ().first)
+        {
+          NS_LOG_DEBUG ("Forgetting MAC packet " << it->first);
+          m_macPacketTracker.erase (it);
+        }
+      m_pendingMacPackets.pop_front ();
     }
-  std::cout << total;
 }
 
 void
-LoraPacketTracker::CountRetransmissions (Time transient, Time simulationTime, MacPacketData
-                                         macPacketTracker, RetransmissionData reTransmissionTracker,
-                                         PhyPacketData packetTracker)
+LoraPacketTracker::PrintPhyBins (void)
 {
-  std::vector<int> totalReTxAmounts (8, 0);
-  std::vector<int> successfulReTxAmounts (8, 0);
-  std::vector<int> failedReTxAmounts (8, 0);
-  Time delaySum = Seconds (0);
-  Time ackDelaySum = Seconds (0);
+  NS_LOG_FUNCTION (this);
 
-  int packetsOutsideTransient = 0;
-  int MACpacketsOutsideTransient = 0;
+  NS_ASSERT_MSG (m_streaming, "Bins are only available in streaming mode");
 
-  for (auto itMac = macPacketTracker.begin (); itMac != macPacketTracker.end (); ++itMac)
+  // Account for the packets whose outcome is not complete yet
+  RetireOldPackets (Time::Max ());
+
+  std::ofstream outputFile;
+  outputFile.open (m_outputFilename, std::ofstream::out | std::ofstream::app);
+
+  // Legend
+  outputFile << "# binStart sent receivedByAnyGateway gateway sf received "
+             << "interfered noMoreReceivers underSensitivity lostBecauseTx"
+             << std::endl;
+
+  for (std::size_t bin = 0; bin < m_bins.size (); bin++)
     {
-      // NS_LOG_DEBUG ("Dealing with packet " << (*itMac).first);
+      const PhyOutcomeBin &phyBin = m_bins[bin];
+      double binStart = (m_binWidth * bin).GetSeconds ();
 
-      if ((*itMac).second.sendTime > transient && (*itMac).second.sendTime < simulationTime - transient)
+      if (phyBin.outcomes.empty ())
         {
-          // Count retransmissions
-          ////////////////////////
-          auto itRetx = reTransmissionTracker.find ((*itMac).first);
+          outputFile << binStart << " " << phyBin.sentPackets << " "
+                     << phyBin.receivedPackets << std::endl;
+          continue;
+        }
 
-          if (itRetx == reTransmissionTracker.end ())
+      for (auto it = phyBin.outcomes.begin (); it != phyBin.outcomes.end (); ++it)
+        {
+          outputFile << binStart << " " << phyBin.sentPackets << " "
+                     << phyBin.receivedPackets << " " << it->first.first << " "
+                     << unsigned(it->first.second);
+          for (auto counter = it->second.begin (); counter != it->second.end ();
+               ++counter)
             {
-              // This means that the device did not finish retransmitting
-              NS_ABORT_MSG ("Searched packet was not found" << "Packet " <<
-                            (*itMac).first << " not found. Sent at " <<
-                            (*itMac).second.sendTime.GetSeconds ());
+              outputFile << " " << *counter;
             }
+          outputFile << std::endl;
+        }
+    }
 
-          packetsOutsideTransient++;
-          MACpacketsOutsideTransient++;
-
-          totalReTxAmounts.at ((*itRetx).second.reTxAttempts - 1)++;
+  outputFile.close ();
+}
 
-          if ((*itRetx).second.successful)
-            {
-              successfulReTxAmounts.at ((*itRetx).second.reTxAttempts - 1)++;
-            }
-          else
-            {
-              failedReTxAmounts.at ((*itRetx).second.reTxAttempts - 1)++;
-            }
+std::vector<int>
+LoraPacketTracker::CountPhyOutcomes (Time startTime, Time stopTime) const
+{
+  // vector performanceAmounts will contain - for the interval given in the
+  // input of the function, the following fields:
+  // totPacketsSent receivedPackets interferedPackets noMoreGwPackets underSensitivityPackets lostBecauseTxPackets
+  std::vector<int> performancesAmounts (6, 0);
 
-          // Compute delays
-          /////////////////
-          if ((*itMac).second.receivedTime == Time::Max ())
+  if (m_streaming)
+    {
+      // Consider the bins starting in the interval
+      for (std::size_t bin = 0; bin < m_bins.size (); bin++)
+        {
+          Time binStart = m_binWidth * bin;
+          if (binStart < startTime || binStart >= stopTime)
             {
-              // NS_LOG_DEBUG ("Packet never received, ignoring it");
-              packetsOutsideTransient--;
+              continue;
             }
-          else
+          const PhyOutcomeBin &phyBin = m_bins[bin];
+          for (auto it = phyBin.outcomes.begin (); it != phyBin.outcomes.end ();
+               ++it)
             {
-              delaySum += (*itMac).second.receivedTime - (*itMac).second.sendTime;
-              ackDelaySum += (*itRetx).second.finishTime - (*itRetx).second.firstAttempt;
+              for (int outcome = RECEIVED; outcome < UNSET; outcome++)
+                {
+                  performancesAmounts.at (0) += it->second.at (outcome);
+                  performancesAmounts.at (outcome + 1) += it->second.at (outcome);
+                }
             }
-
         }
+      return performancesAmounts;
     }
 
-  // Sum PHY outcomes
-  //////////////////////////////////
-  // vector performanceAmounts will contain - for the interval given in the
-  // input of the function, the following fields:
-  // totPacketsSent receivedPackets interferedPackets noMoreGwPackets underSensitivityPackets
-  std::vector<int> performancesAmounts (6, 0);
   for (auto itPhy = m_phyPacketOutcomes.begin (); itPhy != m_phyPacketOutcomes.end (); ++itPhy)
     {
-      if ((*itPhy).first >= transient && (*itPhy).first <= simulationTime - transient)
+      if ((*itPhy).first >= startTime && (*itPhy).first < stopTime)
         {
           performancesAmounts.at (0)++;
 
@@ -315,21 +478,212 @@ LoraPacketTracker::CountRetransmissions (Time transient, Time simulationTime, Ma
         }
     }
 
+  return performancesAmounts;
+}
+
+MacOutcomeBin
+LoraPacketTracker::CountMacOutcomes (Time startTime, Time stopTime) const
+{
+  if (!m_streaming)
+    {
+      return DoCountMacOutcomes (startTime, stopTime, m_macPacketTracker,
+                                 m_reTransmissionTracker);
+    }
+
+  // Sum the bins starting in the interval
+  MacOutcomeBin counts = CreateMacBin ();
+  for (std::size_t bin = 0; bin < m_macBins.size (); bin++)
+    {
+      Time binStart = m_binWidth * bin;
+      if (binStart < startTime || binStart >= stopTime)
+        {
+          continue;
+        }
+      const MacOutcomeBin &macBin = m_macBins[bin];
+      for (std::size_t i = 0; i < counts.successfulReTx.size (); i++)
+        {
+          counts.successfulReTx[i] += macBin.successfulReTx[i];
+          counts.failedReTx[i] += macBin.failedReTx[i];
+        }
+      counts.receivedPackets += macBin.receivedPackets;
+      counts.delaySum += macBin.delaySum;
+      counts.ackDelaySum += macBin.ackDelaySum;
+    }
+  return counts;
+}
+
+MacOutcomeBin
+LoraPacketTracker::DoCountMacOutcomes (Time startTime, Time stopTime,
+                                       const MacPacketData &macPacketTracker,
+                                       const RetransmissionData &reTransmissionTracker)
+{
+  MacOutcomeBin counts = CreateMacBin ();
+  for (auto itMac = macPacketTracker.begin (); itMac != macPacketTracker.end (); ++itMac)
+    {
+      // NS_LOG_DEBUG ("Dealing with packet " << (*itMac).first);
+
+      if ((*itMac).second.sendTime >= startTime && (*itMac).second.sendTime < stopTime)
+        {
+          auto itRetx = reTransmissionTracker.find ((*itMac).first);
+
+          if (itRetx == reTransmissionTracker.end ())
+            {
+              // This means that the device did not finish retransmitting
+              NS_ABORT_MSG ("Searched packet was not found" << "Packet " <<
+                            (*itMac).first << " not found. Sent at " <<
+                            (*itMac).second.sendTime.GetSeconds ());
+            }
+
+          AddMacOutcome (counts, (*itMac).second, (*itRetx).second);
+        }
+    }
+  return counts;
+}
+
+void
+LoraPacketTracker::WriteResults (Time startTime, Time stopTime,
+                                 std::string filename) const
+{
+  NS_LOG_FUNCTION (this << startTime << stopTime << filename);
+
+  MacOutcomeBin macCounts = CountMacOutcomes (startTime, stopTime);
+  std::vector<int> phyCounts = CountPhyOutcomes (startTime, stopTime);
+
+  std::ofstream outputFile (filename.c_str ());
+  NS_ABORT_MSG_UNLESS (outputFile.is_open (), "Cannot open " << filename);
+
+  for (std::size_t i = 0; i < macCounts.successfulReTx.size (); i++)
+    {
+      outputFile << "MacSuccessfulWith" << i + 1 << " "
+                 << macCounts.successfulReTx[i] << std::endl;
+    }
+  for (std::size_t i = 0; i < macCounts.failedReTx.size (); i++)
+    {
+      outputFile << "MacFailedAfter" << i + 1 << " "
+                 << macCounts.failedReTx[i] << std::endl;
+    }
+  double avgDelay = 0;
+  double avgAckDelay = 0;
+  if (macCounts.receivedPackets != 0)
+    {
+      avgDelay = (macCounts.delaySum / macCounts.receivedPackets).GetSeconds ();
+      avgAckDelay = (macCounts.ackDelaySum / macCounts.receivedPackets).GetSeconds ();
+    }
+  outputFile << "MacAverageDelay " << avgDelay << std::endl;
+  outputFile << "MacAverageAckDelay " << avgAckDelay << std::endl;
+
+  const char *phyNames[] = {"PhyTotal", "PhySuccessful", "PhyInterfered",
+                            "PhyNoMoreReceivers", "PhyUnderSensitivity",
+                            "PhyLostBecauseTX"};
+  for (std::size_t i = 0; i < phyCounts.size (); i++)
+    {
+      outputFile << phyNames[i] << " " << phyCounts[i] << std::endl;
+    }
+}
+
+std::size_t
+LoraPacketTracker::GetNTrackedPackets (void) const
+{
+  return m_packetTracker.size () + m_macPacketTracker.size ()
+         + m_reTransmissionTracker.size ();
+}
+
+const PacketStatus *
+LoraPacketTracker::GetPacketStatus (Ptr<Packet const> packet) const
+{
+  auto it = m_packetTracker.find (packet->GetUid ());
+  if (it == m_packetTracker.end ())
+    {
+      return 0;
+    }
+  return &it->second;
+}
+
+void
+LoraPacketTracker::PrintPerformance (Time start, Time stop)
+{
+  NS_LOG_FUNCTION (this);
+
+  CountRetransmissions (start, stop, m_macPacketTracker,
+                        m_reTransmissionTracker, m_packetTracker);
+}
+
+void
+LoraPacketTracker::CountPhyPackets (Time start, Time stop)
+{
+  NS_LOG_FUNCTION (this);
+
+  DoCountPhyPackets (start, stop, m_packetTracker);
+}
+
+void
+LoraPacketTracker::PrintVector (std::vector<int> vector)
+{
+  // NS_LOG_INFO ("PrintRetransmissions");
+
+  for (int i = 0; i < int(vector.size ()); i++)
+    {
+      // NS_LOG_INFO ("i: " << i);
+      std::cout << vector.at (i) << " ";
+    }
+  //
+  // std::cout << std::endl;
+}
+
+
+void
+LoraPacketTracker::PrintSumRetransmissions (std::vector<int> reTxVector)
+{
+  // NS_LOG_INFO ("PrintSumRetransmissions");
+
+  int total = 0;
+  for (int i = 0; i < int(reTxVector.size ()); i++)
+    {
+      // NS_LOG_INFO ("i: " << i);
+      total += reTxVector[i] * (i + 1);
+    }
+  std::cout << total;
+}
+
+void
+LoraPacketTracker::CountRetransmissions (Time transient, Time simulationTime,
+                                         const MacPacketData &macPacketTracker,
+                                         const RetransmissionData &reTransmissionTracker,
+                                         const PhyPacketData &packetTracker)
+{
+  // Count retransmissions and delays
+  ///////////////////////////////////
+  MacOutcomeBin macCounts =
+    m_streaming ? CountMacOutcomes (transient, simulationTime - transient)
+    : DoCountMacOutcomes (transient, simulationTime - transient,
+                          macPacketTracker, reTransmissionTracker);
+
+  std::vector<int> totalReTxAmounts (8, 0);
+  for (std::size_t i = 0; i < totalReTxAmounts.size (); i++)
+    {
+      totalReTxAmounts[i] = macCounts.successfulReTx[i] + macCounts.failedReTx[i];
+    }
+
+  // Sum PHY outcomes
+  //////////////////////////////////
+  std::vector<int> performancesAmounts =
+    CountPhyOutcomes (transient, simulationTime - transient);
+
   double avgDelay = 0;
   double avgAckDelay = 0;
-  if (packetsOutsideTransient != 0)
+  if (macCounts.receivedPackets != 0)
     {
-      avgDelay = (delaySum / packetsOutsideTransient).GetSeconds ();
-      avgAckDelay = ((ackDelaySum) / packetsOutsideTransient).GetSeconds ();
+      avgDelay = (macCounts.delaySum / macCounts.receivedPackets).GetSeconds ();
+      avgAckDelay = (macCounts.ackDelaySum / macCounts.receivedPackets).GetSeconds ();
     }
 
   // Print legend
   std::cout <<
     "Successful with 1 | Successful with 2 | Successful with 3 | Successful with 4 | Successful with 5 | Successful with 6 | Successful with 7 | Successful with 8 | Failed after 1 | Failed after 2 | Failed after 3 | Failed after 4 | Failed after 5 | Failed after 6 | Failed after 7 | Failed after 8 | Average Delay | Average ACK Delay | Total Retransmission amounts || PHY Total | PHY Successful | PHY Interfered | PHY No More Receivers | PHY Under Sensitivity | PHY Lost Because TX" <<
     std::endl;
-  PrintVector (successfulReTxAmounts);
+  PrintVector (macCounts.successfulReTx);
   std::cout << " | ";
-  PrintVector (failedReTxAmounts);
+  PrintVector (macCounts.failedReTx);
   std::cout << " | ";
   std::cout << avgDelay << " ";
   std::cout << avgAckDelay << " ";
@@ -342,54 +696,11 @@ LoraPacketTracker::CountRetransmissions (Time transient, Time simulationTime, Ma
 
 void
 LoraPacketTracker::DoCountPhyPackets (Time startTime, Time stopTime,
-                                      PhyPacketData packetTracker)
+                                      const PhyPacketData &packetTracker)
 {
   // Sum PHY outcomes
   //////////////////////////////////
-  // vector performanceAmounts will contain - for the interval given in the
-  // input of the function, the following fields:
-  // totPacketsSent receivedPackets interferedPackets noMoreGwPackets underSensitivityPackets
-  std::vector<int> performancesAmounts (6, 0);
-  for (auto itPhy = m_phyPacketOutcomes.begin (); itPhy != m_phyPacketOutcomes.end (); ++itPhy)
-    {
-      if ((*itPhy).first >= startTime && (*itPhy).first <= stopTime)
-        {
-          performancesAmounts.at (0)++;
-
-          switch ((*itPhy).second)
-            {
-            case RECEIVED:
-              {
-                performancesAmounts.at (1)++;
-                break;
-              }
-            case INTERFERED:
-              {
-                performancesAmounts.at (2)++;
-                break;
-              }
-            case NO_MORE_RECEIVERS:
-              {
-                performancesAmounts.at (3)++;
-                break;
-              }
-            case UNDER_SENSITIVITY:
-              {
-                performancesAmounts.at (4)++;
-                break;
-              }
-            case LOST_BECAUSE_TX:
-              {
-                performancesAmounts.at (5)++;
-                break;
-              }
-            case UNSET:
-              {
-                break;
-              }
-            }     //end switch
-        }
-    }
+  std::vector<int> performancesAmounts = CountPhyOutcomes (startTime, stopTime);
 
   PrintVector (performancesAmounts);
   std::cout << std::endl;
@@ -21,10 +21,13 @@
 #define LORA_PACKET_TRACKER_H
 
 #include "ns3/packet.h"
+#include "ns3/lora-phy.h"
 #include "ns3/nstime.h"
 
+#include <deque>
 #include <map>
 #include <string>
+#include <unordered_map>
 
 namespace ns3 {
 enum PacketOutcome
@@ -39,9 +42,11 @@ enum PacketOutcome
 
 struct PacketStatus
 {
-  Ptr<Packet const> packet;
+  uint64_t packetUid;
   uint32_t senderId;
+  Time sendTime;
   int outcomeNumber;
+  int receptions;
   std::vector<enum PacketOutcome> outcomes;
 };
 
@@ -62,9 +67,40 @@ struct MacPacketStatus
 
 typedef std::pair<Time, PacketOutcome> PhyOutcome;
 
-typedef std::map<Ptr<Packet const>, MacPacketStatus> MacPacketData;
-typedef std::map<Ptr<Packet const>, PacketStatus> PhyPacketData;
-typedef std::map<Ptr<Packet const>, RetransmissionStatus> RetransmissionData;
+// Counters of PHY outcomes in a time bin of the streaming mode
+struct PhyOutcomeBin
+{
+  // Packets that were sent during this bin
+  uint32_t sentPackets;
+  // Packets sent during this bin that were received by at least one gateway
+  uint32_t receivedPackets;
+  // Outcomes reported during this bin, indexed by (gateway, SF), with one
+  // counter for each PacketOutcome
+  std::map<std::pair<uint32_t, uint8_t>, std::vector<uint32_t> > outcomes;
+};
+
+// Counters of the MAC outcomes of confirmed packets, for the packets sent in
+// a time bin of the streaming mode or in an interval
+struct MacOutcomeBin
+{
+  // Packets that were successful, or failed, after each number of
+  // transmissions
+  std::vector<int> successfulReTx;
+  std::vector<int> failedReTx;
+  // Packets that were received by the MAC layer of a gateway
+  int receivedPackets;
+  // Sum of the delays of received packets, between the first transmission and
+  // the reception at a gateway, and between the first transmission and the
+  // end of the retransmission procedure
+  Time delaySum;
+  Time ackDelaySum;
+};
+
+// Packets are identified by their UID, which is preserved by the copies that
+// are made along the way (e.g., by the MAC layer for retransmissions)
+typedef std::unordered_map<uint64_t, MacPacketStatus> MacPacketData;
+typedef std::unordered_map<uint64_t, PacketStatus> PhyPacketData;
+typedef std::unordered_map<uint64_t, RetransmissionStatus> RetransmissionData;
 
 
 class LoraPacketTracker
@@ -78,12 +114,18 @@ public:
   ///////////////
   // Packet transmission callback
   void TransmissionCallback (Ptr<Packet const> packet, uint32_t systemId);
-  // Packet outcome traces
-  void PacketReceptionCallback (Ptr<Packet const> packet, uint32_t systemId);
-  void InterferenceCallback (Ptr<Packet const> packet, uint32_t systemId);
-  void NoMoreReceiversCallback (Ptr<Packet const> packet, uint32_t systemId);
-  void UnderSensitivityCallback (Ptr<Packet const> packet, uint32_t systemId);
-  void LostBecauseTxCallback (Ptr<Packet const> packet, uint32_t systemId);
+  // Packet outcome traces, with the gateway PHY bound as first argument to
+  // read the parameters of the reception
+  void PacketReceptionCallback (const lorawan::LoraPhy *phy, Ptr<Packet const> packet,
+                                uint32_t systemId);
+  void InterferenceCallback (const lorawan::LoraPhy *phy, Ptr<Packet const> packet,
+                             uint32_t systemId);
+  void NoMoreReceiversCallback (const lorawan::LoraPhy *phy, Ptr<Packet const> packet,
+                                uint32_t systemId);
+  void UnderSensitivityCallback (const lorawan::LoraPhy *phy, Ptr<Packet const> packet,
+                                 uint32_t systemId);
+  void LostBecauseTxCallback (const lorawan::LoraPhy *phy, Ptr<Packet const> packet,
+                              uint32_t systemId);
 
   ///////////////
   // MAC layer //
@@ -98,12 +140,12 @@ public:
   ////////////////////////////////
   // Packet counting facilities //
   ////////////////////////////////
-  void CheckReceptionByAllGWsComplete (std::map<Ptr<Packet const>,
-                                                PacketStatus>::iterator it);
+  void CheckReceptionByAllGWsComplete (PhyPacketData::iterator it);
 
-  void CountRetransmissions (Time transient, Time simulationTime, MacPacketData
-                             macPacketTracker, RetransmissionData reTransmissionTracker,
-                             PhyPacketData packetTracker);
+  void CountRetransmissions (Time transient, Time simulationTime,
+                             const MacPacketData &macPacketTracker,
+                             const RetransmissionData &reTransmissionTracker,
+                             const PhyPacketData &packetTracker);
 
   void CountPhyPackets (Time startTime, Time stopTime);
 
@@ -116,13 +158,99 @@ public:
   ///////////////
   void PrintPerformance (Time start, Time stop);
 
+  // Count the PHY outcomes reported in [startTime, stopTime), in the order
+  // expected by PrintVector: total, received, interfered, no more receivers,
+  // under sensitivity, lost because TX
+  std::vector<int> CountPhyOutcomes (Time startTime, Time stopTime) const;
+
+  // Count the MAC outcomes of the confirmed packets first sent in
+  // [startTime, stopTime)
+  MacOutcomeBin CountMacOutcomes (Time startTime, Time stopTime) const;
+
+  // Get the number of packets the tracker currently keeps in memory
+  std::size_t GetNTrackedPackets (void) const;
+
+  // Get the PHY status of a packet, or 0 if the packet is not tracked
+  const PacketStatus * GetPacketStatus (Ptr<Packet const> packet) const;
+
+  // Write the MAC and PHY outcomes in [startTime, stopTime) to a file meant
+  // to be read by other programs, with one "name value" pair per line
+  void WriteResults (Time startTime, Time stopTime, std::string filename) const;
+
+  ////////////////////
+  // Streaming mode //
+  ////////////////////
+  // Only keep counters of PHY and MAC outcomes in time bins of the given
+  // width. Packets are forgotten as soon as all gateways reported their PHY
+  // outcome, or their retransmission procedure ended, or after maxPacketAge
+  // has elapsed since their transmission. Statistics are then computed with
+  // the resolution of a bin, and are only exact for intervals starting and
+  // ending at multiples of binWidth. maxPacketAge should be longer than the
+  // retransmission procedure of confirmed packets, which are otherwise not
+  // counted.
+  void EnableStreaming (Time binWidth, Time maxPacketAge = Minutes (1));
+
+  // Make the tracker aware of a gateway, so that it knows how many outcomes
+  // to expect for each packet in streaming mode
+  void AddGateway (void);
+
+  // Write the counters of each bin to the output file, with one line per bin,
+  // gateway and SF
+  void PrintPhyBins (void);
+
 private:
-  void DoCountPhyPackets (Time startTime, Time stopTime, PhyPacketData packetTracker);
+  // Get the bin of the streaming mode containing a certain time
+  PhyOutcomeBin & GetBin (Time time);
+
+  // Get the MAC bin of the streaming mode containing a certain time
+  MacOutcomeBin & GetMacBin (Time time);
+
+  // Create a MacOutcomeBin with all counters set to zero
+  static MacOutcomeBin CreateMacBin (void);
+
+  // Account for the end of the retransmission procedure of a packet
+  static void AddMacOutcome (MacOutcomeBin &bin, const MacPacketStatus &macStatus,
+                             const RetransmissionStatus &reTxStatus);
+
+  // Count the MAC outcomes of the packets of some trackers that were first
+  // sent in [startTime, stopTime)
+  static MacOutcomeBin DoCountMacOutcomes (Time startTime, Time stopTime,
+                                           const MacPacketData &macPacketTracker,
+                                           const RetransmissionData &reTransmissionTracker);
+
+  // Account for the outcome of a packet in the bin it was sent in, and forget
+  // the packet
+  void RetirePacket (PhyPacketData::iterator it);
+
+  // Retire all packets that were sent before a certain time
+  void RetireOldPackets (Time limit);
+
+  // Forget the MAC packets that were sent before a certain time, and whose
+  // retransmission procedure did not end
+  void RetireOldMacPackets (Time limit);
+
+  void DoCountPhyPackets (Time startTime, Time stopTime,
+                          const PhyPacketData &packetTracker);
+
+  // Record the outcome of a packet at the PHY layer of a gateway
+  void SetPhyOutcome (Ptr<Packet const> packet, uint32_t systemId,
+                      uint8_t sf, PacketOutcome outcome);
 
   std::list<PhyOutcome> m_phyPacketOutcomes;
 
   std::string m_outputFilename;
 
+  bool m_streaming;
+  Time m_binWidth;
+  Time m_maxPacketAge;
+  uint32_t m_nGateways;
+  std::vector<PhyOutcomeBin> m_bins;
+  // Packets that are still tracked in streaming mode, by send time
+  std::deque<std::pair<Time, uint64_t> > m_pendingPackets;
+  std::vector<MacOutcomeBin> m_macBins;
+  // MAC packets that are still tracked in streaming mode, by send time
+  std::deque<std::pair<Time, uint64_t> > m_pendingMacPackets;
+
   PhyPacketData m_packetTracker;
   MacPacketData m_macPacketTracker;
   RetransmissionData m_reTransmissionTracker;
@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/lora-partition-helper.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/point-to-point-helper.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#endif
+#include "ns3/nstime.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace ns3 {
+namespace lorawan {
+
+NS_LOG_COMPONENT_DEFINE ("LoraPartitionHelper");
+
+LoraPartitionHelper::LoraPartitionHelper () :
+  m_xMin (0),
+  m_xMax (0),
+  m_nPartitions (1)
+{
+}
+
+LoraPartitionHelper::~LoraPartitionHelper ()
+{
+}
+
+void
+LoraPartitionHelper::SetStrips (double xMin, double xMax, uint32_t nPartitions)
+{
+  NS_LOG_FUNCTION (this << xMin << xMax << nPartitions);
+
+  NS_ASSERT (xMin < xMax);
+
+  m_xMin = xMin;
+  m_xMax = xMax;
+#ifdef NS3_MPI
+  m_nPartitions = (nPartitions == 0) ? MpiInterface::GetSize () : nPartitions;
+#else
+  m_nPartitions = (nPartitions == 0) ? 1 : nPartitions;
+#endif
+}
+
+uint32_t
+LoraPartitionHelper::GetNPartitions (void) const
+{
+  return m_nPartitions;
+}
+
+uint32_t
+LoraPartitionHelper::GetSystemId (Vector position) const
+{
+  if (m_nPartitions == 1 || position.x < m_xMin)
+    {
+      return 0;
+    }
+
+  double strip = (position.x - m_xMin) / (m_xMax - m_xMin) * m_nPartitions;
+  return std::min (static_cast<uint32_t> (strip), m_nPartitions - 1);
+}
+
+NodeContainer
+LoraPartitionHelper::Create (Ptr<PositionAllocator> positions, uint32_t n) const
+{
+  NS_LOG_FUNCTION (this << positions << n);
+
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Vector position = positions->GetNext ();
+      Ptr<Node> node = CreateObject<Node> (GetSystemId (position));
+      Ptr<ConstantPositionMobilityModel> mobility =
+        CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (position);
+      node->AggregateObject (mobility);
+      nodes.Add (node);
+    }
+  return nodes;
+}
+
+NodeContainer
+LoraPartitionHelper::GetLocal (NodeContainer nodes) const
+{
+#ifdef NS3_MPI
+  uint32_t systemId = MpiInterface::GetSystemId ();
+#else
+  uint32_t systemId = 0;
+#endif
+
+  NodeContainer local;
+  for (NodeContainer::Iterator it = nodes.Begin (); it != nodes.End (); ++it)
+    {
+      if ((*it)->GetSystemId () == systemId)
+        {
+          local.Add (*it);
+        }
+    }
+  return local;
+}
+
+Time
+LoraPartitionHelper::GetLookAhead (NodeContainer nodes, double speed) const
+{
+  NS_LOG_FUNCTION (this << speed);
+
+  // The range of x coordinates used by each partition
+  std::vector<double> xFirst (m_nPartitions, std::numeric_limits<double>::max ());
+  std::vector<double> xLast (m_nPartitions, -std::numeric_limits<double>::max ());
+  for (NodeContainer::Iterator it = nodes.Begin (); it != nodes.End (); ++it)
+    {
+      Ptr<MobilityModel> mobility = (*it)->GetObject<MobilityModel> ();
+      NS_ABORT_MSG_IF (mobility == 0,
+                       "Node " << (*it)->GetId () << " has no mobility model");
+      double x = mobility->GetPosition ().x;
+      uint32_t systemId = (*it)->GetSystemId ();
+      NS_ASSERT (systemId < m_nPartitions);
+      xFirst[systemId] = std::min (xFirst[systemId], x);
+      xLast[systemId] = std::max (xLast[systemId], x);
+    }
+
+  // Partitions are ordered by x, so that the narrowest gap between nodes of
+  // different partitions is between two consecutive non-empty partitions
+  double gap = std::numeric_limits<double>::max ();
+  double previousLast = -std::numeric_limits<double>::max ();
+  for (uint32_t p = 0; p < m_nPartitions; p++)
+    {
+      if (xFirst[p] > xLast[p])
+        {
+          continue;
+        }
+      if (previousLast > -std::numeric_limits<double>::max ())
+        {
+          gap = std::min (gap, xFirst[p] - previousLast);
+        }
+      previousLast = xLast[p];
+    }
+
+  if (gap == std::numeric_limits<double>::max ())
+    {
+      // All nodes are in the same partition
+      return Time::Max ();
+    }
+
+  NS_LOG_DEBUG ("Narrowest gap between partitions: " << gap << " m");
+
+  return Seconds (std::max (gap, 0.0) / speed);
+}
+
+NodeContainer
+LoraPartitionHelper::Install (Ptr<LoraChannel> channel, Time lookAhead) const
+{
+  NS_LOG_FUNCTION (this << channel << lookAhead);
+
+#ifndef NS3_MPI
+  return NodeContainer ();
+#else
+  if (!MpiInterface::IsEnabled () || MpiInterface::GetSize () == 1)
+    {
+      return NodeContainer ();
+    }
+
+  NS_ABORT_MSG_IF (m_nPartitions != MpiInterface::GetSize (),
+                   "The simulation has " << m_nPartitions << " partitions, but "
+                   << MpiInterface::GetSize () << " processes");
+  NS_ABORT_MSG_IF (!lookAhead.IsStrictlyPositive (),
+                   "The look ahead between partitions must be positive");
+
+  uint32_t systemId = MpiInterface::GetSystemId ();
+
+  // Each proxy has a device whose MpiReceiver passes the transmissions it
+  // receives to the channel
+  NodeContainer proxies;
+  std::vector<uint32_t> devices;
+  for (uint32_t p = 0; p < m_nPartitions; p++)
+    {
+      Ptr<Node> proxy = CreateObject<Node> (p);
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      proxy->AddDevice (device);
+      if (p == systemId)
+        {
+          Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver> ();
+          receiver->SetReceiveCallback (MakeCallback (&LoraChannel::ReceiveRemote,
+                                                      channel));
+          device->AggregateObject (receiver);
+        }
+      proxies.Add (proxy);
+      devices.push_back (device->GetIfIndex ());
+    }
+
+  // Links between partitions give the distributed simulator its look ahead
+  PointToPointHelper p2pHelper;
+  p2pHelper.SetChannelAttribute ("Delay", TimeValue (lookAhead));
+  for (uint32_t p = 0; p < m_nPartitions; p++)
+    {
+      for (uint32_t q = p + 1; q < m_nPartitions; q++)
+        {
+          p2pHelper.Install (proxies.Get (p), proxies.Get (q));
+        }
+    }
+
+  for (uint32_t p = 0; p < m_nPartitions; p++)
+    {
+      if (p != systemId)
+        {
+          channel->AddRemotePartition (proxies.Get (p)->GetId (), devices[p],
+                                       lookAhead);
+        }
+    }
+
+  return proxies;
+#endif
+}
+
+}
+}
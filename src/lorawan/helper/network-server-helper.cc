@@ -31,7 +31,8 @@ namespace lorawan {
 
 NS_LOG_COMPONENT_DEFINE ("NetworkServerHelper");
 
-NetworkServerHelper::NetworkServerHelper ()
+NetworkServerHelper::NetworkServerHelper () :
+  m_adrEnabled (false)
 {
   m_factory.SetTypeId ("ns3::NetworkServer");
   p2pHelper.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
@@ -60,6 +61,12 @@ NetworkServerHelper::SetEndDevices (NodeContainer endDevices)
   m_endDevices = endDevices;
 }
 
+void
+NetworkServerHelper::EnableAdr (bool enableAdr)
+{
+  m_adrEnabled = enableAdr;
+}
+
 ApplicationContainer
 NetworkServerHelper::Install (Ptr<Node> node)
 {
@@ -132,6 +139,12 @@ NetworkServerHelper::InstallComponents (Ptr<NetworkServer> netServer)
   // Add LinkCheck support
   Ptr<LinkCheckComponent> linkCheckSupport = CreateObject<LinkCheckComponent> ();
   netServer->AddComponent (linkCheckSupport);
+
+  // Add Adaptive Data Rate support
+  if (m_adrEnabled)
+    {
+      netServer->AddComponent (CreateObject<AdrComponent> ());
+    }
 }
 }
 } // namespace ns3
@@ -61,6 +61,12 @@ public:
    */
   void SetEndDevices (NodeContainer endDevices);
 
+  /**
+   * Set whether the NS runs an AdrComponent, controlling the data rate and
+   * transmission power of the end devices that enable ADR.
+   */
+  void EnableAdr (bool enableAdr);
+
 private:
   void InstallComponents (Ptr<NetworkServer> netServer);
   Ptr<Application> InstallPriv (Ptr<Node> node);
@@ -72,6 +78,8 @@ private:
   NodeContainer m_endDevices;   //!< Set of endDevices to connect to this NS
 
   PointToPointHelper p2pHelper; //!< Helper to create PointToPoint links
+
+  bool m_adrEnabled; //!< Whether to install an AdrComponent
 };
 
 } // namespace ns3
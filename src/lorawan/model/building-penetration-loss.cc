@@ -19,6 +19,7 @@
 #include "ns3/building-penetration-loss.h"
 #include "ns3/mobility-building-info.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include <cmath>
 
@@ -36,11 +37,19 @@ BuildingPenetrationLoss::GetTypeId (void)
     .SetParent<PropagationLossModel> ()
     .SetGroupName ("Lora")
     .AddConstructor<BuildingPenetrationLoss> ()
+    .AddAttribute ("FrozenPerLink",
+                   "Whether to draw the random components of the loss only "
+                   "once for each (transmitter, receiver) pair, and to return "
+                   "the same loss for that link from then on",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&BuildingPenetrationLoss::m_frozenPerLink),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
-BuildingPenetrationLoss::BuildingPenetrationLoss ()
+BuildingPenetrationLoss::BuildingPenetrationLoss () :
+  m_frozenPerLink (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
@@ -53,6 +62,12 @@ BuildingPenetrationLoss::~BuildingPenetrationLoss ()
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+bool
+BuildingPenetrationLoss::IsFrozenPerLink (void) const
+{
+  return m_frozenPerLink;
+}
+
 double
 BuildingPenetrationLoss::DoCalcRxPower (double txPowerDbm,
                                         Ptr<MobilityModel> a,
@@ -60,6 +75,29 @@ BuildingPenetrationLoss::DoCalcRxPower (double txPowerDbm,
 {
   NS_LOG_FUNCTION (this << txPowerDbm << a << b);
 
+  if (!m_frozenPerLink)
+    {
+      return txPowerDbm - ComputeLoss (a, b);
+    }
+
+  // Only compute the loss the first time we see this link
+  std::pair<Ptr<MobilityModel>, Ptr<MobilityModel> > link (a, b);
+  auto it = m_linkLossMap.find (link);
+  if (it == m_linkLossMap.end ())
+    {
+      it = m_linkLossMap.insert (std::make_pair (link, ComputeLoss (a, b))).first;
+      NS_LOG_DEBUG ("Froze the loss of a new link: " << it->second);
+    }
+
+  return txPowerDbm - it->second;
+}
+
+double
+BuildingPenetrationLoss::ComputeLoss (Ptr<MobilityModel> a,
+                                      Ptr<MobilityModel> b) const
+{
+  NS_LOG_FUNCTION (this << a << b);
+
   Ptr<MobilityBuildingInfo> a1 = a->GetObject<MobilityBuildingInfo> ();
   Ptr<MobilityBuildingInfo> b1 = b->GetObject<MobilityBuildingInfo> ();
 
@@ -127,7 +165,7 @@ BuildingPenetrationLoss::DoCalcRxPower (double txPowerDbm,
 
   NS_LOG_DEBUG ("Total loss due to building penetration: " << loss);
 
-  return txPowerDbm - loss;
+  return loss;
 }
 
 int64_t
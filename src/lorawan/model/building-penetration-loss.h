@@ -41,6 +41,15 @@ public:
 
   ~BuildingPenetrationLoss ();
 
+  /**
+   * Whether the random components of the loss are drawn only once for each
+   * link.
+   *
+   * \return True if the loss of each link is computed only once, false if
+   * the random components are drawn again at each call.
+   */
+  bool IsFrozenPerLink (void) const;
+
 private:
   /**
    * Perform the computation of the received power according to the current
@@ -52,6 +61,16 @@ private:
 
   virtual int64_t DoAssignStreams (int64_t stream);
 
+  /**
+   * Compute the loss between two nodes, drawing the random components of the
+   * model.
+   *
+   * \param a The mobility model of the transmitter.
+   * \param b The mobility model of the receiver.
+   * \returns The loss in dB.
+   */
+  double ComputeLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
   /**
    * Generate a random p value.
    * The distribution of the returned value is as specified in TR 45.820.
@@ -94,6 +113,18 @@ private:
    * loss.
    */
   mutable std::map<Ptr<MobilityModel>, int> m_wallLossMap;
+
+  /**
+   * Whether the loss of each link is only computed once.
+   */
+  bool m_frozenPerLink;
+
+  /**
+   * A map linking each (transmitter, receiver) pair to its loss, used when
+   * m_frozenPerLink is true.
+   */
+  mutable std::map<std::pair<Ptr<MobilityModel>, Ptr<MobilityModel> >, double>
+  m_linkLossMap;
 };
 }
 }
@@ -17,9 +17,16 @@
  */
 
 #include "ns3/correlated-shadowing-propagation-loss-model.h"
+#include "ns3/core-config.h"
 #include "ns3/double.h"
 #include "ns3/log.h"
 #include <cmath>
+#include <unistd.h>
+#include <unordered_set>
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 
 namespace ns3 {
 namespace lorawan {
@@ -28,6 +35,44 @@ NS_LOG_COMPONENT_DEFINE ("CorrelatedShadowingPropagationLossModel");
 
 NS_OBJECT_ENSURE_REGISTERED (CorrelatedShadowingPropagationLossModel);
 
+// Compute the coordinate of the grid square containing x (i.e., round the
+// raw position)
+static int32_t
+GetSquareCoordinate (double x, double correlationDistance)
+{
+  // (x > 0) - (x < 0) is the sign function
+  return ((x > 0) - (x < 0))
+         * ((std::fabs (x) + correlationDistance / 2) / correlationDistance);
+}
+
+// Pack a pair of integer coordinates in a key for hash maps
+static uint64_t
+GetKey (int32_t i, int32_t j)
+{
+  return (uint64_t (uint32_t (i)) << 32) | uint32_t (j);
+}
+
+// A set of ShadowingMap instances to fill with the shadowing at some positions
+struct ShadowingMapGeneration
+{
+  std::vector<Ptr<CorrelatedShadowingPropagationLossModel::ShadowingMap> > maps;
+  const std::vector<CorrelatedShadowingPropagationLossModel::Position> *positions;
+};
+
+static void
+GenerateShadowingMaps (ShadowingMapGeneration *generation)
+{
+  for (auto map = generation->maps.begin (); map != generation->maps.end ();
+       ++map)
+    {
+      for (auto position = generation->positions->begin ();
+           position != generation->positions->end (); ++position)
+        {
+          (*map)->GetLoss (*position);
+        }
+    }
+}
+
 TypeId
 CorrelatedShadowingPropagationLossModel::GetTypeId (void)
 {
@@ -49,58 +94,46 @@ CorrelatedShadowingPropagationLossModel::CorrelatedShadowingPropagationLossModel
 {
 }
 
-double
-CorrelatedShadowingPropagationLossModel::DoCalcRxPower (double txPowerDbm,
-                                                        Ptr<MobilityModel> a,
-                                                        Ptr<MobilityModel> b) const
+Ptr<CorrelatedShadowingPropagationLossModel::ShadowingMap>
+CorrelatedShadowingPropagationLossModel::GetShadowingMap (Vector position) const
 {
-  NS_LOG_FUNCTION (this << txPowerDbm << a << b);
-
-  /*
-   * Check whether the a MobilityModel is in a grid square that already has
-   * its shadowing map.
-   */
-  Vector position = a->GetPosition ();
-
-  double x = position.x;
-  double y = position.y;
-
-  // Compute the coordinates of the grid square (i.e., round the raw position)
-  // (x > 0) - (x < 0) is the sign function
-  int xcoord =
-    ((x > 0) - (x < 0)) * ((std::fabs (x) + m_correlationDistance / 2) / m_correlationDistance);
-  int ycoord =
-    ((y > 0) - (y < 0)) * ((std::fabs (y) + m_correlationDistance / 2) / m_correlationDistance);
-
-  // Wrap coordinates up in a pair
-  std::pair<int, int> coordinates (xcoord, ycoord);
+  int32_t xcoord = GetSquareCoordinate (position.x, m_correlationDistance);
+  int32_t ycoord = GetSquareCoordinate (position.y, m_correlationDistance);
 
-  NS_LOG_DEBUG ("x " << x << ", y " << y);
+  NS_LOG_DEBUG ("x " << position.x << ", y " << position.y);
   NS_LOG_DEBUG ("xcoord " << xcoord << ", ycoord " << ycoord);
 
   // Look for the computed coordinates in the shadowingGrid
-  std::map<std::pair<int,int>, Ptr<ShadowingMap> >::const_iterator it;
-
-  it = m_shadowingGrid.find (coordinates);
+  Ptr<ShadowingMap> &shadowingMap = m_shadowingGrid[GetKey (xcoord, ycoord)];
 
-  if (it == m_shadowingGrid.end ())     // Did not find the coordinates
+  if (shadowingMap == 0)     // Did not find the coordinates
     {
       // If this shadowing grid was not found, create it
       NS_LOG_DEBUG ("Creating a new shadowing map to be used at coordinates "
-                    << coordinates.first << " " << coordinates.second);
+                    << xcoord << " " << ycoord);
 
-      Ptr<ShadowingMap> shadowingMap =
-        Create<CorrelatedShadowingPropagationLossModel::ShadowingMap> ();
-
-      m_shadowingGrid[coordinates] = shadowingMap;
+      shadowingMap = Create<CorrelatedShadowingPropagationLossModel::ShadowingMap>
+          (m_correlationDistance);
     }
   else
     {
       NS_LOG_DEBUG ("This square already has its shadowingMap!");
     }
 
-  // Place the iterator on the coordinates
-  it = m_shadowingGrid.find (coordinates);
+  return shadowingMap;
+}
+
+double
+CorrelatedShadowingPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                                        Ptr<MobilityModel> a,
+                                                        Ptr<MobilityModel> b) const
+{
+  NS_LOG_FUNCTION (this << txPowerDbm << a << b);
+
+  /*
+   * Get the shadowing map of the grid square the a MobilityModel is in.
+   */
+  Ptr<ShadowingMap> shadowingMap = GetShadowingMap (a->GetPosition ());
 
   // Get b's position in a's ShadowingMap
   CorrelatedShadowingPropagationLossModel::Position bPosition
@@ -108,13 +141,88 @@ CorrelatedShadowingPropagationLossModel::DoCalcRxPower (double txPowerDbm,
 
   // Use the map of the a MobilityModel to determine the value of shadowing
   // that corresponds to the position of the MobilityModel b.
-  double loss = it->second->GetLoss (bPosition);
+  double loss = shadowingMap->GetLoss (bPosition);
 
   NS_LOG_INFO ("Shadowing loss: " << loss);
 
   return txPowerDbm - loss;
 }
 
+void
+CorrelatedShadowingPropagationLossModel::Generate (NodeContainer senders,
+                                                   NodeContainer receivers,
+                                                   uint32_t nThreads)
+{
+  NS_LOG_FUNCTION (this << senders.GetN () << receivers.GetN () << nThreads);
+
+  std::vector<Position> positions;
+  for (auto it = receivers.Begin (); it != receivers.End (); ++it)
+    {
+      Ptr<MobilityModel> mobility = (*it)->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      positions.push_back (Position (mobility->GetPosition ().x,
+                                     mobility->GetPosition ().y));
+    }
+
+  // Create the maps in the main thread and in the order of the senders, so
+  // that their random variables are assigned the same streams regardless of
+  // the number of threads
+  std::vector<Ptr<ShadowingMap> > maps;
+  std::unordered_set<ShadowingMap *> seenMaps;
+  for (auto it = senders.Begin (); it != senders.End (); ++it)
+    {
+      Ptr<MobilityModel> mobility = (*it)->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      Ptr<ShadowingMap> map = GetShadowingMap (mobility->GetPosition ());
+      if (seenMaps.insert (PeekPointer (map)).second)
+        {
+          maps.push_back (map);
+        }
+    }
+
+  if (nThreads == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      nThreads = cores > 0 ? cores : 1;
+    }
+  if (nThreads > maps.size ())
+    {
+      nThreads = maps.size ();
+    }
+
+  // Each map is only accessed by a single thread
+  std::vector<ShadowingMapGeneration> generations (std::max (nThreads, 1u));
+  for (std::size_t i = 0; i < maps.size (); i++)
+    {
+      generations[i % generations.size ()].maps.push_back (maps[i]);
+    }
+  for (auto it = generations.begin (); it != generations.end (); ++it)
+    {
+      it->positions = &positions;
+    }
+
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > threads;
+  for (std::size_t i = 1; i < generations.size (); i++)
+    {
+      threads.push_back (Create<SystemThread>
+                           (MakeBoundCallback (&GenerateShadowingMaps,
+                                               &generations[i])));
+      threads.back ()->Start ();
+    }
+  GenerateShadowingMaps (&generations[0]);
+  for (auto it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+#else
+  for (auto it = generations.begin (); it != generations.end (); ++it)
+    {
+      GenerateShadowingMaps (&(*it));
+    }
+#endif
+}
+
 int64_t
 CorrelatedShadowingPropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -134,8 +242,9 @@ const double CorrelatedShadowingPropagationLossModel::ShadowingMap::m_kInv[4][4]
   {-0.366414485833771, -0.0415206295795327, -0.366414485833771, 1.27968707244633}
 };
 
-CorrelatedShadowingPropagationLossModel::ShadowingMap::ShadowingMap () :
-  m_correlationDistance (110)
+CorrelatedShadowingPropagationLossModel::ShadowingMap::ShadowingMap
+  (double correlationDistance) :
+  m_correlationDistance (correlationDistance)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
@@ -151,110 +260,107 @@ CorrelatedShadowingPropagationLossModel::ShadowingMap::~ShadowingMap ()
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+double
+CorrelatedShadowingPropagationLossModel::ShadowingMap::GetGridValue (int32_t i,
+                                                                    int32_t j)
+{
+  auto it = m_gridValues.find (GetKey (i, j));
+  if (it != m_gridValues.end ())
+    {
+      return it->second;
+    }
+
+  double value = m_shadowingValue->GetValue ();
+  m_gridValues[GetKey (i, j)] = value;
+  return value;
+}
+
 double
 CorrelatedShadowingPropagationLossModel::ShadowingMap::GetLoss
   (CorrelatedShadowingPropagationLossModel::Position position)
 {
   NS_LOG_FUNCTION (this << position.x << position.y);
 
-  // Verify whether this position is already in the shadowingMap. Since the
-  // Position implementation overloads the == operator, this comparison
-  // between doubles is ok and we can use std::map's find function.
-  std::map<CorrelatedShadowingPropagationLossModel::Position,
-           double>::const_iterator it;
-  it = m_shadowingMap.find (position);
+  // Positions closer than 10 cm are considered to be the same, so we look for
+  // the cell of a 10 cm grid containing this position.
+  uint64_t key = GetKey (std::lround (position.x * 10),
+                         std::lround (position.y * 10));
+  auto it = m_shadowingMap.find (key);
 
-  // If it's not found (i.e, if find returns the end of the map), we need to
-  // generate the value at the specified position.
-  if (it == m_shadowingMap.end ())
+  if (it != m_shadowingMap.end ())
     {
-      // Get the coordinates of the position
-      double x = position.x;
-      double y = position.y;
-      int xcoord =
-        ((x > 0) - (x < 0)) * ((std::fabs (x) + m_correlationDistance / 2) / m_correlationDistance);
-      int ycoord =
-        ((y > 0) - (y < 0)) * ((std::fabs (y) + m_correlationDistance / 2) / m_correlationDistance);
-
-      // Verify whether there already are the 4 surrounding positions in the
-      // map
-      double xmin = xcoord * m_correlationDistance - m_correlationDistance / 2;
-      double xmax = xcoord * m_correlationDistance + m_correlationDistance / 2;
-      double ymin = ycoord * m_correlationDistance - m_correlationDistance / 2;
-      double ymax = ycoord * m_correlationDistance + m_correlationDistance / 2;
-
-      CorrelatedShadowingPropagationLossModel::Position lowerLeft (xmin, ymin);
-      CorrelatedShadowingPropagationLossModel::Position upperLeft (xmin, ymax);
-      CorrelatedShadowingPropagationLossModel::Position lowerRight (xmax, ymin);
-      CorrelatedShadowingPropagationLossModel::Position upperRight (xmax, ymax);
-
-      NS_LOG_DEBUG ("Generating a new shadowing value in the following quadrant:");
-      NS_LOG_DEBUG ("xmin " << xmin << ", xmax " << xmax <<
-                    ", ymin " << ymin << ", ymax " << ymax);
-
-      // Use the map's insert method to insert the coordinates of the 4
-      // surrounding positions (if they are already there, they won't be
-      // substituted thanks to the map's implementation).
-      // TODO: Avoid useless generation of ShadowingMap values. This can be
-      // done by performing some checks (and not leveraging the map
-      // implementation)
-      double q11 = m_shadowingValue->GetValue ();
-      NS_LOG_DEBUG ("Lower left corner: " << q11);
-      m_shadowingMap[lowerLeft] = q11;
-      double q12 = m_shadowingValue->GetValue ();
-      NS_LOG_DEBUG ("Upper left corner: " << q12);
-      m_shadowingMap[upperLeft] = q12;
-      double q21 = m_shadowingValue->GetValue ();
-      NS_LOG_DEBUG ("Lower right corner: " << q21);
-      m_shadowingMap[lowerRight] = q21;
-      double q22 = m_shadowingValue->GetValue ();
-      NS_LOG_DEBUG ("Upper right corner: " << q22);
-      m_shadowingMap[upperRight] = q22;
-
-      NS_LOG_DEBUG (q11 << " " << q12 << " " << q21 << " " << q22 << " ");
-
-      // The c matrix contains the positions of the 4 vertices
-      double c[2][4] = {{xmin, xmax, xmax, xmin}, {ymin, ymin, ymax, ymax}};
-
-      // For the following procedure, reference:
-      // S. Schlegel et al., "On the Interpolation of Data with Normally
-      // Distributed Uncertainty for Visualization", IEEE Transactions on
-      // Visualization and Computer Graphics, vol. 18, no. 12, Dec. 2012.
-
-      // Compute the phi coefficients
-      double phi1 = 0;
-      double phi2 = 0;
-      double phi3 = 0;
-      double phi4 = 0;
-
-      for (int j = 0; j < 4; j++)
-        {
-          double distance = sqrt ((c[0][j] - x) * (c[0][j] - x) + (c[1][j] - y) * (c[1][j] - y));
+      NS_LOG_DEBUG ("Shadowing map for this location already exists");
+      return it->second;
+    }
 
-          NS_LOG_DEBUG ("Distance: " << distance);
+  // If it's not found, we need to generate the value at the specified
+  // position.
 
-          double k = std::exp (-distance / m_correlationDistance);
-          phi1 = phi1 + m_kInv[0][j] * k;
-          phi2 = phi2 + m_kInv[1][j] * k;
-          phi3 = phi3 + m_kInv[2][j] * k;
-          phi4 = phi4 + m_kInv[3][j] * k;
-        }
-
-      NS_LOG_DEBUG ("Phi: " << phi1 << " " << phi2 << " " << phi3 << " " <<
-                    phi4 << " ");
+  // Get the coordinates of the position
+  double x = position.x;
+  double y = position.y;
+  int32_t xcoord = GetSquareCoordinate (x, m_correlationDistance);
+  int32_t ycoord = GetSquareCoordinate (y, m_correlationDistance);
+
+  // Get the 4 surrounding positions of the grid
+  double xmin = xcoord * m_correlationDistance - m_correlationDistance / 2;
+  double xmax = xcoord * m_correlationDistance + m_correlationDistance / 2;
+  double ymin = ycoord * m_correlationDistance - m_correlationDistance / 2;
+  double ymax = ycoord * m_correlationDistance + m_correlationDistance / 2;
+
+  NS_LOG_DEBUG ("Generating a new shadowing value in the following quadrant:");
+  NS_LOG_DEBUG ("xmin " << xmin << ", xmax " << xmax <<
+                ", ymin " << ymin << ", ymax " << ymax);
+
+  // The point of the grid at (xmin, ymin) has indexes (xcoord, ycoord)
+  double q11 = GetGridValue (xcoord, ycoord);
+  NS_LOG_DEBUG ("Lower left corner: " << q11);
+  double q12 = GetGridValue (xcoord, ycoord + 1);
+  NS_LOG_DEBUG ("Upper left corner: " << q12);
+  double q21 = GetGridValue (xcoord + 1, ycoord);
+  NS_LOG_DEBUG ("Lower right corner: " << q21);
+  double q22 = GetGridValue (xcoord + 1, ycoord + 1);
+  NS_LOG_DEBUG ("Upper right corner: " << q22);
+
+  NS_LOG_DEBUG (q11 << " " << q12 << " " << q21 << " " << q22 << " ");
+
+  // The c matrix contains the positions of the 4 vertices
+  double c[2][4] = {{xmin, xmax, xmax, xmin}, {ymin, ymin, ymax, ymax}};
+
+  // For the following procedure, reference:
+  // S. Schlegel et al., "On the Interpolation of Data with Normally
+  // Distributed Uncertainty for Visualization", IEEE Transactions on
+  // Visualization and Computer Graphics, vol. 18, no. 12, Dec. 2012.
+
+  // Compute the phi coefficients
+  double phi1 = 0;
+  double phi2 = 0;
+  double phi3 = 0;
+  double phi4 = 0;
+
+  for (int j = 0; j < 4; j++)
+    {
+      double distance = sqrt ((c[0][j] - x) * (c[0][j] - x) + (c[1][j] - y) * (c[1][j] - y));
 
-      double shadowing = q11 * phi1 + q21 * phi2 + q22 * phi3 + q12 * phi4;
+      NS_LOG_DEBUG ("Distance: " << distance);
 
-      // Add the newly computed shadowing value to the shadowing map
-      m_shadowingMap[position] = shadowing;
-      NS_LOG_DEBUG ("Created new shadowing map: " << shadowing);
-    }
-  else
-    {
-      NS_LOG_DEBUG ("Shadowing map for this location already exists");
+      double k = std::exp (-distance / m_correlationDistance);
+      phi1 = phi1 + m_kInv[0][j] * k;
+      phi2 = phi2 + m_kInv[1][j] * k;
+      phi3 = phi3 + m_kInv[2][j] * k;
+      phi4 = phi4 + m_kInv[3][j] * k;
     }
 
-  return m_shadowingMap[position];
+  NS_LOG_DEBUG ("Phi: " << phi1 << " " << phi2 << " " << phi3 << " " <<
+                phi4 << " ");
+
+  double shadowing = q11 * phi1 + q21 * phi2 + q22 * phi3 + q12 * phi4;
+
+  // Add the newly computed shadowing value to the shadowing map
+  m_shadowingMap[key] = shadowing;
+  NS_LOG_DEBUG ("Created new shadowing map: " << shadowing);
+
+  return shadowing;
 }
 
 /*****************************
@@ -23,6 +23,8 @@
 #include "ns3/mobility-model.h"
 #include "ns3/vector.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/node-container.h"
+#include <unordered_map>
 
 namespace ns3 {
 class MobilityModel;
@@ -51,7 +53,7 @@ public:
     /**
      * Constructor.
      * This initializes the shadowing map with a grid of independent
-     * shadowing values, one m_correlationDistance meters apart from the next
+     * shadowing values, one correlationDistance meters apart from the next
      * one. The result is something like:
      *  o---o---o---o---o
      *  |   |   |   |   |
@@ -61,14 +63,17 @@ public:
      *  |   |   |   |   |
      *  o---o---o---o---o
      *  where at each o we have an independently generated shadowing value.
-     *  We can then interpolate the 4 values surrounding any point in space
-     *  in order to get a correlated shadowing value. After generating this
-     *  value, we will add it to the map so that we don't have to compute it
-     *  twice. Also, since interpolation is a deterministic operation, we are
-     *  guaranteed that, as long as the grid doesn't change, also two values
-     *  generated in the same square will be correlated.
+     *  Values on the grid are drawn the first time they are needed, and
+     *  then never change. We can then interpolate the 4 values surrounding
+     *  any point in space in order to get a correlated shadowing value.
+     *  After generating this value, we will add it to the map so that we
+     *  don't have to compute it twice. Also, since interpolation is a
+     *  deterministic operation, we are guaranteed that two values generated
+     *  in the same square will be correlated.
+     *
+     * \param correlationDistance The distance between points of the grid.
      */
-    ShadowingMap ();
+    ShadowingMap (double correlationDistance = 110);
 
     ~ShadowingMap ();
 
@@ -81,12 +86,25 @@ public:
 
 private:
     /**
-     * For each Position, this map gives a corresponding loss.
-     * The map contains a basic grid that is initialized at construction
-     * time, and then newly computed values are added as they are created.
+     * Get the independent shadowing value at a point of the grid, drawing it
+     * if this is the first time it is needed.
+     *
+     * \param i The index of the point along the x axis.
+     * \param j The index of the point along the y axis.
      */
-    std::map<CorrelatedShadowingPropagationLossModel::Position, double>
-    m_shadowingMap;
+    double GetGridValue (int32_t i, int32_t j);
+
+    /**
+     * The independent shadowing values at the points of the grid, by the
+     * key of their indexes.
+     */
+    std::unordered_map<uint64_t, double> m_gridValues;
+
+    /**
+     * The shadowing values that were already interpolated, by the key of
+     * the 10 cm cell containing the position they were computed for.
+     */
+    std::unordered_map<uint64_t, double> m_shadowingMap;
 
     /**
      * The distance after which two samples are to be considered almost
@@ -124,7 +142,36 @@ private:
    */
   double GetCorrelationDistance (void);
 
+  /**
+   * Compute in advance the shadowing of all links from a set of senders to a
+   * set of receivers, at their current positions.
+   *
+   * This creates the ShadowingMap of every grid square containing a sender,
+   * and fills it with the shadowing at the positions of all receivers, so
+   * that no random values need to be drawn during the simulation for these
+   * links. Different ShadowingMap instances are filled by parallel threads,
+   * when threading is available.
+   *
+   * The values obtained for a link do not depend on the number of threads,
+   * but they differ from the ones that would be obtained by letting the
+   * simulation compute them lazily, since the order in which random values
+   * are drawn is different.
+   *
+   * \param senders The nodes transmitting on the links.
+   * \param receivers The nodes receiving on the links.
+   * \param nThreads The number of threads to use, or 0 to use all
+   * available cores.
+   */
+  void Generate (NodeContainer senders, NodeContainer receivers,
+                 uint32_t nThreads = 0);
+
 private:
+  /**
+   * Get the ShadowingMap associated to the grid square containing a position,
+   * creating it if necessary.
+   */
+  Ptr<ShadowingMap> GetShadowingMap (Vector position) const;
+
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
@@ -136,8 +183,8 @@ private:
   /**
    * Map linking a square to a ShadowingMap.
    * Each square of the shadowing grid has a corresponding ShadowingMap, and a
-   * square is identified by a pair of coordinates. Coordinates are computed as
-   * such:
+   * square is identified by a pair of coordinates, packed in a single key.
+   * Coordinates are computed as such:
    *
    *  o---------o---------o---------o---------o---------o
    *  |         |         |    '    |         |         |
@@ -170,7 +217,7 @@ private:
    *  a to points b and c, the shadowing experienced by b and c will be similar
    *  if they are close (ideally, within a correlation distance).
    */
-  mutable std::map<std::pair<int, int>, Ptr<ShadowingMap> > m_shadowingGrid;
+  mutable std::unordered_map<uint64_t, Ptr<ShadowingMap> > m_shadowingGrid;
 };
 
 }
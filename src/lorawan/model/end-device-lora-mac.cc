@@ -23,6 +23,7 @@
 #include "ns3/end-device-lora-phy.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 #include <algorithm>
 
 namespace ns3 {
@@ -38,6 +39,13 @@ EndDeviceLoraMac::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::EndDeviceLoraMac")
     .SetParent<LoraMac> ()
     .SetGroupName ("lorawan")
+    .AddAttribute ("EnableAdr",
+                   "Whether to set the ADR bit of uplinks, letting the "
+                   "network server control the data rate and transmission "
+                   "power",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&EndDeviceLoraMac::m_enableAdr),
+                   MakeBooleanChecker ())
     .AddTraceSource ("RequiredTransmissions",
                      "Total number of transmissions required to deliver this packet",
                      MakeTraceSourceAccessor
@@ -78,6 +86,7 @@ EndDeviceLoraMac::GetTypeId (void)
 
 EndDeviceLoraMac::EndDeviceLoraMac ()
   : m_enableDRAdapt (false),
+  m_enableAdr (false),
   m_maxNumbTx (8),
   m_dataRate (0),
   m_txPower (14),
@@ -221,7 +230,7 @@ EndDeviceLoraMac::DoSend (Ptr<Packet> packet)
       ApplyNecessaryOptions (macHdr);
       packet->AddHeader (macHdr);
 
-      // Reset MAC command list
+      // Reset MAC command list, keeping its storage for the next packets
       m_macCommandList.clear ();
 
       if (m_retxParams.waitingAck)
@@ -313,11 +322,8 @@ EndDeviceLoraMac::SendToPhy (Ptr<Packet> packetToSend)
   // Register packet transmission for duty cycle
   //////////////////////////////////////////////
 
-  // Compute packet duration
-  Time duration = m_phy->GetOnAirTime (packetToSend, params);
-
   // Register the sent packet into the DutyCycleHelper
-  m_channelHelper.AddEvent (duration, txChannel);
+  m_channelHelper.AddEvent (packetToSend->GetSize (), params, txChannel);
 
   //////////////////////////////
   // Prepare for the downlink //
@@ -341,7 +347,8 @@ EndDeviceLoraMac::SendToPhy (Ptr<Packet> packetToSend)
 //////////////////////////
 
 void
-EndDeviceLoraMac::Receive (Ptr<Packet const> packet)
+EndDeviceLoraMac::Receive (Ptr<Packet const> packet,
+                           const LoraRxParameters &rxParams)
 {
   NS_LOG_FUNCTION (this << packet);
 
@@ -489,23 +496,19 @@ EndDeviceLoraMac::ParseCommands (LoraFrameHeader frameHeader)
         }
     }
 
-  std::list<Ptr<MacCommand> > commands = frameHeader.GetCommands ();
-  std::list<Ptr<MacCommand> >::iterator it;
-  for (it = commands.begin (); it != commands.end (); it++)
+  for (uint8_t i = 0; i < frameHeader.GetNCommands (); i++)
     {
       NS_LOG_DEBUG ("Iterating over the MAC commands...");
-      enum MacCommandType type = (*it)->GetCommandType ();
-      switch (type)
+      MacCommandValue command = frameHeader.GetCommand (i);
+      switch (command.type)
         {
         case (LINK_CHECK_ANS):
           {
             NS_LOG_DEBUG ("Detected a LinkCheckAns command.");
 
-            // Cast the command
-            Ptr<LinkCheckAns> linkCheckAns = (*it)->GetObject<LinkCheckAns> ();
-
             // Call the appropriate function to take action
-            OnLinkCheckAns (linkCheckAns->GetMargin (), linkCheckAns->GetGwCnt ());
+            OnLinkCheckAns (command.linkCheckAns.margin,
+                            command.linkCheckAns.gwCnt);
 
             break;
           }
@@ -513,13 +516,20 @@ EndDeviceLoraMac::ParseCommands (LoraFrameHeader frameHeader)
           {
             NS_LOG_DEBUG ("Detected a LinkAdrReq command.");
 
-            // Cast the command
-            Ptr<LinkAdrReq> linkAdrReq = (*it)->GetObject<LinkAdrReq> ();
+            // Take the enabled channels from the channel mask
+            std::list<int> enabledChannels;
+            for (int channel = 0; channel < 16; channel++)
+              {
+                if (command.linkAdrReq.channelMask & (0b1 << channel))
+                  {
+                    enabledChannels.push_back (channel);
+                  }
+              }
 
             // Call the appropriate function to take action
-            OnLinkAdrReq (linkAdrReq->GetDataRate (), linkAdrReq->GetTxPower (),
-                          linkAdrReq->GetEnabledChannelsList (),
-                          linkAdrReq->GetRepetitions ());
+            OnLinkAdrReq (command.linkAdrReq.dataRate,
+                          command.linkAdrReq.txPower, enabledChannels,
+                          command.linkAdrReq.nbRep);
 
             break;
           }
@@ -527,11 +537,9 @@ EndDeviceLoraMac::ParseCommands (LoraFrameHeader frameHeader)
           {
             NS_LOG_DEBUG ("Detected a DutyCycleReq command.");
 
-            // Cast the command
-            Ptr<DutyCycleReq> dutyCycleReq = (*it)->GetObject<DutyCycleReq> ();
-
             // Call the appropriate function to take action
-            OnDutyCycleReq (dutyCycleReq->GetMaximumAllowedDutyCycle ());
+            OnDutyCycleReq (DutyCycleReq::GetMaximumAllowedDutyCycle
+                              (command.dutyCycleReq.maxDCycle));
 
             break;
           }
@@ -539,13 +547,10 @@ EndDeviceLoraMac::ParseCommands (LoraFrameHeader frameHeader)
           {
             NS_LOG_DEBUG ("Detected a RxParamSetupReq command.");
 
-            // Cast the command
-            Ptr<RxParamSetupReq> rxParamSetupReq = (*it)->GetObject<RxParamSetupReq> ();
-
             // Call the appropriate function to take action
-            OnRxParamSetupReq (rxParamSetupReq->GetRx1DrOffset (),
-                               rxParamSetupReq->GetRx2DataRate (),
-                               rxParamSetupReq->GetFrequency ());
+            OnRxParamSetupReq (command.rxParamSetupReq.rx1DrOffset,
+                               command.rxParamSetupReq.rx2DataRate,
+                               command.rxParamSetupReq.frequency);
 
             break;
           }
@@ -553,9 +558,6 @@ EndDeviceLoraMac::ParseCommands (LoraFrameHeader frameHeader)
           {
             NS_LOG_DEBUG ("Detected a DevStatusReq command.");
 
-            // Cast the command
-            Ptr<DevStatusReq> devStatusReq = (*it)->GetObject<DevStatusReq> ();
-
             // Call the appropriate function to take action
             OnDevStatusReq ();
 
@@ -565,11 +567,11 @@ EndDeviceLoraMac::ParseCommands (LoraFrameHeader frameHeader)
           {
             NS_LOG_DEBUG ("Detected a NewChannelReq command.");
 
-            // Cast the command
-            Ptr<NewChannelReq> newChannelReq = (*it)->GetObject<NewChannelReq> ();
-
             // Call the appropriate function to take action
-            OnNewChannelReq (newChannelReq->GetChannelIndex (), newChannelReq->GetFrequency (), newChannelReq->GetMinDataRate (), newChannelReq->GetMaxDataRate ());
+            OnNewChannelReq (command.newChannelReq.chIndex,
+                             command.newChannelReq.frequency,
+                             command.newChannelReq.minDataRate,
+                             command.newChannelReq.maxDataRate);
 
             break;
           }
@@ -603,7 +605,7 @@ EndDeviceLoraMac::ApplyNecessaryOptions (LoraFrameHeader& frameHeader)
   frameHeader.SetAsUplink ();
   frameHeader.SetFPort (1);             // TODO Use an appropriate frame port based on the application
   frameHeader.SetAddress (m_address);
-  frameHeader.SetAdr (0);             // TODO Set ADR if a member variable is true
+  frameHeader.SetAdr (m_enableAdr);
   frameHeader.SetAdrAckReq (0);             // TODO Set ADRACKREQ if a member variable is true
   if (m_mType == LoraMacHeader::CONFIRMED_DATA_UP)
     {
@@ -620,8 +622,7 @@ EndDeviceLoraMac::ApplyNecessaryOptions (LoraFrameHeader& frameHeader)
   for (const auto &command : m_macCommandList)
     {
       NS_LOG_INFO ("Applying a MAC Command of CID " <<
-                   unsigned(MacCommand::GetCIDFromMacCommand
-                              (command->GetCommandType ())));
+                   unsigned(MacCommand::GetCIDFromMacCommand (command.type)));
 
       frameHeader.AddCommand (command);
     }
@@ -1090,12 +1091,12 @@ EndDeviceLoraMac::OnLinkAdrReq (uint8_t dataRate, uint8_t txPower,
         {
           if (std::find (enabledChannels.begin (), enabledChannels.end (), i) != enabledChannels.end ())
             {
-              m_channelHelper.GetChannelList ().at (i)->SetEnabledForUplink ();
+              m_channelHelper.EnableChannel (i);
               NS_LOG_DEBUG ("Channel " << i << " enabled");
             }
           else
             {
-              m_channelHelper.GetChannelList ().at (i)->DisableForUplink ();
+              m_channelHelper.DisableChannel (i);
               NS_LOG_DEBUG ("Channel " << i << " disabled");
             }
         }
@@ -1109,8 +1110,11 @@ EndDeviceLoraMac::OnLinkAdrReq (uint8_t dataRate, uint8_t txPower,
 
   // Craft a LinkAdrAns MAC command as a response
   ///////////////////////////////////////////////
-  m_macCommandList.push_back (CreateObject<LinkAdrAns> (txPowerOk, dataRateOk,
-                                                        channelMaskOk));
+  MacCommandValue linkAdrAns (LINK_ADR_ANS);
+  linkAdrAns.linkAdrAns.powerAck = txPowerOk;
+  linkAdrAns.linkAdrAns.dataRateAck = dataRateOk;
+  linkAdrAns.linkAdrAns.channelMaskAck = channelMaskOk;
+  AddMacCommand (linkAdrAns);
 }
 
 void
@@ -1126,7 +1130,7 @@ EndDeviceLoraMac::OnDutyCycleReq (double dutyCycle)
 
   // Craft a DutyCycleAns as response
   NS_LOG_INFO ("Adding DutyCycleAns reply");
-  m_macCommandList.push_back (CreateObject<DutyCycleAns> ());
+  AddMacCommand (MacCommandValue (DUTY_CYCLE_ANS));
 }
 
 void
@@ -1161,8 +1165,11 @@ EndDeviceLoraMac::OnRxParamSetupReq (uint8_t rx1DrOffset, uint8_t rx2DataRate, d
 
   // Craft a RxParamSetupAns as response
   NS_LOG_INFO ("Adding RxParamSetupAns reply");
-  m_macCommandList.push_back (CreateObject<RxParamSetupAns> (offsetOk,
-                                                             dataRateOk, true));
+  MacCommandValue rxParamSetupAns (RX_PARAM_SETUP_ANS);
+  rxParamSetupAns.rxParamSetupAns.rx1DrOffsetAck = offsetOk;
+  rxParamSetupAns.rxParamSetupAns.rx2DataRateAck = dataRateOk;
+  rxParamSetupAns.rxParamSetupAns.channelAck = true;
+  AddMacCommand (rxParamSetupAns);
 }
 
 void
@@ -1175,7 +1182,10 @@ EndDeviceLoraMac::OnDevStatusReq (void)
 
   // Craft a RxParamSetupAns as response
   NS_LOG_INFO ("Adding DevStatusAns reply");
-  m_macCommandList.push_back (CreateObject<DevStatusAns> (battery, margin));
+  MacCommandValue devStatusAns (DEV_STATUS_ANS);
+  devStatusAns.devStatusAns.battery = battery;
+  devStatusAns.devStatusAns.margin = margin;
+  AddMacCommand (devStatusAns);
 }
 
 void
@@ -1192,8 +1202,10 @@ EndDeviceLoraMac::OnNewChannelReq (uint8_t chIndex, double frequency, uint8_t mi
   SetLogicalChannel (chIndex, frequency, minDataRate, maxDataRate);
 
   NS_LOG_INFO ("Adding NewChannelAns reply");
-  m_macCommandList.push_back (CreateObject<NewChannelAns> (dataRateRangeOk,
-                                                           channelFrequencyOk));
+  MacCommandValue newChannelAns (NEW_CHANNEL_ANS);
+  newChannelAns.newChannelAns.dataRateRangeOk = dataRateRangeOk;
+  newChannelAns.newChannelAns.channelFrequencyOk = channelFrequencyOk;
+  AddMacCommand (newChannelAns);
 }
 
 void
@@ -1274,6 +1286,29 @@ EndDeviceLoraMac::AddMacCommand (Ptr<MacCommand> macCommand)
 {
   NS_LOG_FUNCTION (this << macCommand);
 
+  AddMacCommand (MacCommandValue::FromMacCommand (macCommand));
+}
+
+void
+EndDeviceLoraMac::AddMacCommand (const MacCommandValue &macCommand)
+{
+  NS_LOG_FUNCTION (this << macCommand.type);
+
+  // Drop commands that would not fit in the FOpts field of the next packet
+  uint8_t queuedSize = 0;
+  for (const auto &command : m_macCommandList)
+    {
+      queuedSize += command.GetSerializedSize ();
+    }
+  if (queuedSize + macCommand.GetSerializedSize ()
+      > LoraFrameHeader::MAX_FOPTS_LEN)
+    {
+      NS_LOG_WARN ("Dropping MAC command of CID " <<
+                   unsigned (MacCommand::GetCIDFromMacCommand (macCommand.type)) <<
+                   ": FOpts is full");
+      return;
+    }
+
   m_macCommandList.push_back (macCommand);
 }
 
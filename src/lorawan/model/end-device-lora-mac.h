@@ -29,6 +29,8 @@
 #include "ns3/lora-device-address.h"
 #include "ns3/traced-value.h"
 
+#include <vector>
+
 namespace ns3 {
 namespace lorawan {
 
@@ -89,8 +91,10 @@ public:
    * layer so that it's called when a packet is going up the stack.
    *
    * \param packet the received packet.
+   * \param rxParams the parameters of the reception.
    */
-  virtual void Receive (Ptr<Packet const> packet);
+  virtual void Receive (Ptr<Packet const> packet,
+                        const LoraRxParameters &rxParams);
 
   virtual void FailedReception (Ptr<Packet const> packet);
 
@@ -368,9 +372,21 @@ public:
   /**
    * Add a MAC command to the list of those that will be sent out in the next
    * packet.
+   *
+   * Commands that don't fit in the FOpts field of the next packet, together
+   * with the ones already in the list, are dropped.
    */
   void AddMacCommand (Ptr<MacCommand> macCommand);
 
+  /**
+   * Add a MAC command to the list of those that will be sent out in the next
+   * packet, without creating a MacCommand object.
+   *
+   * Commands that don't fit in the FOpts field of the next packet are
+   * dropped.
+   */
+  void AddMacCommand (const MacCommandValue &macCommand);
+
   uint8_t GetTransmissionPower (void);
 
 private:
@@ -391,6 +407,12 @@ private:
    */
   bool m_enableDRAdapt;
 
+  /**
+   * Whether the network server is asked to control the data rate and
+   * transmission power, by setting the ADR bit of uplinks.
+   */
+  bool m_enableAdr;
+
   /**
    * Maximum number of transmission allowed.
    */
@@ -543,7 +565,7 @@ TracedValue<uint8_t> m_requiredTx;
   /**
    * List of the MAC commands that need to be applied to the next UL packet.
    */
-  std::list<Ptr<MacCommand> > m_macCommandList;
+  std::vector<MacCommandValue> m_macCommandList;
 
   /**
    * The aggregated duty cycle this device needs to respect across all sub-bands.
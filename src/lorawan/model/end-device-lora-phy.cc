@@ -121,6 +121,12 @@ EndDeviceLoraPhy::SwitchToStandby (void)
 
   m_state = STANDBY;
 
+  // Let the channel know we are now listening
+  if (m_channel)
+    {
+      m_channel->SetListening (this, true);
+    }
+
   // Notify listeners of the state change
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
     {
@@ -153,6 +159,12 @@ EndDeviceLoraPhy::SwitchToTx (double txPowerDbm)
 
   m_state = TX;
 
+  // Let the channel know we are not listening anymore
+  if (m_channel)
+    {
+      m_channel->SetListening (this, false);
+    }
+
   // Notify listeners of the state change
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
     {
@@ -169,6 +181,12 @@ EndDeviceLoraPhy::SwitchToSleep (void)
 
   m_state = SLEEP;
 
+  // Let the channel know we are not listening anymore
+  if (m_channel)
+    {
+      m_channel->SetListening (this, false);
+    }
+
   // Notify listeners of the state change
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
     {
@@ -140,6 +140,11 @@ public:
     RX
   };
 
+  /**
+   * The number of states, which must be updated if a state is added after RX.
+   */
+  static const int N_STATES = RX + 1;
+
   static TypeId GetTypeId (void);
 
   // Constructor and destructor
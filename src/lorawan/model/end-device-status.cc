@@ -29,20 +29,89 @@
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "ns3/lora-tag.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
+#include <limits>
 
 namespace ns3 {
 namespace lorawan {
 
 NS_LOG_COMPONENT_DEFINE ("EndDeviceStatus");
 
+/*************************
+ *  GatewayAddressTable  *
+ *************************/
+
+std::size_t
+GatewayAddressTable::AddressHash::operator() (const Address& address) const
+{
+  uint8_t buffer[Address::MAX_SIZE + 2];
+  uint32_t size = address.CopyAllTo (buffer, sizeof (buffer));
+
+  // FNV-1a
+  std::size_t hash = 14695981039346656037ULL;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      hash = (hash ^ buffer[i]) * 1099511628211ULL;
+    }
+  return hash;
+}
+
+uint16_t
+GatewayAddressTable::GetIndex (const Address& address)
+{
+  auto it = m_indexes.find (address);
+  if (it != m_indexes.end ())
+    {
+      return it->second;
+    }
+
+  NS_ABORT_MSG_IF (m_addresses.size () > std::numeric_limits<uint16_t>::max (),
+                   "Too many gateways");
+
+  uint16_t index = m_addresses.size ();
+  m_addresses.push_back (address);
+  m_indexes[address] = index;
+  return index;
+}
+
+bool
+GatewayAddressTable::FindIndex (const Address& address, uint16_t &index) const
+{
+  auto it = m_indexes.find (address);
+  if (it == m_indexes.end ())
+    {
+      return false;
+    }
+  index = it->second;
+  return true;
+}
+
+Address
+GatewayAddressTable::GetAddress (uint16_t index) const
+{
+  return m_addresses.at (index);
+}
+
+/*********************
+ *  EndDeviceStatus  *
+ *********************/
+
+const uint8_t EndDeviceStatus::MAX_GATEWAYS_PER_PACKET;
+
 TypeId
 EndDeviceStatus::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::EndDeviceStatus")
     .SetParent<Object> ()
     .AddConstructor<EndDeviceStatus> ()
+    .AddAttribute ("ReceivedPacketHistory",
+                   "The number of received packets that are remembered",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&EndDeviceStatus::SetHistoryDepth,
+                                         &EndDeviceStatus::GetHistoryDepth),
+                   MakeUintegerChecker<uint32_t> (1))
     .SetGroupName ("lorawan");
   return tid;
 }
@@ -51,19 +120,21 @@ EndDeviceStatus::EndDeviceStatus (LoraDeviceAddress endDeviceAddress,
                                   Ptr<EndDeviceLoraMac> endDeviceMac) :
   m_reply (EndDeviceStatus::Reply ()),
   m_endDeviceAddress (endDeviceAddress),
-  m_receivedPacketList (ReceivedPacketList ()),
+  m_nextReception (0),
+  m_historyDepth (4),
   m_mac (endDeviceMac)
 {
   NS_LOG_FUNCTION (endDeviceAddress);
 }
 
-EndDeviceStatus::EndDeviceStatus ()
+EndDeviceStatus::EndDeviceStatus () :
+  m_nextReception (0),
+  m_historyDepth (4)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
   // Initialize data structure
   m_reply = EndDeviceStatus::Reply ();
-  m_receivedPacketList = ReceivedPacketList ();
 }
 
 EndDeviceStatus::~EndDeviceStatus ()
@@ -172,11 +243,49 @@ EndDeviceStatus::GetMac (void)
   return m_mac;
 }
 
+void
+EndDeviceStatus::SetHistoryDepth (uint32_t depth)
+{
+  NS_LOG_FUNCTION (this << depth);
+  NS_ABORT_MSG_IF (depth == 0, "The packet history must hold at least one packet");
+
+  // Rebuild the ring buffer with the newest packets, from the oldest one
+  uint32_t size = m_receptions.size ();
+  uint32_t kept = std::min (size, depth);
+  std::vector<Reception> receptions;
+  receptions.reserve (kept);
+  for (uint32_t i = kept; i > 0; i--)
+    {
+      receptions.push_back
+        (m_receptions[(m_nextReception + m_historyDepth - i) % m_historyDepth]);
+    }
+  m_receptions.swap (receptions);
+  m_historyDepth = depth;
+  m_nextReception = kept % depth;
+}
+
+uint32_t
+EndDeviceStatus::GetHistoryDepth (void) const
+{
+  return m_historyDepth;
+}
+
 EndDeviceStatus::ReceivedPacketList
 EndDeviceStatus::GetReceivedPacketList ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  return m_receivedPacketList;
+
+  // Go through the ring buffer from the oldest packet
+  ReceivedPacketList list;
+  uint32_t size = m_receptions.size ();
+  uint32_t oldest = size < m_historyDepth ? 0 : m_nextReception;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      const Reception &reception = m_receptions[(oldest + i) % size];
+      list.push_back (std::make_pair (reception.packet,
+                                      GetReceivedPacketInfo (reception)));
+    }
+  return list;
 }
 
 void
@@ -238,8 +347,6 @@ EndDeviceStatus::InsertReceivedPacket (Ptr<Packet const> receivedPacket,
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  NS_LOG_DEBUG (*this);
-
   // Create a copy of the packet
   Ptr<Packet> myPacket = receivedPacket->Copy ();
 
@@ -251,81 +358,183 @@ EndDeviceStatus::InsertReceivedPacket (Ptr<Packet const> receivedPacket,
   frameHdr.SetAsUplink ();
   myPacket->RemoveHeader (frameHdr);
 
-  // Update current parameters
   LoraTag tag;
-  myPacket->RemovePacketTag (tag);
+  myPacket->PeekPacketTag (tag);
+
+  InsertReceivedPacket (receivedPacket, gwAddress, frameHdr.GetFCnt (), tag);
+}
+
+void
+EndDeviceStatus::InsertReceivedPacket (Ptr<Packet const> receivedPacket,
+                                       const Address& gwAddress,
+                                       uint16_t fCnt, const LoraTag &tag)
+{
+  NS_LOG_FUNCTION (this << receivedPacket << gwAddress << fCnt);
+
+  NS_LOG_DEBUG (*this);
+
+  // Update current parameters
   SetFirstReceiveWindowSpreadingFactor (tag.GetSpreadingFactor ());
   SetFirstReceiveWindowFrequency (tag.GetFrequency ());
 
-  // Update Information on the received packet
-  ReceivedPacketInfo info;
-  info.sf = tag.GetSpreadingFactor ();
-  info.frequency = tag.GetFrequency ();
-  info.packet = receivedPacket;
-
   double rcvPower = tag.GetReceivePower ();
 
-  // Perform insertion in list, also checking that the packet isn't already in
-  // the list (it could have been received by another GW already)
+  // Perform insertion in the history, also checking that the packet isn't
+  // already there (it could have been received by another GW already)
+  Reception *existing = FindReception (fCnt);
+  if (existing != 0)
+    {
+      NS_LOG_INFO ("Packet was already received by another gateway");
+
+      // This packet had already been received from another gateway:
+      // add this gateway's reception information.
+      AddGateway (*existing, gwAddress, rcvPower);
+
+      NS_LOG_DEBUG ("Size of gateway list: " <<
+                    unsigned(existing->nStoredGateways));
+      return;
+    }
+
+  NS_LOG_INFO ("Packet was received for the first time");
+  Reception reception;
+  reception.packet = receivedPacket;
+  reception.frequency = tag.GetFrequency ();
+  reception.fCnt = fCnt;
+  reception.sf = tag.GetSpreadingFactor ();
+  reception.nStoredGateways = 0;
+  reception.nGateways = 0;
+  AddGateway (reception, gwAddress, rcvPower);
+
+  // Overwrite the oldest packet once the history is full
+  if (m_receptions.size () < m_historyDepth)
+    {
+      m_receptions.push_back (reception);
+    }
+  else
+    {
+      m_receptions[m_nextReception] = reception;
+    }
+  m_nextReception = (m_nextReception + 1) % m_historyDepth;
+}
+
+void
+EndDeviceStatus::InsertGatewayReception (Ptr<Packet const> receivedPacket,
+                                         const Address& gwAddress,
+                                         uint16_t fCnt)
+{
+  NS_LOG_FUNCTION (this << receivedPacket << gwAddress << fCnt);
 
-  // Start searching from the end
-  auto it = m_receivedPacketList.rbegin ();
-  for (; it != m_receivedPacketList.rend (); it++)
+  // A newer packet may have been received in the meantime
+  Reception *reception = FindReception (fCnt);
+  if (reception == 0)
     {
-      // Get the frame counter of the current packet to compare it with the
-      // newly received one
-      Ptr<Packet> packetCopy = ((*it).first)->Copy ();
-      LoraMacHeader currentMacHdr;
-      packetCopy->RemoveHeader (currentMacHdr);
-      LoraFrameHeader currentFrameHdr;
-      frameHdr.SetAsUplink ();
-      packetCopy->RemoveHeader (currentFrameHdr);
-
-      NS_LOG_DEBUG ("Received packet's frame counter: " <<
-                    unsigned(frameHdr.GetFCnt ()) <<
-                    "\nCurrent packet's frame counter: " <<
-                    unsigned(currentFrameHdr.GetFCnt ()));
-
-      if (frameHdr.GetFCnt () == currentFrameHdr.GetFCnt ())
+      NS_LOG_DEBUG ("Packet is not in the history anymore");
+      return;
+    }
+
+  LoraTag tag;
+  receivedPacket->PeekPacketTag (tag);
+  AddGateway (*reception, gwAddress, tag.GetReceivePower ());
+
+  NS_LOG_DEBUG ("Size of gateway list: " <<
+                unsigned(reception->nStoredGateways));
+}
+
+void
+EndDeviceStatus::AddGateway (Reception &reception, const Address& gwAddress,
+                             double rxPower)
+{
+  if (m_gatewayTable == 0)
+    {
+      m_gatewayTable = Create<GatewayAddressTable> ();
+    }
+  uint16_t gateway = m_gatewayTable->GetIndex (gwAddress);
+
+  // Each gateway is only counted once
+  uint8_t worst = 0;
+  for (uint8_t i = 0; i < reception.nStoredGateways; i++)
+    {
+      if (reception.gateways[i].gateway == gateway)
+        {
+          return;
+        }
+      if (reception.gateways[i].rxPower < reception.gateways[worst].rxPower)
         {
-          NS_LOG_INFO ("Packet was already received by another gateway");
+          worst = i;
+        }
+    }
+  reception.nGateways++;
 
-          // This packet had already been received from another gateway:
-          // add this gateway's reception information.
-          GatewayList& gwList = it->second.gwList;
+  GatewayReception gatewayReception;
+  gatewayReception.receivedTime = Simulator::Now ();
+  gatewayReception.rxPower = rxPower;
+  gatewayReception.gateway = gateway;
 
-          PacketInfoPerGw gwInfo;
-          gwInfo.receivedTime = Simulator::Now ();
-          gwInfo.rxPower = rcvPower;
-          gwInfo.gwAddress = gwAddress;
-          gwList.insert (std::pair<Address, PacketInfoPerGw> (gwAddress, gwInfo));
+  if (reception.nStoredGateways < MAX_GATEWAYS_PER_PACKET)
+    {
+      reception.gateways[reception.nStoredGateways++] = gatewayReception;
+    }
+  else if (reception.gateways[worst].rxPower < rxPower)
+    {
+      // Only remember the best gateways
+      reception.gateways[worst] = gatewayReception;
+    }
+}
 
-          NS_LOG_DEBUG ("Size of gateway list: " << gwList.size ());
+EndDeviceStatus::Reception *
+EndDeviceStatus::GetLastReception (void)
+{
+  if (m_receptions.empty ())
+    {
+      return 0;
+    }
+  return &m_receptions[(m_nextReception + m_historyDepth - 1) % m_historyDepth];
+}
 
-          break;     // Exit from the cycle
+EndDeviceStatus::Reception *
+EndDeviceStatus::FindReception (uint16_t fCnt)
+{
+  // Start searching from the newest packet
+  uint32_t size = m_receptions.size ();
+  for (uint32_t i = 0; i < size; i++)
+    {
+      Reception &reception =
+        m_receptions[(m_nextReception + m_historyDepth - 1 - i) % m_historyDepth];
+      if (reception.fCnt == fCnt)
+        {
+          return &reception;
         }
     }
-  if (it == m_receivedPacketList.rend ())
+  return 0;
+}
+
+EndDeviceStatus::ReceivedPacketInfo
+EndDeviceStatus::GetReceivedPacketInfo (const Reception &reception) const
+{
+  ReceivedPacketInfo info;
+  info.packet = reception.packet;
+  info.sf = reception.sf;
+  info.frequency = reception.frequency;
+  for (uint8_t i = 0; i < reception.nStoredGateways; i++)
     {
-      NS_LOG_INFO ("Packet was received for the first time");
       PacketInfoPerGw gwInfo;
-      gwInfo.receivedTime = Simulator::Now ();
-      gwInfo.rxPower = rcvPower;
-      gwInfo.gwAddress = gwAddress;
-      info.gwList.insert (std::pair<Address, PacketInfoPerGw> (gwAddress, gwInfo));
-      m_receivedPacketList.push_back (std::pair<Ptr<Packet const>, ReceivedPacketInfo>
-                                        (receivedPacket, info));
+      gwInfo.gwAddress = m_gatewayTable->GetAddress (reception.gateways[i].gateway);
+      gwInfo.receivedTime = reception.gateways[i].receivedTime;
+      gwInfo.rxPower = reception.gateways[i].rxPower;
+      info.gwList.insert (std::pair<Address, PacketInfoPerGw>
+                            (gwInfo.gwAddress, gwInfo));
     }
+  return info;
 }
 
 EndDeviceStatus::ReceivedPacketInfo
 EndDeviceStatus::GetLastReceivedPacketInfo (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  auto it = m_receivedPacketList.rbegin ();
-  if (it != m_receivedPacketList.rend ())
+  Reception *reception = GetLastReception ();
+  if (reception != 0)
     {
-      return it->second;
+      return GetReceivedPacketInfo (*reception);
     }
   else
     {
@@ -333,14 +542,56 @@ EndDeviceStatus::GetLastReceivedPacketInfo (void)
     }
 }
 
+uint16_t
+EndDeviceStatus::GetLastReceivedPacketGatewayCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Reception *reception = GetLastReception ();
+  if (reception != 0)
+    {
+      return reception->nGateways;
+    }
+  else
+    {
+      return 0;
+    }
+}
+
+double
+EndDeviceStatus::GetLastReceivedPacketBestRxPower (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  double bestRxPower = -std::numeric_limits<double>::infinity ();
+  Reception *reception = GetLastReception ();
+  if (reception != 0)
+    {
+      for (uint8_t i = 0; i < reception->nStoredGateways; i++)
+        {
+          bestRxPower = std::max (bestRxPower, reception->gateways[i].rxPower);
+        }
+    }
+  return bestRxPower;
+}
+
+void
+EndDeviceStatus::SetGatewayAddressTable (Ptr<GatewayAddressTable> table)
+{
+  NS_LOG_FUNCTION (this << table);
+
+  NS_ASSERT_MSG (m_receptions.empty (),
+                 "Cannot change the gateway table of a device with a history");
+  m_gatewayTable = table;
+}
+
 Ptr<Packet const>
 EndDeviceStatus::GetLastPacketReceivedFromDevice (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  auto it = m_receivedPacketList.rbegin ();
-  if (it != m_receivedPacketList.rend ())
+  Reception *reception = GetLastReception ();
+  if (reception != 0)
     {
-      return it->first;
+      return reception->packet;
     }
   else
     {
@@ -369,23 +620,20 @@ EndDeviceStatus::GetBestGatewayForReply (void)
   // Pick the one that received it with the highest power.
   // If it is available for transmission, return that one. Else, check the
   // second best one.
-  ReceivedPacketInfo info = m_receivedPacketList.back ().second;
-
-  GatewayList gwList = info.gwList;
-
+  Reception *reception = GetLastReception ();
+  NS_ASSERT (reception != 0);
 
   Address bestGwAddress = Address ();
   double bestRxPower = -1000;
 
-  for (auto it = gwList.begin (); it != gwList.end (); it++)
+  for (uint8_t i = 0; i < reception->nStoredGateways; i++)
     {
-      Address currentGwAddress = (*it).first;
-      double currentRxPower = (*it).second.rxPower;
+      double currentRxPower = reception->gateways[i].rxPower;
 
       if (currentRxPower > bestRxPower)
         {
           bestRxPower = currentRxPower;
-          bestGwAddress = currentGwAddress;
+          bestGwAddress = m_gatewayTable->GetAddress (reception->gateways[i].gateway);
         }
     }
 
@@ -395,11 +643,11 @@ EndDeviceStatus::GetBestGatewayForReply (void)
 std::ostream&
 operator<< (std::ostream& os, const EndDeviceStatus& status)
 {
-  os << "Total packets received: " << status.m_receivedPacketList.size () << std::endl;
+  EndDeviceStatus::ReceivedPacketList list =
+    const_cast<EndDeviceStatus &> (status).GetReceivedPacketList ();
+  os << "Total packets received: " << list.size () << std::endl;
 
-  for (auto j = status.m_receivedPacketList.begin ();
-       j != status.m_receivedPacketList.end ();
-       j++)
+  for (auto j = list.begin (); j != list.end (); j++)
     {
       EndDeviceStatus::ReceivedPacketInfo info = (*j).second;
       EndDeviceStatus::GatewayList gatewayList = info.gwList;
@@ -27,14 +27,59 @@
 #include "ns3/lora-mac-header.h"
 #include "ns3/end-device-lora-mac.h"
 #include "ns3/lora-frame-header.h"
+#include "ns3/lora-tag.h"
 #include "ns3/pointer.h"
 #include "ns3/lora-mac-header.h"
 #include "ns3/lora-frame-header.h"
+#include "ns3/simple-ref-count.h"
 #include <iostream>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 namespace lorawan {
 
+/**
+ * Assigns a small index to each gateway address, so that EndDeviceStatus
+ * objects can refer to gateways without storing their whole Address.
+ *
+ * A table is shared by all the EndDeviceStatus objects of a NetworkStatus.
+ */
+class GatewayAddressTable : public SimpleRefCount<GatewayAddressTable>
+{
+public:
+  /**
+   * Get the index of a gateway address, assigning a new one if the address
+   * was never seen before.
+   */
+  uint16_t GetIndex (const Address& address);
+
+  /**
+   * Get the index of a gateway address, without assigning one.
+   *
+   * \return False if the address was never seen before.
+   */
+  bool FindIndex (const Address& address, uint16_t &index) const;
+
+  /**
+   * Get the address of the gateway with a certain index.
+   */
+  Address GetAddress (uint16_t index) const;
+
+private:
+  /**
+   * Hash an address, including its type.
+   */
+  struct AddressHash
+  {
+    std::size_t operator() (const Address& address) const;
+  };
+
+  std::vector<Address> m_addresses; //!< The addresses, by index
+  std::unordered_map<Address, uint16_t, AddressHash> m_indexes; //!< The indexes, by address
+};
+
 /**
  * This class represents the Network Server's knowledge about an End Device in
  * the LoRaWAN network it is administering.
@@ -77,6 +122,13 @@ namespace lorawan {
  *
  *  (Gateway list) - Time at which the packet was received
  *                 - Reception power
+ *
+ * Only the last ReceivedPacketHistory packets are kept, in a ring buffer of
+ * flat records. For each packet, the record holds the best
+ * MAX_GATEWAYS_PER_PACKET gateways that received it (by reception power), as
+ * indexes in a GatewayAddressTable, and the total number of gateways that
+ * received it. The ReceivedPacketList and GatewayList structures returned by
+ * this class are built from these records on request.
  */
 
 class EndDeviceStatus : public Object
@@ -182,6 +234,12 @@ public:
   /* Proper EndDeviceStatus class definition */
   /*******************************************/
 
+  /**
+   * The maximum number of gateways that are remembered for each received
+   * packet.
+   */
+  static const uint8_t MAX_GATEWAYS_PER_PACKET = 4;
+
   static TypeId GetTypeId (void);
 
   EndDeviceStatus ();
@@ -269,6 +327,32 @@ public:
   void InsertReceivedPacket (Ptr<Packet const> receivedPacket,
                              const Address& gwAddress);
 
+  /**
+   * Insert a received packet in the packet list, given the frame counter and
+   * the LoraTag the caller already extracted from it, so that its headers
+   * are not parsed again.
+   *
+   * \param receivedPacket The packet forwarded by the gateway.
+   * \param gwAddress The address of the gateway.
+   * \param fCnt The frame counter of the packet.
+   * \param tag The LoraTag of the packet.
+   */
+  void InsertReceivedPacket (Ptr<Packet const> receivedPacket,
+                             const Address& gwAddress, uint16_t fCnt,
+                             const LoraTag &tag);
+
+  /**
+   * Add the information about a gateway that received a copy of a packet in
+   * the packet list. Copies of packets that already left the list are
+   * ignored.
+   *
+   * \param receivedPacket The copy forwarded by the gateway.
+   * \param gwAddress The address of the gateway.
+   * \param fCnt The frame counter of the packet.
+   */
+  void InsertGatewayReception (Ptr<Packet const> receivedPacket,
+                               const Address& gwAddress, uint16_t fCnt);
+
   /**
    * Return the last packet that was received from this device.
    */
@@ -280,6 +364,23 @@ public:
    */
   EndDeviceStatus::ReceivedPacketInfo GetLastReceivedPacketInfo (void);
 
+  /**
+   * Return the number of gateways that received the last packet from the
+   * device, including the ones that are not in its gateway list.
+   */
+  uint16_t GetLastReceivedPacketGatewayCount (void);
+
+  /**
+   * Return the power the last packet from the device was received with by
+   * the best gateway, or -infinity if no packet was received.
+   */
+  double GetLastReceivedPacketBestRxPower (void);
+
+  /**
+   * Set the table used to translate gateway addresses to indexes.
+   */
+  void SetGatewayAddressTable (Ptr<GatewayAddressTable> table);
+
   /**
    * Initialize reply.
    */
@@ -315,7 +416,67 @@ private:
   uint8_t m_secondReceiveWindowOffset = 0;
   double m_secondReceiveWindowFrequency = 868.625;
 
-  ReceivedPacketList m_receivedPacketList;   //<! List of received packets
+  /**
+   * The information about a gateway that received a packet.
+   */
+  struct GatewayReception
+  {
+    Time receivedTime; //!< Time at which the packet was received by the gateway
+    double rxPower; //!< Reception power of the packet at the gateway
+    uint16_t gateway; //!< Index of the gateway in the GatewayAddressTable
+  };
+
+  /**
+   * A packet received from this device.
+   */
+  struct Reception
+  {
+    Ptr<Packet const> packet; //!< The received packet
+    double frequency; //!< The frequency of the packet
+    uint16_t fCnt; //!< The frame counter of the packet
+    uint8_t sf; //!< The spreading factor of the packet
+    uint8_t nStoredGateways; //!< The number of valid entries in gateways
+    uint16_t nGateways; //!< The number of gateways that received the packet
+    GatewayReception gateways[MAX_GATEWAYS_PER_PACKET]; //!< The best gateways
+  };
+
+  /**
+   * Get the last packet that was received, or 0 if there is none.
+   */
+  Reception * GetLastReception (void);
+
+  /**
+   * Set the capacity of the ring buffer, keeping the newest packets if it
+   * shrinks.
+   */
+  void SetHistoryDepth (uint32_t depth);
+
+  /**
+   * Get the capacity of the ring buffer.
+   */
+  uint32_t GetHistoryDepth (void) const;
+
+  /**
+   * Get the newest packet with a frame counter, or 0 if there is none.
+   */
+  Reception * FindReception (uint16_t fCnt);
+
+  /**
+   * Add a gateway to a reception, replacing the worst one if the reception
+   * already holds MAX_GATEWAYS_PER_PACKET gateways.
+   */
+  void AddGateway (Reception &reception, const Address& gwAddress,
+                   double rxPower);
+
+  /**
+   * Build the public representation of a reception.
+   */
+  ReceivedPacketInfo GetReceivedPacketInfo (const Reception &reception) const;
+
+  std::vector<Reception> m_receptions; //!< Ring buffer of received packets
+  uint32_t m_nextReception; //!< Index of m_receptions where the next packet goes
+  uint32_t m_historyDepth; //!< The capacity of the ring buffer
+  Ptr<GatewayAddressTable> m_gatewayTable; //!< The table of gateway indexes
 
   // NOTE Using this attribute is 'cheating', since we are assuming perfect
   // synchronization between the info at the device and at the network server
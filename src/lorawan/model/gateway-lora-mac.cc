@@ -58,14 +58,13 @@ GatewayLoraMac::Send (Ptr<Packet> packet)
 
   // Get DataRate to send this packet with
   LoraTag tag;
-  packet->RemovePacketTag (tag);
+  packet->PeekPacketTag (tag);
   uint8_t dataRate = tag.GetDataRate ();
   double frequency = tag.GetFrequency ();
   NS_LOG_DEBUG ("DR: " << unsigned (dataRate));
   NS_LOG_DEBUG ("SF: " << unsigned (GetSfFromDataRate (dataRate)));
   NS_LOG_DEBUG ("BW: " << GetBandwidthFromDataRate (dataRate));
   NS_LOG_DEBUG ("Freq: " << frequency << " MHz");
-  packet->AddPacketTag (tag);
 
   LoraTxParameters params;
   params.sf = GetSfFromDataRate (dataRate);
@@ -76,18 +75,13 @@ GatewayLoraMac::Send (Ptr<Packet> packet)
   params.crcEnabled = 1;
   params.lowDataRateOptimizationEnabled = 0;
 
-  // Get the duration
-  Time duration = m_phy->GetOnAirTime (packet, params);
-
-  NS_LOG_DEBUG ("Duration: " << duration.GetSeconds ());
-
   // Find the channel with the desired frequency
   double sendingPower = m_channelHelper.GetTxPowerForChannel
       (CreateObject<LogicalLoraChannel> (frequency));
 
   // Add the event to the channelHelper to keep track of duty cycle
-  m_channelHelper.AddEvent (duration, CreateObject<LogicalLoraChannel>
-                              (frequency));
+  m_channelHelper.AddEvent (packet->GetSize (), params,
+                            CreateObject<LogicalLoraChannel> (frequency));
 
   // Send the packet to the PHY layer to send it on the channel
   m_phy->Send (packet, params, frequency, sendingPower);
@@ -100,7 +94,8 @@ GatewayLoraMac::IsTransmitting (void)
 }
 
 void
-GatewayLoraMac::Receive (Ptr<Packet const> packet)
+GatewayLoraMac::Receive (Ptr<Packet const> packet,
+                         const LoraRxParameters &rxParams)
 {
   NS_LOG_FUNCTION (this << packet);
 
@@ -113,6 +108,14 @@ GatewayLoraMac::Receive (Ptr<Packet const> packet)
 
   if (macHdr.IsUplink ())
     {
+      // The network server learns about the reception from the LoraTag, which
+      // travels with the packet on the link to the server
+      LoraTag tag;
+      tag.SetSpreadingFactor (rxParams.sf);
+      tag.SetReceivePower (rxParams.rxPowerDbm);
+      tag.SetFrequency (rxParams.frequencyMHz);
+      packetCopy->ReplacePacketTag (tag);
+
       m_device->GetObject<LoraNetDevice> ()->Receive (packetCopy);
 
       NS_LOG_DEBUG ("Received packet: " << packet);
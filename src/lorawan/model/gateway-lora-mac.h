@@ -42,7 +42,8 @@ public:
   bool IsTransmitting (void);
 
   // Implementation of the LoraMac interface
-  virtual void Receive (Ptr<Packet const> packet);
+  virtual void Receive (Ptr<Packet const> packet,
+                        const LoraRxParameters &rxParams);
 
   // Implementation of the LoraMac interface
   virtual void FailedReception (Ptr<Packet const> packet);
@@ -130,6 +130,13 @@ GatewayLoraPhy::GetTypeId (void)
                      MakeTraceSourceAccessor
                        (&GatewayLoraPhy::m_noMoreDemodulators),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("SignalArrival",
+                     "Trace source indicating a signal started "
+                     "arriving at the gateway, with its power, "
+                     "spreading factor, duration and frequency",
+                     MakeTraceSourceAccessor
+                       (&GatewayLoraPhy::m_signalArrival),
+                     "ns3::lorawan::GatewayLoraPhy::SignalArrivalTracedCallback")
     .AddTraceSource ("OccupiedReceptionPaths",
                      "Number of currently occupied reception paths",
                      MakeTraceSourceAccessor
@@ -159,6 +166,7 @@ GatewayLoraPhy::AddReceptionPath (double frequencyMHz)
 {
   NS_LOG_FUNCTION (this << frequencyMHz);
 
+  m_availableReceptionPaths[frequencyMHz].push_back (m_receptionPaths.size ());
   m_receptionPaths.push_back (Create<GatewayLoraPhy::ReceptionPath>
                                 (frequencyMHz));
 }
@@ -169,6 +177,57 @@ GatewayLoraPhy::ResetReceptionPaths (void)
   NS_LOG_FUNCTION (this);
 
   m_receptionPaths.clear ();
+  m_availableReceptionPaths.clear ();
+}
+
+bool
+GatewayLoraPhy::IsReceptionPathAvailable (double frequencyMHz)
+{
+  auto it = m_availableReceptionPaths.find (frequencyMHz);
+  return it != m_availableReceptionPaths.end () && !it->second.empty ();
+}
+
+Ptr<GatewayLoraPhy::ReceptionPath>
+GatewayLoraPhy::LockReceptionPath (Ptr<LoraInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  auto it = m_availableReceptionPaths.find (event->GetFrequency ());
+  if (it == m_availableReceptionPaths.end () || it->second.empty ())
+    {
+      return 0;
+    }
+
+  uint32_t index = it->second.back ();
+  it->second.pop_back ();
+
+  Ptr<ReceptionPath> path = m_receptionPaths[index];
+  path->LockOnEvent (event);
+  event->SetReceptionPath (index);
+  m_occupiedReceptionPaths++;
+
+  return path;
+}
+
+void
+GatewayLoraPhy::FreeReceptionPath (Ptr<LoraInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  uint32_t index = event->GetReceptionPath ();
+
+  // The paths may have been reset since the event was locked on
+  if (index >= m_receptionPaths.size ()
+      || m_receptionPaths[index]->GetEvent () != event)
+    {
+      return;
+    }
+
+  Ptr<ReceptionPath> path = m_receptionPaths[index];
+  path->Free ();
+  event->SetReceptionPath (LoraInterferenceHelper::Event::NO_RECEPTION_PATH);
+  m_availableReceptionPaths[path->GetFrequency ()].push_back (index);
+  m_occupiedReceptionPaths--;
 }
 
 void
@@ -188,23 +247,9 @@ GatewayLoraPhy::IsOnFrequency (double frequencyMHz)
 {
   NS_LOG_FUNCTION (this << frequencyMHz);
 
-  // Search every demodulator to see whether there's one listening on this
-  // frequency.
-  std::list< Ptr< GatewayLoraPhy::ReceptionPath > >::iterator it;
-
-  for (it = m_receptionPaths.begin (); it != m_receptionPaths.end (); ++it)
-    {
-      Ptr<GatewayLoraPhy::ReceptionPath> currentPath = *it;
-
-      NS_LOG_DEBUG ("Current reception path is on frequency " <<
-                    currentPath->GetFrequency ());
-
-      if (currentPath->GetFrequency () == frequencyMHz)
-        {
-          return true;
-        }
-    }
-  return false;
+  // There is an entry for every frequency a demodulator is listening on
+  return m_availableReceptionPaths.find (frequencyMHz)
+         != m_availableReceptionPaths.end ();
 }
 }
 }
@@ -28,7 +28,8 @@
 #include "ns3/node.h"
 #include "ns3/lora-phy.h"
 #include "ns3/traced-value.h"
-#include <list>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 namespace lorawan {
@@ -53,6 +54,19 @@ public:
   GatewayLoraPhy ();
   virtual ~GatewayLoraPhy ();
 
+  /**
+   * TracedCallback signature for the arrival of a signal at a gateway.
+   *
+   * \param packet The packet carried by the signal.
+   * \param rxPowerDbm The power of the signal at the gateway.
+   * \param sf The Spreading Factor of the signal.
+   * \param duration The duration of the signal.
+   * \param frequencyMHz The frequency of the signal.
+   */
+  typedef void (* SignalArrivalTracedCallback)
+    (Ptr<const Packet> packet, double rxPowerDbm, uint8_t sf, Time duration,
+    double frequencyMHz);
+
   virtual void StartReceive (Ptr<Packet> packet, double rxPowerDbm, uint8_t sf,
                              Time duration, double frequencyMHz) = 0;
 
@@ -197,10 +211,44 @@ private:
   };
 
   /**
-   * A list containing the various parallel receivers that are managed by this
-   * Gateway.
+   * Check whether a reception path listening on a frequency is available.
+   *
+   * \param frequencyMHz The frequency of interest.
+   * \return True if a free path is listening on frequencyMHz.
+   */
+  bool IsReceptionPathAvailable (double frequencyMHz);
+
+  /**
+   * Lock an available reception path listening on the event's frequency.
+   *
+   * The index of the path is stored in the event, so that the path can be
+   * freed without searching for it.
+   *
+   * \param event The event to lock the path on.
+   * \return The locked path, or 0 if no path is available.
+   */
+  Ptr<ReceptionPath> LockReceptionPath (Ptr<LoraInterferenceHelper::Event>
+                                        event);
+
+  /**
+   * Free the reception path locked on an event, if any.
+   *
+   * \param event The event the path is locked on.
+   */
+  void FreeReceptionPath (Ptr<LoraInterferenceHelper::Event> event);
+
+  /**
+   * A vector containing the various parallel receivers that are managed by
+   * this Gateway.
+   */
+  std::vector<Ptr<ReceptionPath> > m_receptionPaths;
+
+  /**
+   * The indexes in m_receptionPaths of the available reception paths, by
+   * frequency. All frequencies with a reception path have an entry, even if
+   * no path is currently available on them.
    */
-  std::list<Ptr<ReceptionPath> > m_receptionPaths;
+  std::unordered_map<double, std::vector<uint32_t> > m_availableReceptionPaths;
 
   /**
    * The number of occupied reception paths.
@@ -223,6 +271,14 @@ private:
    */
   TracedCallback<Ptr<const Packet>, uint32_t> m_noReceptionBecauseTransmitting;
 
+  /**
+   * Trace source that is fired when a signal starts arriving at the gateway,
+   * whatever the outcome of its reception.
+   *
+   * \see SignalArrivalTracedCallback
+   */
+  TracedCallback<Ptr<const Packet>, double, uint8_t, Time, double> m_signalArrival;
+
   bool m_isTransmitting; //!< Flag indicating whether a transmission is going on
 };
 
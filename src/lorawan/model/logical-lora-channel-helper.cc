@@ -39,6 +39,7 @@ LogicalLoraChannelHelper::GetTypeId (void)
 }
 
 LogicalLoraChannelHelper::LogicalLoraChannelHelper () :
+  m_plan (Create<ChannelPlan> ()),
   m_nextAggregatedTransmissionTime (Seconds (0)),
   m_aggregatedDutyCycle (1)
 {
@@ -50,18 +51,27 @@ LogicalLoraChannelHelper::~LogicalLoraChannelHelper ()
   NS_LOG_FUNCTION (this);
 }
 
+const uint8_t LogicalLoraChannelHelper::MAX_CHANNELS;
+
+Ptr<LogicalLoraChannelHelper::ChannelPlan>
+LogicalLoraChannelHelper::GetPrivatePlan (void)
+{
+  // Copy on write: the plan we are using belongs to other helpers, too
+  if (m_plan->GetReferenceCount () > 1)
+    {
+      NS_LOG_DEBUG ("Making a private copy of the channel plan");
+      m_plan = Create<ChannelPlan> (*m_plan);
+    }
+  return m_plan;
+}
+
 std::vector<Ptr <LogicalLoraChannel> >
 LogicalLoraChannelHelper::GetChannelList (void)
 {
   NS_LOG_FUNCTION (this);
 
   // Make a copy of the channel vector
-  std::vector<Ptr<LogicalLoraChannel> > vector;
-  vector.reserve (m_channelList.size ());
-  std::copy (m_channelList.begin (), m_channelList.end (), std::back_inserter
-               (vector));
-
-  return vector;
+  return m_plan->channels;
 }
 
 
@@ -70,19 +80,12 @@ LogicalLoraChannelHelper::GetEnabledChannelList (void)
 {
   NS_LOG_FUNCTION (this);
 
-  // Make a copy of the channel vector
-  std::vector<Ptr<LogicalLoraChannel> > vector;
-  vector.reserve (m_channelList.size ());
-  std::copy (m_channelList.begin (), m_channelList.end (), std::back_inserter
-               (vector));     // Working on a copy
-
   std::vector<Ptr <LogicalLoraChannel> > channels;
-  std::vector<Ptr <LogicalLoraChannel> >::iterator it;
-  for (it = vector.begin (); it != vector.end (); it++)
+  for (uint32_t i = 0; i < m_plan->channels.size (); i++)
     {
-      if ((*it)->IsEnabledForUplink ())
+      if (m_enabledChannels.test (i))
         {
-          channels.push_back (*it);
+          channels.push_back (m_plan->channels[i]);
         }
     }
 
@@ -98,20 +101,32 @@ LogicalLoraChannelHelper::GetSubBandFromChannel (Ptr<LogicalLoraChannel>
 
 Ptr<SubBand>
 LogicalLoraChannelHelper::GetSubBandFromFrequency (double frequency)
+{
+  int index = GetSubBandIndex (frequency);
+
+  if (index < 0)
+    {
+      NS_LOG_ERROR ("Warning: frequency is outside any known SubBand.");
+
+      return 0;     // If no SubBand is found, return 0
+    }
+
+  return m_plan->subBands[index];
+}
+
+int
+LogicalLoraChannelHelper::GetSubBandIndex (double frequency) const
 {
   // Get the SubBand this frequency belongs to
-  std::list< Ptr< SubBand > >::iterator it;
-  for (it = m_subBandList.begin (); it != m_subBandList.end (); it++)
+  for (uint32_t i = 0; i < m_plan->subBands.size (); i++)
     {
-      if ((*it)->BelongsToSubBand (frequency))
+      if (m_plan->subBands[i]->BelongsToSubBand (frequency))
         {
-          return *it;
+          return i;
         }
     }
 
-  NS_LOG_ERROR ("Warning: frequency is outside any known SubBand.");
-
-  return 0;     // If no SubBand is found, return 0
+  return -1;
 }
 
 void
@@ -119,14 +134,11 @@ LogicalLoraChannelHelper::AddChannel (double frequency)
 {
   NS_LOG_FUNCTION (this << frequency);
 
-  // Create the new channel and increment the counter
-  Ptr<LogicalLoraChannel> channel = Create<LogicalLoraChannel> (frequency);
-
-  // Add it to the list
-  m_channelList.push_back (channel);
+  // Create the new channel and add it to the list
+  AddChannel (Create<LogicalLoraChannel> (frequency));
 
   NS_LOG_DEBUG ("Added a channel. Current number of channels in list is " <<
-                m_channelList.size ());
+                m_plan->channels.size ());
 }
 
 void
@@ -134,8 +146,14 @@ LogicalLoraChannelHelper::AddChannel (Ptr<LogicalLoraChannel> logicalChannel)
 {
   NS_LOG_FUNCTION (this << logicalChannel);
 
+  NS_ABORT_MSG_IF (m_plan->channels.size () >= MAX_CHANNELS,
+                   "Cannot add more than " << unsigned (MAX_CHANNELS) <<
+                   " channels");
+
   // Add it to the list
-  m_channelList.push_back (logicalChannel);
+  m_enabledChannels.set (m_plan->channels.size (),
+                         logicalChannel->IsEnabledForUplink ());
+  GetPrivatePlan ()->channels.push_back (logicalChannel);
 }
 
 void
@@ -145,7 +163,18 @@ LogicalLoraChannelHelper::SetChannel (uint8_t chIndex,
 {
   NS_LOG_FUNCTION (this << chIndex << logicalChannel);
 
-  m_channelList.at (chIndex) = logicalChannel;
+  Ptr<LogicalLoraChannel> current = m_plan->channels.at (chIndex);
+  m_enabledChannels.set (chIndex, logicalChannel->IsEnabledForUplink ());
+
+  // Keep sharing the plan if the channel doesn't actually change
+  if (current->GetFrequency () == logicalChannel->GetFrequency ()
+      && current->GetMinimumDataRate () == logicalChannel->GetMinimumDataRate ()
+      && current->GetMaximumDataRate () == logicalChannel->GetMaximumDataRate ())
+    {
+      return;
+    }
+
+  GetPrivatePlan ()->channels.at (chIndex) = logicalChannel;
 }
 
 void
@@ -158,7 +187,7 @@ LogicalLoraChannelHelper::AddSubBand (double firstFrequency,
   Ptr<SubBand> subBand = Create<SubBand> (firstFrequency, lastFrequency,
                                           dutyCycle, maxTxPowerDbm);
 
-  m_subBandList.push_back (subBand);
+  GetPrivatePlan ()->subBands.push_back (subBand);
 }
 
 void
@@ -166,20 +195,28 @@ LogicalLoraChannelHelper::AddSubBand (Ptr<SubBand> subBand)
 {
   NS_LOG_FUNCTION (this << subBand);
 
-  m_subBandList.push_back (subBand);
+  GetPrivatePlan ()->subBands.push_back (subBand);
 }
 
 void
 LogicalLoraChannelHelper::RemoveChannel (Ptr<LogicalLoraChannel> logicalChannel)
 {
   // Search and remove the channel from the list
-  std::vector<Ptr<LogicalLoraChannel> >::iterator it;
-  for (it = m_channelList.begin (); it != m_channelList.end (); it++)
+  for (uint32_t i = 0; i < m_plan->channels.size (); i++)
     {
-      Ptr<LogicalLoraChannel> currentChannel = *it;
-      if (currentChannel == logicalChannel)
+      if (m_plan->channels[i] == logicalChannel)
         {
-          m_channelList.erase (it);
+          std::vector<Ptr<LogicalLoraChannel> > &channels =
+            GetPrivatePlan ()->channels;
+
+          // Channels after the removed one move back by one position
+          for (uint32_t j = i; j + 1 < channels.size (); j++)
+            {
+              m_enabledChannels.set (j, m_enabledChannels.test (j + 1));
+            }
+          m_enabledChannels.reset (channels.size () - 1);
+
+          channels.erase (channels.begin () + i);
           return;
         }
     }
@@ -205,10 +242,16 @@ LogicalLoraChannelHelper::GetWaitingTime (Ptr<LogicalLoraChannel> channel)
 {
   NS_LOG_FUNCTION (this << channel);
 
+  int index = GetSubBandIndex (channel->GetFrequency ());
+  NS_ABORT_MSG_IF (index < 0, "Logical channel doesn't belong to a known SubBand");
+
   // SubBand waiting time
-  Time subBandWaitingTime = GetSubBandFromChannel (channel)->
-    GetNextTransmissionTime () -
-    Simulator::Now ();
+  Time nextTransmissionTime = Seconds (0);
+  if (uint32_t (index) < m_nextTransmissionTimes.size ())
+    {
+      nextTransmissionTime = m_nextTransmissionTimes[index];
+    }
+  Time subBandWaitingTime = nextTransmissionTime - Simulator::Now ();
 
   // Handle case in which waiting time is negative
   subBandWaitingTime = Seconds (std::max (subBandWaitingTime.GetSeconds (),
@@ -225,14 +268,19 @@ LogicalLoraChannelHelper::AddEvent (Time duration,
 {
   NS_LOG_FUNCTION (this << duration << channel);
 
-  Ptr<SubBand> subBand = GetSubBandFromChannel (channel);
+  int index = GetSubBandIndex (channel->GetFrequency ());
+  NS_ABORT_MSG_IF (index < 0, "Logical channel doesn't belong to a known SubBand");
 
-  double dutyCycle = subBand->GetDutyCycle ();
+  double dutyCycle = m_plan->subBands[index]->GetDutyCycle ();
   double timeOnAir = duration.GetSeconds ();
 
   // Computation of necessary waiting time on this sub-band
-  subBand->SetNextTransmissionTime (Simulator::Now () + Seconds
-                                      (timeOnAir / dutyCycle - timeOnAir));
+  if (uint32_t (index) >= m_nextTransmissionTimes.size ())
+    {
+      m_nextTransmissionTimes.resize (m_plan->subBands.size (), Seconds (0));
+    }
+  m_nextTransmissionTimes[index] = Simulator::Now () + Seconds
+      (timeOnAir / dutyCycle - timeOnAir);
 
   // Computation of necessary aggregate waiting time
   m_nextAggregatedTransmissionTime = Simulator::Now () + Seconds
@@ -242,11 +290,21 @@ LogicalLoraChannelHelper::AddEvent (Time duration,
   NS_LOG_DEBUG ("m_aggregatedDutyCycle: " << m_aggregatedDutyCycle);
   NS_LOG_DEBUG ("Current time: " << Simulator::Now ().GetSeconds ());
   NS_LOG_DEBUG ("Next transmission on this sub-band allowed at time: " <<
-                (subBand->GetNextTransmissionTime ()).GetSeconds ());
+                m_nextTransmissionTimes[index].GetSeconds ());
   NS_LOG_DEBUG ("Next aggregated transmission allowed at time " <<
                 m_nextAggregatedTransmissionTime.GetSeconds ());
 }
 
+void
+LogicalLoraChannelHelper::AddEvent (uint32_t payloadSize,
+                                    LoraTxParameters txParams,
+                                    Ptr<LogicalLoraChannel> channel)
+{
+  NS_LOG_FUNCTION (this << payloadSize << txParams << channel);
+
+  AddEvent (LoraPhy::GetOnAirTime (payloadSize, txParams), channel);
+}
+
 double
 LogicalLoraChannelHelper::GetTxPowerForChannel (Ptr<LogicalLoraChannel>
                                                 logicalChannel)
@@ -254,18 +312,10 @@ LogicalLoraChannelHelper::GetTxPowerForChannel (Ptr<LogicalLoraChannel>
   NS_LOG_FUNCTION_NOARGS ();
 
   // Get the maxTxPowerDbm from the SubBand this channel is in
-  std::list< Ptr< SubBand > >::iterator it;
-  for (it = m_subBandList.begin (); it != m_subBandList.end (); it++)
-    {
-      // Check whether this channel is in this SubBand
-      if ((*it)->BelongsToSubBand (logicalChannel->GetFrequency ()))
-        {
-          return (*it)->GetMaxTxPowerDbm ();
-        }
-    }
-  NS_ABORT_MSG ("Logical channel doesn't belong to a known SubBand");
+  int index = GetSubBandIndex (logicalChannel->GetFrequency ());
+  NS_ABORT_MSG_IF (index < 0, "Logical channel doesn't belong to a known SubBand");
 
-  return 0;
+  return m_plan->subBands[index]->GetMaxTxPowerDbm ();
 }
 
 void
@@ -273,7 +323,25 @@ LogicalLoraChannelHelper::DisableChannel (int index)
 {
   NS_LOG_FUNCTION (this << index);
 
-  m_channelList.at (index)->DisableForUplink ();
+  NS_ASSERT (uint32_t (index) < m_plan->channels.size ());
+
+  m_enabledChannels.reset (index);
+}
+
+void
+LogicalLoraChannelHelper::EnableChannel (int index)
+{
+  NS_LOG_FUNCTION (this << index);
+
+  NS_ASSERT (uint32_t (index) < m_plan->channels.size ());
+
+  m_enabledChannels.set (index);
+}
+
+bool
+LogicalLoraChannelHelper::IsChannelEnabled (int index) const
+{
+  return m_enabledChannels.test (index);
 }
 }
 }
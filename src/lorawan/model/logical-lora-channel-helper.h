@@ -23,10 +23,12 @@
 
 #include "ns3/object.h"
 #include "ns3/logical-lora-channel.h"
+#include "ns3/lora-phy.h"
 #include "ns3/nstime.h"
 #include "ns3/packet.h"
 #include "ns3/sub-band.h"
-#include <list>
+#include "ns3/simple-ref-count.h"
+#include <bitset>
 #include <iterator>
 #include <vector>
 
@@ -38,9 +40,18 @@ namespace lorawan {
  * channels that the device is supposed to be using, and establishes their
  * relationship with SubBands.
  *
- * This class also takes into account duty cycle limitations, by updating a list
- * of SubBand objects and providing methods to query whether transmission on a
- * set channel is admissible or not.
+ * This class also takes into account duty cycle limitations, by keeping track
+ * of the next time transmission is allowed on each SubBand and providing
+ * methods to query whether transmission on a set channel is admissible or not.
+ *
+ * The channels and SubBands (i.e., the regional channel plan) are shared by all
+ * copies of a helper, and are never modified once they are shared: a helper
+ * gets a private copy of the plan only when a channel or SubBand is added,
+ * set or removed. The state of each device is limited to the mask of the
+ * channels that are enabled for uplink and to the duty cycle timers. For this
+ * reason, the LogicalLoraChannel and SubBand objects returned by this class
+ * must not be modified: channels should be enabled and disabled through
+ * EnableChannel and DisableChannel.
  */
 class LogicalLoraChannelHelper : public Object
 {
@@ -80,6 +91,17 @@ public:
    */
   void AddEvent (Time duration, Ptr<LogicalLoraChannel> channel);
 
+  /**
+   * Register the transmission of a payload, whose duration is computed from
+   * its size and transmission parameters.
+   *
+   * \param payloadSize The size of the PHY payload [bytes].
+   * \param txParams The parameters of the transmission.
+   * \param channel The channel the transmission was made on.
+   */
+  void AddEvent (uint32_t payloadSize, LoraTxParameters txParams,
+                 Ptr<LogicalLoraChannel> channel);
+
   /**
    * Get the list of LogicalLoraChannels currently registered on this helper.
    *
@@ -175,18 +197,76 @@ public:
    */
   void DisableChannel (int index);
 
+  /**
+   * Enable the channel at a specified index for uplink transmission.
+   *
+   * \param index The index of the channel to enable.
+   */
+  void EnableChannel (int index);
+
+  /**
+   * Check whether the channel at a specified index is enabled for uplink
+   * transmission.
+   *
+   * \param index The index of the channel to check.
+   * \return Whether the channel is enabled.
+   */
+  bool IsChannelEnabled (int index) const;
+
+  /**
+   * The maximum number of channels a helper can manage.
+   */
+  static const uint8_t MAX_CHANNELS = 96;
+
 private:
   /**
-   * A list of the SubBands that are currently registered within this helper.
+   * The channels and SubBands of a regional plan.
+   */
+  struct ChannelPlan : public SimpleRefCount<ChannelPlan>
+  {
+    /**
+     * The SubBands that are currently registered within this plan.
+     */
+    std::vector<Ptr<SubBand> > subBands;
+
+    /**
+     * The LogicalLoraChannels that are currently registered within this plan.
+     * The first N channels are the default ones for a fixed region.
+     */
+    std::vector<Ptr<LogicalLoraChannel> > channels;
+  };
+
+  /**
+   * Get a plan that can be modified by this helper, copying the current one
+   * if it is shared with other helpers.
+   *
+   * \return The plan owned by this helper.
+   */
+  Ptr<ChannelPlan> GetPrivatePlan (void);
+
+  /**
+   * Get the index of the SubBand a frequency belongs to.
+   *
+   * \param frequency The frequency we want to check.
+   * \return The index of the SubBand in the plan, or -1 if the frequency is
+   * outside any known SubBand.
+   */
+  int GetSubBandIndex (double frequency) const;
+
+  Ptr<ChannelPlan> m_plan; //!< The plan, possibly shared with other helpers
+
+  /**
+   * The mask of the channels that are enabled for uplink transmission, where
+   * bit i refers to the i-th channel of the plan.
    */
-  std::list<Ptr <SubBand> > m_subBandList;
+  std::bitset<MAX_CHANNELS> m_enabledChannels;
 
   /**
-   * A vector of the LogicalLoraChannels that are currently registered within
-   * this helper. This vector represents the node's channel mask. The first N
-   * channels are the default ones for a fixed region.
+   * The next time at which transmission will be possible on each SubBand of
+   * the plan, according to its duty cycle. SubBands without an entry have no
+   * restriction.
    */
-  std::vector<Ptr <LogicalLoraChannel> > m_channelList;
+  std::vector<Time> m_nextTransmissionTimes;
 
   Time m_nextAggregatedTransmissionTime; //!< The next time at which
   //!transmission will be possible
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/lora-background-traffic.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+namespace lorawan {
+
+NS_LOG_COMPONENT_DEFINE ("LoraBackgroundTraffic");
+
+NS_OBJECT_ENSURE_REGISTERED (LoraBackgroundTraffic);
+
+TypeId
+LoraBackgroundTraffic::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LoraBackgroundTraffic")
+    .SetParent<Object> ()
+    .SetGroupName ("lorawan")
+    .AddConstructor<LoraBackgroundTraffic> ();
+  return tid;
+}
+
+LoraBackgroundTraffic::LoraBackgroundTraffic () :
+  m_nInjectedSignals (0)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_interArrival = CreateObject<ExponentialRandomVariable> ();
+  m_interArrival->SetAttribute ("Mean", DoubleValue (1));
+  m_sampleChoice = CreateObject<UniformRandomVariable> ();
+}
+
+LoraBackgroundTraffic::~LoraBackgroundTraffic ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LoraBackgroundTraffic::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Stop ();
+  m_processes.clear ();
+  m_phy = 0;
+
+  Object::DoDispose ();
+}
+
+void
+LoraBackgroundTraffic::SetPhy (Ptr<LoraPhy> phy)
+{
+  m_phy = phy;
+}
+
+void
+LoraBackgroundTraffic::AddProcess (double frequencyMHz, uint8_t sf,
+                                   double rate,
+                                   const std::vector<Sample> &samples)
+{
+  NS_LOG_FUNCTION (this << frequencyMHz << unsigned (sf) << rate);
+
+  NS_ASSERT (rate > 0);
+  NS_ASSERT (!samples.empty ());
+
+  Process process;
+  process.frequencyMHz = frequencyMHz;
+  process.sf = sf;
+  process.rate = rate;
+  process.samples = samples;
+  m_processes.push_back (process);
+}
+
+void
+LoraBackgroundTraffic::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ABORT_MSG_IF (m_phy == 0, "No PHY to inject background traffic in");
+
+  for (uint32_t i = 0; i < m_processes.size (); i++)
+    {
+      if (!m_processes[i].arrival.IsRunning ())
+        {
+          ScheduleArrival (i);
+        }
+    }
+}
+
+void
+LoraBackgroundTraffic::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (auto it = m_processes.begin (); it != m_processes.end (); ++it)
+    {
+      Simulator::Cancel (it->arrival);
+    }
+}
+
+uint64_t
+LoraBackgroundTraffic::GetNInjectedSignals (void) const
+{
+  return m_nInjectedSignals;
+}
+
+int64_t
+LoraBackgroundTraffic::AssignStreams (int64_t stream)
+{
+  m_interArrival->SetStream (stream);
+  m_sampleChoice->SetStream (stream + 1);
+  return 2;
+}
+
+void
+LoraBackgroundTraffic::ScheduleArrival (uint32_t index)
+{
+  Process &process = m_processes[index];
+  Time delay = Seconds (m_interArrival->GetValue () / process.rate);
+  process.arrival = Simulator::Schedule (delay, &LoraBackgroundTraffic::Arrival,
+                                         this, index);
+}
+
+void
+LoraBackgroundTraffic::Arrival (uint32_t index)
+{
+  const Process &process = m_processes[index];
+  const Sample &sample = process.samples[m_sampleChoice->GetInteger
+                                           (0, process.samples.size () - 1)];
+
+  NS_LOG_DEBUG ("Injecting a signal at " << process.frequencyMHz << " MHz, SF"
+                << unsigned (process.sf) << ", " << sample.first << " dBm");
+
+  m_phy->AddInterference (sample.first, process.sf, sample.second,
+                          process.frequencyMHz);
+  m_nInjectedSignals++;
+
+  ScheduleArrival (index);
+}
+
+}
+}
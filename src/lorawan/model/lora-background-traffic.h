@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LORA_BACKGROUND_TRAFFIC_H
+#define LORA_BACKGROUND_TRAFFIC_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/lora-phy.h"
+
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * Injects the signals of devices that are not simulated explicitly in the
+ * interference computations of a PHY layer.
+ *
+ * The load is described by a set of independent Poisson processes, one for
+ * each (frequency, spreading factor) pair. The power and duration of each
+ * signal are drawn from a list of samples, which is usually collected in a
+ * short simulation of the whole population of devices (see
+ * LoraBackgroundTrafficHelper). Injected signals go straight to the
+ * LoraInterferenceHelper of the PHY: they can destroy the packets they
+ * overlap with, but they never occupy a reception path.
+ */
+class LoraBackgroundTraffic : public Object
+{
+public:
+  /**
+   * A sample of a signal, made of its power in dBm and its duration.
+   */
+  typedef std::pair<double, Time> Sample;
+
+  static TypeId GetTypeId (void);
+
+  LoraBackgroundTraffic ();
+  virtual ~LoraBackgroundTraffic ();
+
+  /**
+   * Set the PHY layer the signals are injected in.
+   */
+  void SetPhy (Ptr<LoraPhy> phy);
+
+  /**
+   * Add an arrival process of signals.
+   *
+   * \param frequencyMHz The frequency of the signals.
+   * \param sf The spreading factor of the signals.
+   * \param rate The mean number of signals per second.
+   * \param samples The power and duration of signals, among which the ones
+   * of injected signals are drawn uniformly.
+   */
+  void AddProcess (double frequencyMHz, uint8_t sf, double rate,
+                   const std::vector<Sample> &samples);
+
+  /**
+   * Start injecting signals.
+   */
+  void Start (void);
+
+  /**
+   * Stop injecting signals.
+   */
+  void Stop (void);
+
+  /**
+   * Get the number of signals that were injected so far.
+   */
+  uint64_t GetNInjectedSignals (void) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this object.
+   *
+   * \param stream The first stream index to use.
+   * \return The number of stream indexes assigned.
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * An arrival process of signals.
+   */
+  struct Process
+  {
+    double frequencyMHz;
+    uint8_t sf;
+    double rate;
+    std::vector<Sample> samples;
+    EventId arrival; //!< The next arrival of this process
+  };
+
+  /**
+   * Schedule the next arrival of a process.
+   */
+  void ScheduleArrival (uint32_t index);
+
+  /**
+   * Inject a signal of a process, and schedule the next one.
+   */
+  void Arrival (uint32_t index);
+
+  Ptr<LoraPhy> m_phy; //!< The PHY signals are injected in
+  std::vector<Process> m_processes; //!< The arrival processes
+  uint64_t m_nInjectedSignals; //!< The number of signals injected so far
+
+  Ptr<ExponentialRandomVariable> m_interArrival; //!< Unit-mean inter-arrival times
+  Ptr<UniformRandomVariable> m_sampleChoice; //!< Used to pick a sample
+};
+
+}
+}
+#endif /* LORA_BACKGROUND_TRAFFIC_H */
@@ -21,12 +21,25 @@
 #include "ns3/lora-channel.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/object-factory.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/end-device-lora-phy.h"
 #include "ns3/gateway-lora-phy.h"
+#include "ns3/building-penetration-loss.h"
+#include "ns3/correlated-shadowing-propagation-loss-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/lora-profiler.h"
+#include "ns3/lora-remote-transmission-header.h"
+#include "ns3/constant-position-mobility-model.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace ns3 {
 namespace lorawan {
@@ -52,6 +65,43 @@ LoraChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&LoraChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "The maximum distance [m] at which transmissions are "
+                   "delivered. If positive, PHYs are kept in a grid based on "
+                   "their position and Send only visits the ones in range. "
+                   "A value of 0 disables this feature.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&LoraChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MinRxPower",
+                   "The minimum power [dBm] a transmission needs to have at a "
+                   "PHY in order to be delivered to it",
+                   DoubleValue (-std::numeric_limits<double>::max ()),
+                   MakeDoubleAccessor (&LoraChannel::m_minRxPowerDbm),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("OnlyListeningPhys",
+                   "Whether to only deliver transmissions to PHYs that are "
+                   "listening, i.e., gateways and end devices in the STANDBY "
+                   "or RX states",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::m_onlyListening),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SeparateIqPolarity",
+                   "Whether to deliver uplink transmissions only to gateways "
+                   "and downlink transmissions only to end devices, like the "
+                   "inverted IQ polarity of downlinks does in real devices",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::m_separateIqPolarity),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CacheLinkBudgets",
+                   "Whether to compute the received power and delay of each "
+                   "link only once, until one of its ends moves. This only "
+                   "has an effect if the loss and delay models are known to "
+                   "be deterministic, or have their random components frozen "
+                   "for each link (see LoraChannel::IsLinkBudgetCacheable).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::m_cacheLinkBudgets),
+                   MakeBooleanChecker ())
     .AddTraceSource ("PacketSent",
                      "Trace source fired whenever a packet goes out on the channel",
                      MakeTraceSourceAccessor (&LoraChannel::m_packetSent),
@@ -59,7 +109,14 @@ LoraChannel::GetTypeId (void)
   return tid;
 }
 
-LoraChannel::LoraChannel ()
+LoraChannel::LoraChannel () :
+  m_maxRange (0),
+  m_minRxPowerDbm (-std::numeric_limits<double>::max ()),
+  m_onlyListening (false),
+  m_separateIqPolarity (false),
+  m_cacheLinkBudgets (false),
+  m_spatialIndexValid (false),
+  m_hasRemotePhys (false)
 {
 }
 
@@ -71,17 +128,72 @@ LoraChannel::~LoraChannel ()
 LoraChannel::LoraChannel (Ptr<PropagationLossModel> loss,
                           Ptr<PropagationDelayModel> delay) :
   m_loss (loss),
-  m_delay (delay)
+  m_delay (delay),
+  m_maxRange (0),
+  m_minRxPowerDbm (-std::numeric_limits<double>::max ()),
+  m_onlyListening (false),
+  m_separateIqPolarity (false),
+  m_cacheLinkBudgets (false),
+  m_spatialIndexValid (false),
+  m_hasRemotePhys (false)
 {
 }
 
+void
+LoraChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Stop listening for position changes
+  for (auto it = m_mobilityPhys.begin (); it != m_mobilityPhys.end (); ++it)
+    {
+      it->first->TraceDisconnectWithoutContext
+        ("CourseChange", MakeCallback (&LoraChannel::CourseChanged, this));
+    }
+  m_mobilityPhys.clear ();
+  m_grid.clear ();
+  m_phyCells.clear ();
+  m_linkBudgets.clear ();
+  m_linkBudgetLossChain.clear ();
+  m_linkBudgetDelay = 0;
+  m_spatialIndexValid = false;
+
+  Channel::DoDispose ();
+}
+
 void
 LoraChannel::Add (Ptr<LoraPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
 
   // Add the new phy to the vector
+  uint32_t index = m_phyList.size ();
   m_phyList.push_back (phy);
+  m_phyIndexes[phy] = index;
+
+  // Gateways are always listening, while end devices only listen when they
+  // are in the STANDBY or RX states
+  bool isGateway = (DynamicCast<GatewayLoraPhy> (phy) != 0);
+  bool isListening = true;
+  Ptr<EndDeviceLoraPhy> edPhy = DynamicCast<EndDeviceLoraPhy> (phy);
+  if (edPhy != 0)
+    {
+      isListening = (edPhy->GetState () == EndDeviceLoraPhy::STANDBY
+                     || edPhy->GetState () == EndDeviceLoraPhy::RX);
+    }
+  m_phyIsGateway.push_back (isGateway);
+  m_phyIsListening.push_back (isListening);
+  if (isListening)
+    {
+      m_listeningPhys.insert (index);
+    }
+  if (isGateway)
+    {
+      m_gatewayPhys.push_back (index);
+    }
+
+  // The spatial index will need to take this PHY into account
+  m_spatialIndexValid = false;
 }
 
 void
@@ -90,7 +202,70 @@ LoraChannel::Remove (Ptr<LoraPhy> phy)
   NS_LOG_FUNCTION (this << phy);
 
   // Remove the phy from the vector
-  m_phyList.erase (find (m_phyList.begin (), m_phyList.end (), phy));
+  auto it = m_phyIndexes.find (phy);
+  NS_ASSERT (it != m_phyIndexes.end ());
+  uint32_t index = it->second;
+  m_phyList.erase (m_phyList.begin () + index);
+  m_phyIsGateway.erase (m_phyIsGateway.begin () + index);
+  m_phyIsListening.erase (m_phyIsListening.begin () + index);
+
+  // Indexes in m_phyList changed, so all structures referring to them need to
+  // be rebuilt
+  RebuildPhyIndexes ();
+  m_spatialIndexValid = false;
+  m_phyIsRemote.clear ();
+}
+
+void
+LoraChannel::RebuildPhyIndexes (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_phyIndexes.clear ();
+  m_listeningPhys.clear ();
+  m_gatewayPhys.clear ();
+
+  for (uint32_t j = 0; j < m_phyList.size (); j++)
+    {
+      m_phyIndexes[m_phyList[j]] = j;
+      if (m_phyIsListening[j])
+        {
+          m_listeningPhys.insert (j);
+        }
+      if (m_phyIsGateway[j])
+        {
+          m_gatewayPhys.push_back (j);
+        }
+    }
+}
+
+void
+LoraChannel::SetListening (Ptr<LoraPhy> phy, bool listening)
+{
+  NS_LOG_FUNCTION (this << phy << listening);
+
+  auto it = m_phyIndexes.find (phy);
+  if (it == m_phyIndexes.end ())
+    {
+      // The PHY was not added to this channel (yet)
+      return;
+    }
+
+  uint32_t index = it->second;
+  if (m_phyIsListening[index] == listening || m_phyIsGateway[index])
+    {
+      return;
+    }
+
+  m_phyIsListening[index] = listening;
+  if (listening)
+    {
+      m_listeningPhys.insert (index);
+    }
+  else
+    {
+      m_listeningPhys.erase (index);
+    }
 }
 
 std::size_t
@@ -113,41 +288,258 @@ LoraChannel::Send (Ptr< LoraPhy > sender, Ptr< Packet > packet,
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << txParams <<
                    duration << frequencyMHz);
 
+  LoraProfiler::Scope profilerScope (LoraProfiler::CHANNEL_SEND);
+
   // Get the mobility model of the sender
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
 
   NS_ASSERT (senderMobility != 0);     // Make sure it's available
 
+  // Uplinks are sent by end devices, downlinks by gateways
+  bool isDownlink = (DynamicCast<GatewayLoraPhy> (sender) != 0);
+
+  Deliver (sender, senderMobility, isDownlink, packet, txPowerDbm, txParams.sf,
+           duration, frequencyMHz, Seconds (0));
+
+#ifdef NS3_MPI
+  // Other partitions deliver the transmission to their own PHYs
+  if (!m_remotePartitions.empty ())
+    {
+      LoraRemoteTransmissionHeader header;
+      header.SetSenderPosition (senderMobility->GetPosition ());
+      header.SetTxPower (txPowerDbm);
+      header.SetSpreadingFactor (txParams.sf);
+      header.SetFrequency (frequencyMHz);
+      header.SetDuration (duration);
+      header.SetTxTime (Simulator::Now ());
+      header.SetDownlink (isDownlink);
+      Ptr<Packet> message = packet->Copy ();
+      message->AddHeader (header);
+
+      for (auto it = m_remotePartitions.begin ();
+           it != m_remotePartitions.end (); ++it)
+        {
+          MpiInterface::SendPacket (message, Simulator::Now () + it->lookAhead,
+                                    it->node, it->device);
+        }
+    }
+#endif
+}
+
+void
+LoraChannel::AddRemotePartition (uint32_t node, uint32_t device,
+                                 Time lookAhead)
+{
+  NS_LOG_FUNCTION (this << node << device << lookAhead);
+
+#ifndef NS3_MPI
+  NS_FATAL_ERROR ("Distributed simulations need ns-3 to be configured with "
+                  "--enable-mpi");
+#endif
+  CheckDistributedModels ();
+
+  RemotePartition partition;
+  partition.node = node;
+  partition.device = device;
+  partition.lookAhead = lookAhead;
+  m_remotePartitions.push_back (partition);
+}
+
+void
+LoraChannel::ReceiveRemote (Ptr<Packet> message)
+{
+  NS_LOG_FUNCTION (this << message);
+
+  LoraRemoteTransmissionHeader header;
+  message->RemoveHeader (header);
+
+  // The models may have been changed after the partitions were connected
+  CheckDistributedModels ();
+
+  if (m_remoteSenderMobility == 0)
+    {
+      m_remoteSenderMobility = CreateObject<ConstantPositionMobilityModel> ();
+    }
+  m_remoteSenderMobility->SetPosition (header.GetSenderPosition ());
+
+  Deliver (0, m_remoteSenderMobility, header.IsDownlink (), message,
+           header.GetTxPower (), header.GetSpreadingFactor (),
+           header.GetDuration (), header.GetFrequency (),
+           Simulator::Now () - header.GetTxTime ());
+}
+
+void
+LoraChannel::CheckDistributedModels (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  // Remote senders are replayed through a single mobility model that only
+  // knows their position. Loss models that also depend on other aggregated
+  // objects, keep state for each mobility model or draw random numbers
+  // would give results that differ from those of a single process.
+  NS_ABORT_MSG_UNLESS (IsRxPowerThreadSafe (),
+                       "Distributed simulations only support propagation loss "
+                       "models that are deterministic functions of positions");
+  NS_ABORT_MSG_UNLESS (DynamicCast<ConstantSpeedPropagationDelayModel> (m_delay) != 0,
+                       "Distributed simulations only support a "
+                       "ConstantSpeedPropagationDelayModel");
+}
+
+void
+LoraChannel::UpdateRemotePhys (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef NS3_MPI
+  uint32_t systemId = MpiInterface::GetSystemId ();
+#else
+  uint32_t systemId = 0;
+#endif
+
+  m_phyIsRemote.assign (m_phyList.size (), false);
+  m_hasRemotePhys = false;
+  for (uint32_t j = 0; j < m_phyList.size (); j++)
+    {
+      Ptr<NetDevice> device = m_phyList[j]->GetDevice ();
+      if (device != 0 && device->GetNode ()->GetSystemId () != systemId)
+        {
+          m_phyIsRemote[j] = true;
+          m_hasRemotePhys = true;
+        }
+    }
+}
+
+void
+LoraChannel::Deliver (Ptr<LoraPhy> sender, Ptr<MobilityModel> senderMobility,
+                      bool isDownlink, Ptr<Packet> packet, double txPowerDbm,
+                      uint8_t sf, Time duration, double frequencyMHz,
+                      Time elapsed) const
+{
+  NS_LOG_FUNCTION (this << sender << packet << elapsed);
+
   NS_LOG_INFO ("Starting cycle over all " << m_phyList.size () << " PHYs");
   NS_LOG_INFO ("Sender mobility: " << senderMobility->GetPosition ());
 
-  // Cycle over all registered PHYs
-  uint32_t j = 0;
-  std::vector<Ptr<LoraPhy> >::const_iterator i;
-  for (i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  // PHYs of nodes that belong to other partitions are simulated by other
+  // processes. PHYs get their device after being added, so look for them
+  // at the first transmission after an Add.
+  if (m_phyIsRemote.size () != m_phyList.size ())
+    {
+      UpdateRemotePhys ();
+    }
+
+  // Check whether we can use cached link budgets for this sender
+  bool useLinkBudgetCache = false;
+  uint32_t senderIndex = 0;
+  if (m_cacheLinkBudgets)
     {
-      // Do not deliver to the sender (*i is the current PHY)
-      if (sender != (*i))
+      if (!m_spatialIndexValid)
         {
+          BuildSpatialIndex ();
+        }
+      auto senderIt = m_phyIndexes.find (sender);
+      if (UpdateLinkBudgetCache () && sender != 0
+          && senderIt != m_phyIndexes.end ())
+        {
+          useLinkBudgetCache = true;
+          senderIndex = senderIt->second;
+        }
+    }
+
+  // If the spatial index is enabled, only consider PHYs that are in range.
+  // Otherwise, start from the smallest set of PHYs that can be interested in
+  // this transmission.
+  std::vector<uint32_t> candidates;
+  if (m_maxRange > 0)
+    {
+      GetPhysInRange (senderMobility->GetPosition (), candidates);
+      NS_LOG_INFO (candidates.size () << " PHYs are in range of the sender");
+    }
+  else if (m_separateIqPolarity && !isDownlink)
+    {
+      candidates = m_gatewayPhys;
+    }
+  else if (m_onlyListening)
+    {
+      candidates.assign (m_listeningPhys.begin (), m_listeningPhys.end ());
+    }
+  else
+    {
+      candidates.resize (m_phyList.size ());
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          candidates[j] = j;
+        }
+    }
+
+  std::vector<uint32_t>::const_iterator i;
+  for (i = candidates.begin (); i != candidates.end (); i++)
+    {
+      uint32_t j = *i;
+
+      // Do not deliver to PHYs that are not listening, if so configured
+      if (m_onlyListening && !m_phyIsListening[j])
+        {
+          continue;
+        }
+
+      // Uplinks only reach gateways, and downlinks only reach end devices
+      if (m_separateIqPolarity && m_phyIsGateway[j] == isDownlink)
+        {
+          continue;
+        }
+
+      // Do not deliver to the sender
+      if (sender != m_phyList[j])
+        {
+          if (m_hasRemotePhys && m_phyIsRemote[j])
+            {
+              continue;
+            }
+
           // Get the receiver's mobility model
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->
+          Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ()->
             GetObject<MobilityModel> ();
 
           NS_LOG_INFO ("Receiver mobility: " <<
                        receiverMobility->GetPosition ());
 
-          // Compute delay using the delay model
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+          Time delay;
+          double rxPowerDbm;
+          if (useLinkBudgetCache)
+            {
+              GetLinkBudget (senderIndex, j, txPowerDbm, senderMobility,
+                             receiverMobility, rxPowerDbm, delay);
+            }
+          else
+            {
+              // Compute delay using the delay model
+              delay = m_delay->GetDelay (senderMobility, receiverMobility);
+
+              // Compute received power using the loss model
+              rxPowerDbm = GetRxPower (txPowerDbm, senderMobility,
+                                       receiverMobility);
+            }
 
-          // Compute received power using the loss model
-          double rxPowerDbm = GetRxPower (txPowerDbm, senderMobility,
-                                          receiverMobility);
+          // Transmissions from other partitions reach us after some time
+          delay -= elapsed;
+          NS_ABORT_MSG_IF (delay.IsStrictlyNegative (),
+                           "A remote transmission arrived after its "
+                           "propagation delay, the look ahead is too large");
 
           NS_LOG_DEBUG ("Propagation: txPower=" << txPowerDbm <<
                         "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) <<
                         "m, delay=" << delay);
 
+          // Do not deliver transmissions that are too weak to matter
+          if (rxPowerDbm < m_minRxPowerDbm)
+            {
+              NS_LOG_INFO ("Not delivering, received power is below " <<
+                           m_minRxPowerDbm << " dBm");
+              continue;
+            }
+
           // Get the id of the destination PHY to correctly format the context
           Ptr<NetDevice> dstNetDevice = m_phyList[j]->GetDevice ();
           uint32_t dstNode = 0;
@@ -165,7 +557,7 @@ LoraChannel::Send (Ptr< LoraPhy > sender, Ptr< Packet > packet,
           // Create the parameters object based on the calculations above
           LoraChannelParameters parameters;
           parameters.rxPowerDbm = rxPowerDbm;
-          parameters.sf = txParams.sf;
+          parameters.sf = sf;
           parameters.duration = duration;
           parameters.frequencyMHz = frequencyMHz;
 
@@ -198,6 +590,290 @@ LoraChannel::GetRxPower (double txPowerDbm, Ptr<MobilityModel> senderMobility,
   return m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
 }
 
+LoraChannel::GridCell
+LoraChannel::GetGridCell (Vector position) const
+{
+  return GridCell (static_cast<int32_t> (std::floor (position.x / m_maxRange)),
+                   static_cast<int32_t> (std::floor (position.y / m_maxRange)));
+}
+
+void
+LoraChannel::BuildSpatialIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  m_grid.clear ();
+  m_phyCells.resize (m_phyList.size ());
+  m_linkBudgets.clear ();
+  m_phyPositionVersions.assign (m_phyList.size (), 0);
+
+  std::map<Ptr<MobilityModel>, std::vector<uint32_t> > oldMobilityPhys;
+  oldMobilityPhys.swap (m_mobilityPhys);
+
+  for (uint32_t j = 0; j < m_phyList.size (); j++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[j]->GetMobility ();
+      NS_ASSERT (mobility != 0);
+
+      if (m_maxRange > 0)
+        {
+          GridCell cell = GetGridCell (mobility->GetPosition ());
+          m_grid[cell].push_back (j);
+          m_phyCells[j] = cell;
+        }
+      m_mobilityPhys[mobility].push_back (j);
+    }
+
+  // Only connect to the mobility models we were not already tracking, and
+  // disconnect from the ones that are no longer used by any PHY
+  for (auto it = m_mobilityPhys.begin (); it != m_mobilityPhys.end (); ++it)
+    {
+      if (oldMobilityPhys.erase (it->first) == 0)
+        {
+          it->first->TraceConnectWithoutContext
+            ("CourseChange", MakeCallback (&LoraChannel::CourseChanged, this));
+        }
+    }
+  for (auto it = oldMobilityPhys.begin (); it != oldMobilityPhys.end (); ++it)
+    {
+      it->first->TraceDisconnectWithoutContext
+        ("CourseChange", MakeCallback (&LoraChannel::CourseChanged, this));
+    }
+
+  m_spatialIndexValid = true;
+}
+
+void
+LoraChannel::CourseChanged (Ptr<const MobilityModel> mobility) const
+{
+  NS_LOG_FUNCTION (this << mobility);
+
+  if (!m_spatialIndexValid)
+    {
+      // The index will be rebuilt with up to date positions anyway
+      return;
+    }
+
+  auto mobilityIt = m_mobilityPhys.find (ConstCast<MobilityModel> (mobility));
+  if (mobilityIt == m_mobilityPhys.end ())
+    {
+      return;
+    }
+
+  // Invalidate the cached link budgets of the PHYs using this mobility model
+  for (auto it = mobilityIt->second.begin (); it != mobilityIt->second.end ();
+       ++it)
+    {
+      m_phyPositionVersions[*it]++;
+    }
+
+  if (m_maxRange <= 0)
+    {
+      return;
+    }
+
+  GridCell newCell = GetGridCell (mobility->GetPosition ());
+
+  for (auto it = mobilityIt->second.begin (); it != mobilityIt->second.end ();
+       ++it)
+    {
+      uint32_t j = *it;
+      if (m_phyCells[j] == newCell)
+        {
+          continue;
+        }
+
+      NS_LOG_DEBUG ("Moving PHY " << j << " to cell (" << newCell.first <<
+                    ", " << newCell.second << ")");
+
+      // Remove the PHY from its old cell
+      std::vector<uint32_t> &oldCellPhys = m_grid[m_phyCells[j]];
+      oldCellPhys.erase (std::find (oldCellPhys.begin (), oldCellPhys.end (), j));
+      if (oldCellPhys.empty ())
+        {
+          m_grid.erase (m_phyCells[j]);
+        }
+
+      // Add it to the new one
+      m_grid[newCell].push_back (j);
+      m_phyCells[j] = newCell;
+    }
+}
+
+bool
+LoraChannel::IsLinkBudgetCacheable (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (DynamicCast<ConstantSpeedPropagationDelayModel> (m_delay) == 0)
+    {
+      NS_LOG_DEBUG ("Not caching link budgets: " <<
+                    m_delay->GetInstanceTypeId ().GetName () <<
+                    " is not known to be deterministic");
+      return false;
+    }
+
+  for (Ptr<PropagationLossModel> model = m_loss; model != 0;
+       model = model->GetNext ())
+    {
+      Ptr<BuildingPenetrationLoss> penetrationLoss =
+        DynamicCast<BuildingPenetrationLoss> (model);
+      if (penetrationLoss != 0 && penetrationLoss->IsFrozenPerLink ())
+        {
+          continue;
+        }
+
+      if (DynamicCast<LogDistancePropagationLossModel> (model) == 0
+          && DynamicCast<ThreeLogDistancePropagationLossModel> (model) == 0
+          && DynamicCast<FriisPropagationLossModel> (model) == 0
+          && DynamicCast<TwoRayGroundPropagationLossModel> (model) == 0
+          && DynamicCast<FixedRssLossModel> (model) == 0
+          && DynamicCast<RangePropagationLossModel> (model) == 0
+          && DynamicCast<CorrelatedShadowingPropagationLossModel> (model) == 0)
+        {
+          NS_LOG_DEBUG ("Not caching link budgets: " <<
+                        model->GetInstanceTypeId ().GetName () <<
+                        " is not known to be deterministic");
+          return false;
+        }
+    }
+
+  return true;
+}
+
+bool
+LoraChannel::UpdateLinkBudgetCache (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  // Check whether the models changed since the cached values were computed
+  bool changed = m_delay != m_linkBudgetDelay;
+  std::size_t n = 0;
+  for (Ptr<PropagationLossModel> model = m_loss; model != 0 && !changed;
+       model = model->GetNext (), n++)
+    {
+      changed = n >= m_linkBudgetLossChain.size ()
+        || m_linkBudgetLossChain[n] != model;
+    }
+  changed = changed || n != m_linkBudgetLossChain.size ();
+
+  if (changed)
+    {
+      NS_LOG_DEBUG ("The propagation models changed, emptying the link budget cache");
+      m_linkBudgets.clear ();
+      m_linkBudgetDelay = m_delay;
+      m_linkBudgetLossChain.clear ();
+      for (Ptr<PropagationLossModel> model = m_loss; model != 0;
+           model = model->GetNext ())
+        {
+          m_linkBudgetLossChain.push_back (model);
+        }
+    }
+
+  return IsLinkBudgetCacheable ();
+}
+
+bool
+LoraChannel::IsRxPowerThreadSafe (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  for (Ptr<PropagationLossModel> model = m_loss; model != 0;
+       model = model->GetNext ())
+    {
+      if (DynamicCast<LogDistancePropagationLossModel> (model) == 0
+          && DynamicCast<ThreeLogDistancePropagationLossModel> (model) == 0
+          && DynamicCast<FriisPropagationLossModel> (model) == 0
+          && DynamicCast<TwoRayGroundPropagationLossModel> (model) == 0
+          && DynamicCast<FixedRssLossModel> (model) == 0
+          && DynamicCast<RangePropagationLossModel> (model) == 0)
+        {
+          NS_LOG_DEBUG (model->GetInstanceTypeId ().GetName () <<
+                        " may not be thread-safe");
+          return false;
+        }
+    }
+
+  return true;
+}
+
+void
+LoraChannel::GetLinkBudget (uint32_t senderIndex, uint32_t receiverIndex,
+                            double txPowerDbm,
+                            Ptr<MobilityModel> senderMobility,
+                            Ptr<MobilityModel> receiverMobility,
+                            double &rxPowerDbm, Time &delay) const
+{
+  NS_LOG_FUNCTION (this << senderIndex << receiverIndex << txPowerDbm);
+
+  std::pair<uint32_t, uint32_t> link (senderIndex, receiverIndex);
+  uint32_t senderVersion = m_phyPositionVersions[senderIndex];
+  uint32_t receiverVersion = m_phyPositionVersions[receiverIndex];
+
+  auto it = m_linkBudgets.find (link);
+  if (it != m_linkBudgets.end ()
+      && it->second.senderVersion == senderVersion
+      && it->second.receiverVersion == receiverVersion
+      && it->second.txPowerDbm == txPowerDbm)
+    {
+      NS_LOG_DEBUG ("Using cached link budget");
+      rxPowerDbm = it->second.rxPowerDbm;
+      delay = it->second.delay;
+      return;
+    }
+
+  delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  rxPowerDbm = GetRxPower (txPowerDbm, senderMobility, receiverMobility);
+
+  LinkBudget &linkBudget = m_linkBudgets[link];
+  linkBudget.senderVersion = senderVersion;
+  linkBudget.receiverVersion = receiverVersion;
+  linkBudget.txPowerDbm = txPowerDbm;
+  linkBudget.rxPowerDbm = rxPowerDbm;
+  linkBudget.delay = delay;
+}
+
+void
+LoraChannel::GetPhysInRange (Vector position,
+                             std::vector<uint32_t> &candidates) const
+{
+  NS_LOG_FUNCTION (this << position);
+
+  if (!m_spatialIndexValid)
+    {
+      BuildSpatialIndex ();
+    }
+
+  // Since cells have side m_maxRange, all PHYs in range are either in the
+  // sender's cell or in one of the eight surrounding ones.
+  GridCell center = GetGridCell (position);
+  for (int32_t dx = -1; dx <= 1; dx++)
+    {
+      for (int32_t dy = -1; dy <= 1; dy++)
+        {
+          auto cellIt = m_grid.find (GridCell (center.first + dx,
+                                               center.second + dy));
+          if (cellIt == m_grid.end ())
+            {
+              continue;
+            }
+
+          for (auto it = cellIt->second.begin (); it != cellIt->second.end ();
+               ++it)
+            {
+              Vector receiverPosition = m_phyList[*it]->GetMobility ()->
+                GetPosition ();
+              if (CalculateDistance (position, receiverPosition) <= m_maxRange)
+                {
+                  candidates.push_back (*it);
+                }
+            }
+        }
+    }
+
+  std::sort (candidates.begin (), candidates.end ());
+}
+
 std::ostream &operator << (std::ostream &os, const LoraChannelParameters &params)
 {
   os << "(rxPowerDbm: " << params.rxPowerDbm << ", SF: " << unsigned(params.sf) <<
@@ -25,6 +25,8 @@
 #define LORA_CHANNEL_H
 
 #include <vector>
+#include <map>
+#include <set>
 #include "ns3/lora-phy.h"
 #include "ns3/mobility-model.h"
 #include "ns3/channel.h"
@@ -114,6 +116,19 @@ public:
     */
   void Remove (Ptr<LoraPhy> phy);
 
+  /**
+    * Register or unregister a PHY as currently listening.
+    *
+    * Gateway PHYs are always considered to be listening, while end device
+    * PHYs notify the channel when they switch to and from the STANDBY and RX
+    * states. If the OnlyListeningPhys attribute is set, transmissions are
+    * only delivered to PHYs that are listening.
+    *
+    * \param phy The PHY whose listening state changed.
+    * \param listening Whether the PHY is now listening.
+    */
+  void SetListening (Ptr<LoraPhy> phy, bool listening);
+
   /**
     * Send a packet in the channel.
     *
@@ -153,7 +168,181 @@ public:
   double GetRxPower (double txPowerDbm, Ptr<MobilityModel> senderMobility,
                      Ptr<MobilityModel> receiverMobility) const;
 
+  /**
+   * Check whether GetRxPower can be called by multiple threads at the same
+   * time.
+   *
+   * This is only true if all loss models in the chain are known to compute
+   * their values without drawing random numbers or storing state.
+   *
+   * \return True if GetRxPower is thread-safe.
+   */
+  bool IsRxPowerThreadSafe (void) const;
+
+  /**
+   * Forward the transmissions of local PHYs to a partition of a distributed
+   * simulation that is run by another process.
+   *
+   * Each partition needs a device whose MpiReceiver passes the received
+   * messages to ReceiveRemote (see LoraPartitionHelper).
+   *
+   * Remote senders are only known by their position, so the simulation aborts
+   * unless the propagation loss models are deterministic functions of
+   * positions (see IsRxPowerThreadSafe), and the delay model is a
+   * ConstantSpeedPropagationDelayModel. This rules out, e.g., random and
+   * building-aware loss models. ns-3 must be configured with --enable-mpi.
+   *
+   * \param node The id of a node of the remote partition.
+   * \param device The index of the device of that node that receives
+   * transmissions.
+   * \param lookAhead The time after which the remote partition receives the
+   * message, which can't be larger than the propagation delay between any
+   * local PHY and any remote one.
+   */
+  void AddRemotePartition (uint32_t node, uint32_t device, Time lookAhead);
+
+  /**
+   * Deliver a transmission forwarded by another partition to the local PHYs.
+   *
+   * \param message The PHY packet, preceded by a LoraRemoteTransmissionHeader.
+   */
+  void ReceiveRemote (Ptr<Packet> message);
+
+protected:
+  virtual void DoDispose (void);
+
 private:
+  /**
+   * Rebuild the structures that refer to PHYs through their index in
+   * m_phyList.
+   */
+  void RebuildPhyIndexes (void);
+
+  /**
+   * Abort if the propagation models can't be used in a distributed
+   * simulation (see AddRemotePartition).
+   */
+  void CheckDistributedModels (void) const;
+
+  /**
+   * Find the PHYs that belong to nodes simulated by other processes.
+   */
+  void UpdateRemotePhys (void) const;
+
+  /**
+   * Schedule the reception of a transmission at the local PHYs that are
+   * interested in it.
+   *
+   * \param sender The PHY that sent the transmission, or 0 if it belongs to
+   * another partition.
+   * \param senderMobility The mobility model of the sender.
+   * \param isDownlink Whether the sender is a gateway.
+   * \param packet The PHY layer packet.
+   * \param txPowerDbm The power of the transmission.
+   * \param sf The spreading factor of the transmission.
+   * \param duration The on-air duration of the transmission.
+   * \param frequencyMHz The frequency of the transmission.
+   * \param elapsed The time since the transmission started, which is
+   * subtracted from propagation delays.
+   */
+  void Deliver (Ptr<LoraPhy> sender, Ptr<MobilityModel> senderMobility,
+                bool isDownlink, Ptr<Packet> packet, double txPowerDbm,
+                uint8_t sf, Time duration, double frequencyMHz, Time elapsed)
+  const;
+
+  /**
+   * Index of a cell of the uniform grid used to cull receivers in Send.
+   */
+  typedef std::pair<int32_t, int32_t> GridCell;
+
+  /**
+   * Compute the grid cell a position falls into.
+   *
+   * \param position The position to map to a cell.
+   * \return The cell containing the position.
+   */
+  GridCell GetGridCell (Vector position) const;
+
+  /**
+   * Rebuild the spatial index from scratch, based on the current positions of
+   * all connected PHYs, and start tracking their position changes.
+   *
+   * This is done lazily at the first Send after a PHY is added or removed,
+   * since at Add time the PHY may not be connected to a node yet. Since PHY
+   * indexes may have changed, this also empties the link budget cache.
+   */
+  void BuildSpatialIndex (void) const;
+
+  /**
+   * Move the PHYs using a mobility model to the grid cell corresponding to
+   * their new position, and invalidate their cached link budgets.
+   *
+   * This method is connected to the CourseChange trace source of the mobility
+   * models of all the PHYs in the spatial index.
+   *
+   * \param mobility The mobility model whose position changed.
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility) const;
+
+  /**
+   * Check whether the loss and delay models always return the same values for
+   * the same pair of positions, so that link budgets can be cached.
+   *
+   * This is only true if the delay model is a
+   * ConstantSpeedPropagationDelayModel, and all loss models in the chain are
+   * known to be deterministic functions of positions, or are configured to
+   * keep their random components frozen for each link (see
+   * BuildingPenetrationLoss's FrozenPerLink attribute). Unknown models
+   * disable the cache.
+   *
+   * \return True if link budgets can be cached.
+   */
+  bool IsLinkBudgetCacheable (void) const;
+
+  /**
+   * Empty the link budget cache if the loss or delay models were replaced
+   * since the cached values were computed, and check whether the current
+   * models allow link budgets to be cached.
+   *
+   * This is done at every Send, so that changes to the chain of loss models
+   * are taken into account. Changes to the attributes of the models are not
+   * detected.
+   *
+   * \return True if link budgets can be cached.
+   */
+  bool UpdateLinkBudgetCache (void) const;
+
+  /**
+   * Get the received power and delay of a transmission between two PHYs,
+   * using the cached values if the PHYs did not move since they were
+   * computed.
+   *
+   * \param senderIndex The index of the sender in m_phyList.
+   * \param receiverIndex The index of the receiver in m_phyList.
+   * \param txPowerDbm The transmission power.
+   * \param senderMobility The mobility model of the sender.
+   * \param receiverMobility The mobility model of the receiver.
+   * \param rxPowerDbm The received power [dBm] is stored here.
+   * \param delay The propagation delay is stored here.
+   */
+  void GetLinkBudget (uint32_t senderIndex, uint32_t receiverIndex,
+                      double txPowerDbm, Ptr<MobilityModel> senderMobility,
+                      Ptr<MobilityModel> receiverMobility, double &rxPowerDbm,
+                      Time &delay) const;
+
+  /**
+   * Fill a vector with the indexes of the PHYs that are within m_maxRange of
+   * a position.
+   *
+   * The indexes are returned in increasing order, so that reception events
+   * are scheduled in the same order as with a full scan of m_phyList.
+   *
+   * \param position The position of the transmitter.
+   * \param candidates The vector to fill with PHY indexes.
+   */
+  void GetPhysInRange (Vector position, std::vector<uint32_t> &candidates)
+  const;
+
   /**
     * Private method that is scheduled by LoraChannel's Send method to happen
     * after the channel delay, for each of the connected PHY layers.
@@ -192,6 +381,146 @@ private:
    */
   TracedCallback<Ptr<const Packet> > m_packetSent;
 
+  /**
+   * The maximum distance [m] at which a transmission is delivered to a PHY.
+   *
+   * A value of 0 disables the spatial index, and makes Send visit every PHY.
+   */
+  double m_maxRange;
+
+  /**
+   * The minimum power [dBm] a transmission needs to have at a PHY to be
+   * delivered to it.
+   */
+  double m_minRxPowerDbm;
+
+  /**
+   * Whether to only deliver transmissions to PHYs that are listening.
+   */
+  bool m_onlyListening;
+
+  /**
+   * Whether to model the IQ polarity inversion of downlink transmissions, by
+   * never delivering uplinks to end devices and downlinks to gateways.
+   */
+  bool m_separateIqPolarity;
+
+  /**
+   * The index of each PHY in m_phyList.
+   */
+  std::map<Ptr<LoraPhy>, uint32_t> m_phyIndexes;
+
+  /**
+   * Whether each PHY (indexed like m_phyList) belongs to a gateway.
+   */
+  std::vector<bool> m_phyIsGateway;
+
+  /**
+   * Whether each PHY (indexed like m_phyList) is currently listening.
+   */
+  std::vector<bool> m_phyIsListening;
+
+  /**
+   * The indexes of the PHYs that are currently listening.
+   */
+  std::set<uint32_t> m_listeningPhys;
+
+  /**
+   * The indexes of the gateway PHYs, in increasing order.
+   */
+  std::vector<uint32_t> m_gatewayPhys;
+
+  /**
+   * Whether to cache the received power and delay of each link.
+   */
+  bool m_cacheLinkBudgets;
+
+  /**
+   * The propagation results of a link, together with the position versions of
+   * its ends at the time they were computed.
+   */
+  struct LinkBudget
+  {
+    uint32_t senderVersion; //!< The position version of the sender
+    uint32_t receiverVersion; //!< The position version of the receiver
+    double txPowerDbm; //!< The transmission power used in the computation
+    double rxPowerDbm; //!< The resulting received power
+    Time delay; //!< The propagation delay
+  };
+
+  /**
+   * The cached link budgets, indexed by (sender, receiver) indexes in
+   * m_phyList.
+   */
+  mutable std::map<std::pair<uint32_t, uint32_t>, LinkBudget> m_linkBudgets;
+
+  /**
+   * For each PHY (indexed like m_phyList), a counter that is incremented
+   * every time its position changes, invalidating its cached link budgets.
+   */
+  mutable std::vector<uint32_t> m_phyPositionVersions;
+
+  /**
+   * The chain of loss models the cached link budgets were computed with.
+   */
+  mutable std::vector<Ptr<PropagationLossModel> > m_linkBudgetLossChain;
+
+  /**
+   * The delay model the cached link budgets were computed with.
+   */
+  mutable Ptr<PropagationDelayModel> m_linkBudgetDelay;
+
+  /**
+   * Whether m_grid reflects the current content of m_phyList.
+   */
+  mutable bool m_spatialIndexValid;
+
+  /**
+   * The uniform grid of cells of side m_maxRange, each holding the indexes
+   * (in m_phyList) of the PHYs that are currently inside it.
+   */
+  mutable std::map<GridCell, std::vector<uint32_t> > m_grid;
+
+  /**
+   * The cell each PHY (indexed like m_phyList) currently belongs to.
+   */
+  mutable std::vector<GridCell> m_phyCells;
+
+  /**
+   * The indexes of the PHYs using each mobility model we are tracking.
+   */
+  mutable std::map<Ptr<MobilityModel>, std::vector<uint32_t> > m_mobilityPhys;
+
+  /**
+   * A partition of a distributed simulation that is run by another process.
+   */
+  struct RemotePartition
+  {
+    uint32_t node; //!< The node receiving transmissions in the partition
+    uint32_t device; //!< The index of its receiving device
+    Time lookAhead; //!< The delay of messages to the partition
+  };
+
+  /**
+   * The partitions local transmissions are forwarded to.
+   */
+  std::vector<RemotePartition> m_remotePartitions;
+
+  /**
+   * The position of the sender of remote transmissions.
+   */
+  Ptr<MobilityModel> m_remoteSenderMobility;
+
+  /**
+   * Whether each PHY (indexed like m_phyList) belongs to a node that is
+   * simulated by another process.
+   */
+  mutable std::vector<bool> m_phyIsRemote;
+
+  /**
+   * Whether any PHY belongs to a node simulated by another process.
+   */
+  mutable bool m_hasRemotePhys;
 };
 
 } /* namespace ns3 */
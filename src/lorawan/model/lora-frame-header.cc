@@ -36,7 +36,9 @@ LoraFrameHeader::LoraFrameHeader () :
   m_ack       (0),
   m_fPending  (0),
   m_fOptsLen  (0),
-  m_fCnt      (0)
+  m_fCnt      (0),
+  m_nCommands (0),
+  m_isUplink  (true)
 {
 }
 
@@ -84,22 +86,18 @@ LoraFrameHeader::Serialize (Buffer::Iterator start) const
 
   // fCtrl field
   uint8_t fCtrl = 0;
-  fCtrl |= uint8_t (m_adr << 6 & 0b1000000);
-  fCtrl |= uint8_t (m_adrAckReq << 5 & 0b100000);
-  fCtrl |= uint8_t (m_ack << 4 & 0b10000);
-  fCtrl |= uint8_t (m_fPending << 3 & 0b1000);
-  fCtrl |= m_fOptsLen & 0b111;
+  fCtrl |= uint8_t (m_adr << 7 & 0b10000000);
+  fCtrl |= uint8_t (m_adrAckReq << 6 & 0b1000000);
+  fCtrl |= uint8_t (m_ack << 5 & 0b100000);
+  fCtrl |= uint8_t (m_fPending << 4 & 0b10000);
+  fCtrl |= m_fOptsLen & 0b1111;
   start.WriteU8 (fCtrl);
 
   // FCnt field
   start.WriteU16 (m_fCnt);
 
   // FOpts field
-  for (auto it = m_macCommands.begin (); it != m_macCommands.end (); it++)
-    {
-      NS_LOG_DEBUG ("Serializing a MAC command");
-      (*it)->Serialize (start);
-    }
+  start.Write (m_fOpts, m_fOptsLen);
 
   // FPort
   start.WriteU8 (m_fPort);
@@ -110,17 +108,14 @@ LoraFrameHeader::Deserialize (Buffer::Iterator start)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  // Empty the list of MAC commands
-  m_macCommands.clear ();
-
   // Read from buffer and save into local variables
   m_address.Set (start.ReadU32 ());
   uint8_t fCtl = start.ReadU8 ();
-  m_adr = (fCtl >> 6) & 0b1;
-  m_adrAckReq = (fCtl >> 5) & 0b1;
-  m_ack = (fCtl >> 4) & 0b1;
-  m_fPending = (fCtl >> 3) & 0b1;
-  m_fOptsLen = fCtl & 0b111;
+  m_adr = (fCtl >> 7) & 0b1;
+  m_adrAckReq = (fCtl >> 6) & 0b1;
+  m_ack = (fCtl >> 5) & 0b1;
+  m_fPending = (fCtl >> 4) & 0b1;
+  m_fOptsLen = fCtl & 0b1111;
   m_fCnt = start.ReadU16 ();
 
   NS_LOG_DEBUG ("Deserialized data: ");
@@ -132,182 +127,34 @@ LoraFrameHeader::Deserialize (Buffer::Iterator start)
   NS_LOG_DEBUG ("fOptsLen: " << unsigned (m_fOptsLen));
   NS_LOG_DEBUG ("fCnt: " << unsigned (m_fCnt));
 
-  // Deserialize MAC commands
-  NS_LOG_DEBUG ("Starting deserialization of MAC commands");
-  for (uint8_t byteNumber = 0; byteNumber < m_fOptsLen;)
+  // Copy the MAC commands, and count the ones that can be parsed. Uplink and
+  // downlink commands have the same CIDs, and the context about where this
+  // message will be Serialized/Deserialized (i.e., at the ED or at the NS) is
+  // important.
+  uint8_t wireFOptsLen = m_fOptsLen;
+  start.Read (m_fOpts, m_fOptsLen);
+  m_nCommands = 0;
+  for (uint8_t byteNumber = 0; byteNumber < wireFOptsLen;)
     {
-      uint8_t cid = start.PeekU8 ();
-      NS_LOG_DEBUG ("CID: " << unsigned(cid));
-
-      // Divide Uplink and Downlink messages
-      // This needs to be done because they have the same CID, and the context
-      // about where this message will be Serialized/Deserialized (i.e., at the
-      // ED or at the NS) is umportant.
-      if (m_isUplink)
-        {
-          switch (cid)
-            {
-            // In the case of Uplink messages, the NS will deserialize the
-            // request for a link check
-            case (0x02):
-              {
-                NS_LOG_DEBUG ("Creating a LinkCheckReq command");
-                Ptr<LinkCheckReq> command = Create <LinkCheckReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x03):
-              {
-                NS_LOG_DEBUG ("Creating a LinkAdrAns command");
-                Ptr<LinkAdrAns> command = Create <LinkAdrAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x04):
-              {
-                NS_LOG_DEBUG ("Creating a DutyCycleAns command");
-                Ptr<DutyCycleAns> command = Create <DutyCycleAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x05):
-              {
-                NS_LOG_DEBUG ("Creating a RxParamSetupAns command");
-                Ptr<RxParamSetupAns> command = Create <RxParamSetupAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x06):
-              {
-                NS_LOG_DEBUG ("Creating a DevStatusAns command");
-                Ptr<DevStatusAns> command = Create <DevStatusAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x07):
-              {
-                NS_LOG_DEBUG ("Creating a NewChannelAns command");
-                Ptr<NewChannelAns> command = Create <NewChannelAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x08):
-              {
-                NS_LOG_DEBUG ("Creating a RxTimingSetupAns command");
-                Ptr<RxTimingSetupAns> command = Create <RxTimingSetupAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x09):
-              {
-                NS_LOG_DEBUG ("Creating a TxParamSetupAns command");
-                Ptr<TxParamSetupAns> command = Create <TxParamSetupAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x0A):
-              {
-                NS_LOG_DEBUG ("Creating a DlChannelAns command");
-                Ptr<DlChannelAns> command = Create <DlChannelAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            default:
-              {
-                NS_LOG_ERROR ("CID not recognized during deserialization");
-              }
-            }
-        }
-      else
+      enum MacCommandType type =
+        MacCommandValue::GetCommandType (m_fOpts[byteNumber], m_isUplink);
+      uint8_t size = MacCommandValue::GetSerializedSize (type);
+      NS_LOG_DEBUG ("CID: " << unsigned (m_fOpts[byteNumber]));
+
+      if (type == INVALID || byteNumber + size > wireFOptsLen)
         {
-          switch (cid)
-            {
-            // In the case of Downlink messages, the ED will deserialize the
-            // answer to a link check
-            case (0x02):
-              {
-                NS_LOG_DEBUG ("Creating a LinkCheckAns command");
-                Ptr<LinkCheckAns> command = Create <LinkCheckAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x03):
-              {
-                NS_LOG_DEBUG ("Creating a LinkAdrReq command");
-                Ptr<LinkAdrReq> command = Create <LinkAdrReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x04):
-              {
-                NS_LOG_DEBUG ("Creating a DutyCycleReq command");
-                Ptr<DutyCycleReq> command = Create <DutyCycleReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x05):
-              {
-                NS_LOG_DEBUG ("Creating a RxParamSetupReq command");
-                Ptr<RxParamSetupReq> command = Create <RxParamSetupReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x06):
-              {
-                NS_LOG_DEBUG ("Creating a DevStatusReq command");
-                Ptr<DevStatusReq> command = Create <DevStatusReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x07):
-              {
-                NS_LOG_DEBUG ("Creating a NewChannelReq command");
-                Ptr<NewChannelReq> command = Create <NewChannelReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x08):
-              {
-                NS_LOG_DEBUG ("Creating a RxTimingSetupReq command");
-                Ptr<RxTimingSetupReq> command = Create <RxTimingSetupReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x09):
-              {
-                NS_LOG_DEBUG ("Creating a TxParamSetupReq command");
-                Ptr<TxParamSetupReq> command = Create <TxParamSetupReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            default:
-              {
-                NS_LOG_ERROR ("CID not recognized during deserialization");
-              }
-            }
+          // Commands after an unknown one can't be delimited
+          NS_LOG_ERROR ("CID not recognized during deserialization");
+          m_fOptsLen = byteNumber;
+          break;
         }
+      byteNumber += size;
+      m_nCommands++;
     }
 
   m_fPort = uint8_t (start.ReadU8 ());
 
-  return 8 + m_fOptsLen;       // the number of bytes consumed.
+  return 8 + wireFOptsLen;       // the number of bytes consumed.
 }
 
 void
@@ -323,9 +170,9 @@ LoraFrameHeader::Print (std::ostream &os) const
   os << "FOptsLen=" << unsigned(m_fOptsLen) << std::endl;
   os << "FCnt=" << unsigned(m_fCnt) << std::endl;
 
-  for (auto it = m_macCommands.begin (); it != m_macCommands.end (); it++)
+  for (uint8_t i = 0; i < m_nCommands; i++)
     {
-      (*it)->Print (os);
+      GetCommand (i).Print (os);
     }
 
   os << "FPort=" << unsigned(m_fPort) << std::endl;
@@ -420,14 +267,7 @@ LoraFrameHeader::GetFPending (void) const
 uint8_t
 LoraFrameHeader::GetFOptsLen (void) const
 {
-  // Sum the serialized lenght of all commands in the list
-  uint8_t fOptsLen = 0;
-  std::list< Ptr< MacCommand> >::const_iterator it;
-  for (it = m_macCommands.begin (); it != m_macCommands.end (); it++)
-    {
-      fOptsLen = fOptsLen + (*it)->GetSerializedSize ();
-    }
-  return fOptsLen;
+  return m_fOptsLen;
 }
 
 void
@@ -447,11 +287,7 @@ LoraFrameHeader::AddLinkCheckReq (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  Ptr<LinkCheckReq> command = Create<LinkCheckReq> ();
-  m_macCommands.push_back (command);
-
-  NS_LOG_DEBUG ("Command SerializedSize: " << unsigned(command->GetSerializedSize ()));
-  m_fOptsLen += command->GetSerializedSize ();
+  AddCommand (MacCommandValue (LINK_CHECK_REQ));
 }
 
 void
@@ -459,10 +295,10 @@ LoraFrameHeader::AddLinkCheckAns (uint8_t margin, uint8_t gwCnt)
 {
   NS_LOG_FUNCTION (this << unsigned(margin) << unsigned(gwCnt));
 
-  Ptr<LinkCheckAns> command = Create<LinkCheckAns> (margin, gwCnt);
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  MacCommandValue command (LINK_CHECK_ANS);
+  command.linkCheckAns.margin = margin;
+  command.linkCheckAns.gwCnt = gwCnt;
+  AddCommand (command);
 }
 
 void
@@ -480,10 +316,12 @@ LoraFrameHeader::AddLinkAdrReq (uint8_t dataRate, uint8_t txPower, std::list<int
 
   // TODO Implement chMaskCntl field
 
-  Ptr<LinkAdrReq> command = Create<LinkAdrReq> (dataRate, txPower, channelMask, 0, repetitions);
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  MacCommandValue command (LINK_ADR_REQ);
+  command.linkAdrReq.dataRate = dataRate;
+  command.linkAdrReq.txPower = txPower;
+  command.linkAdrReq.channelMask = channelMask;
+  command.linkAdrReq.nbRep = repetitions;
+  AddCommand (command);
 }
 
 void
@@ -491,10 +329,11 @@ LoraFrameHeader::AddLinkAdrAns (bool powerAck, bool dataRateAck, bool channelMas
 {
   NS_LOG_FUNCTION (this << powerAck << dataRateAck << channelMaskAck);
 
-  Ptr<LinkAdrAns> command = Create<LinkAdrAns> (powerAck, dataRateAck, channelMaskAck);
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  MacCommandValue command (LINK_ADR_ANS);
+  command.linkAdrAns.powerAck = powerAck;
+  command.linkAdrAns.dataRateAck = dataRateAck;
+  command.linkAdrAns.channelMaskAck = channelMaskAck;
+  AddCommand (command);
 }
 
 void
@@ -502,11 +341,9 @@ LoraFrameHeader::AddDutyCycleReq (uint8_t dutyCycle)
 {
   NS_LOG_FUNCTION (this << unsigned (dutyCycle));
 
-  Ptr<DutyCycleReq> command = Create<DutyCycleReq> (dutyCycle);
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  MacCommandValue command (DUTY_CYCLE_REQ);
+  command.dutyCycleReq.maxDCycle = dutyCycle;
+  AddCommand (command);
 }
 
 void
@@ -514,11 +351,7 @@ LoraFrameHeader::AddDutyCycleAns (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<DutyCycleAns> command = Create<DutyCycleAns> ();
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  AddCommand (MacCommandValue (DUTY_CYCLE_ANS));
 }
 
 void
@@ -530,13 +363,11 @@ LoraFrameHeader::AddRxParamSetupReq (uint8_t rx1DrOffset, uint8_t rx2DataRate, d
   // Evaluate whether to eliminate this assert in case new offsets can be defined.
   NS_ASSERT (0 <= rx1DrOffset && rx1DrOffset <= 5);
 
-  Ptr<RxParamSetupReq> command = Create<RxParamSetupReq> (rx1DrOffset,
-                                                          rx2DataRate,
-                                                          frequency);
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  MacCommandValue command (RX_PARAM_SETUP_REQ);
+  command.rxParamSetupReq.rx1DrOffset = rx1DrOffset;
+  command.rxParamSetupReq.rx2DataRate = rx2DataRate;
+  command.rxParamSetupReq.frequency = frequency;
+  AddCommand (command);
 }
 
 void
@@ -544,11 +375,7 @@ LoraFrameHeader::AddRxParamSetupAns (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<RxParamSetupAns> command = Create<RxParamSetupAns> ();
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  AddCommand (MacCommandValue (RX_PARAM_SETUP_ANS));
 }
 
 void
@@ -556,11 +383,7 @@ LoraFrameHeader::AddDevStatusReq (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<DevStatusReq> command = Create<DevStatusReq> ();
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  AddCommand (MacCommandValue (DEV_STATUS_REQ));
 }
 
 void
@@ -569,12 +392,12 @@ LoraFrameHeader::AddNewChannelReq (uint8_t chIndex, double frequency,
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<NewChannelReq> command = Create<NewChannelReq> (chIndex, frequency,
-                                                      minDataRate, maxDataRate);
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  MacCommandValue command (NEW_CHANNEL_REQ);
+  command.newChannelReq.chIndex = chIndex;
+  command.newChannelReq.frequency = frequency;
+  command.newChannelReq.minDataRate = minDataRate;
+  command.newChannelReq.maxDataRate = maxDataRate;
+  AddCommand (command);
 }
 
 std::list<Ptr<MacCommand> >
@@ -582,7 +405,12 @@ LoraFrameHeader::GetCommands (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  return m_macCommands;
+  std::list<Ptr<MacCommand> > macCommands;
+  for (uint8_t i = 0; i < m_nCommands; i++)
+    {
+      macCommands.push_back (GetCommand (i).CreateMacCommand ());
+    }
+  return macCommands;
 }
 
 void
@@ -590,8 +418,68 @@ LoraFrameHeader::AddCommand (Ptr<MacCommand> macCommand)
 {
   NS_LOG_FUNCTION (this << macCommand);
 
-  m_macCommands.push_back (macCommand);
-  m_fOptsLen += macCommand->GetSerializedSize ();
+  AddCommand (MacCommandValue::FromMacCommand (macCommand));
+}
+
+void
+LoraFrameHeader::AddCommand (const MacCommandValue &command)
+{
+  NS_LOG_FUNCTION (this << command.type);
+
+  uint8_t size = command.GetSerializedSize ();
+  NS_ASSERT (command.type != INVALID);
+  NS_ABORT_MSG_IF (m_fOptsLen + size > MAX_FOPTS_LEN,
+                   "MAC commands don't fit in the " << unsigned (MAX_FOPTS_LEN)
+                   << " bytes of the FOpts field");
+
+  // Commands are parsed according to the direction of the header
+  bool isUplink = MacCommandValue::IsUplink (command.type);
+  NS_ASSERT_MSG (m_nCommands == 0 || isUplink == m_isUplink,
+                 "Uplink and downlink commands can't be mixed");
+  m_isUplink = isUplink;
+
+  NS_LOG_DEBUG ("Command SerializedSize: " << unsigned (size));
+  command.Serialize (m_fOpts + m_fOptsLen);
+  m_fOptsLen += size;
+  m_nCommands++;
+}
+
+uint8_t
+LoraFrameHeader::GetNCommands (void) const
+{
+  return m_nCommands;
+}
+
+MacCommandValue
+LoraFrameHeader::GetCommand (uint8_t index) const
+{
+  NS_ASSERT (index < m_nCommands);
+
+  MacCommandValue command;
+  uint8_t byteNumber = 0;
+  for (uint8_t i = 0; i <= index; i++)
+    {
+      byteNumber += command.Deserialize (m_fOpts + byteNumber, m_isUplink);
+    }
+  return command;
+}
+
+bool
+LoraFrameHeader::FindCommand (enum MacCommandType commandType,
+                              MacCommandValue &command) const
+{
+  for (uint8_t byteNumber = 0; byteNumber < m_fOptsLen;)
+    {
+      enum MacCommandType type =
+        MacCommandValue::GetCommandType (m_fOpts[byteNumber], m_isUplink);
+      if (type == commandType)
+        {
+          command.Deserialize (m_fOpts + byteNumber, m_isUplink);
+          return true;
+        }
+      byteNumber += MacCommandValue::GetSerializedSize (type);
+    }
+  return false;
 }
 
 }
@@ -287,6 +287,9 @@ public:
 
   /**
    * Return a list of pointers to all the MAC commands saved in this header.
+   *
+   * \remark A new MacCommand object is created for each command: use
+   * GetNCommands and GetCommand to read commands without allocations.
    */
   std::list<Ptr<MacCommand> > GetCommands (void);
 
@@ -295,6 +298,44 @@ public:
    */
   void AddCommand (Ptr<MacCommand> macCommand);
 
+  /**
+   * Add a command to the FOpts field.
+   *
+   * The FOpts field can hold up to MAX_FOPTS_LEN bytes of commands.
+   *
+   * \param command The command, whose type can't be INVALID.
+   */
+  void AddCommand (const MacCommandValue &command);
+
+  /**
+   * Get the number of MAC commands in this header.
+   */
+  uint8_t GetNCommands (void) const;
+
+  /**
+   * Get a MAC command of this header.
+   *
+   * Commands are parsed from the FOpts field at each call, so iterating over
+   * all the commands of a header with this method takes quadratic time in
+   * the number of commands, which is at most 15.
+   *
+   * \param index The position of the command, smaller than GetNCommands.
+   * \return The command.
+   */
+  MacCommandValue GetCommand (uint8_t index) const;
+
+  /**
+   * Look for the first MAC command of a type in this header.
+   *
+   * \param commandType The type of command.
+   * \param command Set to the command, if one is found.
+   * \return Whether the header contains a command of this type.
+   */
+  bool FindCommand (enum MacCommandType commandType,
+                    MacCommandValue &command) const;
+
+  static const uint8_t MAX_FOPTS_LEN = 15; //!< The maximum size of FOpts
+
 private:
   uint8_t m_fPort;
 
@@ -308,13 +349,13 @@ private:
 
   uint16_t m_fCnt;
 
-  Buffer m_fOpts;
-
   /**
-   * List containing all the MacCommand instances that are contained in this
-   * LoraFrameHeader.
+   * The serialized MAC commands contained in this LoraFrameHeader, of which
+   * the first m_fOptsLen bytes are used.
    */
-  std::list< Ptr< MacCommand> > m_macCommands;
+  uint8_t m_fOpts[MAX_FOPTS_LEN];
+
+  uint8_t m_nCommands; //!< The number of commands in m_fOpts
 
   bool m_isUplink;
 };
@@ -325,8 +366,9 @@ Ptr<T>
 LoraFrameHeader::GetMacCommand ()
 {
   // Iterate on MAC commands and try casting
+  std::list< Ptr< MacCommand> > macCommands = GetCommands ();
   std::list< Ptr< MacCommand> >::const_iterator it;
-  for (it = m_macCommands.begin (); it != m_macCommands.end (); ++it)
+  for (it = macCommands.begin (); it != macCommands.end (); ++it)
     {
       if ((*it)->GetObject<T> () != 0)
         {
@@ -20,7 +20,11 @@
 
 #include "ns3/lora-interference-helper.h"
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include <limits>
+#include <algorithm>
+#include <cmath>
+#include <new>
 
 namespace ns3 {
 namespace lorawan {
@@ -39,8 +43,10 @@ LoraInterferenceHelper::Event::Event (Time duration, double rxPowerdBm,
   m_endTime (m_startTime + duration),
   m_sf (spreadingFactor),
   m_rxPowerdBm (rxPowerdBm),
+  m_rxPowermW (std::pow (10, rxPowerdBm / 10)),
   m_packet (packet),
-  m_frequencyMHz (frequencyMHz)
+  m_frequencyMHz (frequencyMHz),
+  m_receptionPath (NO_RECEPTION_PATH)
 {
   // NS_LOG_FUNCTION_NOARGS ();
 }
@@ -76,6 +82,12 @@ LoraInterferenceHelper::Event::GetRxPowerdBm (void) const
   return m_rxPowerdBm;
 }
 
+double
+LoraInterferenceHelper::Event::GetRxPowermW (void) const
+{
+  return m_rxPowermW;
+}
+
 uint8_t
 LoraInterferenceHelper::Event::GetSpreadingFactor (void) const
 {
@@ -94,6 +106,20 @@ LoraInterferenceHelper::Event::GetFrequency (void) const
   return m_frequencyMHz;
 }
 
+void
+LoraInterferenceHelper::Event::SetReceptionPath (uint32_t receptionPath)
+{
+  m_receptionPath = receptionPath;
+}
+
+uint32_t
+LoraInterferenceHelper::Event::GetReceptionPath (void) const
+{
+  return m_receptionPath;
+}
+
+const uint32_t LoraInterferenceHelper::Event::NO_RECEPTION_PATH;
+
 void
 LoraInterferenceHelper::Event::Print (std::ostream &stream) const
 {
@@ -109,6 +135,103 @@ std::ostream &operator << (std::ostream &os, const LoraInterferenceHelper::Event
   return os;
 }
 
+/*******************************************
+ *    LoraInterferenceHelper::EventPool    *
+ *******************************************/
+
+// The number of events in the first and in the largest chunks of a pool
+static const uint32_t FIRST_CHUNK_SIZE = 8;
+static const uint32_t MAX_CHUNK_SIZE = 1024;
+
+LoraInterferenceHelper::EventAllocationCounters::EventAllocationCounters () :
+  events (0),
+  reusedEvents (0),
+  chunks (0)
+{
+}
+
+void
+LoraInterferenceHelper::EventDeleter::Delete (Event *event)
+{
+  if (event->m_pool == 0)
+    {
+      delete event;
+      return;
+    }
+
+  // Keep the pool alive until the memory is back in it, since the event might
+  // hold the last reference to it
+  Ptr<EventPool> pool = event->m_pool;
+  event->~Event ();
+  pool->Free (event);
+}
+
+LoraInterferenceHelper::EventPool::EventPool () :
+  m_nextChunkSize (FIRST_CHUNK_SIZE)
+{
+}
+
+LoraInterferenceHelper::EventPool::~EventPool ()
+{
+  // All events were destroyed, since each of them holds a reference to us
+  for (auto it = m_chunks.begin (); it != m_chunks.end (); ++it)
+    {
+      ::operator delete (*it);
+    }
+}
+
+Ptr<LoraInterferenceHelper::Event>
+LoraInterferenceHelper::EventPool::Allocate (Time duration, double rxPowerdBm,
+                                             uint8_t spreadingFactor,
+                                             Ptr<Packet> packet,
+                                             double frequencyMHz)
+{
+  m_counters.events++;
+  totalEventAllocationCounters.events++;
+
+  if (m_freeEvents.empty ())
+    {
+      // Get a new chunk of memory and make all of its events available
+      Event *chunk = static_cast<Event *>
+        (::operator new (m_nextChunkSize * sizeof (Event)));
+      m_chunks.push_back (chunk);
+      for (uint32_t i = m_nextChunkSize; i > 0; i--)
+        {
+          m_freeEvents.push_back (chunk + i - 1);
+        }
+      m_nextChunkSize = std::min (2 * m_nextChunkSize, MAX_CHUNK_SIZE);
+
+      m_counters.chunks++;
+      totalEventAllocationCounters.chunks++;
+    }
+  else
+    {
+      m_counters.reusedEvents++;
+      totalEventAllocationCounters.reusedEvents++;
+    }
+
+  Event *event = m_freeEvents.back ();
+  m_freeEvents.pop_back ();
+  new (event) Event (duration, rxPowerdBm, spreadingFactor, packet,
+                     frequencyMHz);
+  event->m_pool = this;
+
+  // The event starts with a reference count of one, which we take over
+  return Ptr<Event> (event, false);
+}
+
+void
+LoraInterferenceHelper::EventPool::Free (Event *event)
+{
+  m_freeEvents.push_back (event);
+}
+
+LoraInterferenceHelper::EventAllocationCounters
+LoraInterferenceHelper::EventPool::GetCounters (void) const
+{
+  return m_counters;
+}
+
 /****************************
  *  LoraInterferenceHelper  *
  ****************************/
@@ -125,9 +248,13 @@ LoraInterferenceHelper::GetTypeId (void)
   return tid;
 }
 
-LoraInterferenceHelper::LoraInterferenceHelper ()
+LoraInterferenceHelper::LoraInterferenceHelper () :
+  m_eventPool (Create<EventPool> ())
 {
   NS_LOG_FUNCTION (this);
+
+  static bool collisionSnirLinearInitialized = InitializeCollisionSnirLinear ();
+  NS_UNUSED (collisionSnirLinearInitialized);
 }
 
 LoraInterferenceHelper::~LoraInterferenceHelper ()
@@ -164,8 +291,31 @@ const double LoraInterferenceHelper::collisionSnir[6][6] =
   {-36, -36, -36, -36, -36,   6}        // SF12
 };
 
+double LoraInterferenceHelper::collisionSnirLinear[6][6];
+
+bool
+LoraInterferenceHelper::InitializeCollisionSnirLinear (void)
+{
+  for (int i = 0; i < 6; i++)
+    {
+      for (int j = 0; j < 6; j++)
+        {
+          collisionSnirLinear[i][j] = std::pow (10, collisionSnir[i][j] / 10);
+        }
+    }
+  return true;
+}
+
 Time LoraInterferenceHelper::oldEventThreshold = Seconds (2);
 
+LoraInterferenceHelper::EventAllocationCounters
+LoraInterferenceHelper::totalEventAllocationCounters;
+
+LoraInterferenceHelper::FrequencyEvents::FrequencyEvents () :
+  first (0)
+{
+}
+
 Ptr<LoraInterferenceHelper::Event>
 LoraInterferenceHelper::Add (Time duration, double rxPower,
                              uint8_t spreadingFactor, Ptr<Packet> packet,
@@ -175,19 +325,43 @@ LoraInterferenceHelper::Add (Time duration, double rxPower,
   NS_LOG_FUNCTION (this << duration.GetSeconds () << rxPower << unsigned
                    (spreadingFactor) << packet << frequencyMHz);
 
+  NS_ASSERT (spreadingFactor >= 7 && spreadingFactor <= 12);
+
   // Create an event based on the parameters
   Ptr<LoraInterferenceHelper::Event> event =
-    Create<LoraInterferenceHelper::Event> (duration, rxPower, spreadingFactor,
-                                           packet, frequencyMHz);
-
-  // Add the event to the list
-  m_events.push_back (event);
-
-  // Clean the event list
-  if (m_events.size () > 100)
+    m_eventPool->Allocate (duration, rxPower, spreadingFactor, packet,
+                           frequencyMHz);
+
+  // Add the event to the events on its frequency, keeping them sorted by start
+  // time. Since events start when they are added, this is usually an append.
+  FrequencyEvents &frequencyEvents = m_events[frequencyMHz];
+  int64_t startTime = event->GetStartTime ().GetTimeStep ();
+  std::size_t position = frequencyEvents.startTimes.size ();
+  if (!frequencyEvents.startTimes.empty ()
+      && frequencyEvents.startTimes.back () > startTime)
     {
-      CleanOldEvents ();
+      position = std::upper_bound (frequencyEvents.startTimes.begin ()
+                                   + frequencyEvents.first,
+                                   frequencyEvents.startTimes.end (),
+                                   startTime)
+        - frequencyEvents.startTimes.begin ();
     }
+  frequencyEvents.events.insert (frequencyEvents.events.begin () + position,
+                                 event);
+  frequencyEvents.startTimes.insert (frequencyEvents.startTimes.begin ()
+                                     + position, startTime);
+  frequencyEvents.endTimes.insert (frequencyEvents.endTimes.begin ()
+                                   + position,
+                                   event->GetEndTime ().GetTimeStep ());
+  frequencyEvents.rxPowersmW.insert (frequencyEvents.rxPowersmW.begin ()
+                                     + position, event->GetRxPowermW ());
+  frequencyEvents.sfIndexes.insert (frequencyEvents.sfIndexes.begin ()
+                                    + position, spreadingFactor - 7);
+  frequencyEvents.maxDuration = std::max (frequencyEvents.maxDuration,
+                                          duration);
+
+  // Clean the events on this frequency
+  CleanOldEvents (frequencyEvents);
 
   return event;
 }
@@ -197,21 +371,64 @@ LoraInterferenceHelper::CleanOldEvents (void)
 {
   NS_LOG_FUNCTION (this);
 
-  // Cycle the events, and clean up if an event is old.
-  for (auto it = m_events.begin (); it != m_events.end ();)
+  for (auto it = m_events.begin (); it != m_events.end (); ++it)
     {
-      if ((*it)->GetEndTime () + oldEventThreshold < Simulator::Now ())
-        {
-          it = m_events.erase (it);
-        }
-      it++;
+      CleanOldEvents (it->second);
+    }
+}
+
+void
+LoraInterferenceHelper::CleanOldEvents (FrequencyEvents &frequencyEvents)
+{
+  // Events are sorted by start time, so we only need to look at the front.
+  // Keep events that could still overlap with the longest possible event
+  // currently being received.
+  int64_t limit = (Simulator::Now () - frequencyEvents.maxDuration
+                   - oldEventThreshold).GetTimeStep ();
+  std::size_t size = frequencyEvents.events.size ();
+  while (frequencyEvents.first < size
+         && frequencyEvents.endTimes[frequencyEvents.first] < limit)
+    {
+      frequencyEvents.events[frequencyEvents.first] = 0;
+      frequencyEvents.first++;
+    }
+
+  // Only compact the arrays once at least half of them is stale, so that the
+  // cost of shifting the remaining events is amortized over the removals.
+  if (frequencyEvents.first > 0 && frequencyEvents.first >= size / 2)
+    {
+      std::size_t first = frequencyEvents.first;
+      frequencyEvents.events.erase (frequencyEvents.events.begin (),
+                                    frequencyEvents.events.begin () + first);
+      frequencyEvents.startTimes.erase (frequencyEvents.startTimes.begin (),
+                                        frequencyEvents.startTimes.begin ()
+                                        + first);
+      frequencyEvents.endTimes.erase (frequencyEvents.endTimes.begin (),
+                                      frequencyEvents.endTimes.begin ()
+                                      + first);
+      frequencyEvents.rxPowersmW.erase (frequencyEvents.rxPowersmW.begin (),
+                                        frequencyEvents.rxPowersmW.begin ()
+                                        + first);
+      frequencyEvents.sfIndexes.erase (frequencyEvents.sfIndexes.begin (),
+                                       frequencyEvents.sfIndexes.begin ()
+                                       + first);
+      frequencyEvents.first = 0;
     }
 }
 
 std::list<Ptr<LoraInterferenceHelper::Event> >
 LoraInterferenceHelper::GetInterferers ()
 {
-  return m_events;
+  std::list<Ptr<LoraInterferenceHelper::Event> > interferers;
+
+  for (auto it = m_events.begin (); it != m_events.end (); ++it)
+    {
+      interferers.insert (interferers.end (),
+                          it->second.events.begin () + it->second.first,
+                          it->second.events.end ());
+    }
+
+  return interferers;
 }
 
 void
@@ -221,7 +438,8 @@ LoraInterferenceHelper::PrintEvents (std::ostream &stream)
 
   stream << "Currently registered events:" << std::endl;
 
-  for (auto it = m_events.begin (); it != m_events.end (); it++)
+  std::list<Ptr<LoraInterferenceHelper::Event> > events = GetInterferers ();
+  for (auto it = events.begin (); it != events.end (); it++)
     {
       (*it)->Print (stream);
       stream << std::endl;
@@ -234,99 +452,103 @@ LoraInterferenceHelper::IsDestroyedByInterference
 {
   NS_LOG_FUNCTION (this << event);
 
-  NS_LOG_INFO ("Current number of events in LoraInterferenceHelper: " << m_events.size ());
-
   // We want to see the interference affecting this event: cycle through events
   // that overlap with this one and see whether it survives the interference or
   // not.
 
   // Gather information about the event
-  double rxPowerDbm = event->GetRxPowerdBm ();
   uint8_t sf = event->GetSpreadingFactor ();
   double frequency = event->GetFrequency ();
-
-  // Handy information about the time frame when the packet was received
-  Time now = Simulator::Now ();
-  Time duration = event->GetDuration ();
-  Time packetStartTime = now - duration;
-  Time packetEndTime = now;
-
-  // Get the list of interfering events
-  std::list<Ptr<LoraInterferenceHelper::Event> >::iterator it;
-
-  // Energy for interferers of various SFs
-  std::vector<double> cumulativeInterferenceEnergy (6,0);
-
-  // Cycle over the events
-  for (it = m_events.begin (); it != m_events.end ();)
+  int64_t startTime = event->GetStartTime ().GetTimeStep ();
+  int64_t endTime = event->GetEndTime ().GetTimeStep ();
+
+  // Get the events on the same frequency: we assume there's no interchannel
+  // interference.
+  auto frequencyIt = m_events.find (frequency);
+  NS_ASSERT (frequencyIt != m_events.end ());
+  const FrequencyEvents &frequencyEvents = frequencyIt->second;
+
+  NS_LOG_INFO ("Current number of events on this frequency: " <<
+               frequencyEvents.events.size () - frequencyEvents.first);
+
+  // The first event that can overlap with ours is the first one that started
+  // less than maxDuration before it, and the last one is the last one that
+  // starts before ours ends.
+  std::vector<int64_t>::const_iterator firstStart =
+    frequencyEvents.startTimes.begin () + frequencyEvents.first;
+  int64_t earliestStartTime = startTime
+    - frequencyEvents.maxDuration.GetTimeStep ();
+  std::size_t begin = std::lower_bound (firstStart,
+                                        frequencyEvents.startTimes.end (),
+                                        earliestStartTime)
+    - frequencyEvents.startTimes.begin ();
+  std::size_t end = std::lower_bound (frequencyEvents.startTimes.begin ()
+                                      + begin,
+                                      frequencyEvents.startTimes.end (),
+                                      endTime)
+    - frequencyEvents.startTimes.begin ();
+  std::size_t count = end - begin;
+
+  // Compute the energy of each candidate interferer, as the product of its
+  // power and of the time it overlaps with our event. This loop only reads
+  // contiguous arrays and has no branches, so that it can be vectorized.
+  // Since we only need the ratio of energies, time is measured in time steps
+  // and power in mW.
+  if (m_interferenceEnergies.size () < count)
+    {
+      m_interferenceEnergies.resize (count);
+    }
+  const int64_t *startTimes = frequencyEvents.startTimes.data () + begin;
+  const int64_t *endTimes = frequencyEvents.endTimes.data () + begin;
+  const double *rxPowersmW = frequencyEvents.rxPowersmW.data () + begin;
+  double *energies = m_interferenceEnergies.data ();
+  for (std::size_t k = 0; k < count; k++)
     {
-      // Pointer to the current interferer
-      Ptr< LoraInterferenceHelper::Event > interferer = *it;
+      int64_t overlapStart = std::max (startTimes[k], startTime);
+      int64_t overlapEnd = std::min (endTimes[k], endTime);
+      int64_t overlap = std::max (overlapEnd - overlapStart, int64_t (0));
+      energies[k] = overlap * rxPowersmW[k];
+    }
 
-      // Only consider the current event if the channel is the same: we
-      // assume there's no interchannel interference. Also skip the current
-      // event if it's the same that we want to analyze.
-      if (!(interferer->GetFrequency () == frequency) || interferer == event)
+  // Accumulate the energy of interferers of the various SFs
+  double cumulativeInterferenceEnergy[6] = {0, 0, 0, 0, 0, 0};
+  const uint8_t *sfIndexes = frequencyEvents.sfIndexes.data () + begin;
+  for (std::size_t k = 0; k < count; k++)
+    {
+      // Skip the current event if it's the same that we want to analyze.
+      if (frequencyEvents.events[begin + k] == event)
         {
-          NS_LOG_DEBUG ("Different channel or same event");
-          it++;
-          continue;       // Continues from the first line inside the for cycle
+          NS_LOG_DEBUG ("Same event");
+          continue;
         }
-
-      NS_LOG_DEBUG ("Interferer on same channel");
-
-      // Gather information about this interferer
-      uint8_t interfererSf = interferer->GetSpreadingFactor ();
-      double interfererPower = interferer->GetRxPowerdBm ();
-      Time interfererStartTime = interferer->GetStartTime ();
-      Time interfererEndTime = interferer->GetEndTime ();
-
-      NS_LOG_INFO ("Found an interferer: sf = " << unsigned(interfererSf)
-                                                << ", power = " << interfererPower
-                                                << ", start time = " << interfererStartTime
-                                                << ", end time = " << interfererEndTime);
-
-      // Compute the fraction of time the two events are overlapping
-      Time overlap = GetOverlapTime (event, interferer);
-
-      NS_LOG_DEBUG ("The two events overlap for " << overlap.GetSeconds () << " s.");
-
-      // Compute the equivalent energy of the interference
-      // Power [mW] = 10^(Power[dBm]/10)
-      // Power [W] = Power [mW] / 1000
-      double interfererPowerW = pow (10, interfererPower / 10) / 1000;
-      // Energy [J] = Time [s] * Power [W]
-      double interferenceEnergy = overlap.GetSeconds () * interfererPowerW;
-      cumulativeInterferenceEnergy.at (unsigned(interfererSf) - 7) += interferenceEnergy;
-      NS_LOG_DEBUG ("Interferer power in W: " << interfererPowerW);
-      NS_LOG_DEBUG ("Interference energy: " << interferenceEnergy);
-      it++;
+      NS_LOG_DEBUG ("Found an interferer: " << *frequencyEvents.events[begin + k]
+                    << ", interference energy = " << energies[k] << " mW steps");
+      cumulativeInterferenceEnergy[sfIndexes[k]] += energies[k];
     }
 
   // For each SF, check if there was destructive interference
+  double signalEnergy = (endTime - startTime) * event->GetRxPowermW ();
+  NS_LOG_DEBUG ("Signal energy: " << signalEnergy << " mW steps");
   for (uint8_t currentSf = uint8_t (7); currentSf <= uint8_t (12); currentSf++)
     {
-      NS_LOG_DEBUG ("Cumulative Interference Energy: " <<
-                    cumulativeInterferenceEnergy.at (unsigned(currentSf) - 7));
-
-      // Use the computed cumulativeInterferenceEnergy to determine whether the
-      // interference with this SF destroys the packet
-      double signalPowerW = pow (10, rxPowerDbm / 10) / 1000;
-      double signalEnergy = duration.GetSeconds () * signalPowerW;
-      NS_LOG_DEBUG ("Signal power in W: " << signalPowerW);
-      NS_LOG_DEBUG ("Signal energy: " << signalEnergy);
-
-      // Check whether the packet survives the interference of this SF
-      double snirIsolation = collisionSnir [unsigned(sf) - 7][unsigned(currentSf) - 7];
+      double interferenceEnergy =
+        cumulativeInterferenceEnergy[unsigned(currentSf) - 7];
+      NS_LOG_DEBUG ("Cumulative Interference Energy: " << interferenceEnergy);
+
+      // Check whether the packet survives the interference of this SF, i.e.,
+      // whether the SNIR is at least the needed isolation. Comparing linear
+      // energies avoids computing a logarithm.
+      double snirIsolation =
+        collisionSnirLinear [unsigned(sf) - 7][unsigned(currentSf) - 7];
       NS_LOG_DEBUG ("The needed isolation to survive is "
-                    << snirIsolation << " dB");
-      double snir = 10 * log10 (signalEnergy / cumulativeInterferenceEnergy.at (unsigned(currentSf) - 7));
-      NS_LOG_DEBUG ("The current SNIR is " << snir << " dB");
+                    << collisionSnir [unsigned(sf) - 7][unsigned(currentSf) - 7]
+                    << " dB");
 
-      if (snir >= snirIsolation)
+      if (signalEnergy >= snirIsolation * interferenceEnergy)
         {
           // Move on and check the rest of the interferers
-          NS_LOG_DEBUG ("Packet survived interference with SF " << currentSf);
+          NS_LOG_DEBUG ("Packet survived interference with SF " <<
+                        unsigned(currentSf));
         }
       else
         {
@@ -351,6 +573,18 @@ LoraInterferenceHelper::ClearAllEvents (void)
   m_events.clear ();
 }
 
+LoraInterferenceHelper::EventAllocationCounters
+LoraInterferenceHelper::GetEventAllocationCounters (void) const
+{
+  return m_eventPool->GetCounters ();
+}
+
+LoraInterferenceHelper::EventAllocationCounters
+LoraInterferenceHelper::GetTotalEventAllocationCounters (void)
+{
+  return totalEventAllocationCounters;
+}
+
 Time
 LoraInterferenceHelper::GetOverlapTime (Ptr<LoraInterferenceHelper::Event> event1,
                                         Ptr<LoraInterferenceHelper::Event> event2)
@@ -371,10 +605,17 @@ LoraInterferenceHelper::GetOverlapTime (Ptr<LoraInterferenceHelper::Event> event
     {
       overlap = Seconds (0);
     }
-  // event1 before event2
+  // event1 before event2, possibly containing it
   else if (s1 < s2)
     {
-      overlap = e1 - s2;
+      if (e1 < e2)
+        {
+          overlap = e1 - s2;
+        }
+      else
+        {
+          overlap = e2 - s2;
+        }
     }
   // event2 before event1 or they start at the same time (s1 = s2)
   else
@@ -29,6 +29,8 @@
 #include "ns3/packet.h"
 #include "ns3/logical-lora-channel.h"
 #include <list>
+#include <vector>
+#include <map>
 
 namespace ns3 {
 namespace lorawan {
@@ -43,13 +45,38 @@ namespace lorawan {
 class LoraInterferenceHelper
 {
 public:
+  class Event;
+  class EventPool;
+
+  /**
+   * Gives events back to the pool they were allocated from when their last
+   * reference is released, or deletes them if they don't belong to a pool.
+   */
+  struct EventDeleter
+  {
+    static void Delete (Event *event);
+  };
+
+  /**
+   * Counters of the events allocated by an EventPool.
+   */
+  struct EventAllocationCounters
+  {
+    EventAllocationCounters ();
+
+    uint64_t events; //!< The number of events that were allocated
+    uint64_t reusedEvents; //!< The number of events that reused the memory of a released one
+    uint64_t chunks; //!< The number of memory chunks that were allocated from the heap
+  };
+
   /**
    * A class representing a signal in time.
    *
    * Used in LoraInterferenceHelper to keep track of which signals overlap and
    * cause destructive interference.
    */
-  class Event : public SimpleRefCount<LoraInterferenceHelper::Event>
+  class Event : public SimpleRefCount<LoraInterferenceHelper::Event, empty,
+                                      LoraInterferenceHelper::EventDeleter>
   {
 
 public:
@@ -77,6 +104,13 @@ public:
      */
     double GetRxPowerdBm (void) const;
 
+    /**
+     * Get the power of the event in linear units.
+     *
+     * \return The received power [mW].
+     */
+    double GetRxPowermW (void) const;
+
     /**
      * Get the spreading factor used by this signal.
      */
@@ -92,6 +126,25 @@ public:
      */
     double GetFrequency (void) const;
 
+    /**
+     * Set the index of the gateway reception path locked on this event.
+     */
+    void SetReceptionPath (uint32_t receptionPath);
+
+    /**
+     * Get the index of the gateway reception path locked on this event.
+     *
+     * \return The index, or NO_RECEPTION_PATH if no path is locked on this
+     * event.
+     */
+    uint32_t GetReceptionPath (void) const;
+
+    /**
+     * The value of the reception path index when no path is locked on an
+     * event.
+     */
+    static const uint32_t NO_RECEPTION_PATH = 0xffffffff;
+
     /**
      * Print the current event in a human readable form.
      */
@@ -118,6 +171,11 @@ private:
      */
     double m_rxPowerdBm;
 
+    /**
+     * The power of this event in mW (at the device).
+     */
+    double m_rxPowermW;
+
     /**
      * The packet this event was generated for.
      */
@@ -128,6 +186,63 @@ private:
      */
     double m_frequencyMHz;
 
+    /**
+     * The index of the gateway reception path locked on this event.
+     */
+    uint32_t m_receptionPath;
+
+    /**
+     * The pool this event was allocated from, if any.
+     */
+    Ptr<EventPool> m_pool;
+
+    friend class EventPool;
+    friend struct EventDeleter;
+  };
+
+  /**
+   * A free-list pool of events.
+   *
+   * Events are constructed in chunks of memory owned by the pool, whose size
+   * doubles up to a maximum, and the memory of events that are released is
+   * reused by the following ones. Since each event keeps a reference to its
+   * pool, the memory stays valid as long as any Ptr to an event exists (for
+   * example, in a gateway reception path), even after the
+   * LoraInterferenceHelper is destroyed.
+   */
+  class EventPool : public SimpleRefCount<LoraInterferenceHelper::EventPool>
+  {
+public:
+    EventPool ();
+    ~EventPool ();
+
+    /**
+     * Allocate an event from the pool.
+     *
+     * \return The new event, whose parameters are the same as the ones of the
+     * Event constructor.
+     */
+    Ptr<Event> Allocate (Time duration, double rxPowerdBm,
+                         uint8_t spreadingFactor, Ptr<Packet> packet,
+                         double frequencyMHz);
+
+    /**
+     * Make the memory of a destroyed event available to the next allocations.
+     *
+     * \param event The event, which was allocated from this pool.
+     */
+    void Free (Event *event);
+
+    /**
+     * Get the counters of the events allocated by this pool.
+     */
+    EventAllocationCounters GetCounters (void) const;
+
+private:
+    std::vector<Event *> m_freeEvents; //!< Memory available for new events
+    std::vector<void *> m_chunks; //!< The memory chunks owned by this pool
+    uint32_t m_nextChunkSize; //!< The number of events in the next chunk
+    EventAllocationCounters m_counters; //!< The counters of this pool
   };
 
   static TypeId GetTypeId (void);
@@ -195,23 +310,98 @@ private:
    */
   void CleanOldEvents (void);
 
+  /**
+   * Get the counters of the events allocated by this LoraInterferenceHelper.
+   */
+  EventAllocationCounters GetEventAllocationCounters (void) const;
+
+  /**
+   * Get the counters of the events allocated by all LoraInterferenceHelper
+   * instances.
+   */
+  static EventAllocationCounters GetTotalEventAllocationCounters (void);
+
 private:
   /**
-   * A list of the events this LoraInterferenceHelper is keeping track of.
+   * The events that were registered on a certain frequency.
+   *
+   * Events are ordered by start time. Since every event lasts at most
+   * maxDuration, the events overlapping with an interval [s, e) can be found
+   * with a binary search for the first event starting after s - maxDuration,
+   * and by scanning forward until events start after e.
+   *
+   * The fields needed to compute interference are also kept in separate
+   * contiguous arrays (in the same order as events), so that the energy of
+   * all overlapping interferers can be computed in a single tight loop.
+   * Events before index first are no longer relevant: they are removed from
+   * the arrays in batches, to avoid shifting the arrays at every removal.
+   */
+  struct FrequencyEvents
+  {
+    FrequencyEvents ();
+
+    std::vector< Ptr< LoraInterferenceHelper::Event > > events; //!< The events, by start time
+    std::vector<int64_t> startTimes; //!< The start times of the events [time steps]
+    std::vector<int64_t> endTimes; //!< The end times of the events [time steps]
+    std::vector<double> rxPowersmW; //!< The received powers of the events [mW]
+    std::vector<uint8_t> sfIndexes; //!< The spreading factors of the events, minus 7
+    std::size_t first; //!< The index of the first event that is still relevant
+    Time maxDuration; //!< The duration of the longest event
+  };
+
+  /**
+   * Remove the events that can no longer interfere with any reception from
+   * the front of a FrequencyEvents structure.
+   *
+   * \param frequencyEvents The structure to clean.
+   */
+  void CleanOldEvents (FrequencyEvents &frequencyEvents);
+
+  /**
+   * The events this LoraInterferenceHelper is keeping track of, grouped by
+   * frequency.
+   */
+  std::map<double, FrequencyEvents> m_events;
+
+  /**
+   * The pool the events of this LoraInterferenceHelper are allocated from.
+   */
+  Ptr<EventPool> m_eventPool;
+
+  /**
+   * Buffer where IsDestroyedByInterference stores the energy of each
+   * interferer, kept across calls to avoid reallocations.
    */
-  std::list< Ptr< LoraInterferenceHelper::Event > > m_events;
+  std::vector<double> m_interferenceEnergies;
 
   /**
    * The matrix containing information about how packets survive interference.
    */
   static const double collisionSnir[6][6];
 
+  /**
+   * The values of collisionSnir, converted to linear energy ratios.
+   */
+  static double collisionSnirLinear[6][6];
+
+  /**
+   * Fill collisionSnirLinear.
+   *
+   * \return True.
+   */
+  static bool InitializeCollisionSnirLinear (void);
+
   /**
    * The threshold after which an event is considered old and removed from the
    * list.
    */
   static Time oldEventThreshold;
 
+  /**
+   * The counters of the events allocated by all pools.
+   */
+  static EventAllocationCounters totalEventAllocationCounters;
+
 };
 
 /**
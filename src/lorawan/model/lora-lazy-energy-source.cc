@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/lora-lazy-energy-source.h"
+#include "ns3/lora-radio-energy-model.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3 {
+namespace lorawan {
+
+NS_LOG_COMPONENT_DEFINE ("LoraLazyEnergySource");
+
+NS_OBJECT_ENSURE_REGISTERED (LoraLazyEnergySource);
+
+/**
+ * Get the time it takes to consume some energy with a certain power, or
+ * Time::Max () if it can't be represented.
+ */
+static Time
+GetTimeToConsume (double energyJ, double currentA, double voltageV)
+{
+  double seconds = energyJ / (currentA * voltageV);
+  if (currentA <= 0 || seconds >= Time::Max ().GetSeconds ())
+    {
+      return Time::Max ();
+    }
+  return Seconds (seconds);
+}
+
+TypeId
+LoraLazyEnergySource::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LoraLazyEnergySource")
+    .SetParent<EnergySource> ()
+    .SetGroupName ("Energy")
+    .AddConstructor<LoraLazyEnergySource> ()
+    .AddAttribute ("InitialEnergyJ",
+                   "Initial energy stored in the energy source.",
+                   DoubleValue (10),  // in Joules
+                   MakeDoubleAccessor (&LoraLazyEnergySource::m_initialEnergyJ),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("SupplyVoltageV",
+                   "Constant supply voltage of the energy source.",
+                   DoubleValue (3.0), // in Volts
+                   MakeDoubleAccessor (&LoraLazyEnergySource::m_supplyVoltageV),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("DepletionHorizon",
+                   "State changes are notified to the source once it could "
+                   "be depleted within this time.",
+                   TimeValue (Hours (1)),
+                   MakeTimeAccessor (&LoraLazyEnergySource::m_depletionHorizon),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+LoraLazyEnergySource::LoraLazyEnergySource () :
+  m_tracking (false),
+  m_depleted (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LoraLazyEnergySource::~LoraLazyEnergySource ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+LoraLazyEnergySource::GetSupplyVoltage (void) const
+{
+  return m_supplyVoltageV;
+}
+
+double
+LoraLazyEnergySource::GetInitialEnergy (void) const
+{
+  return m_initialEnergyJ;
+}
+
+double
+LoraLazyEnergySource::GetRemainingEnergy (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  double consumedEnergyJ = 0;
+  const std::vector<Ptr<LoraRadioEnergyModel> > &models = GetModels ();
+  for (auto it = models.begin (); it != models.end (); ++it)
+    {
+      consumedEnergyJ += (*it)->GetTotalEnergyConsumption ();
+    }
+  return std::max (m_initialEnergyJ - consumedEnergyJ, 0.0);
+}
+
+double
+LoraLazyEnergySource::GetEnergyFraction (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  return GetRemainingEnergy () / m_initialEnergyJ;
+}
+
+void
+LoraLazyEnergySource::UpdateEnergySource (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_depleted)
+    {
+      return;
+    }
+
+  m_checkEvent.Cancel ();
+
+  double remainingEnergyJ = GetRemainingEnergy ();
+  const std::vector<Ptr<LoraRadioEnergyModel> > &models = GetModels ();
+
+  if (!m_tracking)
+    {
+      // Check again when the source could be empty at the earliest
+      double maxCurrentA = 0;
+      for (auto it = models.begin (); it != models.end (); ++it)
+        {
+          maxCurrentA += (*it)->GetMaxCurrentA ();
+        }
+      Time earliestDepletion = GetTimeToConsume (remainingEnergyJ, maxCurrentA,
+                                                 m_supplyVoltageV);
+      if (earliestDepletion > m_depletionHorizon)
+        {
+          if (earliestDepletion != Time::Max ())
+            {
+              m_checkEvent = Simulator::Schedule (earliestDepletion,
+                                                  &LoraLazyEnergySource::UpdateEnergySource,
+                                                  this);
+            }
+          return;
+        }
+
+      NS_LOG_DEBUG ("Tracking depletion with " << remainingEnergyJ << " J left");
+      m_tracking = true;
+    }
+
+  // Check again when the source is empty if radios keep their state
+  double currentA = 0;
+  for (auto it = models.begin (); it != models.end (); ++it)
+    {
+      currentA += (*it)->GetCurrentA ();
+    }
+  Time depletion = GetTimeToConsume (remainingEnergyJ, currentA,
+                                     m_supplyVoltageV);
+  if (depletion.IsZero ())
+    {
+      Deplete ();
+    }
+  else if (depletion != Time::Max ())
+    {
+      m_checkEvent = Simulator::Schedule (depletion,
+                                          &LoraLazyEnergySource::UpdateEnergySource,
+                                          this);
+    }
+}
+
+bool
+LoraLazyEnergySource::IsTracking (void) const
+{
+  return m_tracking;
+}
+
+Time
+LoraLazyEnergySource::GetDepletionTime (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_depleted)
+    {
+      return m_depletionTime;
+    }
+
+  double currentA = 0;
+  const std::vector<Ptr<LoraRadioEnergyModel> > &models = GetModels ();
+  for (auto it = models.begin (); it != models.end (); ++it)
+    {
+      currentA += (*it)->GetCurrentA ();
+    }
+  Time timeLeft = GetTimeToConsume (GetRemainingEnergy (), currentA,
+                                    m_supplyVoltageV);
+  if (timeLeft == Time::Max ())
+    {
+      return Time::Max ();
+    }
+  return Simulator::Now () + timeLeft;
+}
+
+void
+LoraLazyEnergySource::DoInitialize (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  UpdateEnergySource ();  // Plan the first depletion check
+}
+
+void
+LoraLazyEnergySource::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_checkEvent.Cancel ();
+  m_loraModels.clear ();
+  BreakDeviceEnergyModelRefCycle ();
+}
+
+const std::vector<Ptr<LoraRadioEnergyModel> > &
+LoraLazyEnergySource::GetModels (void)
+{
+  if (m_loraModels.empty ())
+    {
+      DeviceEnergyModelContainer models =
+        FindDeviceEnergyModels (LoraRadioEnergyModel::GetTypeId ());
+      for (auto it = models.Begin (); it != models.End (); ++it)
+        {
+          m_loraModels.push_back ((*it)->GetObject<LoraRadioEnergyModel> ());
+        }
+    }
+  return m_loraModels;
+}
+
+void
+LoraLazyEnergySource::Deplete (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_DEBUG ("Energy depleted");
+
+  m_depleted = true;
+  m_depletionTime = Simulator::Now ();
+  m_checkEvent.Cancel ();
+  NotifyEnergyDrained ();
+}
+
+}
+}
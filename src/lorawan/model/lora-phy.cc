@@ -19,6 +19,8 @@
  */
 
 #include "ns3/lora-phy.h"
+#include "ns3/lora-tag.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include <algorithm>
@@ -69,11 +71,19 @@ LoraPhy::GetTypeId (void)
                      "could not be correctly received because"
                      "its received power is below the sensitivity of the receiver",
                      MakeTraceSourceAccessor (&LoraPhy::m_underSensitivity),
-                     "ns3::Packet::TracedCallback");
+                     "ns3::Packet::TracedCallback")
+    .AddAttribute ("TagPackets",
+                   "Whether to also store the spreading factor of "
+                   "transmissions, and the parameters of receptions, in the "
+                   "LoraTag of packets, for trace sinks that read it",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraPhy::m_tagPackets),
+                   MakeBooleanChecker ());
   return tid;
 }
 
-LoraPhy::LoraPhy ()
+LoraPhy::LoraPhy () :
+  m_tagPackets (false)
 {
 }
 
@@ -95,6 +105,16 @@ LoraPhy::SetDevice (Ptr<NetDevice> device)
   m_device = device;
 }
 
+void
+LoraPhy::AddInterference (double rxPowerDbm, uint8_t sf, Time duration,
+                          double frequencyMHz)
+{
+  NS_LOG_FUNCTION (this << rxPowerDbm << unsigned (sf) << duration
+                        << frequencyMHz);
+
+  m_interference.Add (duration, rxPowerDbm, sf, 0, frequencyMHz);
+}
+
 Ptr<LoraChannel>
 LoraPhy::GetChannel (void) const
 {
@@ -154,13 +174,107 @@ LoraPhy::SetTxFinishedCallback (TxFinishedCallback callback)
   m_txFinishedCallback = callback;
 }
 
+const LoraRxParameters &
+LoraPhy::GetRxParameters (void) const
+{
+  return m_rxParameters;
+}
+
+void
+LoraPhy::SetRxParameters (Ptr<Packet> packet, uint8_t sf, double rxPowerDbm,
+                          double frequencyMHz, uint8_t destroyedBy)
+{
+  m_rxParameters.sf = sf;
+  m_rxParameters.rxPowerDbm = rxPowerDbm;
+  m_rxParameters.frequencyMHz = frequencyMHz;
+  m_rxParameters.destroyedBy = destroyedBy;
+
+  if (m_tagPackets)
+    {
+      LoraTag tag;
+      packet->RemovePacketTag (tag);
+      tag.SetSpreadingFactor (sf);
+      tag.SetReceivePower (rxPowerDbm);
+      tag.SetFrequency (frequencyMHz);
+      tag.SetDestroyedBy (destroyedBy);
+      packet->AddPacketTag (tag);
+    }
+}
+
 
 Time
 LoraPhy::GetOnAirTime (Ptr<Packet> packet, LoraTxParameters txParams)
 {
-
   NS_LOG_FUNCTION (packet << txParams);
 
+  // Payload size, including Headers and Trailers
+  return GetOnAirTime (packet->GetSize (), txParams);
+}
+
+std::deque<LoraPhy::OnAirTimeTable> &
+LoraPhy::GetOnAirTimeTables (void)
+{
+  static std::deque<OnAirTimeTable> tables;
+  return tables;
+}
+
+Time
+LoraPhy::GetOnAirTime (uint32_t payloadSize, LoraTxParameters txParams)
+{
+  NS_LOG_FUNCTION (payloadSize << txParams);
+
+  if (txParams.sf < 7 || txParams.sf > 12 || payloadSize > 255)
+    {
+      return ComputeOnAirTime (payloadSize, txParams);
+    }
+
+  // Look for the table of the parameters other than the SF
+  std::deque<OnAirTimeTable> &tables = GetOnAirTimeTables ();
+  OnAirTimeTable *table = 0;
+  for (auto it = tables.begin (); it != tables.end (); ++it)
+    {
+      if (it->bandwidthHz == txParams.bandwidthHz
+          && it->nPreamble == txParams.nPreamble
+          && it->codingRate == txParams.codingRate
+          && it->headerDisabled == txParams.headerDisabled
+          && it->crcEnabled == txParams.crcEnabled
+          && it->lowDataRateOptimizationEnabled
+          == txParams.lowDataRateOptimizationEnabled)
+        {
+          table = &(*it);
+          break;
+        }
+    }
+  if (table == 0)
+    {
+      if (tables.size () == MAX_ON_AIR_TIME_TABLES)
+        {
+          return ComputeOnAirTime (payloadSize, txParams);
+        }
+      tables.emplace_back ();
+      table = &tables.back ();
+      table->bandwidthHz = txParams.bandwidthHz;
+      table->nPreamble = txParams.nPreamble;
+      table->codingRate = txParams.codingRate;
+      table->headerDisabled = txParams.headerDisabled;
+      table->crcEnabled = txParams.crcEnabled;
+      table->lowDataRateOptimizationEnabled =
+        txParams.lowDataRateOptimizationEnabled;
+    }
+
+  Time &duration = table->durations[txParams.sf - 7][payloadSize];
+  if (duration.IsZero ())
+    {
+      duration = ComputeOnAirTime (payloadSize, txParams);
+    }
+  return duration;
+}
+
+Time
+LoraPhy::ComputeOnAirTime (uint32_t payloadSize, LoraTxParameters txParams)
+{
+  NS_LOG_FUNCTION (payloadSize << txParams);
+
   // The contents of this function are based on [1].
   // [1] SX1272 LoRa modem designer's guide.
 
@@ -172,7 +286,7 @@ LoraPhy::GetOnAirTime (Ptr<Packet> packet, LoraTxParameters txParams)
   double tPreamble = (double(txParams.nPreamble) + 4.25) * tSym;
 
   // Payload size
-  uint32_t pl = packet->GetSize ();      // Size in bytes
+  uint32_t pl = payloadSize;      // Size in bytes
   NS_LOG_DEBUG ("Packet of size " << pl << " bytes");
 
   // This step is needed since the formula deals with double values.
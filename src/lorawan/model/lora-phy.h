@@ -30,6 +30,7 @@
 #include "ns3/lora-channel.h"
 #include "ns3/net-device.h"
 #include "ns3/lora-interference-helper.h"
+#include <deque>
 #include <list>
 
 namespace ns3 {
@@ -57,6 +58,18 @@ struct LoraTxParameters
  */
 std::ostream &operator << (std::ostream &os, const LoraTxParameters &params);
 
+/**
+ * Structure to collect the parameters of a reception, which the PHY passes to
+ * the upper layer along with the packet.
+ */
+struct LoraRxParameters
+{
+  uint8_t sf = 0;     //!< Spreading Factor the packet was sent with
+  double rxPowerDbm = 0;     //!< Power the packet was received with
+  double frequencyMHz = 0;     //!< Frequency the packet was received on
+  uint8_t destroyedBy = 0;     //!< SF of the interference that destroyed the packet, or 0
+};
+
 /**
  * \ingroup lorawan
  *
@@ -84,9 +97,9 @@ public:
    * Type definition for a callback for when a packet is correctly received.
    *
    * This callback can be set by an upper layer that wishes to be informed of
-   * correct reception events.
+   * correct reception events, and receives the parameters of the reception.
    */
-  typedef Callback<void, Ptr<const Packet> > RxOkCallback;
+  typedef Callback<void, Ptr<const Packet>, const LoraRxParameters &> RxOkCallback;
 
   /**
    * Type definition for a callback for when a packet reception fails.
@@ -188,6 +201,16 @@ public:
    */
   void SetTxFinishedCallback (TxFinishedCallback callback);
 
+  /**
+   * Get the parameters of the last reception this PHY reported.
+   *
+   * They are set right before the reception trace sources fire, so that trace
+   * sinks can read the parameters of the packet they are passed.
+   *
+   * \return The parameters of the reception.
+   */
+  const LoraRxParameters & GetRxParameters (void) const;
+
   /**
    * Get the mobility model associated to this PHY.
    *
@@ -232,6 +255,22 @@ public:
    */
   void SetDevice (Ptr<NetDevice> device);
 
+  /**
+   * Add a signal that doesn't come from LoraChannel to the interference
+   * computations of this PHY.
+   *
+   * The signal can only prevent the reception of the packets it overlaps
+   * with, and is never received itself. This is used to model the load of
+   * devices that are not simulated explicitly (see LoraBackgroundTraffic).
+   *
+   * \param rxPowerDbm The power of the signal at this PHY.
+   * \param sf The Spreading Factor of the signal.
+   * \param duration The duration of the signal, starting now.
+   * \param frequencyMHz The frequency of the signal.
+   */
+  void AddInterference (double rxPowerDbm, uint8_t sf, Time duration,
+                        double frequencyMHz);
+
   /**
    * Compute the time that a packet with certain characteristics will take to be
    * transmitted.
@@ -246,7 +285,61 @@ public:
    */
   static Time GetOnAirTime (Ptr<Packet> packet, LoraTxParameters txParams);
 
+  /**
+   * Compute the time that a payload of a certain size will take to be
+   * transmitted with a certain set of parameters.
+   *
+   * This version does not need a Packet, and can be used to compute
+   * durations in advance. Durations of payloads of up to 255 bytes are kept
+   * in a table for each combination of the parameters other than the SF, so
+   * that each one is only computed once.
+   *
+   * \param payloadSize The size of the PHY payload [bytes].
+   * \param txParams The set of parameters that will be used for transmission.
+   * \return The time necessary to transmit the payload.
+   */
+  static Time GetOnAirTime (uint32_t payloadSize, LoraTxParameters txParams);
+
 private:
+  /**
+   * Compute the on-air time of a payload with the formula of the SX1272 LoRa
+   * modem designer's guide.
+   *
+   * \param payloadSize The size of the PHY payload [bytes].
+   * \param txParams The set of parameters that will be used for transmission.
+   * \return The time necessary to transmit the payload.
+   */
+  static Time ComputeOnAirTime (uint32_t payloadSize,
+                                LoraTxParameters txParams);
+
+  /**
+   * The on-air times of all SFs and payload sizes, for a combination of the
+   * other transmission parameters.
+   */
+  struct OnAirTimeTable
+  {
+    double bandwidthHz;     //!< Bandwidth in Hz
+    uint32_t nPreamble;     //!< Number of preamble symbols
+    uint8_t codingRate;     //!< Code rate
+    bool headerDisabled;     //!< Whether to use implicit header mode
+    bool crcEnabled;     //!< Whether Cyclic Redundancy Check is enabled
+    bool lowDataRateOptimizationEnabled;     //!< Whether LDRO is enabled
+    Time durations[6][256];     //!< By SF - 7 and payload size, zero until computed
+  };
+
+  /**
+   * The maximum number of tables, beyond which on-air times are computed at
+   * every call.
+   */
+  static const std::size_t MAX_ON_AIR_TIME_TABLES = 8;
+
+  /**
+   * Get the tables of on-air times that were created so far.
+   *
+   * \return The tables.
+   */
+  static std::deque<OnAirTimeTable> & GetOnAirTimeTables (void);
+
   Ptr<MobilityModel> m_mobility;   //!< The mobility model associated to this PHY.
 
 protected:
@@ -259,6 +352,27 @@ protected:
   LoraInterferenceHelper m_interference; //!< The LoraInterferenceHelper
   //!associated to this PHY.
 
+  /**
+   * Store the parameters of a reception, and also in the packet's LoraTag if
+   * TagPackets is set.
+   *
+   * Since all receivers share the same packet, this needs to be done right
+   * before the packet is passed on.
+   *
+   * \param packet The received packet.
+   * \param sf The Spreading Factor of the packet.
+   * \param rxPowerDbm The power of the reception.
+   * \param frequencyMHz The frequency of the reception.
+   * \param destroyedBy The SF of the interference that destroyed the packet,
+   * or 0 if it was not destroyed by interference.
+   */
+  void SetRxParameters (Ptr<Packet> packet, uint8_t sf, double rxPowerDbm,
+                        double frequencyMHz, uint8_t destroyedBy);
+
+  LoraRxParameters m_rxParameters; //!< The parameters of the last reception
+
+  bool m_tagPackets; //!< Whether to store parameters in the LoraTag
+
   // Trace sources
 
   /**
@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/lora-profiler.h"
+
+namespace ns3 {
+namespace lorawan {
+
+bool LoraProfiler::m_enabled = false;
+double LoraProfiler::m_seconds[LoraProfiler::N_SECTIONS] = {0, 0, 0, 0, 0};
+uint64_t LoraProfiler::m_calls[LoraProfiler::N_SECTIONS] = {0, 0, 0, 0, 0};
+
+void
+LoraProfiler::Enable (void)
+{
+  m_enabled = true;
+}
+
+void
+LoraProfiler::Disable (void)
+{
+  m_enabled = false;
+}
+
+void
+LoraProfiler::Reset (void)
+{
+  for (int i = 0; i < N_SECTIONS; i++)
+    {
+      m_seconds[i] = 0;
+      m_calls[i] = 0;
+    }
+}
+
+double
+LoraProfiler::GetSeconds (Section section)
+{
+  return m_seconds[section];
+}
+
+uint64_t
+LoraProfiler::GetCalls (Section section)
+{
+  return m_calls[section];
+}
+
+}
+}
@@ -19,6 +19,8 @@
 #include "ns3/pointer.h"
 #include "ns3/energy-source.h"
 #include "lora-radio-energy-model.h"
+#include "lora-lazy-energy-source.h"
+#include <algorithm>
 
 
 namespace ns3 {
@@ -76,6 +78,12 @@ LoraRadioEnergyModel::LoraRadioEnergyModel ()
   NS_LOG_FUNCTION (this);
   m_currentState = EndDeviceLoraPhy::SLEEP;      // initially STANDBY
   m_lastUpdateTime = Seconds (0.0);
+  for (int state = 0; state < EndDeviceLoraPhy::N_STATES; state++)
+    {
+      m_stateDuration[state] = Seconds (0);
+      m_stateEnergy[state] = 0;
+    }
+  m_maxTxCurrentA = 0;
   m_nPendingChangeState = 0;
   m_isSupersededChangeState = false;
   m_energyDepletionCallback.Nullify ();
@@ -99,12 +107,25 @@ LoraRadioEnergyModel::SetEnergySource (Ptr<EnergySource> source)
   NS_LOG_FUNCTION (this << source);
   NS_ASSERT (source != NULL);
   m_source = source;
+  m_lazySource = DynamicCast<LoraLazyEnergySource> (source);
 }
 
 double
 LoraRadioEnergyModel::GetTotalEnergyConsumption (void) const
 {
   NS_LOG_FUNCTION (this);
+
+  if (m_lazySource != 0)
+    {
+      double totalEnergyConsumption = 0;
+      for (int state = 0; state < EndDeviceLoraPhy::N_STATES; state++)
+        {
+          totalEnergyConsumption +=
+            GetStateEnergyConsumption ((EndDeviceLoraPhy::State) state);
+        }
+      return totalEnergyConsumption;
+    }
+
   return m_totalEnergyConsumption;
 }
 
@@ -134,6 +155,7 @@ LoraRadioEnergyModel::SetTxCurrentA (double txCurrentA)
 {
   NS_LOG_FUNCTION (this << txCurrentA);
   m_txCurrentA = txCurrentA;
+  m_maxTxCurrentA = std::max (m_maxTxCurrentA, txCurrentA);
 }
 
 double
@@ -164,6 +186,39 @@ LoraRadioEnergyModel::SetSleepCurrentA (double sleepCurrentA)
   m_sleepCurrentA = sleepCurrentA;
 }
 
+double
+LoraRadioEnergyModel::GetMaxCurrentA (void) const
+{
+  return std::max (std::max (m_maxTxCurrentA, m_rxCurrentA),
+                   std::max (m_idleCurrentA, m_sleepCurrentA));
+}
+
+Time
+LoraRadioEnergyModel::GetStateDuration (EndDeviceLoraPhy::State state) const
+{
+  NS_LOG_FUNCTION (this << state);
+
+  if (state == m_currentState)
+    {
+      return m_stateDuration[state] + (Simulator::Now () - m_lastUpdateTime);
+    }
+  return m_stateDuration[state];
+}
+
+double
+LoraRadioEnergyModel::GetStateEnergyConsumption (EndDeviceLoraPhy::State state) const
+{
+  NS_LOG_FUNCTION (this << state);
+
+  if (state == m_currentState && m_source != 0)
+    {
+      Time duration = Simulator::Now () - m_lastUpdateTime;
+      return m_stateEnergy[state] + duration.GetSeconds () * DoGetCurrentA () *
+             m_source->GetSupplyVoltage ();
+    }
+  return m_stateEnergy[state];
+}
+
 EndDeviceLoraPhy::State
 LoraRadioEnergyModel::GetCurrentState (void) const
 {
@@ -207,7 +262,37 @@ LoraRadioEnergyModel::SetTxCurrentFromModel (double txPowerDbm)
   if (m_txCurrentModel)
     {
       m_txCurrentA = m_txCurrentModel->CalcTxCurrent (txPowerDbm);
+
+      if (m_txCurrentA > m_maxTxCurrentA)
+        {
+          m_maxTxCurrentA = m_txCurrentA;
+
+          // The lazy source assumed a lower maximum current
+          if (m_lazySource != 0)
+            {
+              m_lazySource->UpdateEnergySource ();
+            }
+        }
+    }
+}
+
+double
+LoraRadioEnergyModel::GetTxEnergy (uint32_t payloadSize,
+                                   LoraTxParameters txParams,
+                                   double txPowerDbm) const
+{
+  NS_LOG_FUNCTION (this << payloadSize << txParams << txPowerDbm);
+  NS_ASSERT (m_source != 0);
+
+  double txCurrentA = m_txCurrentA;
+  if (m_txCurrentModel)
+    {
+      txCurrentA = m_txCurrentModel->CalcTxCurrent (txPowerDbm);
     }
+
+  // energy = current * voltage * time
+  return txCurrentA * m_source->GetSupplyVoltage ()
+         * LoraPhy::GetOnAirTime (payloadSize, txParams).GetSeconds ();
 }
 
 void
@@ -239,12 +324,27 @@ LoraRadioEnergyModel::ChangeState (int newState)
       NS_FATAL_ERROR ("LoraRadioEnergyModel:Undefined radio state: " << m_currentState);
     }
 
-  // update total energy consumption
-  m_totalEnergyConsumption += energyToDecrease;
+  m_stateDuration[m_currentState] += duration;
+  m_stateEnergy[m_currentState] += energyToDecrease;
 
   // update last update time stamp
   m_lastUpdateTime = Simulator::Now ();
 
+  // a lazy source computes its energy from the per-state totals, and only
+  // needs to know about state changes when it is close to empty
+  if (m_lazySource != 0)
+    {
+      SetLoraRadioState ((EndDeviceLoraPhy::State) newState);
+      if (m_lazySource->IsTracking ())
+        {
+          m_lazySource->UpdateEnergySource ();
+        }
+      return;
+    }
+
+  // update total energy consumption
+  m_totalEnergyConsumption += energyToDecrease;
+
   m_nPendingChangeState++;
 
   // notify energy source
@@ -319,6 +419,7 @@ LoraRadioEnergyModel::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_source = NULL;
+  m_lazySource = NULL;
   m_energyDepletionCallback.Nullify ();
 }
 
@@ -25,6 +25,8 @@
 namespace ns3 {
 namespace lorawan {
 
+class LoraLazyEnergySource;
+
 /**
  * \ingroup energy
  */
@@ -211,6 +213,24 @@ public:
    */
   void SetSleepCurrentA (double sleepCurrentA);
 
+  /**
+   * \returns The largest current the device can draw, including the largest
+   * tx current computed by the tx current model so far.
+   */
+  double GetMaxCurrentA (void) const;
+
+  /**
+   * \param state A radio state.
+   * \returns The time the radio spent in the state, up to now.
+   */
+  Time GetStateDuration (EndDeviceLoraPhy::State state) const;
+
+  /**
+   * \param state A radio state.
+   * \returns The energy consumed in the state, up to now.
+   */
+  double GetStateEnergyConsumption (EndDeviceLoraPhy::State state) const;
+
   /**
    * \returns Current state.
    */
@@ -245,6 +265,20 @@ public:
   // NOTICE VERY WELL: Current  Model linear or constant as possible choices
   void SetTxCurrentFromModel (double txPowerDbm);
 
+  /**
+   * Compute the energy a transmission would consume, without a Packet.
+   *
+   * The tx current comes from the tx current model if one is set, and is the
+   * current tx current otherwise.
+   *
+   * \param payloadSize The size of the PHY payload [bytes].
+   * \param txParams The parameters of the transmission.
+   * \param txPowerDbm The nominal tx power in dBm.
+   * \returns The energy of the transmission [J].
+   */
+  double GetTxEnergy (uint32_t payloadSize, LoraTxParameters txParams,
+                      double txPowerDbm) const;
+
   /**
    * \brief Changes state of the LoraRadioEnergyMode.
    *
@@ -300,12 +334,14 @@ private:
   void SetLoraRadioState (const EndDeviceLoraPhy::State state);
 
   Ptr<EnergySource> m_source; ///< energy source
+  Ptr<LoraLazyEnergySource> m_lazySource; ///< energy source, if lazy
 
   // Member variables for current draw in different radio modes.
   double m_txCurrentA; ///< transmit current
   double m_rxCurrentA; ///< receive current
   double m_idleCurrentA; ///< idle current
   double m_sleepCurrentA; ///< sleep current
+  double m_maxTxCurrentA; ///< largest transmit current so far
   // NOTICE VERY WELL: Current  Model linear or constant as possible choices
   Ptr<LoraTxCurrentModel> m_txCurrentModel; ///< current model
 
@@ -315,6 +351,8 @@ private:
   // State variables.
   EndDeviceLoraPhy::State m_currentState;  ///< current state the radio is in
   Time m_lastUpdateTime;          ///< time stamp of previous energy update
+  Time m_stateDuration[EndDeviceLoraPhy::N_STATES]; ///< time spent in each state
+  double m_stateEnergy[EndDeviceLoraPhy::N_STATES]; ///< energy consumed in each state
 
   uint8_t m_nPendingChangeState; ///< pending state change
   bool m_isSupersededChangeState; ///< superseded change state
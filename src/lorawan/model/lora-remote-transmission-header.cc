@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/lora-remote-transmission-header.h"
+#include "ns3/log.h"
+#include <cstring>
+
+namespace ns3 {
+namespace lorawan {
+
+NS_LOG_COMPONENT_DEFINE ("LoraRemoteTransmissionHeader");
+
+/**
+ * Write a double with the network byte order.
+ */
+static void
+WriteDouble (Buffer::Iterator &i, double value)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  i.WriteHtonU64 (bits);
+}
+
+/**
+ * Read a double written by WriteDouble.
+ */
+static double
+ReadDouble (Buffer::Iterator &i)
+{
+  uint64_t bits = i.ReadNtohU64 ();
+  double value;
+  std::memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+LoraRemoteTransmissionHeader::LoraRemoteTransmissionHeader () :
+  m_txPowerDbm (0),
+  m_sf (0),
+  m_frequencyMHz (0),
+  m_downlink (false)
+{
+}
+
+LoraRemoteTransmissionHeader::~LoraRemoteTransmissionHeader ()
+{
+}
+
+TypeId
+LoraRemoteTransmissionHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("LoraRemoteTransmissionHeader")
+    .SetParent<Header> ()
+    .AddConstructor<LoraRemoteTransmissionHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+LoraRemoteTransmissionHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+LoraRemoteTransmissionHeader::GetSerializedSize (void) const
+{
+  // Position, power and frequency as doubles, duration and time as 64-bit
+  // integers, spreading factor and downlink flag as bytes
+  return 5 * 8 + 2 * 8 + 2;
+}
+
+void
+LoraRemoteTransmissionHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  WriteDouble (start, m_senderPosition.x);
+  WriteDouble (start, m_senderPosition.y);
+  WriteDouble (start, m_senderPosition.z);
+  WriteDouble (start, m_txPowerDbm);
+  WriteDouble (start, m_frequencyMHz);
+  start.WriteHtonU64 (m_duration.GetTimeStep ());
+  start.WriteHtonU64 (m_txTime.GetTimeStep ());
+  start.WriteU8 (m_sf);
+  start.WriteU8 (m_downlink);
+}
+
+uint32_t
+LoraRemoteTransmissionHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  m_senderPosition.x = ReadDouble (start);
+  m_senderPosition.y = ReadDouble (start);
+  m_senderPosition.z = ReadDouble (start);
+  m_txPowerDbm = ReadDouble (start);
+  m_frequencyMHz = ReadDouble (start);
+  m_duration = TimeStep (start.ReadNtohU64 ());
+  m_txTime = TimeStep (start.ReadNtohU64 ());
+  m_sf = start.ReadU8 ();
+  m_downlink = start.ReadU8 ();
+
+  return GetSerializedSize ();
+}
+
+void
+LoraRemoteTransmissionHeader::Print (std::ostream &os) const
+{
+  os << "SenderPosition=" << m_senderPosition << std::endl;
+  os << "TxPower=" << m_txPowerDbm << std::endl;
+  os << "SF=" << unsigned(m_sf) << std::endl;
+  os << "Frequency=" << m_frequencyMHz << std::endl;
+  os << "Duration=" << m_duration << std::endl;
+  os << "TxTime=" << m_txTime << std::endl;
+  os << "Downlink=" << m_downlink << std::endl;
+}
+
+void
+LoraRemoteTransmissionHeader::SetSenderPosition (Vector position)
+{
+  m_senderPosition = position;
+}
+
+Vector
+LoraRemoteTransmissionHeader::GetSenderPosition (void) const
+{
+  return m_senderPosition;
+}
+
+void
+LoraRemoteTransmissionHeader::SetTxPower (double txPowerDbm)
+{
+  m_txPowerDbm = txPowerDbm;
+}
+
+double
+LoraRemoteTransmissionHeader::GetTxPower (void) const
+{
+  return m_txPowerDbm;
+}
+
+void
+LoraRemoteTransmissionHeader::SetSpreadingFactor (uint8_t sf)
+{
+  m_sf = sf;
+}
+
+uint8_t
+LoraRemoteTransmissionHeader::GetSpreadingFactor (void) const
+{
+  return m_sf;
+}
+
+void
+LoraRemoteTransmissionHeader::SetFrequency (double frequencyMHz)
+{
+  m_frequencyMHz = frequencyMHz;
+}
+
+double
+LoraRemoteTransmissionHeader::GetFrequency (void) const
+{
+  return m_frequencyMHz;
+}
+
+void
+LoraRemoteTransmissionHeader::SetDuration (Time duration)
+{
+  m_duration = duration;
+}
+
+Time
+LoraRemoteTransmissionHeader::GetDuration (void) const
+{
+  return m_duration;
+}
+
+void
+LoraRemoteTransmissionHeader::SetTxTime (Time txTime)
+{
+  m_txTime = txTime;
+}
+
+Time
+LoraRemoteTransmissionHeader::GetTxTime (void) const
+{
+  return m_txTime;
+}
+
+void
+LoraRemoteTransmissionHeader::SetDownlink (bool downlink)
+{
+  m_downlink = downlink;
+}
+
+bool
+LoraRemoteTransmissionHeader::IsDownlink (void) const
+{
+  return m_downlink;
+}
+
+}
+}
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LORA_REMOTE_TRANSMISSION_HEADER_H
+#define LORA_REMOTE_TRANSMISSION_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * Describes a transmission that a LoraChannel forwards to the partitions of a
+ * distributed simulation that are run by other processes.
+ *
+ * The header is added in front of the PHY packet, and contains everything the
+ * remote LoraChannel needs to deliver the transmission to its own PHYs: the
+ * position of the sender, the transmission power, spreading factor, frequency
+ * and duration, the time the transmission started and whether it is a
+ * downlink.
+ */
+class LoraRemoteTransmissionHeader : public Header
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LoraRemoteTransmissionHeader ();
+  ~LoraRemoteTransmissionHeader ();
+
+  // Pure virtual methods from Header that need to be implemented by this class
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  void SetSenderPosition (Vector position);
+  Vector GetSenderPosition (void) const;
+
+  void SetTxPower (double txPowerDbm);
+  double GetTxPower (void) const;
+
+  void SetSpreadingFactor (uint8_t sf);
+  uint8_t GetSpreadingFactor (void) const;
+
+  void SetFrequency (double frequencyMHz);
+  double GetFrequency (void) const;
+
+  void SetDuration (Time duration);
+  Time GetDuration (void) const;
+
+  void SetTxTime (Time txTime);
+  Time GetTxTime (void) const;
+
+  void SetDownlink (bool downlink);
+  bool IsDownlink (void) const;
+
+private:
+  Vector m_senderPosition; //!< The position of the sender
+  double m_txPowerDbm; //!< The transmission power
+  uint8_t m_sf; //!< The spreading factor
+  double m_frequencyMHz; //!< The frequency
+  Time m_duration; //!< The on-air time
+  Time m_txTime; //!< The time the transmission started
+  bool m_downlink; //!< Whether the sender is a gateway
+};
+
+}
+}
+#endif /* LORA_REMOTE_TRANSMISSION_HEADER_H */
@@ -107,14 +107,14 @@ public:
   /**
    * Get the frequency of the packet.
    */
-  double GetFrequency (void);
+  double GetFrequency (void) const;
 
   /**
    * Get the data rate for this packet.
    *
    * \return The data rate that needs to be employed for this packet.
    */
-  uint8_t GetDataRate (void);
+  uint8_t GetDataRate (void) const;
 
   /**
    * Set the data rate for this packet.
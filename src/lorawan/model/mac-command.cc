@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include <bitset>
 #include <cmath>
+#include <cstring>
 
 namespace ns3 {
 namespace lorawan {
@@ -499,18 +500,24 @@ DutyCycleReq::GetMaximumAllowedDutyCycle (void) const
 {
   NS_LOG_FUNCTION (this);
 
+  return GetMaximumAllowedDutyCycle (m_maxDCycle);
+}
+
+double
+DutyCycleReq::GetMaximumAllowedDutyCycle (uint8_t maxDCycle)
+{
   // Check if we need to turn off completely
-  if (m_maxDCycle == 255)
+  if (maxDCycle == 255)
     {
       return 0;
     }
 
-  if (m_maxDCycle == 0)
+  if (maxDCycle == 0)
     {
       return 1;
     }
 
-  return 1 / std::pow (2,double(m_maxDCycle));
+  return 1 / std::pow (2,double(maxDCycle));
 }
 
 //////////////////
@@ -886,7 +893,7 @@ NewChannelReq::Deserialize (Buffer::Iterator &start)
   // Read the data
   m_chIndex = start.ReadU8 ();
   uint32_t encodedFrequency = 0;
-  encodedFrequency |= uint32_t (start.ReadU16 ()) << 8;
+  encodedFrequency |= uint32_t (start.ReadNtohU16 ()) << 8; // MSB first
   encodedFrequency |= uint32_t (start.ReadU8 ());
   m_frequency = double (encodedFrequency) * 100;
   uint8_t dataRateByte = start.ReadU8 ();
@@ -1220,5 +1227,368 @@ TxParamSetupAns::Print (std::ostream &os) const
   os << "TxParamSetupAns" << std::endl;
 }
 
+
+/////////////////////
+// MacCommandValue //
+/////////////////////
+
+MacCommandValue::MacCommandValue (enum MacCommandType commandType) :
+  type (commandType)
+{
+  // Zero all fields, whichever member is used
+  std::memset (&newChannelReq, 0, sizeof (newChannelReq));
+  std::memset (&linkAdrReq, 0, sizeof (linkAdrReq));
+}
+
+enum MacCommandType
+MacCommandValue::GetCommandType (uint8_t cid, bool isUplink)
+{
+  static const enum MacCommandType uplinkTypes[] =
+  {INVALID, INVALID, LINK_CHECK_REQ, LINK_ADR_ANS, DUTY_CYCLE_ANS,
+   RX_PARAM_SETUP_ANS, DEV_STATUS_ANS, NEW_CHANNEL_ANS, RX_TIMING_SETUP_ANS,
+   TX_PARAM_SETUP_ANS, DL_CHANNEL_ANS};
+  static const enum MacCommandType downlinkTypes[] =
+  {INVALID, INVALID, LINK_CHECK_ANS, LINK_ADR_REQ, DUTY_CYCLE_REQ,
+   RX_PARAM_SETUP_REQ, DEV_STATUS_REQ, NEW_CHANNEL_REQ, RX_TIMING_SETUP_REQ,
+   TX_PARAM_SETUP_REQ, INVALID};
+
+  if (cid > 0x0A)
+    {
+      return INVALID;
+    }
+  return isUplink ? uplinkTypes[cid] : downlinkTypes[cid];
+}
+
+uint8_t
+MacCommandValue::GetSerializedSize (enum MacCommandType commandType)
+{
+  switch (commandType)
+    {
+    case (LINK_CHECK_ANS):
+    case (DEV_STATUS_ANS):
+      {
+        return 3;
+      }
+    case (LINK_ADR_REQ):
+    case (RX_PARAM_SETUP_REQ):
+      {
+        return 5;
+      }
+    case (NEW_CHANNEL_REQ):
+      {
+        return 6;
+      }
+    case (LINK_ADR_ANS):
+    case (DUTY_CYCLE_REQ):
+    case (RX_PARAM_SETUP_ANS):
+    case (NEW_CHANNEL_ANS):
+    case (RX_TIMING_SETUP_REQ):
+      {
+        return 2;
+      }
+    case (INVALID):
+      {
+        return 0;
+      }
+    default:
+      {
+        // Commands without fields
+        return 1;
+      }
+    }
+}
+
+bool
+MacCommandValue::IsUplink (enum MacCommandType commandType)
+{
+  switch (commandType)
+    {
+    case (LINK_CHECK_REQ):
+    case (LINK_ADR_ANS):
+    case (DUTY_CYCLE_ANS):
+    case (RX_PARAM_SETUP_ANS):
+    case (DEV_STATUS_ANS):
+    case (NEW_CHANNEL_ANS):
+    case (RX_TIMING_SETUP_ANS):
+    case (TX_PARAM_SETUP_ANS):
+    case (DL_CHANNEL_ANS):
+      {
+        return true;
+      }
+    default:
+      {
+        return false;
+      }
+    }
+}
+
+uint8_t
+MacCommandValue::GetSerializedSize (void) const
+{
+  return GetSerializedSize (type);
+}
+
+void
+MacCommandValue::Serialize (uint8_t *start) const
+{
+  NS_ASSERT (type != INVALID);
+
+  start[0] = MacCommand::GetCIDFromMacCommand (type);
+  switch (type)
+    {
+    case (LINK_CHECK_ANS):
+      {
+        start[1] = linkCheckAns.margin;
+        start[2] = linkCheckAns.gwCnt;
+        break;
+      }
+    case (LINK_ADR_REQ):
+      {
+        start[1] = linkAdrReq.dataRate << 4 | (linkAdrReq.txPower & 0b1111);
+        start[2] = linkAdrReq.channelMask & 0xff; // Like Buffer::WriteU16
+        start[3] = linkAdrReq.channelMask >> 8;
+        start[4] = linkAdrReq.chMaskCntl << 4 | (linkAdrReq.nbRep & 0b1111);
+        break;
+      }
+    case (LINK_ADR_ANS):
+      {
+        start[1] = (uint8_t (linkAdrAns.powerAck) << 2)
+          | (uint8_t (linkAdrAns.dataRateAck) << 1)
+          | uint8_t (linkAdrAns.channelMaskAck);
+        break;
+      }
+    case (DUTY_CYCLE_REQ):
+      {
+        start[1] = dutyCycleReq.maxDCycle;
+        break;
+      }
+    case (RX_PARAM_SETUP_REQ):
+      {
+        uint32_t encodedFrequency = uint32_t (rxParamSetupReq.frequency / 100);
+        start[1] = (rxParamSetupReq.rx1DrOffset & 0b111) << 4
+          | (rxParamSetupReq.rx2DataRate & 0b1111);
+        start[2] = (encodedFrequency & 0xff0000) >> 16;
+        start[3] = (encodedFrequency & 0xff00) >> 8;
+        start[4] = encodedFrequency & 0xff;
+        break;
+      }
+    case (RX_PARAM_SETUP_ANS):
+      {
+        start[1] = uint8_t (rxParamSetupAns.rx1DrOffsetAck) << 2
+          | uint8_t (rxParamSetupAns.rx2DataRateAck) << 1
+          | uint8_t (rxParamSetupAns.channelAck);
+        break;
+      }
+    case (DEV_STATUS_ANS):
+      {
+        start[1] = devStatusAns.battery;
+        start[2] = devStatusAns.margin;
+        break;
+      }
+    case (NEW_CHANNEL_REQ):
+      {
+        uint32_t encodedFrequency = uint32_t (newChannelReq.frequency / 100);
+        start[1] = newChannelReq.chIndex;
+        start[2] = (encodedFrequency & 0xff0000) >> 16;
+        start[3] = (encodedFrequency & 0xff00) >> 8;
+        start[4] = encodedFrequency & 0xff;
+        start[5] = (newChannelReq.maxDataRate << 4)
+          | (newChannelReq.minDataRate & 0xf);
+        break;
+      }
+    case (NEW_CHANNEL_ANS):
+      {
+        start[1] = (uint8_t (newChannelAns.dataRateRangeOk) << 1)
+          | uint8_t (newChannelAns.channelFrequencyOk);
+        break;
+      }
+    case (RX_TIMING_SETUP_REQ):
+      {
+        start[1] = rxTimingSetupReq.delay & 0xf;
+        break;
+      }
+    default:
+      {
+        // Only the CID
+        break;
+      }
+    }
+}
+
+uint8_t
+MacCommandValue::Deserialize (const uint8_t *start, bool isUplink)
+{
+  *this = MacCommandValue (GetCommandType (start[0], isUplink));
+
+  switch (type)
+    {
+    case (INVALID):
+      {
+        return 0;
+      }
+    case (LINK_CHECK_ANS):
+      {
+        linkCheckAns.margin = start[1];
+        linkCheckAns.gwCnt = start[2];
+        break;
+      }
+    case (LINK_ADR_REQ):
+      {
+        linkAdrReq.dataRate = start[1] >> 4;
+        linkAdrReq.txPower = start[1] & 0b1111;
+        linkAdrReq.channelMask = start[2] | uint16_t (start[3]) << 8;
+        linkAdrReq.chMaskCntl = start[4] >> 4;
+        linkAdrReq.nbRep = start[4] & 0b1111;
+        break;
+      }
+    case (LINK_ADR_ANS):
+      {
+        linkAdrAns.powerAck = start[1] & 0b100;
+        linkAdrAns.dataRateAck = start[1] & 0b10;
+        linkAdrAns.channelMaskAck = start[1] & 0b1;
+        break;
+      }
+    case (DUTY_CYCLE_REQ):
+      {
+        dutyCycleReq.maxDCycle = start[1];
+        break;
+      }
+    case (RX_PARAM_SETUP_REQ):
+      {
+        uint32_t encodedFrequency = (uint32_t (start[2]) << 16)
+          | (uint32_t (start[3]) << 8) | start[4];
+        rxParamSetupReq.rx1DrOffset = (start[1] & 0b1110000) >> 4;
+        rxParamSetupReq.rx2DataRate = start[1] & 0b1111;
+        rxParamSetupReq.frequency = double (encodedFrequency) * 100;
+        break;
+      }
+    case (RX_PARAM_SETUP_ANS):
+      {
+        rxParamSetupAns.rx1DrOffsetAck = start[1] & 0b100;
+        rxParamSetupAns.rx2DataRateAck = start[1] & 0b10;
+        rxParamSetupAns.channelAck = start[1] & 0b1;
+        break;
+      }
+    case (DEV_STATUS_ANS):
+      {
+        devStatusAns.battery = start[1];
+        devStatusAns.margin = start[2] & 0b111111;
+        break;
+      }
+    case (NEW_CHANNEL_REQ):
+      {
+        uint32_t encodedFrequency = (uint32_t (start[2]) << 16)
+          | (uint32_t (start[3]) << 8) | start[4];
+        newChannelReq.chIndex = start[1];
+        newChannelReq.frequency = double (encodedFrequency) * 100;
+        newChannelReq.maxDataRate = start[5] >> 4;
+        newChannelReq.minDataRate = start[5] & 0xf;
+        break;
+      }
+    case (NEW_CHANNEL_ANS):
+      {
+        newChannelAns.dataRateRangeOk = start[1] & 0b10;
+        newChannelAns.channelFrequencyOk = start[1] & 0b1;
+        break;
+      }
+    case (RX_TIMING_SETUP_REQ):
+      {
+        rxTimingSetupReq.delay = start[1] & 0xf;
+        break;
+      }
+    default:
+      {
+        // Only the CID
+        break;
+      }
+    }
+
+  return GetSerializedSize ();
+}
+
+void
+MacCommandValue::Print (std::ostream &os) const
+{
+  // Reuse the format of the MacCommand classes
+  if (type != INVALID)
+    {
+      CreateMacCommand ()->Print (os);
+    }
+}
+
+Ptr<MacCommand>
+MacCommandValue::CreateMacCommand (void) const
+{
+  switch (type)
+    {
+    case (LINK_CHECK_REQ):
+      return Create<LinkCheckReq> ();
+    case (LINK_CHECK_ANS):
+      return Create<LinkCheckAns> (linkCheckAns.margin, linkCheckAns.gwCnt);
+    case (LINK_ADR_REQ):
+      return Create<LinkAdrReq> (linkAdrReq.dataRate, linkAdrReq.txPower,
+                                 linkAdrReq.channelMask, linkAdrReq.chMaskCntl,
+                                 linkAdrReq.nbRep);
+    case (LINK_ADR_ANS):
+      return Create<LinkAdrAns> (linkAdrAns.powerAck, linkAdrAns.dataRateAck,
+                                 linkAdrAns.channelMaskAck);
+    case (DUTY_CYCLE_REQ):
+      return Create<DutyCycleReq> (dutyCycleReq.maxDCycle);
+    case (DUTY_CYCLE_ANS):
+      return Create<DutyCycleAns> ();
+    case (RX_PARAM_SETUP_REQ):
+      return Create<RxParamSetupReq> (rxParamSetupReq.rx1DrOffset,
+                                      rxParamSetupReq.rx2DataRate,
+                                      rxParamSetupReq.frequency);
+    case (RX_PARAM_SETUP_ANS):
+      return Create<RxParamSetupAns> (rxParamSetupAns.rx1DrOffsetAck,
+                                      rxParamSetupAns.rx2DataRateAck,
+                                      rxParamSetupAns.channelAck);
+    case (DEV_STATUS_REQ):
+      return Create<DevStatusReq> ();
+    case (DEV_STATUS_ANS):
+      return Create<DevStatusAns> (devStatusAns.battery, devStatusAns.margin);
+    case (NEW_CHANNEL_REQ):
+      return Create<NewChannelReq> (newChannelReq.chIndex, newChannelReq.frequency,
+                                    newChannelReq.minDataRate,
+                                    newChannelReq.maxDataRate);
+    case (NEW_CHANNEL_ANS):
+      return Create<NewChannelAns> (newChannelAns.dataRateRangeOk,
+                                    newChannelAns.channelFrequencyOk);
+    case (RX_TIMING_SETUP_REQ):
+      return Create<RxTimingSetupReq> (rxTimingSetupReq.delay);
+    case (RX_TIMING_SETUP_ANS):
+      return Create<RxTimingSetupAns> ();
+    case (TX_PARAM_SETUP_REQ):
+      return Create<TxParamSetupReq> ();
+    case (TX_PARAM_SETUP_ANS):
+      return Create<TxParamSetupAns> ();
+    case (DL_CHANNEL_ANS):
+      return Create<DlChannelAns> ();
+    default:
+      NS_ABORT_MSG ("MAC command type " << type << " has no MacCommand class");
+    }
+  return 0;
+}
+
+MacCommandValue
+MacCommandValue::FromMacCommand (Ptr<const MacCommand> macCommand)
+{
+  NS_LOG_FUNCTION (macCommand);
+
+  // Only the classes know their fields, so go through their serialization
+  uint8_t size = macCommand->GetSerializedSize ();
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator it = buffer.Begin ();
+  macCommand->Serialize (it);
+  uint8_t bytes[6];
+  NS_ASSERT (size <= sizeof (bytes));
+  buffer.CopyData (bytes, size);
+
+  MacCommandValue value;
+  value.Deserialize (bytes, IsUplink (macCommand->GetCommandType ()));
+  return value;
+}
 }
 }
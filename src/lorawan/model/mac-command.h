@@ -313,6 +313,15 @@ public:
    */
   double GetMaximumAllowedDutyCycle (void) const;
 
+  /**
+   * Get the maximum duty cycle, in fraction form, encoded by the MaxDCycle
+   * field of a DutyCycleReq.
+   *
+   * \param maxDCycle The field of the command.
+   * \return The maximum duty cycle.
+   */
+  static double GetMaximumAllowedDutyCycle (uint8_t maxDCycle);
+
 private:
   uint8_t m_maxDCycle;
 };
@@ -609,6 +618,142 @@ public:
 
 private:
 };
+
+/**
+ * A MAC command stored by value, which can be copied, serialized and parsed
+ * without heap allocations.
+ *
+ * The type tells which member of the union holds the fields of the command;
+ * commands without fields only have a type. The wire format is the same as
+ * the one of the MacCommand classes, which are still used by code that works
+ * with Ptr<MacCommand>.
+ */
+struct MacCommandValue
+{
+  /**
+   * Create a command of a type, with all fields set to zero.
+   */
+  MacCommandValue (enum MacCommandType commandType = INVALID);
+
+  /**
+   * Get the type of command a CID stands for. Uplink and downlink commands
+   * share CIDs.
+   *
+   * \param cid The CID.
+   * \param isUplink Whether the command was sent by an end device.
+   * \return The type, or INVALID if the CID is not supported.
+   */
+  static enum MacCommandType GetCommandType (uint8_t cid, bool isUplink);
+
+  /**
+   * Get the number of bytes a type of command takes up, CID included.
+   */
+  static uint8_t GetSerializedSize (enum MacCommandType commandType);
+
+  /**
+   * Whether a type of command is sent by end devices.
+   */
+  static bool IsUplink (enum MacCommandType commandType);
+
+  /**
+   * Get the number of bytes this command takes up, CID included.
+   */
+  uint8_t GetSerializedSize (void) const;
+
+  /**
+   * Write this command, CID included.
+   *
+   * \param start Where to write GetSerializedSize () bytes.
+   */
+  void Serialize (uint8_t *start) const;
+
+  /**
+   * Read a command, CID included.
+   *
+   * \param start The serialized command.
+   * \param isUplink Whether the command was sent by an end device.
+   * \return The number of bytes that were read, or 0 if the CID is not
+   * supported.
+   */
+  uint8_t Deserialize (const uint8_t *start, bool isUplink);
+
+  /**
+   * Print the contents of this command in human-readable format.
+   */
+  void Print (std::ostream &os) const;
+
+  /**
+   * Create a MacCommand object with the contents of this command.
+   */
+  Ptr<MacCommand> CreateMacCommand (void) const;
+
+  /**
+   * Get the value of a MacCommand object.
+   */
+  static MacCommandValue FromMacCommand (Ptr<const MacCommand> macCommand);
+
+  enum MacCommandType type; //!< The type of this command
+
+  union
+  {
+    struct
+    {
+      uint8_t margin;
+      uint8_t gwCnt;
+    } linkCheckAns;
+    struct
+    {
+      uint8_t dataRate;
+      uint8_t txPower;
+      uint16_t channelMask;
+      uint8_t chMaskCntl;
+      uint8_t nbRep;
+    } linkAdrReq;
+    struct
+    {
+      bool powerAck;
+      bool dataRateAck;
+      bool channelMaskAck;
+    } linkAdrAns;
+    struct
+    {
+      uint8_t maxDCycle;
+    } dutyCycleReq;
+    struct
+    {
+      uint8_t rx1DrOffset;
+      uint8_t rx2DataRate;
+      double frequency; //!< The frequency _in Hz_
+    } rxParamSetupReq;
+    struct
+    {
+      bool rx1DrOffsetAck;
+      bool rx2DataRateAck;
+      bool channelAck;
+    } rxParamSetupAns;
+    struct
+    {
+      uint8_t battery;
+      uint8_t margin;
+    } devStatusAns;
+    struct
+    {
+      uint8_t chIndex;
+      double frequency; //!< The frequency _in Hz_
+      uint8_t minDataRate;
+      uint8_t maxDataRate;
+    } newChannelReq;
+    struct
+    {
+      bool dataRateRangeOk;
+      bool channelFrequencyOk;
+    } newChannelAns;
+    struct
+    {
+      uint8_t delay;
+    } rxTimingSetupReq;
+  };
+};
 }
 
 }
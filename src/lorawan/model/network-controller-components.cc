@@ -19,6 +19,15 @@
  */
 
 #include "ns3/network-controller-components.h"
+#include "ns3/lora-profiler.h"
+#include "ns3/lora-tag.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 namespace lorawan {
@@ -166,21 +175,17 @@ LinkCheckComponent::BeforeSendingReply (Ptr<EndDeviceStatus> status,
   myPacket->RemoveHeader (mHdr);
   myPacket->RemoveHeader (fHdr);
 
-  Ptr<LinkCheckReq> command = fHdr.GetMacCommand<LinkCheckReq> ();
-
-  // GetMacCommand returns 0 if no command is found
-  if (command)
+  MacCommandValue command;
+  if (fHdr.FindCommand (LINK_CHECK_REQ, command))
     {
       status->m_reply.needsReply = true;
 
       // Get the number of gateways that received the packet and the best
       // margin
-      uint8_t gwCount = status->GetLastReceivedPacketInfo ().gwList.size ();
+      uint8_t gwCount = status->GetLastReceivedPacketGatewayCount ();
 
-      Ptr<LinkCheckAns> replyCommand = Create<LinkCheckAns> ();
-      replyCommand->SetGwCnt (gwCount);
       status->m_reply.frameHeader.SetAsDownlink ();
-      status->m_reply.frameHeader.AddCommand (replyCommand);
+      status->m_reply.frameHeader.AddLinkCheckAns (0, gwCount);
       status->m_reply.macHeader.SetMType (LoraMacHeader::UNCONFIRMED_DATA_DOWN);
     }
   else
@@ -195,5 +200,334 @@ LinkCheckComponent::OnFailedReply (Ptr<EndDeviceStatus> status,
 {
   NS_LOG_FUNCTION (this->GetTypeId () << networkStatus);
 }
+
+//////////////////////////////
+// AdrComponent::SnrHistory //
+//////////////////////////////
+AdrComponent::SnrHistory::SnrHistory (uint8_t capacity) :
+  m_values (capacity),
+  m_maxQueue (capacity),
+  m_capacity (capacity),
+  m_size (0),
+  m_next (0),
+  m_maxHead (0),
+  m_maxSize (0),
+  m_sum (0)
+{
+  NS_ASSERT (capacity > 0);
+}
+
+void
+AdrComponent::SnrHistory::Add (double snr)
+{
+  float value = snr;
+
+  if (m_size == m_capacity)
+    {
+      // The oldest value leaves the history, and the maximum queue if it's
+      // still there
+      m_sum -= m_values[m_next];
+      if (m_maxQueue[m_maxHead] == m_next)
+        {
+          m_maxHead = (m_maxHead + 1) % m_capacity;
+          m_maxSize--;
+        }
+    }
+  else
+    {
+      m_size++;
+    }
+
+  m_values[m_next] = value;
+  m_sum += value;
+
+  // Values that are not larger than the new one can't be the maximum anymore
+  while (m_maxSize > 0
+         && m_values[m_maxQueue[(m_maxHead + m_maxSize - 1) % m_capacity]] <= value)
+    {
+      m_maxSize--;
+    }
+  m_maxQueue[(m_maxHead + m_maxSize) % m_capacity] = m_next;
+  m_maxSize++;
+
+  m_next = (m_next + 1) % m_capacity;
+}
+
+void
+AdrComponent::SnrHistory::RaiseNewest (double snr)
+{
+  float value = snr;
+  uint8_t newest = (m_next + m_capacity - 1) % m_capacity;
+  if (m_size == 0 || value <= m_values[newest])
+    {
+      return;
+    }
+
+  m_sum += value - m_values[newest];
+  m_values[newest] = value;
+
+  // The newest value is always at the back of the queue
+  m_maxSize--;
+  while (m_maxSize > 0
+         && m_values[m_maxQueue[(m_maxHead + m_maxSize - 1) % m_capacity]] <= value)
+    {
+      m_maxSize--;
+    }
+  m_maxQueue[(m_maxHead + m_maxSize) % m_capacity] = newest;
+  m_maxSize++;
+}
+
+void
+AdrComponent::SnrHistory::Clear (void)
+{
+  m_size = 0;
+  m_next = 0;
+  m_maxHead = 0;
+  m_maxSize = 0;
+  m_sum = 0;
+}
+
+uint8_t
+AdrComponent::SnrHistory::GetSize (void) const
+{
+  return m_size;
+}
+
+bool
+AdrComponent::SnrHistory::IsFull (void) const
+{
+  return m_size == m_capacity;
+}
+
+double
+AdrComponent::SnrHistory::GetMaximum (void) const
+{
+  NS_ASSERT (m_size > 0);
+
+  return m_values[m_maxQueue[m_maxHead]];
+}
+
+double
+AdrComponent::SnrHistory::GetAverage (void) const
+{
+  NS_ASSERT (m_size > 0);
+
+  return m_sum / m_size;
+}
+
+//////////////////
+// AdrComponent //
+//////////////////
+TypeId
+AdrComponent::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AdrComponent")
+    .SetParent<NetworkControllerComponent> ()
+    .AddConstructor<AdrComponent> ()
+    .SetGroupName ("lorawan")
+    .AddAttribute ("HistoryRange",
+                   "Number of uplinks the ADR decision is based on",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&AdrComponent::m_historyRange),
+                   MakeUintegerChecker<uint8_t> (1))
+    .AddAttribute ("MultiplePacketsCombiningMethod",
+                   "How the SNR of the uplinks in the history is combined",
+                   EnumValue (AdrComponent::MAXIMUM),
+                   MakeEnumAccessor (&AdrComponent::m_combiningMethod),
+                   MakeEnumChecker (AdrComponent::AVERAGE, "avg",
+                                    AdrComponent::MAXIMUM, "max"))
+    .AddAttribute ("MarginDb",
+                   "SNR margin above the demodulation threshold that devices "
+                   "are left with, in dB",
+                   DoubleValue (10),
+                   MakeDoubleAccessor (&AdrComponent::m_marginDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("ChangeTransmissionPower",
+                   "Whether the transmission power of devices is also adapted",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&AdrComponent::m_changeTxPower),
+                   MakeBooleanChecker ());
+  return tid;
+}
+
+AdrComponent::AdrComponent ()
+{
+}
+AdrComponent::~AdrComponent ()
+{
+}
+
+AdrComponent::DeviceState::DeviceState (uint8_t historyRange) :
+  history (historyRange),
+  txPowerDbm (14),  // The default of end devices
+  requestPending (false),
+  requestedTxPowerDbm (14)
+{
+}
+
+double
+AdrComponent::GetSnr (double rxPowerDbm)
+{
+  // Thermal noise over a 125 kHz channel, with a 6 dB noise figure
+  static const double noiseDbm = -174 + 10 * std::log10 (125000.0) + 6;
+
+  return rxPowerDbm - noiseDbm;
+}
+
+void
+AdrComponent::OnReceivedPacket (Ptr<const Packet> packet,
+                                Ptr<EndDeviceStatus> status,
+                                Ptr<NetworkStatus> networkStatus)
+{
+  NS_LOG_FUNCTION (this->GetTypeId () << packet << networkStatus);
+
+  LoraProfiler::Scope profilerScope (LoraProfiler::ADR_UPDATE);
+
+  LoraMacHeader mHdr;
+  LoraFrameHeader fHdr;
+  fHdr.SetAsUplink ();
+  Ptr<Packet> myPacket = packet->Copy ();
+  myPacket->RemoveHeader (mHdr);
+  myPacket->RemoveHeader (fHdr);
+
+  uint32_t address = status->m_endDeviceAddress.Get ();
+  auto it = m_devices.find (address);
+
+  // The device only changes its settings when it accepts the whole request,
+  // and this packet was sent with the new ones
+  MacCommandValue command;
+  if (it != m_devices.end () && it->second.requestPending
+      && fHdr.FindCommand (LINK_ADR_ANS, command))
+    {
+      DeviceState &device = it->second;
+      device.requestPending = false;
+      if (command.linkAdrAns.powerAck && command.linkAdrAns.dataRateAck
+          && command.linkAdrAns.channelMaskAck)
+        {
+          device.txPowerDbm = device.requestedTxPowerDbm;
+          device.history.Clear ();
+        }
+    }
+
+  if (!fHdr.GetAdr ())
+    {
+      return;
+    }
+
+  // Only the first gateway is known now, the others will be accounted for
+  // before sending the reply
+  LoraTag tag;
+  packet->PeekPacketTag (tag);
+
+  if (it == m_devices.end ())
+    {
+      it = m_devices.emplace (address, DeviceState (m_historyRange)).first;
+    }
+  it->second.history.Add (GetSnr (tag.GetReceivePower ()));
+}
+
+void
+AdrComponent::BeforeSendingReply (Ptr<EndDeviceStatus> status,
+                                  Ptr<NetworkStatus> networkStatus)
+{
+  NS_LOG_FUNCTION (this << status << networkStatus);
+
+  LoraProfiler::Scope profilerScope (LoraProfiler::ADR_DECISION);
+
+  auto it = m_devices.find (status->m_endDeviceAddress.Get ());
+  if (it == m_devices.end ())
+    {
+      return;
+    }
+  DeviceState &device = it->second;
+
+  device.history.RaiseNewest
+    (GetSnr (status->GetLastReceivedPacketBestRxPower ()));
+
+  if (!device.history.IsFull ())
+    {
+      return;
+    }
+
+  double snr = (m_combiningMethod == MAXIMUM) ?
+    device.history.GetMaximum () : device.history.GetAverage ();
+
+  // This is the spreading factor of the last uplink
+  uint8_t spreadingFactor = status->GetFirstReceiveWindowSpreadingFactor ();
+  uint8_t newSpreadingFactor = spreadingFactor;
+  double newTxPowerDbm = device.txPowerDbm;
+  AdrImplementation (snr, newSpreadingFactor, newTxPowerDbm);
+
+  if (newSpreadingFactor == spreadingFactor
+      && newTxPowerDbm == device.txPowerDbm)
+    {
+      return;
+    }
+
+  NS_LOG_DEBUG ("Device " << status->m_endDeviceAddress << " with SNR " << snr
+                          << " dB goes from SF" << unsigned (spreadingFactor)
+                          << " and " << device.txPowerDbm << " dBm to SF"
+                          << unsigned (newSpreadingFactor) << " and "
+                          << newTxPowerDbm << " dBm");
+
+  // EU868 data rates and transmission powers
+  uint8_t dataRate = 12 - newSpreadingFactor;
+  uint8_t txPower = (16 - newTxPowerDbm) / 2;
+  std::list<int> enabledChannels = {0, 1, 2};
+
+  status->m_reply.needsReply = true;
+  status->m_reply.frameHeader.SetAsDownlink ();
+  status->m_reply.frameHeader.SetAddress (status->m_endDeviceAddress);
+  status->m_reply.frameHeader.AddLinkAdrReq (dataRate, txPower,
+                                             enabledChannels, 1);
+  status->m_reply.macHeader.SetMType (LoraMacHeader::UNCONFIRMED_DATA_DOWN);
+
+  // The settings are only known to change when the device answers. Until
+  // then, the request is repeated if the device keeps its old settings.
+  device.requestPending = true;
+  device.requestedTxPowerDbm = newTxPowerDbm;
+}
+
+void
+AdrComponent::OnFailedReply (Ptr<EndDeviceStatus> status,
+                             Ptr<NetworkStatus> networkStatus)
+{
+  NS_LOG_FUNCTION (this->GetTypeId () << networkStatus);
+}
+
+void
+AdrComponent::AdrImplementation (double snr, uint8_t &sf,
+                                 double &txPowerDbm) const
+{
+  // SNR needed to demodulate SF7 to SF12
+  static const double requiredSnr[] = {-7.5, -10, -12.5, -15, -17.5, -20};
+  NS_ASSERT (7 <= sf && sf <= 12);
+
+  double margin = snr - requiredSnr[sf - 7] - m_marginDb;
+  int nStep = std::floor (margin / 3);
+
+  // Use the margin to speed up transmissions first, and then to save power
+  while (nStep > 0 && sf > 7)
+    {
+      sf--;
+      nStep--;
+    }
+
+  if (!m_changeTxPower)
+    {
+      return;
+    }
+
+  while (nStep > 0 && txPowerDbm > 2)
+    {
+      txPowerDbm -= 2;
+      nStep--;
+    }
+  while (nStep < 0 && txPowerDbm < 14)
+    {
+      txPowerDbm += 2;
+      nStep++;
+    }
+}
 }
 }
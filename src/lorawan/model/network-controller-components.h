@@ -25,6 +25,8 @@
 #include "ns3/log.h"
 #include "ns3/packet.h"
 #include "ns3/network-status.h"
+#include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 namespace lorawan {
@@ -141,6 +143,169 @@ private:
   void UpdateLinkCheckAns (Ptr<Packet const> packet,
                            Ptr<EndDeviceStatus> status);
 };
+
+//////////////////////////////
+// Adaptive Data Rate (ADR) //
+//////////////////////////////
+
+/**
+ * Sends LinkAdrReq commands to the devices that set the ADR bit of their
+ * uplinks, following the ADR algorithm recommended by Semtech.
+ *
+ * For each device, the component keeps the SNR of its last HistoryRange
+ * uplinks, estimated from the power received by the best gateway. Once the
+ * history is full, the maximum or average SNR is compared with the one
+ * required by the spreading factor of the device: every 3 dB of margin above
+ * MarginDb lowers the spreading factor and then the transmission power by one
+ * step, and every 3 dB below it raises the transmission power. If the
+ * settings of the device change, a LinkAdrReq is added to the next reply.
+ * The component only adopts the new settings when the device accepts them
+ * with a LinkAdrAns, and then empties the history, since its SNR values refer
+ * to the old settings. Requests that are lost or rejected leave the settings
+ * and the history as they are.
+ *
+ * The history of each device is a ring buffer of fixed capacity, whose
+ * maximum and average are updated at every uplink, so that the cost of the
+ * component doesn't depend on HistoryRange.
+ */
+class AdrComponent : public NetworkControllerComponent
+{
+public:
+  /**
+   * How the SNR values of the history are combined.
+   */
+  enum CombiningMethod
+  {
+    AVERAGE,
+    MAXIMUM
+  };
+
+  /**
+   * The last SNR values of a device, with their running maximum and average.
+   *
+   * Values are kept in a ring buffer, and the maximum is the front of a queue
+   * of slots of the buffer whose values are decreasing: a value is only
+   * queued behind larger ones, which leave the queue before it. Adding a
+   * value thus takes constant amortized time.
+   */
+  class SnrHistory
+  {
+public:
+    /**
+     * Create a history keeping up to capacity values, at most 255.
+     */
+    SnrHistory (uint8_t capacity);
+
+    /**
+     * Add a value, replacing the oldest one if the history is full.
+     */
+    void Add (double snr);
+
+    /**
+     * Replace the newest value with a larger one. Smaller values are ignored.
+     */
+    void RaiseNewest (double snr);
+
+    /**
+     * Remove all values.
+     */
+    void Clear (void);
+
+    /**
+     * Get the number of values in the history.
+     */
+    uint8_t GetSize (void) const;
+
+    /**
+     * Whether the history holds as many values as its capacity.
+     */
+    bool IsFull (void) const;
+
+    /**
+     * Get the largest value. The history must not be empty.
+     */
+    double GetMaximum (void) const;
+
+    /**
+     * Get the average of the values. The history must not be empty.
+     */
+    double GetAverage (void) const;
+
+private:
+    std::vector<float> m_values; //!< The ring buffer of values
+    std::vector<uint8_t> m_maxQueue; //!< Ring buffer of slots, by decreasing value
+    uint8_t m_capacity; //!< The maximum number of values
+    uint8_t m_size; //!< The number of values
+    uint8_t m_next; //!< The slot of the next value
+    uint8_t m_maxHead; //!< The first entry of m_maxQueue
+    uint8_t m_maxSize; //!< The number of entries of m_maxQueue
+    double m_sum; //!< The sum of the values
+  };
+
+  static TypeId GetTypeId (void);
+
+  // Constructor and destructor
+  AdrComponent ();
+  virtual ~AdrComponent ();
+
+  /**
+   * Adopt the settings of a pending request if the packet accepts it, and
+   * add the SNR of the packet to the history of its sender, if it asked for
+   * ADR.
+   *
+   * \param packet The newly received packet
+   * \param networkStatus A pointer to the NetworkStatus object
+   */
+  void OnReceivedPacket (Ptr<const Packet> packet,
+                         Ptr<EndDeviceStatus> status,
+                         Ptr<NetworkStatus> networkStatus);
+
+  /**
+   * Account for the gateways that received the last packet after the first
+   * one, and add a LinkAdrReq to the reply if the device should change its
+   * settings.
+   */
+  void BeforeSendingReply (Ptr<EndDeviceStatus> status,
+                           Ptr<NetworkStatus> networkStatus);
+
+  void OnFailedReply (Ptr<EndDeviceStatus> status,
+                      Ptr<NetworkStatus> networkStatus);
+
+  /**
+   * Get the SNR of a packet, in dB, from the power it was received with.
+   */
+  static double GetSnr (double rxPowerDbm);
+
+private:
+  /**
+   * What the component knows about a device using ADR.
+   */
+  struct DeviceState
+  {
+    DeviceState (uint8_t historyRange);
+
+    SnrHistory history; //!< The SNR of the last uplinks
+    double txPowerDbm; //!< The transmission power accepted by the device
+    bool requestPending; //!< Whether a LinkAdrReq awaits its answer
+    double requestedTxPowerDbm; //!< The transmission power of that request
+  };
+
+  /**
+   * Compute the new settings of a device with the ADR algorithm.
+   *
+   * \param snr The SNR of the history.
+   * \param sf The spreading factor of the device, updated.
+   * \param txPowerDbm The transmission power of the device, updated.
+   */
+  void AdrImplementation (double snr, uint8_t &sf, double &txPowerDbm) const;
+
+  uint8_t m_historyRange; //!< The number of uplinks the decision is based on
+  enum CombiningMethod m_combiningMethod; //!< How the history is combined
+  double m_marginDb; //!< The SNR margin required by the algorithm
+  bool m_changeTxPower; //!< Whether the transmission power is controlled
+
+  std::unordered_map<uint32_t, DeviceState> m_devices; //!< The devices using ADR, by address
+};
 }
 
 }
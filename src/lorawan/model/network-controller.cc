@@ -68,12 +68,12 @@ NetworkController::OnNewPacket (Ptr<Packet const> packet)
   // callbacks and only be called in case a certain MAC command is contained.
   // For now, we call all components.
 
+  Ptr<EndDeviceStatus> edStatus = m_status->GetEndDeviceStatus (packet);
+
   // Inform each component about the new packet
   for (auto it = m_components.begin (); it != m_components.end (); ++it)
     {
-      (*it)->OnReceivedPacket (packet,
-                               m_status->GetEndDeviceStatus (packet),
-                               m_status);
+      (*it)->OnReceivedPacket (packet, edStatus, m_status);
     }
 }
 
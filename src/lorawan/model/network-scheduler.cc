@@ -44,9 +44,8 @@ NetworkScheduler::OnReceivedPacket (Ptr<const Packet> packet)
   // Create a copy of the packet
   Ptr<Packet> myPacket = packet->Copy ();
 
-  // TODO Check if this packet is a duplicate:
-  // It's possible that we already received the same packet from another
-  // gateway.
+  // Duplicates forwarded by other gateways were already filtered out by
+  // NetworkStatus, so this is the first copy of the packet.
   // - Extract the address
   LoraMacHeader macHeader;
   LoraFrameHeader frameHeader;
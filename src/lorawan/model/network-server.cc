@@ -31,6 +31,7 @@
 #include "ns3/node-container.h"
 #include "ns3/end-device-lora-mac.h"
 #include "ns3/mac-command.h"
+#include "ns3/lora-profiler.h"
 
 namespace ns3 {
 namespace lorawan {
@@ -155,18 +156,21 @@ NetworkServer::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
 {
   NS_LOG_FUNCTION (this << packet << protocol << address);
 
-  // Create a copy of the packet
-  Ptr<Packet> myPacket = packet->Copy ();
+  LoraProfiler::Scope profilerScope (LoraProfiler::NETWORK_SERVER);
 
   // Fire the trace source
   m_receivedPacket (packet);
 
+  // Inform the status of the newly arrived packet. If another gateway already
+  // forwarded it, the status just merges this gateway's information.
+  if (!m_status->OnReceivedPacket (packet, address))
+    {
+      return true;
+    }
+
   // Inform the scheduler of the newly arrived packet
   m_scheduler->OnReceivedPacket (packet);
 
-  // Inform the status of the newly arrived packet
-  m_status->OnReceivedPacket (packet, address);
-
   // Inform the controller of the newly arrived packet
   m_controller->OnNewPacket (packet);
 
@@ -29,6 +29,7 @@
 #include "ns3/node-container.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/simulator.h"
 
 namespace ns3 {
 namespace lorawan {
@@ -46,7 +47,9 @@ NetworkStatus::GetTypeId (void)
   return tid;
 }
 
-NetworkStatus::NetworkStatus ()
+NetworkStatus::NetworkStatus () :
+  m_gatewayTable (Create<GatewayAddressTable> ()),
+  m_deduplicationWindow (Seconds (1))
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -63,15 +66,15 @@ NetworkStatus::AddNode (Ptr<EndDeviceLoraMac> edMac)
 
   // Check whether this device already exists in our list
   LoraDeviceAddress edAddress = edMac->GetDeviceAddress ();
-  if (m_endDeviceStatuses.find (edAddress) == m_endDeviceStatuses.end ())
+  if (m_endDeviceStatuses.Find (edAddress) == 0)
     {
       // The device doesn't exist. Create new EndDeviceStatus
       Ptr<EndDeviceStatus> edStatus = CreateObject<EndDeviceStatus>
           (edAddress, edMac->GetObject<EndDeviceLoraMac>());
+      edStatus->SetGatewayAddressTable (m_gatewayTable);
 
-      // Add it to the map
-      m_endDeviceStatuses.insert (std::pair<LoraDeviceAddress, Ptr<EndDeviceStatus> >
-                                    (edAddress, edStatus));
+      // Add it to the table
+      m_endDeviceStatuses.Insert (edAddress, edStatus);
       NS_LOG_DEBUG ("Added to the list a device with address " <<
                     edAddress.Print ());
     }
@@ -83,18 +86,22 @@ NetworkStatus::AddGateway (Address& address, Ptr<GatewayStatus> gwStatus)
   NS_LOG_FUNCTION (this);
 
   // Check whether this device already exists in the list
-  if (m_gatewayStatuses.find (address) == m_gatewayStatuses.end ())
+  uint16_t index = m_gatewayTable->GetIndex (address);
+  if (index >= m_gatewayStatuses.size ())
+    {
+      m_gatewayStatuses.resize (index + 1);
+    }
+  if (m_gatewayStatuses[index] == 0)
     {
       // The device doesn't exist.
 
-      // Add it to the map
-      m_gatewayStatuses.insert (std::pair<Address, Ptr<GatewayStatus> >
-                                  (address, gwStatus));
+      // Add it to the table
+      m_gatewayStatuses[index] = gwStatus;
       NS_LOG_DEBUG ("Added to the list a gateway with address " << address);
     }
 }
 
-void
+bool
 NetworkStatus::OnReceivedPacket (Ptr<const Packet> packet,
                                  const Address& gwAddress)
 {
@@ -110,24 +117,81 @@ NetworkStatus::OnReceivedPacket (Ptr<const Packet> packet,
   frameHdr.SetAsUplink ();
   myPacket->RemoveHeader (frameHdr);
 
-  // Update the correct EndDeviceStatus object
   LoraDeviceAddress edAddr = frameHdr.GetAddress ();
   NS_LOG_DEBUG ("Node address: " << edAddr);
-  m_endDeviceStatuses.at (edAddr)->InsertReceivedPacket (packet, gwAddress);
+
+  // Check whether another gateway already forwarded this packet
+  CleanRecentUplinks ();
+  UplinkKey key = {edAddr.Get (), frameHdr.GetFCnt (), packet->GetUid ()};
+  auto it = m_recentUplinks.find (key);
+  if (it != m_recentUplinks.end ())
+    {
+      NS_LOG_DEBUG ("Duplicate packet, only adding gateway information");
+      it->second->InsertGatewayReception (packet, gwAddress, key.fCnt);
+      return false;
+    }
+
+  // Update the correct EndDeviceStatus object
+  Ptr<EndDeviceStatus> edStatus = GetKnownEndDeviceStatus (edAddr);
+  LoraTag tag;
+  packet->PeekPacketTag (tag);
+  edStatus->InsertReceivedPacket (packet, gwAddress, frameHdr.GetFCnt (), tag);
+
+  // Components will look for the sender of this packet
+  m_lastPacket = packet;
+  m_lastEndDeviceStatus = edStatus;
+
+  m_recentUplinks[key] = edStatus;
+  m_recentUplinkTimes.push_back (std::make_pair (Simulator::Now (), key));
+
+  return true;
+}
+
+void
+NetworkStatus::SetDeduplicationWindow (Time window)
+{
+  NS_LOG_FUNCTION (this << window);
+
+  m_deduplicationWindow = window;
+}
+
+void
+NetworkStatus::CleanRecentUplinks (void)
+{
+  Time limit = Simulator::Now () - m_deduplicationWindow;
+  while (!m_recentUplinkTimes.empty ()
+         && m_recentUplinkTimes.front ().first <= limit)
+    {
+      m_recentUplinks.erase (m_recentUplinkTimes.front ().second);
+      m_recentUplinkTimes.pop_front ();
+    }
+}
+
+bool
+NetworkStatus::UplinkKey::operator== (const UplinkKey &other) const
+{
+  return address == other.address && fCnt == other.fCnt && uid == other.uid;
+}
+
+std::size_t
+NetworkStatus::UplinkKeyHash::operator() (const UplinkKey &key) const
+{
+  // Packet UIDs are already unique among the uplinks in the window
+  return std::hash<uint64_t> () (key.uid);
 }
 
 bool
 NetworkStatus::NeedsReply (LoraDeviceAddress deviceAddress)
 {
-  // Throws out of range if no device is found
-  return m_endDeviceStatuses.at (deviceAddress)->NeedsReply ();
+  // Aborts if no device is found
+  return GetKnownEndDeviceStatus (deviceAddress)->NeedsReply ();
 }
 
 Address
 NetworkStatus::GetBestGatewayForDevice (LoraDeviceAddress deviceAddress)
 {
   // Get the endDeviceStatus we are interested in
-  Ptr<EndDeviceStatus> edStatus = m_endDeviceStatuses.at (deviceAddress);
+  Ptr<EndDeviceStatus> edStatus = GetKnownEndDeviceStatus (deviceAddress);
 
   // Get the list of gateways that this device can reach
   // NOTE: At this point, we could also take into account the whole network to
@@ -143,16 +207,16 @@ NetworkStatus::SendThroughGateway (Ptr<Packet> packet, Address gwAddress)
 {
   NS_LOG_FUNCTION (packet << gwAddress);
 
-  m_gatewayStatuses.find (gwAddress)->second->GetNetDevice ()->Send (packet,
-                                                                     gwAddress,
-                                                                     0x0800);
+  Ptr<GatewayStatus> gwStatus = GetGatewayStatus (gwAddress);
+  NS_ABORT_MSG_IF (gwStatus == 0, "Unknown gateway " << gwAddress);
+  gwStatus->GetNetDevice ()->Send (packet, gwAddress, 0x0800);
 }
 
 Ptr<Packet>
 NetworkStatus::GetReplyForDevice (LoraDeviceAddress edAddress, int windowNumber)
 {
   // Get the reply packet
-  Ptr<EndDeviceStatus> edStatus = m_endDeviceStatuses.find (edAddress)->second;
+  Ptr<EndDeviceStatus> edStatus = GetKnownEndDeviceStatus (edAddress);
   Ptr<Packet> packet = edStatus->GetCompleteReplyPacket ();
 
   // Apply the appropriate tag
@@ -178,22 +242,24 @@ NetworkStatus::GetEndDeviceStatus (Ptr<Packet const> packet)
 {
   NS_LOG_FUNCTION (this << packet);
 
+  // This is usually the packet that is being processed
+  if (packet == m_lastPacket)
+    {
+      return m_lastEndDeviceStatus;
+    }
+
   // Get the address
   LoraMacHeader mHdr;
   LoraFrameHeader fHdr;
   Ptr<Packet> myPacket = packet->Copy ();
   myPacket->RemoveHeader (mHdr);
   myPacket->RemoveHeader (fHdr);
-  auto it = m_endDeviceStatuses.find (fHdr.GetAddress ());
-  if (it != m_endDeviceStatuses.end ())
-    {
-      return (*it).second;
-    }
-  else
+  Ptr<EndDeviceStatus> edStatus = m_endDeviceStatuses.Find (fHdr.GetAddress ());
+  if (edStatus == 0)
     {
       NS_LOG_ERROR ("EndDeviceStatus not found");
-      return 0;
     }
+  return edStatus;
 }
 
 Ptr<EndDeviceStatus>
@@ -201,16 +267,152 @@ NetworkStatus::GetEndDeviceStatus (LoraDeviceAddress address)
 {
   NS_LOG_FUNCTION (this << address);
 
-  auto it = m_endDeviceStatuses.find (address);
-  if (it != m_endDeviceStatuses.end ())
+  Ptr<EndDeviceStatus> edStatus = m_endDeviceStatuses.Find (address);
+  if (edStatus == 0)
     {
-      return (*it).second;
+      NS_LOG_ERROR ("EndDeviceStatus not found");
     }
-  else
+  return edStatus;
+}
+
+Ptr<EndDeviceStatus>
+NetworkStatus::GetKnownEndDeviceStatus (LoraDeviceAddress address)
+{
+  Ptr<EndDeviceStatus> edStatus = m_endDeviceStatuses.Find (address);
+  NS_ABORT_MSG_IF (edStatus == 0, "Unknown device " << address);
+  return edStatus;
+}
+
+uint32_t
+NetworkStatus::GetNEndDevices (void) const
+{
+  return m_endDeviceStatuses.GetSize ();
+}
+
+std::vector<Ptr<EndDeviceStatus> >
+NetworkStatus::GetEndDeviceStatuses (void) const
+{
+  std::vector<Ptr<EndDeviceStatus> > statuses;
+  statuses.reserve (m_endDeviceStatuses.GetSize ());
+  m_endDeviceStatuses.GetStatuses (statuses);
+  return statuses;
+}
+
+Ptr<GatewayStatus>
+NetworkStatus::GetGatewayStatus (const Address& address) const
+{
+  // Unknown addresses must not be assigned an index
+  uint16_t index;
+  if (!m_gatewayTable->FindIndex (address, index)
+      || index >= m_gatewayStatuses.size ())
     {
-      NS_LOG_ERROR ("EndDeviceStatus not found");
       return 0;
     }
+  return m_gatewayStatuses[index];
+}
+
+/***********************************
+ *  NetworkStatus::EndDeviceTable  *
+ ***********************************/
+
+NetworkStatus::EndDeviceTable::EndDeviceTable () :
+  m_addresses (16),
+  m_statuses (16),
+  m_size (0),
+  m_shift (64 - 4)
+{
+}
+
+std::size_t
+NetworkStatus::EndDeviceTable::GetFirstSlot (uint32_t address) const
+{
+  // Fibonacci hashing spreads consecutive addresses over the whole table
+  return (address * 0x9e3779b97f4a7c15ULL) >> m_shift;
+}
+
+Ptr<EndDeviceStatus>
+NetworkStatus::EndDeviceTable::Find (LoraDeviceAddress address) const
+{
+  uint32_t key = address.Get ();
+  std::size_t mask = m_statuses.size () - 1;
+  for (std::size_t slot = GetFirstSlot (key); m_statuses[slot] != 0;
+       slot = (slot + 1) & mask)
+    {
+      if (m_addresses[slot] == key)
+        {
+          return m_statuses[slot];
+        }
+    }
+  return 0;
+}
+
+bool
+NetworkStatus::EndDeviceTable::Insert (LoraDeviceAddress address,
+                                       Ptr<EndDeviceStatus> status)
+{
+  NS_ASSERT (status != 0);
+
+  // Keep the table at most half full, so that probe sequences are short
+  if (2 * (m_size + 1) > m_statuses.size ())
+    {
+      Grow ();
+    }
+
+  uint32_t key = address.Get ();
+  std::size_t mask = m_statuses.size () - 1;
+  std::size_t slot = GetFirstSlot (key);
+  for (; m_statuses[slot] != 0; slot = (slot + 1) & mask)
+    {
+      if (m_addresses[slot] == key)
+        {
+          return false;
+        }
+    }
+  m_addresses[slot] = key;
+  m_statuses[slot] = status;
+  m_size++;
+  return true;
+}
+
+uint32_t
+NetworkStatus::EndDeviceTable::GetSize (void) const
+{
+  return m_size;
+}
+
+void
+NetworkStatus::EndDeviceTable::GetStatuses
+  (std::vector<Ptr<EndDeviceStatus> > &statuses) const
+{
+  for (std::size_t slot = 0; slot < m_statuses.size (); slot++)
+    {
+      if (m_statuses[slot] != 0)
+        {
+          statuses.push_back (m_statuses[slot]);
+        }
+    }
+}
+
+void
+NetworkStatus::EndDeviceTable::Grow (void)
+{
+  std::vector<uint32_t> addresses;
+  std::vector<Ptr<EndDeviceStatus> > statuses;
+  addresses.swap (m_addresses);
+  statuses.swap (m_statuses);
+
+  m_addresses.resize (2 * addresses.size ());
+  m_statuses.resize (2 * statuses.size ());
+  m_shift--;
+  m_size = 0;
+
+  for (std::size_t slot = 0; slot < statuses.size (); slot++)
+    {
+      if (statuses[slot] != 0)
+        {
+          Insert (LoraDeviceAddress (addresses[slot]), statuses[slot]);
+        }
+    }
 }
 }
 }
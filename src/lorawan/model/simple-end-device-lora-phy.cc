@@ -73,11 +73,15 @@ SimpleEndDeviceLoraPhy::Send (Ptr<Packet> packet, LoraTxParameters txParams,
   // We can send the packet: switch to the TX state
   SwitchToTx (txPowerDbm);
 
-  // Tag the packet with information about its Spreading Factor
-  LoraTag tag;
-  packet->RemovePacketTag (tag);
-  tag.SetSpreadingFactor (txParams.sf);
-  packet->AddPacketTag (tag);
+  // Tag the packet with information about its Spreading Factor, if trace
+  // sinks need it: receivers get it from the channel
+  if (m_tagPackets)
+    {
+      LoraTag tag;
+      packet->RemovePacketTag (tag);
+      tag.SetSpreadingFactor (txParams.sf);
+      packet->AddPacketTag (tag);
+    }
 
   // Send the packet over the channel
   NS_LOG_INFO ("Sending the packet in the channel");
@@ -163,6 +167,9 @@ SimpleEndDeviceLoraPhy::StartReceive (Ptr<Packet> packet, double rxPowerDbm,
         // Flag to signal whether we can receive the packet or not
         bool canLockOnPacket = true;
 
+        // Make the parameters available to the trace sinks below
+        SetRxParameters (packet, sf, rxPowerDbm, frequencyMHz, 0);
+
         // Save needed sensitivity
         double sensitivity = EndDeviceLoraPhy::sensitivity[unsigned(sf) - 7];
 
@@ -264,7 +271,10 @@ SimpleEndDeviceLoraPhy::EndReceive (Ptr<Packet> packet,
 
   // Call the LoraInterferenceHelper to determine whether there was destructive
   // interference on this event.
-  bool packetDestroyed = m_interference.IsDestroyedByInterference (event);
+  uint8_t packetDestroyed = m_interference.IsDestroyedByInterference (event);
+  SetRxParameters (packet, event->GetSpreadingFactor (),
+                   event->GetRxPowerdBm (), event->GetFrequency (),
+                   packetDestroyed);
 
   // Fire the trace source if packet was destroyed
   if (packetDestroyed)
@@ -304,7 +314,7 @@ SimpleEndDeviceLoraPhy::EndReceive (Ptr<Packet> packet,
       // If there is one, perform the callback to inform the upper layer
       if (!m_rxOkCallback.IsNull ())
         {
-          m_rxOkCallback (packet);
+          m_rxOkCallback (packet, m_rxParameters);
         }
 
     }
@@ -19,7 +19,7 @@
  */
 
 #include "ns3/simple-gateway-lora-phy.h"
-#include "ns3/lora-tag.h"
+#include "ns3/lora-profiler.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
@@ -65,7 +65,7 @@ SimpleGatewayLoraPhy::Send (Ptr<Packet> packet, LoraTxParameters txParams,
   Time duration = GetOnAirTime (packet, txParams);
 
   // Interrupt all receive operations
-  std::list<Ptr<SimpleGatewayLoraPhy::ReceptionPath> >::iterator it;
+  std::vector<Ptr<SimpleGatewayLoraPhy::ReceptionPath> >::iterator it;
   for (it = m_receptionPaths.begin (); it != m_receptionPaths.end (); ++it)
     {
 
@@ -73,17 +73,21 @@ SimpleGatewayLoraPhy::Send (Ptr<Packet> packet, LoraTxParameters txParams,
 
       if (!currentPath->IsAvailable ())     // Reception path is occupied
         {
+          Ptr<LoraInterferenceHelper::Event> event = currentPath->GetEvent ();
+          SetRxParameters (event->GetPacket (), event->GetSpreadingFactor (),
+                           event->GetRxPowerdBm (), event->GetFrequency (), 0);
+
           // Call the callback for reception interrupted by transmission
           // Fire the trace source
           if (m_device)
             {
-              m_noReceptionBecauseTransmitting (currentPath->GetEvent ()->GetPacket (),
+              m_noReceptionBecauseTransmitting (event->GetPacket (),
                                                 m_device->GetNode ()->GetId ());
 
             }
           else
             {
-              m_noReceptionBecauseTransmitting (currentPath->GetEvent ()->GetPacket (), 0);
+              m_noReceptionBecauseTransmitting (event->GetPacket (), 0);
             }
 
           // Cancel the scheduled EndReceive call
@@ -91,7 +95,7 @@ SimpleGatewayLoraPhy::Send (Ptr<Packet> packet, LoraTxParameters txParams,
 
           // Free it
           // This also resets all parameters like packet and endReceive call
-          currentPath->Free ();
+          FreeReceptionPath (currentPath->GetEvent ());
         }
     }
 
@@ -119,8 +123,11 @@ SimpleGatewayLoraPhy::StartReceive (Ptr<Packet> packet, double rxPowerDbm,
 {
   NS_LOG_FUNCTION (this << packet << rxPowerDbm << duration << frequencyMHz);
 
-  // Fire the trace source
+  LoraProfiler::Scope profilerScope (LoraProfiler::GATEWAY_RECEPTION);
+
+  // Fire the trace sources
   m_phyRxBeginTrace (packet);
+  m_signalArrival (packet, rxPowerDbm, sf, duration, frequencyMHz);
 
   // Add the event to the LoraInterferenceHelper
   Ptr<LoraInterferenceHelper::Event> event;
@@ -136,6 +143,7 @@ SimpleGatewayLoraPhy::StartReceive (Ptr<Packet> packet, double rxPowerDbm,
       m_phyRxEndTrace (packet);
 
       // Fire the trace source
+      SetRxParameters (packet, sf, rxPowerDbm, frequencyMHz, 0);
       if (m_device)
         {
           m_noReceptionBecauseTransmitting (packet, m_device->GetNode ()->GetId ());
@@ -148,65 +156,53 @@ SimpleGatewayLoraPhy::StartReceive (Ptr<Packet> packet, double rxPowerDbm,
       return;
     }
 
-  // Cycle over the receive paths to check availability to receive the packet
-  std::list<Ptr<SimpleGatewayLoraPhy::ReceptionPath> >::iterator it;
-
-  for (it = m_receptionPaths.begin (); it != m_receptionPaths.end (); ++it)
+  // Check whether a receive path listening on the channel of interest is
+  // available to receive the packet
+  if (IsReceptionPathAvailable (frequencyMHz))
     {
-      Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = *it;
+      // See whether the reception power is above or below the sensitivity
+      // for that spreading factor
+      double sensitivity = SimpleGatewayLoraPhy::sensitivity[unsigned(sf) - 7];
 
-      NS_LOG_DEBUG ("Current ReceptionPath is centered on frequency = " <<
-                    currentPath->GetFrequency ());
-
-      // If the receive path is available and listening on the channel of
-      // interest, we have a candidate
-      if (currentPath->GetFrequency () == frequencyMHz
-          && currentPath->IsAvailable ())
+      if (rxPowerDbm < sensitivity)       // Packet arrived below sensitivity
         {
-          // See whether the reception power is above or below the sensitivity
-          // for that spreading factor
-          double sensitivity = SimpleGatewayLoraPhy::sensitivity[unsigned(sf) - 7];
+          NS_LOG_INFO ("Dropping packet reception of packet with sf = "
+                       << unsigned(sf) <<
+                       " because under the sensitivity of "
+                       << sensitivity << " dBm");
 
-          if (rxPowerDbm < sensitivity)       // Packet arrived below sensitivity
+          SetRxParameters (packet, sf, rxPowerDbm, frequencyMHz, 0);
+          if (m_device)
             {
-              NS_LOG_INFO ("Dropping packet reception of packet with sf = "
-                           << unsigned(sf) <<
-                           " because under the sensitivity of "
-                           << sensitivity << " dBm");
-
-              if (m_device)
-                {
-                  m_underSensitivity (packet, m_device->GetNode ()->GetId ());
-                }
-              else
-                {
-                  m_underSensitivity (packet, 0);
-                }
-
-              // Since the packet is below sensitivity, it makes no sense to
-              // search for another ReceivePath
-              return;
+              m_underSensitivity (packet, m_device->GetNode ()->GetId ());
             }
-          else        // We have sufficient sensitivity to start receiving
+          else
             {
-              NS_LOG_INFO ("Scheduling reception of a packet, " <<
-                           "occupying one demodulator");
+              m_underSensitivity (packet, 0);
+            }
 
-              // Block this resource
-              currentPath->LockOnEvent (event);
-              m_occupiedReceptionPaths++;
+          // Since the packet is below sensitivity, it makes no sense to
+          // search for another ReceivePath
+          return;
+        }
+      else        // We have sufficient sensitivity to start receiving
+        {
+          NS_LOG_INFO ("Scheduling reception of a packet, " <<
+                       "occupying one demodulator");
 
-              // Schedule the end of the reception of the packet
-              EventId endReceiveEventId = Simulator::Schedule (duration,
-                                                               &LoraPhy::EndReceive,
-                                                               this, packet,
-                                                               event);
+          // Block this resource
+          Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath =
+            LockReceptionPath (event);
 
-              currentPath->SetEndReceive (endReceiveEventId);
+          // Schedule the end of the reception of the packet
+          EventId endReceiveEventId = Simulator::Schedule (duration,
+                                                           &LoraPhy::EndReceive,
+                                                           this, packet,
+                                                           event);
 
-              // Make sure we don't go on searching for other ReceivePaths
-              return;
-            }
+          currentPath->SetEndReceive (endReceiveEventId);
+
+          return;
         }
     }
   // If we get to this point, there are no demodulators we can use
@@ -215,6 +211,7 @@ SimpleGatewayLoraPhy::StartReceive (Ptr<Packet> packet, double rxPowerDbm,
                " because no suitable demodulator was found");
 
   // Fire the trace source
+  SetRxParameters (packet, sf, rxPowerDbm, frequencyMHz, 0);
   if (m_device)
     {
       m_noMoreDemodulators (packet, m_device->GetNode ()->GetId ());
@@ -231,6 +228,8 @@ SimpleGatewayLoraPhy::EndReceive (Ptr<Packet> packet,
 {
   NS_LOG_FUNCTION (this << packet << *event);
 
+  LoraProfiler::Scope profilerScope (LoraProfiler::GATEWAY_RECEPTION);
+
   // Call the trace source
   m_phyRxEndTrace (packet);
 
@@ -245,11 +244,9 @@ SimpleGatewayLoraPhy::EndReceive (Ptr<Packet> packet,
     {
       NS_LOG_DEBUG ("packetDestroyed by " << unsigned(packetDestroyed));
 
-      // Update the packet's LoraTag
-      LoraTag tag;
-      packet->RemovePacketTag (tag);
-      tag.SetDestroyedBy (packetDestroyed);
-      packet->AddPacketTag (tag);
+      SetRxParameters (packet, event->GetSpreadingFactor (),
+                       event->GetRxPowerdBm (), event->GetFrequency (),
+                       packetDestroyed);
 
       // Fire the trace source
       if (m_device)
@@ -267,6 +264,11 @@ SimpleGatewayLoraPhy::EndReceive (Ptr<Packet> packet,
                    unsigned(event->GetSpreadingFactor ()) <<
                    " received correctly");
 
+      // The receive power and frequency of this packet can be useful for
+      // upper layers trying to control link quality.
+      SetRxParameters (packet, event->GetSpreadingFactor (),
+                       event->GetRxPowerdBm (), event->GetFrequency (), 0);
+
       // Fire the trace source
       if (m_device)
         {
@@ -283,35 +285,13 @@ SimpleGatewayLoraPhy::EndReceive (Ptr<Packet> packet,
           // Make a copy of the packet
           // Ptr<Packet> packetCopy = packet->Copy ();
 
-          // Set the receive power and frequency of this packet in the LoraTag: this
-          // information can be useful for upper layers trying to control link
-          // quality.
-          LoraTag tag;
-          packet->RemovePacketTag (tag);
-          tag.SetReceivePower (event->GetRxPowerdBm ());
-          tag.SetFrequency (event->GetFrequency ());
-          packet->AddPacketTag (tag);
-
-          m_rxOkCallback (packet);
+          m_rxOkCallback (packet, m_rxParameters);
         }
 
     }
 
-  // Search for the demodulator that was locked on this event to free it.
-
-  std::list< Ptr< SimpleGatewayLoraPhy::ReceptionPath > >::iterator it;
-
-  for (it = m_receptionPaths.begin (); it != m_receptionPaths.end (); ++it)
-    {
-      Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = *it;
-
-      if (currentPath->GetEvent () == event)
-        {
-          currentPath->Free ();
-          m_occupiedReceptionPaths--;
-          return;
-        }
-    }
+  // Free the demodulator that was locked on this event
+  FreeReceptionPath (event);
 }
 
 }
@@ -8,10 +8,26 @@
 #include "ns3/mobility-helper.h"
 #include "ns3/one-shot-sender-helper.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/correlated-shadowing-propagation-loss-model.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/lora-background-traffic-helper.h"
+#include "ns3/lora-partition-helper.h"
+#include "ns3/lora-remote-transmission-header.h"
+#include "ns3/lora-lazy-energy-source.h"
+#include "ns3/lora-tag.h"
+#include "ns3/lora-radio-energy-model.h"
+#include "ns3/building-penetration-loss.h"
+#include "ns3/mobility-building-info.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include "utilities.h"
+
+#include <algorithm>
+#include <cstring>
+
 using namespace ns3;
 using namespace lorawan;
 
@@ -81,6 +97,28 @@ InterferenceTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (retval, true, "Overlap computation didn't give the expected result");
   interferenceHelper.ClearAllEvents ();
 
+  // Events starting at different times: advance the simulation clock between
+  // additions. An interferer fully contained in the event only overlaps for
+  // its own duration.
+  event = interferenceHelper.Add (Seconds (4), 14, 7, 0, frequency);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  event1 = interferenceHelper.Add (Seconds (1), 14, 12, 0, frequency);
+  NS_TEST_EXPECT_MSG_EQ (interferenceHelper.GetOverlapTime (event, event1), Seconds (1), "Overlap with a contained event didn't give the expected result");
+  NS_TEST_EXPECT_MSG_EQ (interferenceHelper.GetOverlapTime (event1, event), Seconds (1), "Overlap with a containing event didn't give the expected result");
+  interferenceHelper.ClearAllEvents ();
+  Simulator::Destroy ();
+
+  // An interferer starting during the event and ending after it
+  event = interferenceHelper.Add (Seconds (2), 14, 7, 0, frequency);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  event1 = interferenceHelper.Add (Seconds (3), 14, 12, 0, frequency);
+  NS_TEST_EXPECT_MSG_EQ (interferenceHelper.GetOverlapTime (event, event1), Seconds (1), "Partial overlap computation didn't give the expected result");
+  NS_TEST_EXPECT_MSG_EQ (interferenceHelper.GetOverlapTime (event1, event), Seconds (1), "Partial overlap computation didn't give the expected result");
+  interferenceHelper.ClearAllEvents ();
+  Simulator::Destroy ();
+
   // Perfect overlap, packet survives
   event = interferenceHelper.Add (Seconds (2), 14, 7, 0, frequency);
   interferenceHelper.Add (Seconds (2), 14, 12, 0, frequency);
@@ -151,6 +189,155 @@ InterferenceTest::DoRun (void)
   interferenceHelper.Add (Seconds (2), 14 + 16, 10, 0, frequency);
   NS_TEST_EXPECT_MSG_EQ (interferenceHelper.IsDestroyedByInterference (event), 0, "Packet did not survive interference as expected");
   interferenceHelper.ClearAllEvents ();
+
+  // Event pool
+  // The memory of released events is reused
+  event = 0;
+  LoraInterferenceHelper::EventAllocationCounters counters =
+    interferenceHelper.GetEventAllocationCounters ();
+  event = interferenceHelper.Add (Seconds (2), 14, 7, 0, frequency);
+  interferenceHelper.Add (Seconds (2), 14, 8, 0, frequency);
+  LoraInterferenceHelper::EventAllocationCounters newCounters =
+    interferenceHelper.GetEventAllocationCounters ();
+  NS_TEST_EXPECT_MSG_EQ (newCounters.events, counters.events + 2, "Events were not counted");
+  NS_TEST_EXPECT_MSG_EQ (newCounters.reusedEvents, counters.reusedEvents + 2, "Memory of released events was not reused");
+  NS_TEST_EXPECT_MSG_EQ (newCounters.chunks, counters.chunks, "Memory was allocated although released events were available");
+  interferenceHelper.ClearAllEvents ();
+
+  // Events stay valid after their helper is destroyed
+  {
+    LoraInterferenceHelper otherHelper;
+    event = otherHelper.Add (Seconds (2), 14, 9, 0, differentFrequency);
+  }
+  NS_TEST_EXPECT_MSG_EQ (unsigned (event->GetSpreadingFactor ()), 9, "Event was not kept alive by its handle");
+  NS_TEST_EXPECT_MSG_EQ (event->GetFrequency (), differentFrequency, "Event was not kept alive by its handle");
+}
+
+/*************************
+ * InterferenceIndexTest *
+ *************************/
+
+class InterferenceIndexTest : public TestCase
+{
+public:
+  InterferenceIndexTest ();
+  virtual ~InterferenceIndexTest ();
+
+private:
+  virtual void DoRun (void);
+  void AdvanceTo (Time time);
+};
+
+// Add some help text to this case to describe what it is intended to test
+InterferenceIndexTest::InterferenceIndexTest ()
+  : TestCase ("Verify that LoraInterferenceHelper keeps its events sorted and pruned")
+{
+}
+
+// Reminder that the test case should clean up after itself
+InterferenceIndexTest::~InterferenceIndexTest ()
+{
+}
+
+// Move the simulation clock, since events start when they are added
+void
+InterferenceIndexTest::AdvanceTo (Time time)
+{
+  Simulator::Stop (time - Simulator::Now ());
+  Simulator::Run ();
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+InterferenceIndexTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("InterferenceIndexTest");
+
+  LoraInterferenceHelper interferenceHelper;
+  double frequency = 868.1;
+
+  // Events inserted out of order: restarting the simulator moves the clock
+  // back, so that the later events start before the first one
+  AdvanceTo (Seconds (3));
+  Ptr<LoraInterferenceHelper::Event> event =
+    interferenceHelper.Add (Seconds (1), 14, 7, 0, frequency);
+  Simulator::Destroy ();
+  AdvanceTo (Seconds (1));
+  interferenceHelper.Add (Seconds (0.5), 14 + 40, 7, 0, frequency);
+  AdvanceTo (Seconds (2.5));
+  Ptr<LoraInterferenceHelper::Event> interferer =
+    interferenceHelper.Add (Seconds (1), 14 + 40, 8, 0, frequency);
+  Simulator::Destroy ();
+
+  std::list<Ptr<LoraInterferenceHelper::Event> > events =
+    interferenceHelper.GetInterferers ();
+  NS_TEST_ASSERT_MSG_EQ (events.size (), 3, "Events were lost");
+  Time previousStart = Seconds (0);
+  for (auto it = events.begin (); it != events.end (); ++it)
+    {
+      NS_TEST_EXPECT_MSG_GT_OR_EQ ((*it)->GetStartTime (), previousStart,
+                                   "Events are not sorted by start time");
+      previousStart = (*it)->GetStartTime ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (unsigned (interferenceHelper.IsDestroyedByInterference (event)), 8,
+                         "Interferer inserted before the event was not found");
+  interferenceHelper.ClearAllEvents ();
+
+  // A long event is found even if shorter ones started after it
+  interferer = interferenceHelper.Add (Seconds (10), 14 + 40, 9, 0, frequency);
+  for (int i = 1; i <= 8; i++)
+    {
+      AdvanceTo (Seconds (i));
+      event = interferenceHelper.Add (Seconds (0.5), 14, 7, 0, frequency);
+    }
+  NS_TEST_EXPECT_MSG_EQ (unsigned (interferenceHelper.IsDestroyedByInterference (event)), 9,
+                         "Long interferer was not found");
+  Simulator::Destroy ();
+  interferenceHelper.ClearAllEvents ();
+
+  // Cleanup across the pruning boundary: events are kept as long as they can
+  // overlap with the longest event plus LoraInterferenceHelper's threshold.
+  // Here, all events last 1 s and the threshold is 2 s.
+  Ptr<LoraInterferenceHelper::Event> oldEvent =
+    interferenceHelper.Add (Seconds (1), 14, 7, 0, frequency);
+  AdvanceTo (Seconds (1));
+  Ptr<LoraInterferenceHelper::Event> boundaryEvent =
+    interferenceHelper.Add (Seconds (1), 14, 7, 0, frequency);
+  // The limit is 5 - 1 - 2 = 2 s: the first event ended before it, while the
+  // second one ends exactly at it
+  AdvanceTo (Seconds (5));
+  event = interferenceHelper.Add (Seconds (1), 14, 7, 0, frequency);
+  events = interferenceHelper.GetInterferers ();
+  NS_TEST_EXPECT_MSG_EQ (events.size (), 2, "Unexpected number of events after cleanup");
+  NS_TEST_EXPECT_MSG_EQ ((std::find (events.begin (), events.end (), oldEvent) == events.end ()),
+                         true, "Old event was not removed");
+  NS_TEST_EXPECT_MSG_EQ ((std::find (events.begin (), events.end (), boundaryEvent) != events.end ()),
+                         true, "Event at the boundary was removed");
+
+  // The remaining events are still found after the arrays were compacted
+  interferenceHelper.Add (Seconds (1), 14 + 40, 10, 0, frequency);
+  NS_TEST_EXPECT_MSG_EQ (unsigned (interferenceHelper.IsDestroyedByInterference (event)), 10,
+                         "Interferer was not found after cleanup");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (interferenceHelper.IsDestroyedByInterference (boundaryEvent)), 0,
+                         "Event was destroyed by a later one");
+  Simulator::Destroy ();
+  interferenceHelper.ClearAllEvents ();
+
+  // The slot of a freed event is used by the next one
+  oldEvent = 0;
+  boundaryEvent = 0;
+  interferer = 0;
+  events.clear ();
+  event = interferenceHelper.Add (Seconds (1), 14, 7, 0, frequency);
+  const LoraInterferenceHelper::Event *slot = PeekPointer (event);
+  interferenceHelper.ClearAllEvents ();
+  event = 0;
+  event = interferenceHelper.Add (Seconds (2), 14, 8, 0, frequency);
+  NS_TEST_EXPECT_MSG_EQ ((PeekPointer (event) == slot), true, "Freed event slot was not reused");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (event->GetSpreadingFactor ()), 8, "Reused event was not initialized");
+  NS_TEST_EXPECT_MSG_EQ (event->GetDuration (), Seconds (2), "Reused event was not initialized");
+  interferenceHelper.ClearAllEvents ();
 }
 
 /***************
@@ -368,6 +555,7 @@ private:
   int m_interferenceCalls = 0;
   int m_receivedPacketCalls = 0;
   int m_maxOccupiedReceptionPaths = 0;
+  int m_occupiedReceptionPaths = 0;
 
   double frequency1 = 868.1;
   double frequency2 = 868.3;
@@ -393,6 +581,7 @@ ReceivePathTest::Reset (void)
   m_interferenceCalls = 0;
   m_receivedPacketCalls = 0;
   m_maxOccupiedReceptionPaths = 0;
+  m_occupiedReceptionPaths = 0;
 
   gatewayPhy = CreateObject<SimpleGatewayLoraPhy> ();
   gatewayPhy->TraceConnectWithoutContext ("LostPacketBecauseNoMoreReceivers",
@@ -419,6 +608,7 @@ ReceivePathTest::OccupiedReceptionPaths (int oldValue, int newValue)
 {
   NS_LOG_FUNCTION (oldValue << newValue);
 
+  m_occupiedReceptionPaths = newValue;
   if (m_maxOccupiedReceptionPaths < newValue)
     {
       m_maxOccupiedReceptionPaths = newValue;
@@ -704,6 +894,33 @@ ReceivePathTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_interferenceCalls, 0, "Unexpected value");
   NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 1, "Unexpected value");
   NS_TEST_EXPECT_MSG_EQ (m_maxOccupiedReceptionPaths, 1, "Unexpected value");
+
+  Reset ();
+
+  ///////////////////////////////////////////////////////////////////////////
+  // ReceptionPaths freed because the gateway transmits are reused
+  ///////////////////////////////////////////////////////////////////////////
+  gatewayPhy->SetMobility (CreateObject<ConstantPositionMobilityModel> ());
+  gatewayPhy->SetChannel (CreateChannel ());
+  Simulator::Schedule (Seconds (1), &SimpleGatewayLoraPhy::StartReceive, gatewayPhy,
+                       packet, 14, 7, Seconds (4), frequency1);
+  Simulator::Schedule (Seconds (1), &SimpleGatewayLoraPhy::StartReceive, gatewayPhy,
+                       packet, 14, 8, Seconds (4), frequency1);
+  Simulator::Schedule (Seconds (2), &SimpleGatewayLoraPhy::Send, gatewayPhy,
+                       packet, LoraTxParameters (), 869.525, 14);
+  Simulator::Schedule (Seconds (3), &SimpleGatewayLoraPhy::StartReceive, gatewayPhy,
+                       packet, 14, 9, Seconds (1), frequency1);
+  Simulator::Schedule (Seconds (3), &SimpleGatewayLoraPhy::StartReceive, gatewayPhy,
+                       packet, 14, 10, Seconds (1), frequency1);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_noMoreDemodulatorsCalls, 0, "Unexpected value");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 2, "Unexpected value");
+  NS_TEST_EXPECT_MSG_EQ (m_maxOccupiedReceptionPaths, 2, "Unexpected value");
+  NS_TEST_EXPECT_MSG_EQ (m_occupiedReceptionPaths, 0, "ReceptionPaths were not freed");
 }
 
 /**************************
@@ -812,6 +1029,39 @@ LogicalLoraChannelTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (channelHelper->GetWaitingTime (channel4), 0, "Waiting time affects other subbands");
   NS_TEST_EXPECT_MSG_EQ (channelHelper->GetWaitingTime (channel5), 0, "Waiting time affects other subbands");
 
+  // Shared channel plan tests
+  ////////////////////////////
+
+  // Copies share the plan, but not the channel mask and duty cycle timers
+  LogicalLoraChannelHelper copy = *channelHelper;
+  copy.DisableChannel (1);
+  copy.AddEvent (Seconds (2), channel4);
+  NS_TEST_EXPECT_MSG_EQ (copy.GetEnabledChannelList ().size (), 4, "Channel was not disabled");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetEnabledChannelList ().size (), 5, "Channel mask is shared between copies");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetWaitingTime (channel4), 0, "Duty cycle timers are shared between copies");
+  NS_TEST_EXPECT_MSG_EQ (PeekPointer (copy.GetChannelList ().at (1)), PeekPointer (channelHelper->GetChannelList ().at (1)), "Plan is not shared between copies");
+
+  // Changing the plan of a copy doesn't affect the original
+  copy.EnableChannel (1);
+  copy.SetChannel (1, CreateObject<LogicalLoraChannel> (868.9));
+  NS_TEST_EXPECT_MSG_EQ (copy.GetChannelList ().at (1)->GetFrequency (), 868.9, "Channel was not set");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetChannelList ().at (1)->GetFrequency (), 868.3, "Plan changes are visible in other copies");
+
+  // The mask follows channels when one of them is removed
+  copy.DisableChannel (3);
+  copy.RemoveChannel (channel1);
+  NS_TEST_EXPECT_MSG_EQ (copy.GetChannelList ().size (), 4, "Channel was not removed");
+  NS_TEST_EXPECT_MSG_EQ (copy.IsChannelEnabled (2), false, "Channel mask was not updated on removal");
+  NS_TEST_EXPECT_MSG_EQ (copy.IsChannelEnabled (3), true, "Channel mask was not updated on removal");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetChannelList ().size (), 5, "Plan changes are visible in other copies");
+
+  // Events can be registered from the size of their payload
+  LoraTxParameters txParams;
+  Time duration = LoraPhy::GetOnAirTime (50, txParams);
+  channelHelper->AddEvent (50, txParams, channel4);
+  NS_TEST_EXPECT_MSG_EQ_TOL (channelHelper->GetWaitingTime (channel4),
+                             Seconds (duration.GetSeconds () / 0.1 - duration.GetSeconds ()),
+                             NanoSeconds (1), "Waiting time doesn't behave as expected");
 }
 
 /*****************
@@ -921,6 +1171,27 @@ TimeOnAirTest::DoRun (void)
   txParams.codingRate = 1;
   duration = LoraPhy::GetOnAirTime (packet, txParams);
   NS_TEST_EXPECT_MSG_EQ_TOL (duration.GetSeconds (), 2.301952, 0.0001, "Unexpected duration");
+
+  // Computing the duration from the payload size gives the same result, and
+  // so does looking it up in the table again
+  duration = LoraPhy::GetOnAirTime (50, txParams);
+  NS_TEST_EXPECT_MSG_EQ_TOL (duration.GetSeconds (), 2.301952, 0.0001, "Unexpected duration");
+  NS_TEST_EXPECT_MSG_EQ (LoraPhy::GetOnAirTime (50, txParams), duration, "Table lookup differs");
+
+  // Payloads that don't fit the table are computed, too
+  NS_TEST_EXPECT_MSG_EQ_TOL (LoraPhy::GetOnAirTime (300, txParams).GetSeconds (), 10.493952, 0.0001, "Unexpected duration");
+
+  // Each preamble symbol lasts one symbol, including with more combinations
+  // of parameters than there are tables
+  txParams.sf = 7;
+  for (uint32_t nPreamble = 6; nPreamble < 30; nPreamble++)
+    {
+      txParams.nPreamble = nPreamble;
+      Time shorter = LoraPhy::GetOnAirTime (10, txParams);
+      txParams.nPreamble = nPreamble + 1;
+      Time longer = LoraPhy::GetOnAirTime (10, txParams);
+      NS_TEST_EXPECT_MSG_EQ_TOL ((longer - shorter).GetSeconds (), 0.001024, 1e-9, "Unexpected duration");
+    }
 }
 
 /**************************
@@ -1291,38 +1562,1502 @@ PhyConnectivityTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (edPhy2->GetState (), SimpleEndDeviceLoraPhy::STANDBY, "State didn't switch to STANDBY as expected");
 }
 
-/*****************
- * LoraMacTest *
- *****************/
+/**************************
+ * ChannelCullingTest *
+ **************************/
 
-class LoraMacTest : public TestCase
+class ChannelCullingTest : public TestCase
 {
 public:
-  LoraMacTest ();
-  virtual ~LoraMacTest ();
+  ChannelCullingTest ();
+  virtual ~ChannelCullingTest ();
+  void Reset ();
+  void ReceivedPacket (Ptr<const Packet> packet, uint32_t node);
 
 private:
   virtual void DoRun (void);
+  Ptr<LoraChannel> channel;
+  Ptr<SimpleEndDeviceLoraPhy> edPhy1;
+  Ptr<SimpleEndDeviceLoraPhy> edPhy2;
+  Ptr<SimpleEndDeviceLoraPhy> edPhy3;
+
+  int m_receivedPacketCalls = 0;
 };
 
 // Add some help text to this case to describe what it is intended to test
-LoraMacTest::LoraMacTest ()
-  : TestCase ("Verify that the MAC layer of EDs behaves as expected")
+ChannelCullingTest::ChannelCullingTest ()
+  : TestCase ("Verify that LoraChannel only delivers packets to PHYs that can receive them")
 {
 }
 
 // Reminder that the test case should clean up after itself
-LoraMacTest::~LoraMacTest ()
+ChannelCullingTest::~ChannelCullingTest ()
+{
+}
+
+void
+ChannelCullingTest::ReceivedPacket (Ptr<const Packet> packet, uint32_t node)
+{
+  NS_LOG_FUNCTION (packet << node);
+
+  m_receivedPacketCalls++;
+}
+
+void
+ChannelCullingTest::Reset (void)
 {
+  m_receivedPacketCalls = 0;
+
+  Ptr<LogDistancePropagationLossModel> loss =
+    CreateObject<LogDistancePropagationLossModel> ();
+  loss->SetPathLossExponent (3.76);
+  loss->SetReference (1, 7.7);
+
+  Ptr<PropagationDelayModel> delay =
+    CreateObject<ConstantSpeedPropagationDelayModel> ();
+
+  channel = CreateObject<LoraChannel> (loss, delay);
+
+  edPhy1 = CreateObject<SimpleEndDeviceLoraPhy> ();
+  edPhy2 = CreateObject<SimpleEndDeviceLoraPhy> ();
+  edPhy3 = CreateObject<SimpleEndDeviceLoraPhy> ();
+
+  Ptr<ConstantPositionMobilityModel> mob1 = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> mob2 = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> mob3 = CreateObject<ConstantPositionMobilityModel> ();
+
+  // edPhy3 is far, but still able to receive SF12 packets from edPhy1
+  mob1->SetPosition (Vector (0.0, 0.0, 0.0));
+  mob2->SetPosition (Vector (10.0, 0.0, 0.0));
+  mob3->SetPosition (Vector (3000.0, 0.0, 0.0));
+
+  edPhy1->SetMobility (mob1);
+  edPhy2->SetMobility (mob2);
+  edPhy3->SetMobility (mob3);
+
+  Ptr<SimpleEndDeviceLoraPhy> phys[3] = {edPhy1, edPhy2, edPhy3};
+  for (int i = 0; i < 3; i++)
+    {
+      phys[i]->SwitchToStandby ();
+      phys[i]->SetChannel (channel);
+      phys[i]->SetSpreadingFactor (12);
+      phys[i]->SetFrequency (868.1);
+      channel->Add (phys[i]);
+      phys[i]->TraceConnectWithoutContext
+        ("ReceivedPacket", MakeCallback (&ChannelCullingTest::ReceivedPacket, this));
+    }
 }
 
 // This method is the pure virtual method from class TestCase that every
 // TestCase must implement
 void
-LoraMacTest::DoRun (void)
+ChannelCullingTest::DoRun (void)
 {
-  NS_LOG_DEBUG ("LoraMacTest");
+  NS_LOG_DEBUG ("ChannelCullingTest");
+
+  LoraTxParameters txParams;
+  txParams.sf = 12;
+
+  Ptr<Packet> packet = Create<Packet> (10);
+
+  // Without limits, both PHYs receive the packet
+  Reset ();
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 2, "Channel skipped some PHYs when delivering a packet");
+
+  // The far PHY is out of range
+  Reset ();
+  channel->SetAttribute ("MaxRange", DoubleValue (100));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 1, "Packet was delivered to a PHY out of range");
+
+  // Moving the far PHY close to the sender brings it back in range
+  Reset ();
+  channel->SetAttribute ("MaxRange", DoubleValue (100));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+  Simulator::Schedule (Seconds (4), &ConstantPositionMobilityModel::SetPosition,
+                       edPhy3->GetMobility ()->GetObject<ConstantPositionMobilityModel> (),
+                       Vector (50.0, 50.0, 0.0));
+  Simulator::Schedule (Seconds (6), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 3, "PHY was not tracked when its position changed");
+
+  // The far PHY receives a power that is under the configured threshold
+  Reset ();
+  channel->SetAttribute ("MinRxPower", DoubleValue (-100));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 1, "Packet under the minimum power was delivered");
+
+  // Cached link budgets are recomputed when a PHY moves
+  Reset ();
+  channel->SetAttribute ("MinRxPower", DoubleValue (-100));
+  channel->SetAttribute ("CacheLinkBudgets", BooleanValue (true));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+  Simulator::Schedule (Seconds (4), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+  Simulator::Schedule (Seconds (6), &ConstantPositionMobilityModel::SetPosition,
+                       edPhy3->GetMobility ()->GetObject<ConstantPositionMobilityModel> (),
+                       Vector (50.0, 50.0, 0.0));
+  Simulator::Schedule (Seconds (8), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 4, "Cached link budget was not invalidated when a PHY moved");
+
+  // Sleeping PHYs are not delivered the packet at all
+  Reset ();
+  channel->SetAttribute ("OnlyListeningPhys", BooleanValue (true));
+  edPhy2->SwitchToSleep ();
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+  Simulator::Schedule (Seconds (4), &SimpleEndDeviceLoraPhy::SwitchToStandby, edPhy2);
+  Simulator::Schedule (Seconds (6), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
 
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 3, "Packet was delivered to a PHY that was not listening");
+
+  // Uplinks are not delivered to end devices
+  Reset ();
+  channel->SetAttribute ("SeparateIqPolarity", BooleanValue (true));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet,
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 0, "Uplink packet was delivered to an end device");
+}
+
+/***********************
+ * LinkBudgetCacheTest *
+ ***********************/
+
+class LinkBudgetCacheTest : public TestCase
+{
+public:
+  LinkBudgetCacheTest ();
+  virtual ~LinkBudgetCacheTest ();
+  void ReceivedPacket (Ptr<const Packet> packet, uint32_t node);
+  double GetSecondRxPower (Ptr<PropagationLossModel> loss);
+
+private:
+  virtual void DoRun (void);
+
+  Ptr<SimpleEndDeviceLoraPhy> m_receiver;
+  std::vector<double> m_rxPowers;
+};
+
+// Add some help text to this case to describe what it is intended to test
+LinkBudgetCacheTest::LinkBudgetCacheTest ()
+  : TestCase ("Verify that LoraChannel only caches link budgets of deterministic models")
+{
+}
+
+// Reminder that the test case should clean up after itself
+LinkBudgetCacheTest::~LinkBudgetCacheTest ()
+{
+}
+
+void
+LinkBudgetCacheTest::ReceivedPacket (Ptr<const Packet> packet, uint32_t node)
+{
+  m_rxPowers.push_back (m_receiver->GetRxParameters ().rxPowerDbm);
+}
+
+// Send two packets between two fixed PHYs, at 2 and 4 seconds, and return the
+// power the second one was received with
+double
+LinkBudgetCacheTest::GetSecondRxPower (Ptr<PropagationLossModel> loss)
+{
+  m_rxPowers.clear ();
+
+  Ptr<LoraChannel> channel =
+    CreateObject<LoraChannel> (loss, CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetAttribute ("CacheLinkBudgets", BooleanValue (true));
+
+  Ptr<SimpleEndDeviceLoraPhy> sender = CreateObject<SimpleEndDeviceLoraPhy> ();
+  m_receiver = CreateObject<SimpleEndDeviceLoraPhy> ();
+  Ptr<SimpleEndDeviceLoraPhy> phys[2] = {sender, m_receiver};
+  for (int i = 0; i < 2; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility =
+        CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (10.0 * i, 0.0, 0.0));
+      mobility->AggregateObject (CreateObject<MobilityBuildingInfo> ());
+      phys[i]->SetMobility (mobility);
+      phys[i]->SwitchToStandby ();
+      phys[i]->SetChannel (channel);
+      phys[i]->SetSpreadingFactor (12);
+      phys[i]->SetFrequency (868.1);
+      channel->Add (phys[i]);
+    }
+  m_receiver->TraceConnectWithoutContext
+    ("ReceivedPacket", MakeCallback (&LinkBudgetCacheTest::ReceivedPacket, this));
+
+  LoraTxParameters txParams;
+  txParams.sf = 12;
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, sender,
+                       Create<Packet> (10), txParams, 868.1, 14);
+  Simulator::Schedule (Seconds (4), &SimpleEndDeviceLoraPhy::Send, sender,
+                       Create<Packet> (10), txParams, 868.1, 14);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_receiver = 0;
+  NS_TEST_EXPECT_MSG_EQ (m_rxPowers.size (), 2, "Packets were not received");
+  return m_rxPowers.size () == 2 ? m_rxPowers[1] : 0;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+LinkBudgetCacheTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("LinkBudgetCacheTest");
+
+  // Between the two transmissions, the fixed received power changes. This is
+  // only seen by the channel if it does not use the cached value.
+  Ptr<FixedRssLossModel> rss = CreateObject<FixedRssLossModel> ();
+  rss->SetRss (-80);
+  Simulator::Schedule (Seconds (3), &FixedRssLossModel::SetRss, rss, -90);
+  NS_TEST_EXPECT_MSG_EQ (GetSecondRxPower (rss), -80, "Cached link budget was not used");
+
+  // A model that is not known to be deterministic bypasses the cache
+  rss = CreateObject<FixedRssLossModel> ();
+  rss->SetRss (-80);
+  Ptr<MatrixPropagationLossModel> matrix = CreateObject<MatrixPropagationLossModel> ();
+  matrix->SetDefaultLoss (0);
+  rss->SetNext (matrix);
+  Simulator::Schedule (Seconds (3), &FixedRssLossModel::SetRss, rss, -90);
+  NS_TEST_EXPECT_MSG_EQ (GetSecondRxPower (rss), -90, "Unknown loss model used the cache");
+
+  // So does a BuildingPenetrationLoss, unless it is frozen for each link
+  for (bool frozen : {false, true})
+    {
+      rss = CreateObject<FixedRssLossModel> ();
+      rss->SetRss (-80);
+      Ptr<BuildingPenetrationLoss> penetration = CreateObject<BuildingPenetrationLoss> ();
+      penetration->SetAttribute ("FrozenPerLink", BooleanValue (frozen));
+      rss->SetNext (penetration);
+      Simulator::Schedule (Seconds (3), &FixedRssLossModel::SetRss, rss, -90);
+      NS_TEST_EXPECT_MSG_EQ (GetSecondRxPower (rss), frozen ? -80 : -90,
+                             "Wrong use of the cache with FrozenPerLink " << frozen);
+    }
+
+  // Changing the chain of loss models empties the cache
+  rss = CreateObject<FixedRssLossModel> ();
+  rss->SetRss (-80);
+  Ptr<FixedRssLossModel> nextRss = CreateObject<FixedRssLossModel> ();
+  nextRss->SetRss (-90);
+  Simulator::Schedule (Seconds (3), &PropagationLossModel::SetNext, rss, nextRss);
+  NS_TEST_EXPECT_MSG_EQ (GetSecondRxPower (rss), -90, "Stale link budget after the loss chain changed");
+}
+
+/**********************
+ * OutcomeTraceTest *
+ **********************/
+
+class OutcomeTraceTest : public TestCase
+{
+public:
+  OutcomeTraceTest ();
+  virtual ~OutcomeTraceTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+OutcomeTraceTest::OutcomeTraceTest ()
+  : TestCase ("Verify that binary outcome traces can be read back")
+{
+}
+
+OutcomeTraceTest::~OutcomeTraceTest ()
+{
+}
+
+void
+OutcomeTraceTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("OutcomeTraceTest");
+
+  std::string filename = CreateTempDirFilename ("outcomes.bin");
+
+  // Use small blocks, so that the last one is only partially filled
+  LoraOutcomeTraceWriter writer (filename, 3);
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      writer.Write (Seconds (i), 100 + i, 1, 7 + i % 6, 868.1, -100.0 - i,
+                    PacketOutcome (i % 5));
+    }
+  writer.Close ();
+
+  LoraOutcomeTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Trace could not be opened");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetBlocks ().size (), 3, "Unexpected number of blocks");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetNRows (), 7, "Unexpected number of rows");
+
+  uint32_t i = 0;
+  const std::vector<LoraOutcomeTraceReader::Block> &blocks = reader.GetBlocks ();
+  for (auto block = blocks.begin (); block != blocks.end (); ++block)
+    {
+      for (uint32_t row = 0; row < block->rows; row++, i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (block->times[row], Seconds (i).GetNanoSeconds (), "Wrong time");
+          NS_TEST_EXPECT_MSG_EQ (block->senders[row], 100 + i, "Wrong sender");
+          NS_TEST_EXPECT_MSG_EQ (block->gateways[row], 1, "Wrong gateway");
+          NS_TEST_EXPECT_MSG_EQ (unsigned(block->sfs[row]), 7 + i % 6, "Wrong SF");
+          NS_TEST_EXPECT_MSG_EQ (block->frequencies[row], 868.1, "Wrong frequency");
+          NS_TEST_EXPECT_MSG_EQ (block->rxPowers[row], -100.0 - i, "Wrong power");
+          NS_TEST_EXPECT_MSG_EQ (unsigned(block->outcomes[row]), i % 5, "Wrong outcome");
+        }
+    }
+}
+
+/*******************************
+ * CorrelatedShadowingTest *
+ *******************************/
+
+class CorrelatedShadowingTest : public TestCase
+{
+public:
+  CorrelatedShadowingTest ();
+  virtual ~CorrelatedShadowingTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CorrelatedShadowingTest::CorrelatedShadowingTest ()
+  : TestCase ("Verify that correlated shadowing values are stable and smooth")
+{
+}
+
+CorrelatedShadowingTest::~CorrelatedShadowingTest ()
+{
+}
+
+void
+CorrelatedShadowingTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("CorrelatedShadowingTest");
+
+  Ptr<CorrelatedShadowingPropagationLossModel> shadowing =
+    CreateObject<CorrelatedShadowingPropagationLossModel> ();
+
+  // Senders in different grid squares, and receivers on both sides of the
+  // edge between two squares
+  NodeContainer senders;
+  senders.Create (6);
+  NodeContainer receivers;
+  receivers.Create (3);
+  Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < senders.GetN (); i++)
+    {
+      allocator->Add (Vector (i * 200.0, 0, 0));
+    }
+  allocator->Add (Vector (1054.8, 500, 0));
+  allocator->Add (Vector (1055.2, 500, 0));
+  allocator->Add (Vector (1054.82, 500, 0));
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator (allocator);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (senders);
+  mobility.Install (receivers);
+
+  shadowing->Generate (senders, receivers, 4);
+
+  for (uint32_t i = 0; i < senders.GetN (); i++)
+    {
+      Ptr<MobilityModel> sender = senders.Get (i)->GetObject<MobilityModel> ();
+      double left = shadowing->CalcRxPower
+          (0, sender, receivers.Get (0)->GetObject<MobilityModel> ());
+      double right = shadowing->CalcRxPower
+          (0, sender, receivers.Get (1)->GetObject<MobilityModel> ());
+      double close = shadowing->CalcRxPower
+          (0, sender, receivers.Get (2)->GetObject<MobilityModel> ());
+
+      // Positions closer than 10 cm see the same shadowing
+      NS_TEST_EXPECT_MSG_EQ (close, left, "Shadowing changed within 10 cm");
+
+      // Shadowing is continuous across the edges of grid squares
+      NS_TEST_EXPECT_MSG_EQ_TOL (right, left, 1, "Shadowing is not smooth");
+
+      // Values do not change once generated
+      NS_TEST_EXPECT_MSG_EQ (shadowing->CalcRxPower
+                               (0, sender, receivers.Get (0)->GetObject<MobilityModel> ()),
+                             left, "Shadowing changed");
+    }
+}
+
+/*************************************
+ * SpreadingFactorAssignmentTest *
+ *************************************/
+
+class SpreadingFactorAssignmentTest : public TestCase
+{
+public:
+  SpreadingFactorAssignmentTest ();
+  virtual ~SpreadingFactorAssignmentTest ();
+
+private:
+  virtual void DoRun (void);
+  std::vector<uint8_t> GetDataRates (NodeContainer endDevices);
+};
+
+SpreadingFactorAssignmentTest::SpreadingFactorAssignmentTest ()
+  : TestCase ("Verify that SFs assigned using the closest gateways are correct")
+{
+}
+
+SpreadingFactorAssignmentTest::~SpreadingFactorAssignmentTest ()
+{
+}
+
+std::vector<uint8_t>
+SpreadingFactorAssignmentTest::GetDataRates (NodeContainer endDevices)
+{
+  std::vector<uint8_t> dataRates;
+  for (NodeContainer::Iterator it = endDevices.Begin (); it != endDevices.End (); ++it)
+    {
+      dataRates.push_back (GetMacLayerFromNode<EndDeviceLoraMac> (*it)->GetDataRate ());
+    }
+  return dataRates;
+}
+
+void
+SpreadingFactorAssignmentTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("SpreadingFactorAssignmentTest");
+
+  Ptr<LoraChannel> channel = CreateChannel ();
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::UniformDiscPositionAllocator",
+                                 "rho", DoubleValue (8000),
+                                 "X", DoubleValue (0.0),
+                                 "Y", DoubleValue (0.0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+
+  NodeContainer endDevices = CreateEndDevices (500, mobility, channel);
+  NodeContainer gateways = CreateGateways (10, mobility, channel);
+
+  std::vector<int> sfQuantity =
+    LoraMacHelper::SetSpreadingFactorsUp (endDevices, gateways, channel);
+  std::vector<uint8_t> dataRates = GetDataRates (endDevices);
+
+  // Since the log distance model only depends on distance, the closest
+  // gateway is always the best one
+  std::vector<int> nearestSfQuantity =
+    LoraMacHelper::SetSpreadingFactorsUp (endDevices, gateways, channel, 1, 4);
+  NS_TEST_EXPECT_MSG_EQ ((nearestSfQuantity == sfQuantity), true,
+                         "Different SF histograms");
+  NS_TEST_EXPECT_MSG_EQ ((GetDataRates (endDevices) == dataRates), true,
+                         "Different data rates");
+
+  nearestSfQuantity =
+    LoraMacHelper::SetSpreadingFactorsUp (endDevices, gateways, channel, 3, 1);
+  NS_TEST_EXPECT_MSG_EQ ((nearestSfQuantity == sfQuantity), true,
+                         "Different SF histograms");
+  NS_TEST_EXPECT_MSG_EQ ((GetDataRates (endDevices) == dataRates), true,
+                         "Different data rates");
+
+  // The assignment should not be trivial
+  NS_TEST_EXPECT_MSG_GT (sfQuantity[0], 0, "No device uses SF7");
+  NS_TEST_EXPECT_MSG_LT (sfQuantity[0], 500, "Only SF7 is used");
+
+  Simulator::Destroy ();
+}
+
+/*****************
+ * LoraMacTest *
+ *****************/
+
+class LoraMacTest : public TestCase
+{
+public:
+  LoraMacTest ();
+  virtual ~LoraMacTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+// Add some help text to this case to describe what it is intended to test
+LoraMacTest::LoraMacTest ()
+  : TestCase ("Verify that the MAC layer of EDs behaves as expected")
+{
+}
+
+// Reminder that the test case should clean up after itself
+LoraMacTest::~LoraMacTest ()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+LoraMacTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("LoraMacTest");
+
+}
+
+/*************************
+ * BackgroundTrafficTest *
+ *************************/
+
+class BackgroundTrafficTest : public TestCase
+{
+public:
+  BackgroundTrafficTest ();
+  virtual ~BackgroundTrafficTest ();
+
+private:
+  virtual void DoRun (void);
+  void Interference (Ptr<const Packet> packet, uint32_t node);
+
+  int m_interferenceCalls = 0;
+};
+
+// Add some help text to this case to describe what it is intended to test
+BackgroundTrafficTest::BackgroundTrafficTest ()
+  : TestCase ("Verify that background traffic is calibrated and injected")
+{
+}
+
+// Reminder that the test case should clean up after itself
+BackgroundTrafficTest::~BackgroundTrafficTest ()
+{
+}
+
+void
+BackgroundTrafficTest::Interference (Ptr<const Packet> packet, uint32_t node)
+{
+  m_interferenceCalls++;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+BackgroundTrafficTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("BackgroundTrafficTest");
+
+  // An injected signal destroys the packets it overlaps with
+  Ptr<SimpleGatewayLoraPhy> gatewayPhy = CreateObject<SimpleGatewayLoraPhy> ();
+  gatewayPhy->AddReceptionPath (868.1);
+  gatewayPhy->TraceConnectWithoutContext ("LostPacketBecauseInterference",
+                                          MakeCallback (&BackgroundTrafficTest::Interference, this));
+  gatewayPhy->AddInterference (-100, 7, Seconds (1), 868.1);
+  Simulator::Schedule (Seconds (0.5), &SimpleGatewayLoraPhy::StartReceive,
+                       gatewayPhy, Create<Packet> (10), -110, 7, Seconds (1),
+                       868.1);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_interferenceCalls, 1, "Packet was not destroyed by an injected signal");
+  Simulator::Destroy ();
+
+  // Calibrate with signals under sensitivity, which are never forwarded
+  LoraBackgroundTrafficHelper helper;
+  helper.SetMaxSamples (10);
+  helper.AssignCalibrationStreams (1);
+  NetworkComponents components = InitializeNetwork (1, 1);
+  Ptr<LoraPhy> phy = components.gateways.Get (0)->GetDevice (0)->
+    GetObject<LoraNetDevice> ()->GetPhy ();
+  helper.StartCalibration (components.gateways);
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (Seconds (i), &LoraPhy::StartReceive, phy,
+                           Create<Packet> (10), -150 - 0.01 * i, 7, Seconds (0.1), 868.1);
+      if (i % 2 == 0)
+        {
+          Simulator::Schedule (Seconds (i), &LoraPhy::StartReceive, phy,
+                               Create<Packet> (10), -150, 9, Seconds (0.3), 868.3);
+        }
+    }
+  Simulator::Stop (Seconds (100));
+  Simulator::Run ();
+  helper.StopCalibration ();
+
+  // Signals arriving after the end of calibration are not counted
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      Simulator::Schedule (Seconds (i), &LoraPhy::StartReceive, phy,
+                           Create<Packet> (10), -150, 7, Seconds (0.1), 868.1);
+    }
+  Simulator::Stop (Seconds (50));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ_TOL (helper.GetRate (0, 868.1, 7), 1, 1e-9, "Wrong SF7 rate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (helper.GetRate (0, 868.3, 9), 0.5, 1e-9, "Wrong SF9 rate");
+  NS_TEST_EXPECT_MSG_EQ (helper.GetRate (0, 868.5, 7), 0, "Wrong rate of an idle channel");
+
+  // Samples are drawn from all calibration signals, not only the first ones
+  std::vector<LoraBackgroundTraffic::Sample> samples = helper.GetSamples (0, 868.1, 7);
+  NS_TEST_EXPECT_MSG_EQ (samples.size (), 10, "Wrong number of samples");
+  bool laterSample = false;
+  for (auto it = samples.begin (); it != samples.end (); ++it)
+    {
+      laterSample = laterSample || it->first < -150.095;
+    }
+  NS_TEST_EXPECT_MSG_EQ (laterSample, true, "Only the first signals were sampled");
+
+  // When calibrating on some end devices, the signals of other senders are
+  // not counted. The device's signals arrive under sensitivity too.
+  LoraBackgroundTrafficHelper senderHelper;
+  components = InitializeNetwork (1, 1);
+  phy = components.gateways.Get (0)->GetDevice (0)->GetObject<LoraNetDevice> ()->GetPhy ();
+  Ptr<LoraPhy> endDevicePhy = components.endDevices.Get (0)->GetDevice (0)->
+    GetObject<LoraNetDevice> ()->GetPhy ();
+  senderHelper.StartCalibration (components.gateways, components.endDevices);
+  LoraTxParameters txParams;
+  txParams.sf = 7;
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (Seconds (i), &LoraPhy::StartReceive, phy,
+                           Create<Packet> (10), -150, 7, Seconds (0.1), 868.1);
+      if (i % 10 == 0)
+        {
+          Simulator::Schedule (Seconds (i + 0.5), &LoraPhy::Send, endDevicePhy,
+                               Create<Packet> (10), txParams, 868.1, -100);
+        }
+    }
+  Simulator::Stop (Seconds (100));
+  Simulator::Run ();
+  senderHelper.StopCalibration ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ_TOL (senderHelper.GetRate (0, 868.1, 7), 0.1, 1e-9,
+                             "Signals of other senders were counted");
+
+  // Replay twice the calibrated load on the gateway of another network
+  components = InitializeNetwork (1, 1);
+  helper.Install (components.gateways, 2);
+  helper.AssignStreams (components.gateways, 1);
+  Simulator::Stop (Seconds (1000));
+  Simulator::Run ();
+  Ptr<LoraBackgroundTraffic> traffic =
+    components.gateways.Get (0)->GetObject<LoraBackgroundTraffic> ();
+  NS_TEST_ASSERT_MSG_NE (traffic, 0, "Background traffic was not installed");
+  NS_TEST_EXPECT_MSG_EQ_TOL (double (traffic->GetNInjectedSignals ()), 3000, 150,
+                             "Wrong number of injected signals");
+  Simulator::Destroy ();
+}
+
+/*****************
+ * PartitionTest *
+ *****************/
+
+class PartitionTest : public TestCase
+{
+public:
+  PartitionTest ();
+  virtual ~PartitionTest ();
+  void Reset ();
+  void ReceivedPacket (Ptr<const Packet> packet, uint32_t node);
+
+private:
+  virtual void DoRun (void);
+  Ptr<LoraChannel> channel;
+  Ptr<SimpleEndDeviceLoraPhy> edPhy1;
+  Ptr<SimpleEndDeviceLoraPhy> edPhy2;
+  Ptr<SimpleEndDeviceLoraPhy> edPhy3;
+
+  int m_receivedPacketCalls = 0;
+  Time m_receptionTime;
+};
+
+// Add some help text to this case to describe what it is intended to test
+PartitionTest::PartitionTest ()
+  : TestCase ("Verify that LoraChannel only simulates the PHYs of its partition")
+{
+}
+
+// Reminder that the test case should clean up after itself
+PartitionTest::~PartitionTest ()
+{
+}
+
+void
+PartitionTest::ReceivedPacket (Ptr<const Packet> packet, uint32_t node)
+{
+  NS_LOG_FUNCTION (packet << node);
+
+  m_receivedPacketCalls++;
+  m_receptionTime = Simulator::Now ();
+}
+
+void
+PartitionTest::Reset (void)
+{
+  m_receivedPacketCalls = 0;
+
+  channel = CreateObject<LoraChannel>
+      (CreateObject<LogDistancePropagationLossModel> (),
+      CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  edPhy1 = CreateObject<SimpleEndDeviceLoraPhy> ();
+  edPhy2 = CreateObject<SimpleEndDeviceLoraPhy> ();
+  edPhy3 = CreateObject<SimpleEndDeviceLoraPhy> ();
+
+  // edPhy3 belongs to a partition simulated by another process
+  Ptr<SimpleEndDeviceLoraPhy> phys[3] = {edPhy1, edPhy2, edPhy3};
+  double xs[3] = {0, 10, 600};
+  uint32_t systemIds[3] = {0, 0, 1};
+  for (int i = 0; i < 3; i++)
+    {
+      Ptr<Node> node = CreateObject<Node> (systemIds[i]);
+      Ptr<LoraNetDevice> device = CreateObject<LoraNetDevice> ();
+      node->AddDevice (device);
+      phys[i]->SetDevice (device);
+
+      Ptr<ConstantPositionMobilityModel> mobility =
+        CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (xs[i], 0.0, 0.0));
+      phys[i]->SetMobility (mobility);
+
+      phys[i]->SwitchToStandby ();
+      phys[i]->SetChannel (channel);
+      phys[i]->SetSpreadingFactor (7);
+      phys[i]->SetFrequency (868.1);
+      channel->Add (phys[i]);
+      phys[i]->TraceConnectWithoutContext
+        ("ReceivedPacket", MakeCallback (&PartitionTest::ReceivedPacket, this));
+    }
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+PartitionTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("PartitionTest");
+
+  // The header describing a remote transmission survives serialization
+  LoraRemoteTransmissionHeader header;
+  header.SetSenderPosition (Vector (1.5, -2.5, 3.5));
+  header.SetTxPower (14);
+  header.SetSpreadingFactor (9);
+  header.SetFrequency (868.3);
+  header.SetDuration (MilliSeconds (123));
+  header.SetTxTime (NanoSeconds (456789));
+  header.SetDownlink (true);
+  Ptr<Packet> message = Create<Packet> (10);
+  message->AddHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (message->GetSize (), 10 + header.GetSerializedSize (),
+                         "Wrong message size");
+
+  LoraRemoteTransmissionHeader received;
+  message->RemoveHeader (received);
+  NS_TEST_EXPECT_MSG_EQ (received.GetSenderPosition ().y, -2.5, "Wrong position");
+  NS_TEST_EXPECT_MSG_EQ (received.GetTxPower (), 14, "Wrong power");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (received.GetSpreadingFactor ()), 9, "Wrong SF");
+  NS_TEST_EXPECT_MSG_EQ (received.GetFrequency (), 868.3, "Wrong frequency");
+  NS_TEST_EXPECT_MSG_EQ (received.GetDuration (), MilliSeconds (123), "Wrong duration");
+  NS_TEST_EXPECT_MSG_EQ (received.GetTxTime (), NanoSeconds (456789), "Wrong time");
+  NS_TEST_EXPECT_MSG_EQ (received.IsDownlink (), true, "Wrong direction");
+
+  // Nodes are assigned to strips by position
+  LoraPartitionHelper partitionHelper;
+  partitionHelper.SetStrips (0, 1000, 2);
+  NS_TEST_EXPECT_MSG_EQ (partitionHelper.GetSystemId (Vector (-5, 0, 0)), 0, "Wrong partition");
+  NS_TEST_EXPECT_MSG_EQ (partitionHelper.GetSystemId (Vector (499, 0, 0)), 0, "Wrong partition");
+  NS_TEST_EXPECT_MSG_EQ (partitionHelper.GetSystemId (Vector (501, 0, 0)), 1, "Wrong partition");
+  NS_TEST_EXPECT_MSG_EQ (partitionHelper.GetSystemId (Vector (2000, 0, 0)), 1, "Wrong partition");
+
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  positions->Add (Vector (100, 0, 0));
+  positions->Add (Vector (200, 50, 0));
+  positions->Add (Vector (800, 0, 0));
+  NodeContainer nodes = partitionHelper.Create (positions, 3);
+  NS_TEST_EXPECT_MSG_EQ (nodes.Get (1)->GetSystemId (), 0, "Node created in the wrong partition");
+  NS_TEST_EXPECT_MSG_EQ (nodes.Get (2)->GetSystemId (), 1, "Node created in the wrong partition");
+  NS_TEST_EXPECT_MSG_EQ (partitionHelper.GetLocal (nodes).GetN (), 2, "Wrong local nodes");
+  NS_TEST_EXPECT_MSG_EQ (partitionHelper.GetLookAhead (nodes, 100), Seconds (6),
+                         "Wrong look ahead");
+
+  // Without MPI, there is nothing to connect
+  Reset ();
+  NS_TEST_EXPECT_MSG_EQ (partitionHelper.Install (channel, Seconds (1)).GetN (), 0,
+                         "Partitions were connected without MPI");
+  Simulator::Destroy ();
+
+  // The PHY of the other partition doesn't receive local transmissions
+  LoraTxParameters txParams;
+  txParams.sf = 7;
+
+  Reset ();
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1,
+                       Create<Packet> (10), txParams, 868.1, 14);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 1, "A remote PHY received a packet");
+
+  // A transmission forwarded by another partition is received as if it was
+  // sent locally
+  Reset ();
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy3,
+                       Create<Packet> (10), txParams, 868.1, 14);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 2, "Local PHYs did not receive a packet");
+  Time localReceptionTime = m_receptionTime;
+
+  Reset ();
+  header.SetSenderPosition (Vector (600, 0, 0));
+  header.SetSpreadingFactor (7);
+  header.SetFrequency (868.1);
+  header.SetDuration (LoraPhy::GetOnAirTime (Create<Packet> (10), txParams));
+  header.SetTxTime (Seconds (2));
+  header.SetDownlink (false);
+  message = Create<Packet> (10);
+  message->AddHeader (header);
+  Simulator::Schedule (Seconds (2) + MicroSeconds (1), &LoraChannel::ReceiveRemote,
+                       channel, message);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 2, "Remote transmission was not delivered");
+  NS_TEST_EXPECT_MSG_EQ (m_receptionTime, localReceptionTime,
+                         "Remote transmission was received at the wrong time");
+}
+
+/******************
+ * LazyEnergyTest *
+ ******************/
+
+class LazyEnergyTest : public TestCase
+{
+public:
+  LazyEnergyTest ();
+  virtual ~LazyEnergyTest ();
+  void Depleted (void);
+
+private:
+  virtual void DoRun (void);
+
+  Time m_depletionTime;
+};
+
+// Add some help text to this case to describe what it is intended to test
+LazyEnergyTest::LazyEnergyTest ()
+  : TestCase ("Verify that LoraLazyEnergySource computes energy in closed form")
+{
+}
+
+// Reminder that the test case should clean up after itself
+LazyEnergyTest::~LazyEnergyTest ()
+{
+}
+
+void
+LazyEnergyTest::Depleted (void)
+{
+  m_depletionTime = Simulator::Now ();
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+LazyEnergyTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("LazyEnergyTest");
+
+  Ptr<LoraLazyEnergySource> source = CreateObject<LoraLazyEnergySource> ();
+  source->SetAttribute ("InitialEnergyJ", DoubleValue (1));
+  source->SetAttribute ("SupplyVoltageV", DoubleValue (3.3));
+  source->SetAttribute ("DepletionHorizon", TimeValue (Seconds (1)));
+
+  Ptr<LoraRadioEnergyModel> model = CreateObject<LoraRadioEnergyModel> ();
+  model->SetEnergySource (source);
+  source->AppendDeviceEnergyModel (model);
+  model->SetEnergyDepletionCallback (MakeCallback (&LazyEnergyTest::Depleted, this));
+  source->Initialize ();
+
+  // The radio sleeps for a second, is in standby for a second, transmits for
+  // a second and then stays in standby
+  Simulator::Schedule (Seconds (1), &LoraRadioEnergyModel::ChangeState, model,
+                       int (EndDeviceLoraPhy::STANDBY));
+  Simulator::Schedule (Seconds (2), &LoraRadioEnergyModel::ChangeState, model,
+                       int (EndDeviceLoraPhy::TX));
+  Simulator::Schedule (Seconds (3), &LoraRadioEnergyModel::ChangeState, model,
+                       int (EndDeviceLoraPhy::STANDBY));
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  double sleepEnergy = 0.0000015 * 3.3;
+  double txEnergy = 0.028 * 3.3;
+  double standbyPower = 0.0014 * 3.3;
+  double remainingEnergy = 1 - sleepEnergy - txEnergy - 8 * standbyPower;
+
+  NS_TEST_EXPECT_MSG_EQ (model->GetStateDuration (EndDeviceLoraPhy::STANDBY), Seconds (8),
+                         "Wrong time in standby");
+  NS_TEST_EXPECT_MSG_EQ_TOL (model->GetStateEnergyConsumption (EndDeviceLoraPhy::SLEEP),
+                             sleepEnergy, 1e-12, "Wrong energy in sleep");
+  NS_TEST_EXPECT_MSG_EQ_TOL (model->GetStateEnergyConsumption (EndDeviceLoraPhy::TX),
+                             txEnergy, 1e-12, "Wrong energy in tx");
+  NS_TEST_EXPECT_MSG_EQ_TOL (source->GetRemainingEnergy (), remainingEnergy, 1e-12,
+                             "Wrong remaining energy");
+  NS_TEST_EXPECT_MSG_EQ (source->IsTracking (), false, "Source tracks state changes too early");
+
+  Time expectedDepletion = Seconds (10 + remainingEnergy / standbyPower);
+  NS_TEST_EXPECT_MSG_EQ_TOL (source->GetDepletionTime (), expectedDepletion,
+                             MicroSeconds (1), "Wrong projected depletion time");
+
+  Simulator::Stop (Seconds (1000));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_depletionTime, expectedDepletion, MicroSeconds (1),
+                             "Energy was depleted at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (source->GetRemainingEnergy (), 0, "Depleted source has energy");
+
+  // The energy of a transmission can be computed without a packet
+  LoraTxParameters txParams;
+  NS_TEST_EXPECT_MSG_EQ_TOL (model->GetTxEnergy (50, txParams, 14),
+                             0.028 * 3.3 * LoraPhy::GetOnAirTime (50, txParams).GetSeconds (),
+                             1e-12, "Wrong transmission energy");
+  Simulator::Destroy ();
+}
+
+/***********************
+ * MacCommandValueTest *
+ ***********************/
+
+class MacCommandValueTest : public TestCase
+{
+public:
+  MacCommandValueTest ();
+  virtual ~MacCommandValueTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+// Add some help text to this case to describe what it is intended to test
+MacCommandValueTest::MacCommandValueTest ()
+  : TestCase ("Verify that MAC commands stored by value match MacCommand objects")
+{
+}
+
+// Reminder that the test case should clean up after itself
+MacCommandValueTest::~MacCommandValueTest ()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+MacCommandValueTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("MacCommandValueTest");
+
+  LoraFrameHeader frameHdr;
+  frameHdr.SetAsDownlink ();
+  frameHdr.SetAdr (true);
+  frameHdr.SetFPending (true);
+  frameHdr.AddLinkAdrReq (3, 2, std::list<int> {0, 2, 15}, 1);
+  frameHdr.AddDutyCycleReq (4);
+  NS_TEST_EXPECT_MSG_EQ (unsigned (frameHdr.GetFOptsLen ()), 7, "Wrong FOptsLen");
+
+  Ptr<Packet> pkt = Create<Packet> (10);
+  pkt->AddHeader (frameHdr);
+  NS_TEST_EXPECT_MSG_EQ (pkt->GetSize (), 10 + 8 + 7, "Wrong size of packet + header");
+
+  LoraFrameHeader frameHdr1;
+  frameHdr1.SetAsDownlink ();
+  pkt->RemoveHeader (frameHdr1);
+  NS_TEST_EXPECT_MSG_EQ (pkt->GetSize (), 10, "Wrong size of packet - header");
+  NS_TEST_EXPECT_MSG_EQ (frameHdr1.GetAdr (), true, "Adr changes in the serialization/deserialization process");
+  NS_TEST_EXPECT_MSG_EQ (frameHdr1.GetAck (), false, "Ack changes in the serialization/deserialization process");
+  NS_TEST_EXPECT_MSG_EQ (frameHdr1.GetFPending (), true, "FPending changes in the serialization/deserialization process");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (frameHdr1.GetNCommands ()), 2, "Commands were lost");
+
+  MacCommandValue linkAdrReq = frameHdr1.GetCommand (0);
+  NS_TEST_EXPECT_MSG_EQ (linkAdrReq.type, LINK_ADR_REQ, "Wrong command type");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (linkAdrReq.linkAdrReq.dataRate), 3, "Wrong data rate");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (linkAdrReq.linkAdrReq.txPower), 2, "Wrong tx power");
+  NS_TEST_EXPECT_MSG_EQ (linkAdrReq.linkAdrReq.channelMask, 0b1000000000000101,
+                         "Wrong channel mask");
+
+  MacCommandValue dutyCycleReq;
+  NS_TEST_EXPECT_MSG_EQ (frameHdr1.FindCommand (DUTY_CYCLE_REQ, dutyCycleReq), true,
+                         "DutyCycleReq not found");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (dutyCycleReq.dutyCycleReq.maxDCycle), 4, "Wrong duty cycle");
+
+  MacCommandValue devStatusReq;
+  NS_TEST_EXPECT_MSG_EQ (frameHdr1.FindCommand (DEV_STATUS_REQ, devStatusReq), false,
+                         "Found a command that was not added");
+
+  // Values and objects have the same wire format
+  std::list<Ptr<MacCommand> > commands = frameHdr1.GetCommands ();
+  NS_TEST_ASSERT_MSG_EQ (commands.size (), 2, "Commands were lost");
+  uint8_t valueBytes[6];
+  uint8_t objectBytes[6];
+  uint8_t i = 0;
+  for (auto it = commands.begin (); it != commands.end (); ++it, ++i)
+    {
+      MacCommandValue value = frameHdr1.GetCommand (i);
+      value.Serialize (valueBytes);
+
+      Buffer buf;
+      buf.AddAtStart ((*it)->GetSerializedSize ());
+      Buffer::Iterator serialized = buf.Begin ();
+      (*it)->Serialize (serialized);
+      buf.CopyData (objectBytes, buf.GetSize ());
+
+      NS_TEST_EXPECT_MSG_EQ (buf.GetSize (), value.GetSerializedSize (), "Sizes differ");
+      NS_TEST_EXPECT_MSG_EQ (std::memcmp (valueBytes, objectBytes, buf.GetSize ()), 0,
+                             "Serializations differ");
+    }
+
+  // FCtrl has a 4-bit FOptsLen, so commands can take more than 7 bytes
+  LoraFrameHeader longHdr;
+  longHdr.SetAsDownlink ();
+  longHdr.SetAdr (true);
+  longHdr.AddLinkAdrReq (3, 2, std::list<int> {0, 2, 15}, 1);
+  longHdr.AddNewChannelReq (3, 867.1e6, 0, 5);
+  longHdr.AddDutyCycleReq (4);
+  NS_TEST_EXPECT_MSG_EQ (unsigned (longHdr.GetFOptsLen ()), 13, "Wrong FOptsLen");
+
+  Buffer longBuf;
+  longBuf.AddAtStart (longHdr.GetSerializedSize ());
+  Buffer::Iterator longSerialized = longBuf.Begin ();
+  longHdr.Serialize (longSerialized);
+  Buffer::Iterator fCtrlIt = longBuf.Begin ();
+  fCtrlIt.Next (4);
+  NS_TEST_EXPECT_MSG_EQ (unsigned (fCtrlIt.ReadU8 ()), 0b10001101,
+                         "FCtrl should hold ADR in bit 7 and FOptsLen in bits 3..0");
+
+  LoraFrameHeader longHdr1;
+  longHdr1.SetAsDownlink ();
+  longSerialized = longBuf.Begin ();
+  longHdr1.Deserialize (longSerialized);
+  NS_TEST_EXPECT_MSG_EQ (longHdr1.GetAdr (), true, "Adr changes in the serialization/deserialization process");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (longHdr1.GetFOptsLen ()), 13, "FOptsLen was truncated");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (longHdr1.GetNCommands ()), 3, "Commands were lost");
+
+  MacCommandValue newChannelReq;
+  NS_TEST_EXPECT_MSG_EQ (longHdr1.FindCommand (NEW_CHANNEL_REQ, newChannelReq), true,
+                         "NewChannelReq not found");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (newChannelReq.newChannelReq.chIndex), 3, "Wrong channel index");
+  NS_TEST_EXPECT_MSG_EQ (newChannelReq.newChannelReq.frequency, 867.1e6, "Wrong frequency");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (newChannelReq.newChannelReq.maxDataRate), 5, "Wrong maximum data rate");
+
+  // NewChannelReq objects read the frequency in the order they write it
+  Ptr<NewChannelReq> newChannelReqObject = Create<NewChannelReq> (3, 867.1e6, 0, 5);
+  Buffer objectBuf;
+  objectBuf.AddAtStart (newChannelReqObject->GetSerializedSize ());
+  Buffer::Iterator objectSerialized = objectBuf.Begin ();
+  newChannelReqObject->Serialize (objectSerialized);
+  Ptr<NewChannelReq> newChannelReqObject1 = Create<NewChannelReq> ();
+  objectSerialized = objectBuf.Begin ();
+  newChannelReqObject1->Deserialize (objectSerialized);
+  NS_TEST_EXPECT_MSG_EQ (newChannelReqObject1->GetFrequency (), 867.1e6,
+                         "Wrong frequency after serialization/deserialization");
+
+  // Objects read the serialization of values
+  newChannelReq.Serialize (valueBytes);
+  objectSerialized = objectBuf.Begin ();
+  objectSerialized.Write (valueBytes, newChannelReq.GetSerializedSize ());
+  objectSerialized = objectBuf.Begin ();
+  newChannelReqObject1->Deserialize (objectSerialized);
+  NS_TEST_EXPECT_MSG_EQ (newChannelReqObject1->GetFrequency (), 867.1e6,
+                         "Wrong frequency in MacCommand object");
+
+  // Queued commands that would overflow FOpts are dropped
+  Ptr<EndDeviceLoraMac> edMac = CreateObject<EndDeviceLoraMac> ();
+  for (int command = 0; command < 10; command++)
+    {
+      edMac->AddMacCommand (MacCommandValue (DEV_STATUS_ANS));
+    }
+  LoraFrameHeader uplinkHdr;
+  edMac->ApplyNecessaryOptions (uplinkHdr);
+  NS_TEST_EXPECT_MSG_EQ (unsigned (uplinkHdr.GetNCommands ()), 5,
+                         "Only five 3-byte DevStatusAns fit in FOpts");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (uplinkHdr.GetFOptsLen ()), 15, "Wrong FOptsLen");
+}
+
+/********************
+ * RxParametersTest *
+ ********************/
+
+class RxParametersTest : public TestCase
+{
+public:
+  RxParametersTest ();
+  virtual ~RxParametersTest ();
+  void ReceivedPacket (Ptr<const Packet> packet, const LoraRxParameters &rxParams);
+  void InterruptedReception (Ptr<const Packet> packet, uint32_t node);
+
+private:
+  virtual void DoRun (void);
+
+  Ptr<SimpleGatewayLoraPhy> m_gatewayPhy;
+  LoraRxParameters m_rxParams;
+  LoraRxParameters m_interruptedRxParams;
+  bool m_tagged = false;
+  LoraTag m_tag;
+};
+
+// Add some help text to this case to describe what it is intended to test
+RxParametersTest::RxParametersTest ()
+  : TestCase ("Verify that the PHY passes reception parameters to the upper layer")
+{
+}
+
+// Reminder that the test case should clean up after itself
+RxParametersTest::~RxParametersTest ()
+{
+}
+
+void
+RxParametersTest::ReceivedPacket (Ptr<const Packet> packet,
+                                  const LoraRxParameters &rxParams)
+{
+  m_rxParams = rxParams;
+  m_tagged = packet->PeekPacketTag (m_tag);
+}
+
+void
+RxParametersTest::InterruptedReception (Ptr<const Packet> packet, uint32_t node)
+{
+  m_interruptedRxParams = m_gatewayPhy->GetRxParameters ();
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+RxParametersTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("RxParametersTest");
+
+  for (bool tagPackets : {false, true})
+    {
+      m_rxParams = LoraRxParameters ();
+      m_tagged = false;
+
+      Ptr<SimpleGatewayLoraPhy> gatewayPhy = CreateObject<SimpleGatewayLoraPhy> ();
+      gatewayPhy->SetAttribute ("TagPackets", BooleanValue (tagPackets));
+      gatewayPhy->AddReceptionPath (868.1);
+      gatewayPhy->SetReceiveOkCallback (MakeCallback (&RxParametersTest::ReceivedPacket, this));
+
+      Ptr<Packet> packet = Create<Packet> (10);
+      Simulator::Schedule (Seconds (1), &SimpleGatewayLoraPhy::StartReceive, gatewayPhy,
+                           packet, -110, 9, Seconds (1), 868.1);
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      NS_TEST_EXPECT_MSG_EQ (unsigned (m_rxParams.sf), 9, "Wrong spreading factor");
+      NS_TEST_EXPECT_MSG_EQ (m_rxParams.rxPowerDbm, -110, "Wrong receive power");
+      NS_TEST_EXPECT_MSG_EQ (m_rxParams.frequencyMHz, 868.1, "Wrong frequency");
+      NS_TEST_EXPECT_MSG_EQ (unsigned (m_rxParams.destroyedBy), 0, "Packet was destroyed");
+      NS_TEST_EXPECT_MSG_EQ (gatewayPhy->GetRxParameters ().rxPowerDbm, -110,
+                             "Wrong parameters of the last reception");
+
+      // The LoraTag is only set on request
+      NS_TEST_EXPECT_MSG_EQ (m_tagged, tagPackets, "Unexpected LoraTag");
+      if (tagPackets)
+        {
+          NS_TEST_EXPECT_MSG_EQ (unsigned (m_tag.GetSpreadingFactor ()), 9,
+                                 "Wrong spreading factor in the LoraTag");
+          NS_TEST_EXPECT_MSG_EQ (m_tag.GetReceivePower (), -110,
+                                 "Wrong receive power in the LoraTag");
+        }
+    }
+
+  // A transmission interrupting a reception reports the parameters of the
+  // interrupted reception, not those of the last completed one
+  m_gatewayPhy = CreateObject<SimpleGatewayLoraPhy> ();
+  m_gatewayPhy->AddReceptionPath (868.1);
+  m_gatewayPhy->SetMobility (CreateObject<ConstantPositionMobilityModel> ());
+  m_gatewayPhy->SetChannel (CreateChannel ());
+  m_gatewayPhy->TraceConnectWithoutContext ("NoReceptionBecauseTransmitting",
+                                            MakeCallback (&RxParametersTest::InterruptedReception,
+                                                          this));
+
+  Simulator::Schedule (Seconds (1), &SimpleGatewayLoraPhy::StartReceive, m_gatewayPhy,
+                       Create<Packet> (10), -110, 9, Seconds (1), 868.1);
+  Simulator::Schedule (Seconds (3), &SimpleGatewayLoraPhy::StartReceive, m_gatewayPhy,
+                       Create<Packet> (10), -100, 12, Seconds (2), 868.1);
+  Simulator::Schedule (Seconds (4), &SimpleGatewayLoraPhy::Send, m_gatewayPhy,
+                       Create<Packet> (10), LoraTxParameters (), 869.525, 14);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (unsigned (m_interruptedRxParams.sf), 12,
+                         "Wrong spreading factor of the interrupted reception");
+  NS_TEST_EXPECT_MSG_EQ (m_interruptedRxParams.rxPowerDbm, -100,
+                         "Wrong receive power of the interrupted reception");
+  m_gatewayPhy = 0;
+}
+
+/***********************
+ * StreamingTrackerTest *
+ ***********************/
+
+class StreamingTrackerTest : public TestCase
+{
+public:
+  StreamingTrackerTest ();
+  virtual ~StreamingTrackerTest ();
+  void SendPacket (Ptr<Packet> packet);
+  void ReceivePacket (Ptr<Packet> packet, bool received);
+  void FinishPacket (Ptr<Packet> packet, uint8_t reqTx, bool success, Time firstAttempt);
+
+private:
+  virtual void DoRun (void);
+
+  Ptr<SimpleGatewayLoraPhy> m_gatewayPhy;
+  std::vector<LoraPacketTracker *> m_trackers;
+};
+
+// Add some help text to this case to describe what it is intended to test
+StreamingTrackerTest::StreamingTrackerTest ()
+  : TestCase ("Verify that the streaming packet tracker counts like the regular one")
+{
+}
+
+// Reminder that the test case should clean up after itself
+StreamingTrackerTest::~StreamingTrackerTest ()
+{
+}
+
+void
+StreamingTrackerTest::SendPacket (Ptr<Packet> packet)
+{
+  for (auto tracker : m_trackers)
+    {
+      tracker->MacTransmissionCallback (packet);
+      tracker->TransmissionCallback (packet, 0);
+    }
+}
+
+void
+StreamingTrackerTest::ReceivePacket (Ptr<Packet> packet, bool received)
+{
+  for (auto tracker : m_trackers)
+    {
+      if (received)
+        {
+          tracker->PacketReceptionCallback (PeekPointer (m_gatewayPhy), packet, 0);
+          tracker->MacGwReceptionCallback (packet);
+        }
+      else
+        {
+          tracker->InterferenceCallback (PeekPointer (m_gatewayPhy), packet, 0);
+        }
+    }
+}
+
+void
+StreamingTrackerTest::FinishPacket (Ptr<Packet> packet, uint8_t reqTx,
+                                    bool success, Time firstAttempt)
+{
+  for (auto tracker : m_trackers)
+    {
+      tracker->RequiredTransmissionsCallback (reqTx, success, firstAttempt, packet);
+    }
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+StreamingTrackerTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("StreamingTrackerTest");
+
+  LoraPacketTracker tracker (CreateTempDirFilename ("tracker.txt"));
+  LoraPacketTracker streamingTracker (CreateTempDirFilename ("streaming-tracker.txt"));
+  streamingTracker.EnableStreaming (Seconds (10));
+  m_trackers = {&tracker, &streamingTracker};
+  m_gatewayPhy = CreateObject<SimpleGatewayLoraPhy> ();
+  for (auto t : m_trackers)
+    {
+      t->AddGateway ();
+    }
+
+  // The packet sent at 19.5 s has its PHY outcome exactly at 20 s, and the
+  // one sent at 20 s is sent exactly at the start of a bin
+  std::vector<double> sendTimes = {1, 5, 12, 19.5, 20, 33};
+  for (std::size_t i = 0; i < sendTimes.size (); i++)
+    {
+      Ptr<Packet> packet = Create<Packet> (10);
+      bool received = i % 2 == 0;
+      Simulator::Schedule (Seconds (sendTimes[i]), &StreamingTrackerTest::SendPacket,
+                           this, packet);
+      Simulator::Schedule (Seconds (sendTimes[i] + 0.5), &StreamingTrackerTest::ReceivePacket,
+                           this, packet, received);
+      Simulator::Schedule (Seconds (sendTimes[i] + 1), &StreamingTrackerTest::FinishPacket,
+                           this, packet, 1 + i % 3, received, Seconds (sendTimes[i]));
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::vector<std::pair<Time, Time> > intervals = {
+    {Seconds (0), Seconds (40)}, {Seconds (0), Seconds (20)}, {Seconds (20), Seconds (40)}};
+  std::vector<int> expectedPhyTotal = {6, 3, 3};
+  std::vector<int> expectedMacReceived = {3, 2, 1};
+  for (std::size_t i = 0; i < intervals.size (); i++)
+    {
+      Time start = intervals[i].first;
+      Time stop = intervals[i].second;
+
+      std::vector<int> phy = tracker.CountPhyOutcomes (start, stop);
+      std::vector<int> streamingPhy = streamingTracker.CountPhyOutcomes (start, stop);
+      NS_TEST_EXPECT_MSG_EQ (phy.at (0), expectedPhyTotal[i], "Wrong number of PHY outcomes");
+      for (std::size_t j = 0; j < phy.size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (streamingPhy.at (j), phy.at (j),
+                                 "Streaming PHY count differs in interval " << i);
+        }
+
+      MacOutcomeBin mac = tracker.CountMacOutcomes (start, stop);
+      MacOutcomeBin streamingMac = streamingTracker.CountMacOutcomes (start, stop);
+      NS_TEST_EXPECT_MSG_EQ (mac.receivedPackets, expectedMacReceived[i],
+                             "Wrong number of received MAC packets");
+      NS_TEST_EXPECT_MSG_EQ (streamingMac.receivedPackets, mac.receivedPackets,
+                             "Streaming MAC count differs in interval " << i);
+      NS_TEST_EXPECT_MSG_EQ (streamingMac.delaySum, mac.delaySum,
+                             "Streaming delay differs in interval " << i);
+      NS_TEST_EXPECT_MSG_EQ (streamingMac.ackDelaySum, mac.ackDelaySum,
+                             "Streaming ACK delay differs in interval " << i);
+      for (std::size_t j = 0; j < mac.successfulReTx.size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (streamingMac.successfulReTx.at (j), mac.successfulReTx.at (j),
+                                 "Streaming retransmission count differs in interval " << i);
+          NS_TEST_EXPECT_MSG_EQ (streamingMac.failedReTx.at (j), mac.failedReTx.at (j),
+                                 "Streaming retransmission count differs in interval " << i);
+        }
+    }
+
+  // The streaming tracker forgot every packet whose outcome is known
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetNTrackedPackets (), 18, "Packets were forgotten");
+  NS_TEST_EXPECT_MSG_EQ (streamingTracker.GetNTrackedPackets (), 0, "Packets were not retired");
+
+  m_trackers.clear ();
+  m_gatewayPhy = 0;
+}
+
+/***********************
+ * GatewayOutcomesTest *
+ **********************/
+
+class GatewayOutcomesTest : public TestCase
+{
+public:
+  GatewayOutcomesTest ();
+  virtual ~GatewayOutcomesTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+// Add some help text to this case to describe what it is intended to test
+GatewayOutcomesTest::GatewayOutcomesTest ()
+  : TestCase ("Verify that the outcomes of all gateways are recorded in the status of the sent packet")
+{
+}
+
+// Reminder that the test case should clean up after itself
+GatewayOutcomesTest::~GatewayOutcomesTest ()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+GatewayOutcomesTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("GatewayOutcomesTest");
+
+  LoraPacketTracker tracker (CreateTempDirFilename ("tracker.txt"));
+  LoraPacketTracker streamingTracker (CreateTempDirFilename ("streaming-tracker.txt"));
+  streamingTracker.EnableStreaming (Seconds (10));
+  Ptr<SimpleGatewayLoraPhy> firstGatewayPhy = CreateObject<SimpleGatewayLoraPhy> ();
+  Ptr<SimpleGatewayLoraPhy> secondGatewayPhy = CreateObject<SimpleGatewayLoraPhy> ();
+  streamingTracker.AddGateway ();
+  streamingTracker.AddGateway ();
+
+  Ptr<Packet> packet = Create<Packet> (10);
+  tracker.TransmissionCallback (packet, 0);
+  streamingTracker.TransmissionCallback (packet, 0);
+
+  // Each gateway reports the outcome of its own copy of the packet, which
+  // carries its own tags
+  Ptr<Packet> firstCopy = packet->Copy ();
+  LoraTag firstTag (7);
+  firstCopy->AddPacketTag (firstTag);
+  Ptr<Packet> secondCopy = packet->Copy ();
+  LoraTag secondTag (9);
+  secondCopy->AddPacketTag (secondTag);
+
+  tracker.PacketReceptionCallback (PeekPointer (firstGatewayPhy), firstCopy, 1);
+  streamingTracker.PacketReceptionCallback (PeekPointer (firstGatewayPhy), firstCopy, 1);
+  NS_TEST_EXPECT_MSG_EQ (streamingTracker.GetNTrackedPackets (), 1,
+                         "Packet retired before all gateways reported");
+  tracker.InterferenceCallback (PeekPointer (secondGatewayPhy), secondCopy, 2);
+  streamingTracker.InterferenceCallback (PeekPointer (secondGatewayPhy), secondCopy, 2);
+
+  const PacketStatus *status = tracker.GetPacketStatus (packet);
+  NS_TEST_ASSERT_MSG_NE (status, 0, "Sent packet is not tracked");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetNTrackedPackets (), 1,
+                         "Gateway copies were tracked as new packets");
+  NS_TEST_EXPECT_MSG_EQ (status->outcomeNumber, 2, "Outcome of a gateway was lost");
+  NS_TEST_EXPECT_MSG_EQ (status->receptions, 1, "Reception of the first gateway was lost");
+
+  // Once both gateways reported, the streaming tracker counts the packet as
+  // received and forgets it
+  NS_TEST_EXPECT_MSG_EQ (streamingTracker.GetNTrackedPackets (), 0,
+                         "Packet not retired after all gateways reported");
+  std::vector<int> phy = streamingTracker.CountPhyOutcomes (Seconds (0), Seconds (10));
+  NS_TEST_EXPECT_MSG_EQ (phy.at (0), 2, "Wrong number of PHY outcomes");
+  NS_TEST_EXPECT_MSG_EQ (phy.at (1), 1, "Wrong number of receptions");
+  NS_TEST_EXPECT_MSG_EQ (phy.at (2), 1, "Wrong number of interfered packets");
+
+  Simulator::Destroy ();
 }
 
 /**************
@@ -1345,12 +3080,25 @@ LorawanTestSuite::LorawanTestSuite ()
   LogComponentEnable ("LorawanTestSuite", LOG_LEVEL_DEBUG);
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new InterferenceTest, TestCase::QUICK);
+  AddTestCase (new InterferenceIndexTest, TestCase::QUICK);
   AddTestCase (new AddressTest, TestCase::QUICK);
   AddTestCase (new HeaderTest, TestCase::QUICK);
   AddTestCase (new ReceivePathTest, TestCase::QUICK);
   AddTestCase (new LogicalLoraChannelTest, TestCase::QUICK);
   AddTestCase (new TimeOnAirTest, TestCase::QUICK);
   AddTestCase (new PhyConnectivityTest, TestCase::QUICK);
+  AddTestCase (new ChannelCullingTest, TestCase::QUICK);
+  AddTestCase (new LinkBudgetCacheTest, TestCase::QUICK);
+  AddTestCase (new OutcomeTraceTest, TestCase::QUICK);
+  AddTestCase (new CorrelatedShadowingTest, TestCase::QUICK);
+  AddTestCase (new SpreadingFactorAssignmentTest, TestCase::QUICK);
+  AddTestCase (new BackgroundTrafficTest, TestCase::QUICK);
+  AddTestCase (new PartitionTest, TestCase::QUICK);
+  AddTestCase (new LazyEnergyTest, TestCase::QUICK);
+  AddTestCase (new MacCommandValueTest, TestCase::QUICK);
+  AddTestCase (new RxParametersTest, TestCase::QUICK);
+  AddTestCase (new StreamingTrackerTest, TestCase::QUICK);
+  AddTestCase (new GatewayOutcomesTest, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -15,6 +15,11 @@
 #include "ns3/callback.h"
 #include "ns3/network-server.h"
 #include "ns3/network-server-helper.h"
+#include "ns3/network-controller-components.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <deque>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -267,6 +272,239 @@ LinkCheckTest::DoRun (void)
   NS_ASSERT (m_receivedPacketAtEd);
 }
 
+////////////////////
+// SnrHistoryTest //
+////////////////////
+
+class SnrHistoryTest : public TestCase
+{
+public:
+  SnrHistoryTest ();
+  virtual ~SnrHistoryTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+// Add some help text to this case to describe what it is intended to test
+SnrHistoryTest::SnrHistoryTest ()
+  : TestCase ("Verify that the SNR history of AdrComponent keeps the maximum "
+              "and average of its last values")
+{
+}
+
+// Reminder that the test case should clean up after itself
+SnrHistoryTest::~SnrHistoryTest ()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+SnrHistoryTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("SnrHistoryTest");
+
+  AdrComponent::SnrHistory history (5);
+  std::deque<float> values;
+  Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable> ();
+  rv->SetStream (1);
+
+  for (int i = 0; i < 1000; i++)
+    {
+      double snr = rv->GetValue (-20, 10);
+      if (i % 101 == 100)
+        {
+          history.Clear ();
+          values.clear ();
+          continue;
+        }
+      else if (i % 7 == 6 && !values.empty ())
+        {
+          // Another gateway received the last packet
+          history.RaiseNewest (snr);
+          values.back () = std::max (values.back (), float (snr));
+        }
+      else
+        {
+          history.Add (snr);
+          values.push_back (snr);
+          if (values.size () > 5)
+            {
+              values.pop_front ();
+            }
+        }
+
+      double sum = 0;
+      for (auto it = values.begin (); it != values.end (); ++it)
+        {
+          sum += *it;
+        }
+      NS_TEST_ASSERT_MSG_EQ (history.GetSize (), values.size (), "Wrong size");
+      NS_TEST_ASSERT_MSG_EQ (history.GetMaximum (),
+                             *std::max_element (values.begin (), values.end ()),
+                             "Wrong maximum after " << i << " values");
+      NS_TEST_ASSERT_MSG_EQ_TOL (history.GetAverage (), sum / values.size (),
+                                 1e-4, "Wrong average after " << i << " values");
+    }
+}
+
+/////////////
+// AdrTest //
+/////////////
+
+class AdrTest : public TestCase
+{
+public:
+  AdrTest ();
+  virtual ~AdrTest ();
+
+  void SendPacket (Ptr<Node> endDevice);
+
+private:
+  virtual void DoRun (void);
+};
+
+// Add some help text to this case to describe what it is intended to test
+AdrTest::AdrTest ()
+  : TestCase ("Verify that the AdrComponent raises the data rate of devices "
+              "that use ADR")
+{
+}
+
+// Reminder that the test case should clean up after itself
+AdrTest::~AdrTest ()
+{
+}
+
+void
+AdrTest::SendPacket (Ptr<Node> endDevice)
+{
+  endDevice->GetDevice (0)->Send (Create<Packet> (20), Address (), 0);
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+AdrTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("AdrTest");
+
+  NetworkComponents components = InitializeNetwork (2, 1);
+  NodeContainer endDevices = components.endDevices;
+
+  Ptr<AdrComponent> adr = CreateObject<AdrComponent> ();
+  adr->SetAttribute ("HistoryRange", UintegerValue (3));
+  components.nsNode->GetApplication (0)->GetObject<NetworkServer> ()->AddComponent (adr);
+
+  // Both devices start from the slowest data rate, only the first one uses ADR
+  Ptr<EndDeviceLoraMac> adrMac = GetMacLayerFromNode<EndDeviceLoraMac> (endDevices.Get (0));
+  Ptr<EndDeviceLoraMac> otherMac = GetMacLayerFromNode<EndDeviceLoraMac> (endDevices.Get (1));
+  adrMac->SetAttribute ("EnableAdr", BooleanValue (true));
+  adrMac->SetDataRate (0);
+  otherMac->SetDataRate (0);
+
+  // Send enough packets to fill the history, respecting the duty cycle
+  for (int i = 0; i < 4; i++)
+    {
+      Simulator::Schedule (Seconds (1 + 200 * i), &AdrTest::SendPacket, this,
+                           endDevices.Get (0));
+      Simulator::Schedule (Seconds (100 + 200 * i), &AdrTest::SendPacket, this,
+                           endDevices.Get (1));
+    }
+
+  Simulator::Stop (Seconds (1000));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_GT (unsigned (adrMac->GetDataRate ()), 0,
+                         "The data rate of the ADR device didn't change");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (otherMac->GetDataRate ()), 0,
+                         "The data rate of a device without ADR changed");
+}
+
+////////////////////////
+// AdrRequestLossTest //
+////////////////////////
+
+class AdrRequestLossTest : public TestCase
+{
+public:
+  AdrRequestLossTest ();
+  virtual ~AdrRequestLossTest ();
+
+  void SendPacket (Ptr<Node> endDevice);
+
+private:
+  virtual void DoRun (void);
+};
+
+// Add some help text to this case to describe what it is intended to test
+AdrRequestLossTest::AdrRequestLossTest ()
+  : TestCase ("Verify that the AdrComponent repeats a LinkAdrReq that the "
+              "device didn't answer")
+{
+}
+
+// Reminder that the test case should clean up after itself
+AdrRequestLossTest::~AdrRequestLossTest ()
+{
+}
+
+void
+AdrRequestLossTest::SendPacket (Ptr<Node> endDevice)
+{
+  endDevice->GetDevice (0)->Send (Create<Packet> (20), Address (), 0);
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+AdrRequestLossTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("AdrRequestLossTest");
+
+  NetworkComponents components = InitializeNetwork (1, 1);
+  Ptr<Node> endDevice = components.endDevices.Get (0);
+
+  Ptr<AdrComponent> adr = CreateObject<AdrComponent> ();
+  adr->SetAttribute ("HistoryRange", UintegerValue (3));
+  components.nsNode->GetApplication (0)->GetObject<NetworkServer> ()->AddComponent (adr);
+
+  Ptr<EndDeviceLoraMac> mac = GetMacLayerFromNode<EndDeviceLoraMac> (endDevice);
+  mac->SetAttribute ("EnableAdr", BooleanValue (true));
+  mac->SetDataRate (0);
+
+  // The third uplink fills the history, but the device is out of range when
+  // the reply carrying the LinkAdrReq is sent
+  for (int i = 0; i < 4; i++)
+    {
+      Simulator::Schedule (Seconds (1 + 200 * i), &AdrRequestLossTest::SendPacket,
+                           this, endDevice);
+    }
+  Ptr<MobilityModel> mobility = endDevice->GetObject<MobilityModel> ();
+  Vector position = mobility->GetPosition ();
+  Simulator::Schedule (Seconds (403), &MobilityModel::SetPosition, mobility,
+                       Vector (1e6, 0, 0));
+  Simulator::Schedule (Seconds (500), &MobilityModel::SetPosition, mobility,
+                       position);
+
+  Simulator::Stop (Seconds (450));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (unsigned (mac->GetDataRate ()), 0,
+                         "The device received the LinkAdrReq");
+
+  // The history still describes the settings of the device, so the next
+  // uplink triggers the request again
+  Simulator::Stop (Seconds (650));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_GT (unsigned (mac->GetDataRate ()), 0,
+                         "The LinkAdrReq wasn't repeated");
+}
+
 /**************
  * Test Suite *
  **************/
@@ -305,6 +543,9 @@ NetworkServerTestSuite::NetworkServerTestSuite ()
   AddTestCase (new UplinkPacketTest, TestCase::QUICK);
   AddTestCase (new DownlinkPacketTest, TestCase::QUICK);
   AddTestCase (new LinkCheckTest, TestCase::QUICK);
+  AddTestCase (new SnrHistoryTest, TestCase::QUICK);
+  AddTestCase (new AdrTest, TestCase::QUICK);
+  AddTestCase (new AdrRequestLossTest, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -12,6 +12,11 @@
 #include "ns3/log.h"
 #include "ns3/end-device-status.h"
 #include "ns3/network-status.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lora-mac-header.h"
+#include "ns3/lora-tag.h"
+#include "ns3/mac48-address.h"
+#include "ns3/uinteger.h"
 #include "utilities.h"
 
 // An essential include is test.h
@@ -22,6 +27,27 @@ using namespace lorawan;
 
 NS_LOG_COMPONENT_DEFINE ("NetworkStatusTestSuite");
 
+// Build an uplink packet, as it would be forwarded by a gateway
+Ptr<Packet>
+CreateUplink (LoraDeviceAddress address, uint16_t fCnt, double rxPower)
+{
+  Ptr<Packet> packet = Create<Packet> (10);
+  LoraFrameHeader frameHdr;
+  frameHdr.SetAsUplink ();
+  frameHdr.SetAddress (address);
+  frameHdr.SetFCnt (fCnt);
+  packet->AddHeader (frameHdr);
+  LoraMacHeader macHdr;
+  macHdr.SetMType (LoraMacHeader::UNCONFIRMED_DATA_UP);
+  packet->AddHeader (macHdr);
+  LoraTag tag;
+  tag.SetSpreadingFactor (7);
+  tag.SetFrequency (868.1);
+  tag.SetReceivePower (rxPower);
+  packet->AddPacketTag (tag);
+  return packet;
+}
+
 /////////////////////////////
 // EndDeviceStatus testing //
 /////////////////////////////
@@ -56,6 +82,64 @@ EndDeviceStatusTest::DoRun (void)
 
   // Create an EndDeviceStatus object
   EndDeviceStatus eds = EndDeviceStatus ();
+
+  // Only the last packets are remembered
+  Ptr<EndDeviceStatus> edStatus = CreateObject<EndDeviceStatus> ();
+  edStatus->SetAttribute ("ReceivedPacketHistory", UintegerValue (2));
+  LoraDeviceAddress address (1);
+  Address gateway = Mac48Address::Allocate ();
+  for (uint16_t fCnt = 0; fCnt < 3; fCnt++)
+    {
+      edStatus->InsertReceivedPacket (CreateUplink (address, fCnt, -100), gateway);
+    }
+  EndDeviceStatus::ReceivedPacketList list = edStatus->GetReceivedPacketList ();
+  NS_TEST_EXPECT_MSG_EQ (list.size (), 2, "History is not bounded");
+  LoraMacHeader macHdr;
+  LoraFrameHeader frameHdr;
+  frameHdr.SetAsUplink ();
+  Ptr<Packet> oldest = list.front ().first->Copy ();
+  oldest->RemoveHeader (macHdr);
+  oldest->RemoveHeader (frameHdr);
+  NS_TEST_EXPECT_MSG_EQ (frameHdr.GetFCnt (), 1, "Oldest packet was not overwritten");
+
+  // Only the best gateways are remembered, but all of them are counted
+  Ptr<Packet> packet = CreateUplink (address, 3, -120);
+  edStatus->InsertReceivedPacket (packet, gateway);
+  Address bestGateway;
+  for (int i = 0; i < EndDeviceStatus::MAX_GATEWAYS_PER_PACKET + 2; i++)
+    {
+      Ptr<Packet> copy = CreateUplink (address, 3, -110 + i);
+      Address otherGateway = Mac48Address::Allocate ();
+      edStatus->InsertGatewayReception (copy, otherGateway, 3);
+      bestGateway = otherGateway;
+    }
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetLastReceivedPacketGatewayCount (), EndDeviceStatus::MAX_GATEWAYS_PER_PACKET + 3, "Gateways were not counted");
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetLastReceivedPacketInfo ().gwList.size (), EndDeviceStatus::MAX_GATEWAYS_PER_PACKET, "Gateway list is not bounded");
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetBestGatewayForReply (), bestGateway, "Best gateway was not kept");
+
+  // The history keeps the newest packets when its depth changes
+  Ptr<EndDeviceStatus> resized = CreateObject<EndDeviceStatus> ();
+  resized->SetAttribute ("ReceivedPacketHistory", UintegerValue (3));
+  for (uint16_t fCnt = 0; fCnt < 5; fCnt++)
+    {
+      resized->InsertReceivedPacket (CreateUplink (address, fCnt, -100), gateway);
+    }
+  resized->SetAttribute ("ReceivedPacketHistory", UintegerValue (5));
+  resized->InsertReceivedPacket (CreateUplink (address, 5, -100), gateway);
+  NS_TEST_EXPECT_MSG_EQ (resized->GetReceivedPacketList ().size (), 4, "Packets were lost when the history grew");
+  resized->SetAttribute ("ReceivedPacketHistory", UintegerValue (2));
+  resized->InsertReceivedPacket (CreateUplink (address, 6, -100), gateway);
+  list = resized->GetReceivedPacketList ();
+  NS_TEST_EXPECT_MSG_EQ (list.size (), 2, "History is not bounded after it shrank");
+  uint16_t expectedFCnt = 5;
+  for (auto it = list.begin (); it != list.end (); ++it)
+    {
+      Ptr<Packet> copy = it->first->Copy ();
+      copy->RemoveHeader (macHdr);
+      copy->RemoveHeader (frameHdr);
+      NS_TEST_EXPECT_MSG_EQ (frameHdr.GetFCnt (), expectedFCnt++, "Wrong packet kept");
+    }
+  NS_TEST_EXPECT_MSG_EQ (resized->GetLastReceivedPacketGatewayCount (), 1, "Wrong last packet");
 }
 
 /////////////////////////////
@@ -95,13 +179,82 @@ NetworkStatusTest::DoRun (void)
   NetworkStatus ns = NetworkStatus ();
 
   // Create a bunch of actual devices
-  NetworkComponents components = InitializeNetwork (1, 1);
+  NetworkComponents components = InitializeNetwork (100, 1);
 
   Ptr<LoraChannel> channel = components.channel;
   NodeContainer endDevices = components.endDevices;
   NodeContainer gateways = components.gateways;
 
-  ns.AddNode (GetMacLayerFromNode<EndDeviceLoraMac> (endDevices.Get (0)));
+  Ptr<EndDeviceLoraMac> edMac = GetMacLayerFromNode<EndDeviceLoraMac> (endDevices.Get (0));
+  ns.AddNode (edMac);
+
+  Ptr<Packet> packet = CreateUplink (edMac->GetDeviceAddress (), 1, -100);
+
+  // Copies forwarded by other gateways are merged into the first one
+  Address firstGateway = Mac48Address::Allocate ();
+  Address secondGateway = Mac48Address::Allocate ();
+  NS_TEST_EXPECT_MSG_EQ (ns.OnReceivedPacket (packet->Copy (), firstGateway), true, "First copy was not recognized as new");
+  NS_TEST_EXPECT_MSG_EQ (ns.OnReceivedPacket (packet->Copy (), secondGateway), false, "Duplicate was not recognized");
+  Ptr<EndDeviceStatus> edStatus = ns.GetEndDeviceStatus (edMac->GetDeviceAddress ());
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetLastReceivedPacketInfo ().gwList.size (), 2, "Gateway of the duplicate was not added");
+
+  // A new packet from the same device is not a duplicate
+  Ptr<Packet> otherPacket = CreateUplink (edMac->GetDeviceAddress (), 2, -100);
+  NS_TEST_EXPECT_MSG_EQ (ns.OnReceivedPacket (otherPacket, secondGateway), true, "New packet was recognized as a duplicate");
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetLastReceivedPacketInfo ().gwList.size (), 1, "Gateway list of a new packet is not empty");
+
+  // A late copy of the older packet is added to that packet, not to the
+  // newest one
+  NS_TEST_EXPECT_MSG_EQ (ns.OnReceivedPacket (packet->Copy (), Mac48Address::Allocate ()), false, "Late duplicate was not recognized");
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetLastReceivedPacketInfo ().gwList.size (), 1, "Late duplicate was added to the newest packet");
+  EndDeviceStatus::ReceivedPacketList receivedPackets = edStatus->GetReceivedPacketList ();
+  NS_TEST_EXPECT_MSG_EQ (receivedPackets.size (), 2, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (receivedPackets.front ().second.gwList.size (), 3, "Late duplicate was not added to its packet");
+
+  // Devices with sparse addresses are found in the table after it grows
+  for (uint32_t i = 1; i < endDevices.GetN (); i++)
+    {
+      Ptr<EndDeviceLoraMac> mac = GetMacLayerFromNode<EndDeviceLoraMac> (endDevices.Get (i));
+      mac->SetDeviceAddress (LoraDeviceAddress (0x01000000 + i * 7919));
+      ns.AddNode (mac);
+    }
+  ns.AddNode (edMac);
+  NS_TEST_EXPECT_MSG_EQ (ns.GetNEndDevices (), endDevices.GetN (), "Wrong number of devices");
+  for (uint32_t i = 0; i < endDevices.GetN (); i++)
+    {
+      Ptr<EndDeviceLoraMac> mac = GetMacLayerFromNode<EndDeviceLoraMac> (endDevices.Get (i));
+      Ptr<EndDeviceStatus> status = ns.GetEndDeviceStatus (mac->GetDeviceAddress ());
+      NS_TEST_EXPECT_MSG_NE (status, 0, "Device " << i << " was not found");
+      NS_TEST_EXPECT_MSG_EQ (status->GetMac (), mac, "Device " << i << " was mixed up");
+    }
+  Ptr<Packet> lastPacket = CreateUplink (GetMacLayerFromNode<EndDeviceLoraMac> (endDevices.Get (50))->GetDeviceAddress (), 1, -100);
+  NS_TEST_EXPECT_MSG_EQ (ns.GetEndDeviceStatus (lastPacket)->GetMac (),
+                         GetMacLayerFromNode<EndDeviceLoraMac> (endDevices.Get (50)),
+                         "Sender of a packet was not found");
+
+  // Unknown devices are not found
+  LoraDeviceAddress unknown (0x12345678);
+  NS_TEST_EXPECT_MSG_EQ (ns.GetEndDeviceStatus (unknown), 0, "Unknown device was found");
+  NS_TEST_EXPECT_MSG_EQ (ns.GetEndDeviceStatus (CreateUplink (unknown, 1, -100)), 0, "Sender of a packet from an unknown device was found");
+  NS_TEST_EXPECT_MSG_EQ (ns.GetEndDeviceStatuses ().size (), endDevices.GetN (), "Wrong number of statuses");
+
+  // Gateways are only found after they are added, even if they forwarded
+  // packets before
+  Ptr<GatewayStatus> gwStatus = Create<GatewayStatus> ();
+  NS_TEST_EXPECT_MSG_EQ (ns.GetGatewayStatus (firstGateway), 0, "Gateway that was not added was found");
+  ns.AddGateway (firstGateway, gwStatus);
+  NS_TEST_EXPECT_MSG_EQ (ns.GetGatewayStatus (firstGateway), gwStatus, "Gateway was not found");
+
+  // Looking up unknown gateways doesn't assign them an index
+  Ptr<GatewayAddressTable> table = Create<GatewayAddressTable> ();
+  Address unknownGateway = Mac48Address::Allocate ();
+  uint16_t index;
+  NS_TEST_EXPECT_MSG_EQ (ns.GetGatewayStatus (unknownGateway), 0, "Unknown gateway was found");
+  NS_TEST_EXPECT_MSG_EQ (table->FindIndex (unknownGateway, index), false, "Unknown gateway has an index");
+  NS_TEST_EXPECT_MSG_EQ (table->GetIndex (Mac48Address::Allocate ()), 0, "Lookup assigned an index");
+  NS_TEST_EXPECT_MSG_EQ (table->FindIndex (unknownGateway, index), false, "Lookup assigned an index");
+
+  Simulator::Destroy ();
 }
 
 /**************